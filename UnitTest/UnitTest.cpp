@@ -87,6 +87,20 @@ namespace UnitTest
 			Assert::AreEqual(ret, 0);
 		}
 
+		TEST_METHOD(congestion_extra_repeat)
+		{
+			int ret = quicrq_congestion_extra_repeat_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(congestion_dependency)
+		{
+			int ret = quicrq_congestion_dependency_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(congestion_datagram_recv)
 		{
 			int ret = quicrq_congestion_datagram_recv_test();
@@ -235,6 +249,13 @@ namespace UnitTest
 			Assert::AreEqual(ret, 0);
 		}
 
+		TEST_METHOD(twomedia_congestion_weights)
+		{
+			int ret = quicrq_twomedia_congestion_weights_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(twomedia_tri_stream)
 		{
 			int ret = quicrq_twomedia_tri_stream_test();
@@ -292,6 +313,54 @@ namespace UnitTest
 			Assert::AreEqual(ret, 0);
 		}
 
+		TEST_METHOD(relay_stats) {
+			int ret = quicrq_relay_stats_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_chunks) {
+			int ret = quicrq_relay_chunks_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_chunks_datagram) {
+			int ret = quicrq_relay_chunks_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_origin_timestamp) {
+			int ret = quicrq_relay_origin_timestamp_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_pass_through) {
+			int ret = quicrq_relay_pass_through_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_pass_through_datagram) {
+			int ret = quicrq_relay_pass_through_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_pass_through_warp) {
+			int ret = quicrq_relay_pass_through_warp_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(relay_pass_through_chain) {
+			int ret = quicrq_relay_pass_through_chain_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(subscribe_basic) {
 			int ret = quicrq_subscribe_basic_test();
 
@@ -448,6 +517,18 @@ namespace UnitTest
 			Assert::AreEqual(ret, 0);
 		}
 
+		TEST_METHOD(triangle_intent_time) {
+			int ret = quicrq_triangle_intent_time_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(triangle_intent_time_s) {
+			int ret = quicrq_triangle_intent_time_s_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(triangle_intent_warp) {
 			int ret = quicrq_triangle_intent_warp_test();
 
@@ -596,11 +677,137 @@ namespace UnitTest
 			Assert::AreEqual(ret, 0);
 		}
 
+		TEST_METHOD(fanout_basic) {
+			int ret = quicrq_fanout_basic_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fanout_datagram) {
+			int ret = quicrq_fanout_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fanout_busy) {
+			int ret = quicrq_fanout_busy_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fanout_repeat) {
+			int ret = quicrq_fanout_repeat_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(watchdog) {
+			int ret = quicrq_watchdog_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(watchdog_datagram) {
+			int ret = quicrq_watchdog_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(bundle) {
+			int ret = quicrq_bundle_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(bundle_loss) {
+			int ret = quicrq_bundle_loss_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(scenario) {
+			int ret = quicrq_scenario_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(churn) {
+			int ret = quicrq_churn_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(repair_deadline) {
+			int ret = quicrq_repair_deadline_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(redundant_ingest) {
+			int ret = quicrq_redundant_ingest_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(redundant_ingest_datagram) {
+			int ret = quicrq_redundant_ingest_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(redundant_ingest_loss) {
+			int ret = quicrq_redundant_ingest_loss_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(fragment_cache_fill) {
 			int ret = quicrq_fragment_cache_fill_test();
 
 			Assert::AreEqual(ret, 0);
 		}
+
+		TEST_METHOD(fragment_cache_seek_time) {
+			int ret = quicrq_fragment_cache_seek_time_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fragment_cache_extent) {
+			int ret = quicrq_fragment_cache_extent_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fragment_cache_streamed) {
+			int ret = quicrq_fragment_cache_streamed_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fragment_cache_repair_deadline) {
+			int ret = quicrq_fragment_cache_repair_deadline_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fragment_publisher_lag) {
+			int ret = quicrq_fragment_publisher_lag_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fragment_cache_duplicate) {
+			int ret = quicrq_fragment_cache_duplicate_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fragment_cache_cursor) {
+			int ret = quicrq_fragment_cache_cursor_test();
+
+			Assert::AreEqual(ret, 0);
+		}
 		TEST_METHOD(get_addr) {
 			int ret = quicrq_get_addr_test();
 
@@ -668,6 +875,36 @@ namespace UnitTest
             Assert::AreEqual(ret, 0);
         }
 
+		TEST_METHOD(warp_latest_first) {
+			int ret = quicrq_latest_first_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(warp_latest_first_relay) {
+			int ret = quicrq_latest_first_relay_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(warp_latest_first_relay_stream) {
+			int ret = quicrq_latest_first_relay_stream_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(warp_latest_first_relay_datagram) {
+			int ret = quicrq_latest_first_relay_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(warp_latest_first_start_time) {
+			int ret = quicrq_latest_first_start_time_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(rush_basic) {
 			int ret = quicrq_rush_basic_test();
 
@@ -687,6 +924,76 @@ namespace UnitTest
 			Assert::AreEqual(ret, 0);
 		}
 
+		TEST_METHOD(rush_pack)
+		{
+			int ret = quicrq_rush_pack_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(rush_pack_loss)
+		{
+			int ret = quicrq_rush_pack_loss_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(warp_uni_bound)
+		{
+			int ret = quicrq_warp_uni_bound_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(rush_uni_bound_loss)
+		{
+			int ret = quicrq_rush_uni_bound_loss_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(datagram_split)
+		{
+			int ret = quicrq_datagram_split_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(datagram_split_loss)
+		{
+			int ret = quicrq_datagram_split_loss_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fetch)
+		{
+			int ret = quicrq_fetch_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(fetch_partial)
+		{
+			int ret = quicrq_fetch_partial_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(resume_stream)
+		{
+			int ret = quicrq_resume_stream_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
+		TEST_METHOD(resume_datagram)
+		{
+			int ret = quicrq_resume_datagram_test();
+
+			Assert::AreEqual(ret, 0);
+		}
+
 		TEST_METHOD(rush_triangle) {
 			int ret = quicrq_triangle_rush_test();
 
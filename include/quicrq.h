@@ -14,7 +14,7 @@ extern "C" {
  * The minor version is updated when the protocol changes
  * Only the letter is updated if the code changes without changing the protocol
  */
-#define QUICRQ_VERSION "0.30"
+#define QUICRQ_VERSION "0.37"
 
 /* QUICR ALPN and QUICR port
  * For version zero, the ALPN is set to "quicr-h<minor>", where <minor> is
@@ -22,13 +22,14 @@ extern "C" {
  * different protocol versions will not be compatible, and connections attempts
  * between such binaries will fail, forcing deployments of compatible versions.
  */
-#define QUICRQ_ALPN "quicr-h30"
+#define QUICRQ_ALPN "quicr-h37"
 #define QUICRQ_PORT 853
 
 /* QUICR error codes */
 #define QUICRQ_ERROR_NO_ERROR 0x00
 #define QUICRQ_ERROR_INTERNAL 0x01
 #define QUICRQ_ERROR_PROTOCOL 0x02
+#define QUICRQ_ERROR_STALLED 0x03
 
 /* Media close error codes. */
 typedef enum {
@@ -90,6 +91,28 @@ void quicrq_init_transport_parameters(picoquic_tp_t* tp, int client_mode);
 #define QUICRQ_CACHE_INITIAL_DURATION 30000000
 
 void quicrq_set_cache_duration(quicrq_ctx_t* qr_ctx, uint64_t cache_duration_max);
+
+/* Subscription watchdog.
+ * A subscriber may keep its connection alive while its media stream stops making
+ * progress, for example if it stopped reading or if the path to it is black holed.
+ * The publishing context then keeps the state of the stream, and in a relay
+ * the data that the stream did not send yet is kept in the cache.
+ * The function "quicrq_set_subscription_watchdog" sets two thresholds:
+ * - a subscription is stalled if the data that it sent was not acknowledged
+ *   (datagrams) or its sending position did not move (streams) for more than
+ *   "stall_time_max" microseconds while more data was available,
+ * - a subscription to a real time media is stalled if it is more than
+ *   "lag_groups_max" groups behind the latest group received. This test does
+ *   not apply to fetches, or to subscriptions that asked to start at a given
+ *   point or time, since they intentionally start in the past.
+ * Stalled subscriptions are aborted: the control stream is reset with the
+ * error code QUICRQ_ERROR_STALLED and its resources are released.
+ * Setting a threshold to zero disables the corresponding test (this is the default.)
+ * The function "quicrq_get_nb_stalled_subscriptions" returns the number of
+ * subscriptions aborted so far.
+ */
+void quicrq_set_subscription_watchdog(quicrq_ctx_t* qr_ctx, uint64_t stall_time_max, uint64_t lag_groups_max);
+uint64_t quicrq_get_nb_stalled_subscriptions(quicrq_ctx_t* qr_ctx);
 uint64_t quicrq_time_check(quicrq_ctx_t* qr_ctx, uint64_t current_time);
 
 quicrq_cnx_ctx_t* quicrq_create_cnx_context(quicrq_ctx_t* qr_ctx, picoquic_cnx_t* cnx);
@@ -143,16 +166,48 @@ typedef struct st_quicrq_media_object_header_t {
  *       object ID MUST be set to 0.
  *     * if the group_id matches the previous value, the
  *       object ID MUST be set to previous value + 1.
+ * 
+ * The object properties may declare a dependency class for the object:
+ * 
+ * - independent: the object can be decoded by itself, e.g., a key frame.
+ * - depends on previous: the object can only be decoded if the previous
+ *   non-leaf object in the same group was decoded, e.g., a predicted frame.
+ * - discardable leaf: the object depends on the previous object, but no other
+ *   object depends on it.
+ * 
+ * When congestion control skips an object, the publisher also skips the
+ * objects of the same group that depend on it, since receivers could not
+ * decode them anyway. The class is only known to the node at which the
+ * object is published: it is not carried in the protocol, and relays
+ * forward the resulting placeholders. The default value, "none", keeps
+ * the per-object behavior.
  */
 
+typedef enum {
+    quicrq_object_dependency_none = 0,
+    quicrq_object_dependency_independent,
+    quicrq_object_dependency_previous,
+    quicrq_object_dependency_leaf
+} quicrq_object_dependency_enum;
+
 typedef struct st_quicrq_media_object_source_properties_t {
     unsigned int use_real_time_caching : 1;
     uint64_t start_group_id;
     uint64_t start_object_id;
 } quicrq_media_object_source_properties_t;
 
+/* Origin timestamps.
+ * The publisher may document the capture time of an object in the property
+ * "origin_timestamp", expressed in microseconds on the origin clock. The value
+ * is carried with the first fragment of the object in all transport modes, kept
+ * in relay caches, and passed unchanged to the object consumers, which can use
+ * it to measure the end-to-end latency of the media if the clocks are
+ * synchronized. The value zero means that the timestamp is not set.
+ */
 typedef struct st_quicrq_media_object_properties_t {
     uint8_t flags;
+    quicrq_object_dependency_enum dependency;
+    uint64_t origin_timestamp;
 } quicrq_media_object_properties_t;
 
 typedef struct st_quicrq_media_object_source_ctx_t quicrq_media_object_source_ctx_t;
@@ -168,6 +223,44 @@ int quicrq_publish_object(
     uint64_t group_id,
     uint64_t object_id);
 
+/* Streaming publication of objects.
+ * Live encoders that produce an object as a series of chunks, e.g., the slices
+ * of a video frame, can publish the chunks as they are produced instead of
+ * waiting for the complete object. The application opens the object with
+ * "quicrq_publish_object_open", then appends chunks with
+ * "quicrq_publish_object_append", and finally closes the object with
+ * "quicrq_publish_object_close", providing the last chunk.
+ *
+ * The chunks are added to the cache as fragments, and forwarded immediately by
+ * relays and publishers in stream and datagram mode. Since the length of the
+ * object is not known yet, these fragments carry the provisional object length
+ * QUICRQ_OBJECT_LENGTH_UNKNOWN. The last chunk, provided when closing the object,
+ * carries the actual length. It must not be empty unless the whole object is
+ * empty, because receivers need a fragment carrying the final length. In warp
+ * and rush modes, the object header includes the length, and the object is only
+ * sent after it is closed.
+ *
+ * Only one object can be open at a time on a source, and the group and object
+ * numbers follow the same rules as "quicrq_publish_object".
+ */
+#define QUICRQ_OBJECT_LENGTH_UNKNOWN 0x3FFFFFFFFFFFFFFFull
+
+int quicrq_publish_object_open(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    quicrq_media_object_properties_t* properties,
+    uint64_t group_id,
+    uint64_t object_id);
+
+int quicrq_publish_object_append(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    const uint8_t* data,
+    size_t data_length);
+
+int quicrq_publish_object_close(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    const uint8_t* data,
+    size_t data_length);
+
 void quicrq_publish_object_fin(quicrq_media_object_source_ctx_t* object_source_ctx);
 
 void quicrq_delete_object_source(quicrq_media_object_source_ctx_t* object_source_ctx);
@@ -210,6 +303,7 @@ typedef enum {
 
 typedef struct st_quicrq_object_stream_consumer_properties_t {
     uint8_t flags;
+    uint64_t origin_timestamp; /* Capture time set by the origin, or 0 if not set */
 } quicrq_object_stream_consumer_properties_t;
 
 typedef int (*quicrq_object_stream_consumer_fn)(
@@ -233,16 +327,38 @@ typedef enum {
     quicrq_subscribe_order_max
 } quicrq_subscribe_order_enum;
 
+/* Subscribe intents:
+ * - current_group: start with the first object of the group currently sent by the relay or origin
+ * - next_group: start with the first object of the next group
+ * - start_point: start at the object specified by start_group_id and start_object_id
+ * - start_time: start at the first object of the group that was current at "start_time",
+ *   expressed in microseconds on the origin clock: the time is compared to the
+ *   origin timestamp of the first object of each group. If the origin does not set
+ *   timestamps, the arrival time at the relay or origin cache is used instead. For
+ *   example, a client can request "the last 10 seconds" by setting start_time to
+ *   10 seconds before the current time on the origin clock. If the time is older than the data kept in the cache, the
+ *   subscription starts at the first group in the cache.
+ * - fetch_range: retrieve the objects from start_group_id/start_object_id up to but
+ *   not including end_group_id/end_object_id, in bulk. The range is sent on a single
+ *   stream at the rate allowed by the transport, without skipping objects under
+ *   congestion, and the end of the range is signalled as the end of the media.
+ *   Fetch requests are only supported with the single stream transport mode.
+ */
 typedef enum {
     quicrq_subscribe_intent_current_group = 0,
     quicrq_subscribe_intent_next_group = 1,
-    quicrq_subscribe_intent_start_point = 2
+    quicrq_subscribe_intent_start_point = 2,
+    quicrq_subscribe_intent_start_time = 3,
+    quicrq_subscribe_intent_fetch_range = 4
 } quicrq_subscribe_intent_enum;
 
 typedef struct st_quicrq_subscribe_intent_t {
     quicrq_subscribe_intent_enum intent_mode;
     uint64_t start_group_id;
     uint64_t start_object_id;
+    uint64_t start_time;
+    uint64_t end_group_id;
+    uint64_t end_object_id;
 } quicrq_subscribe_intent_t;
 
 quicrq_object_stream_consumer_ctx* quicrq_subscribe_object_stream(quicrq_cnx_ctx_t* cnx_ctx,
@@ -252,6 +368,19 @@ quicrq_object_stream_consumer_ctx* quicrq_subscribe_object_stream(quicrq_cnx_ctx
 
 void quicrq_unsubscribe_object_stream(quicrq_object_stream_consumer_ctx* subscribe_ctx);
 
+/* Resumable object stream subscriptions.
+ * If a subscription is marked resumable, and the connection that carries it is lost
+ * before the end of the media, the subscription is suspended instead of closed. The
+ * application is not notified, and the subscription context remains valid. The
+ * application can then call quicrq_resume_object_stream with a new connection, and
+ * the subscription resumes after the last object delivered in sequence, without
+ * repeating the objects already delivered. The application can also abandon a suspended
+ * subscription by calling quicrq_unsubscribe_object_stream.
+ */
+void quicrq_object_stream_set_resumable(quicrq_object_stream_consumer_ctx* subscribe_ctx, int is_resumable);
+int quicrq_object_stream_is_suspended(quicrq_object_stream_consumer_ctx* subscribe_ctx);
+int quicrq_resume_object_stream(quicrq_object_stream_consumer_ctx* subscribe_ctx, quicrq_cnx_ctx_t* cnx_ctx);
+
 int quicrq_cnx_post_media(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* url, size_t url_length,
     quicrq_transport_mode_enum transport_mode);
 
@@ -259,7 +388,60 @@ typedef int (*quicrq_media_consumer_init_fn)(quicrq_stream_ctx_t* stream_ctx, co
 int quicrq_set_media_init_callback(quicrq_ctx_t* ctx, quicrq_media_consumer_init_fn media_init_fn);
 
 quicrq_cnx_ctx_t* quicrq_first_connection(quicrq_ctx_t* qr_ctx);
+quicrq_cnx_ctx_t* quicrq_next_connection(quicrq_cnx_ctx_t* cnx_ctx);
 int quicrq_cnx_has_stream(quicrq_cnx_ctx_t* cnx_ctx);
+
+/* Statistics of media streams.
+ * The function "quicrq_cnx_get_stream_statistics" fills a snapshot of the media
+ * streams of a connection. The application can enumerate the connections with
+ * "quicrq_first_connection" and "quicrq_next_connection", for example to identify
+ * slow subscribers and hot tracks on a relay. The snapshot only reads counters
+ * kept by the streams and a few cache lookups, and is cheap enough to be polled
+ * every second.
+ *
+ * For streams sending media, the snapshot documents the next object to send, the
+ * head of the cache (next group and object expected), and the lag between them
+ * in number of objects and in time since the next object was received in cache.
+ * The first byte latency is the delay between the arrival of an object in the
+ * cache and the sending of its first byte on the stream, averaged over the objects
+ * sent so far. Comparing it across the subscribers of a relay shows whether some
+ * of them are consistently served last.
+ * For streams sending datagrams, the snapshot also counts the datagram fragments
+ * sent and the bytes spent in their headers. For streams sending in warp mode, it
+ * counts the groups abandoned by the latest first policy.
+ * The lag in objects is only computed for the 16 groups following the current
+ * position, and is capped at that point. The URL points to the media source,
+ * and is only valid until the next call to the quicrq stack.
+ *
+ * The function returns the number of media streams in "nb_stats", and fills at
+ * most "stats_max" entries.
+ */
+typedef struct st_quicrq_stream_statistics_t {
+    uint64_t stream_id;
+    quicrq_transport_mode_enum transport_mode;
+    int is_sender;
+    const uint8_t* url;
+    size_t url_length;
+    uint64_t current_group_id;
+    uint64_t current_object_id;
+    uint64_t cache_next_group_id;
+    uint64_t cache_next_object_id;
+    uint64_t lag_objects;
+    uint64_t lag_time;
+    uint64_t nb_objects_skipped;
+    uint64_t nb_extra_sent;
+    uint64_t nb_fragment_lost;
+    uint64_t nb_datagram_ack_pending;
+    uint64_t bytes_sent;
+    uint64_t nb_datagrams_sent;
+    uint64_t datagram_header_bytes;
+    uint64_t nb_groups_abandoned;
+    uint64_t first_byte_latency_average;
+    uint64_t first_byte_latency_max;
+} quicrq_stream_statistics_t;
+
+int quicrq_cnx_get_stream_statistics(quicrq_cnx_ctx_t* cnx_ctx, quicrq_stream_statistics_t* stats, size_t stats_max,
+    size_t* nb_stats, uint64_t current_time);
 int quicrq_close_cnx(quicrq_cnx_ctx_t* cnx_ctx);
 int quicrq_is_cnx_disconnected(quicrq_cnx_ctx_t* cnx_ctx);
 
@@ -313,10 +495,25 @@ int quicrq_cnx_subscribe_pattern_close(quicrq_cnx_ctx_t* cnx_ctx, quicrq_stream_
  * `picoquic_packet_loop_time_check`. The function returns the time
  * at will the next extra copy should be scheduled, or UINT64_MAX if no
  * such copy is currently planned.
+ * 
+ * By default, extra copies are sent regardless of network conditions. The
+ * function "quicrq_set_extra_repeat_policy" makes the process congestion
+ * aware: a scheduled copy is dropped if the connection is congested and the
+ * fragment priority is at or above the drop threshold, if the fragment
+ * belongs to a group that the publisher already skipped, or if it was acked
+ * in the meantime. If "budget_percent" is not zero, the extra copies are
+ * also limited to that percentage of the datagram bytes sent on the
+ * connection. Repeats of fragments declared lost ("on nack") are never
+ * suppressed, only the additional copies.
+ * 
+ * The function "quicrq_get_extra_repeat_statistics" returns the number of
+ * extra copies sent and dropped, and the number of bytes sent in copies.
  */
 
 void quicrq_set_extra_repeat(quicrq_ctx_t* qr, int on_nack, int after_delayed);
 void quicrq_set_extra_repeat_delay(quicrq_ctx_t* qr, uint64_t delay_in_microseconds);
+void quicrq_set_extra_repeat_policy(quicrq_ctx_t* qr, int is_congestion_aware, uint64_t budget_percent);
+void quicrq_get_extra_repeat_statistics(quicrq_ctx_t* qr, uint64_t* nb_sent, uint64_t* nb_dropped, uint64_t* bytes_sent);
 uint64_t quicrq_handle_extra_repeat(quicrq_ctx_t* qr, uint64_t current_time);
 
 /* Different modes of congestion control:
@@ -346,6 +543,98 @@ typedef enum {
 
 void quicrq_enable_congestion_control(quicrq_ctx_t* qr, quicrq_congestion_control_enum congestion_control_mode);
 
+/* Per track congestion weights.
+ * By default, delay based congestion control manages a single priority threshold per
+ * connection, and all media streams on the connection skip objects whose priority
+ * flags are at or above that threshold. A bursty track can thus cause drops in
+ * a well behaved track sharing the same connection.
+ *
+ * The function "quicrq_set_media_congestion_weight" assigns a weight to the media
+ * with the specified URL. Once at least one weight is set, the sender tracks the
+ * bytes sent by each media stream, and at each congestion epoch compares them to the
+ * share of the connection capacity allocated to that stream in proportion of its
+ * weight. Only the streams that exceed their share skip objects; the others are
+ * sent intact. Media without an explicit weight use the weight 1. The weight
+ * shall be set before the media is subscribed or posted, and setting a weight 0
+ * removes it.
+ */
+int quicrq_set_media_congestion_weight(quicrq_ctx_t* qr, const uint8_t* url, size_t url_length, uint64_t weight);
+
+/* Per track repair deadline.
+ * When a relay receives a media by datagrams and serves it to subscribers using streams,
+ * the stream subscribers receive the objects in order. A lost datagram blocks them until
+ * it is repaired, and the delay adds up at each relay.
+ *
+ * The function "quicrq_set_media_repair_deadline" sets a deadline, in microseconds, for
+ * the media with the specified URL. If an object is still missing when a later object
+ * was received more than "deadline" ago, the object is marked as skipped in the cache.
+ * The stream and warp subscribers that have not started sending that object then skip
+ * it, as if it had been skipped by the origin. If the repair arrives later, it is still
+ * added to the cache and forwarded to the datagram subscribers. Objects already partially
+ * sent on a stream cannot be skipped, and still wait for the repair. Setting the
+ * deadline 0 removes it.
+ */
+int quicrq_set_media_repair_deadline(quicrq_ctx_t* qr, const uint8_t* url, size_t url_length, uint64_t deadline);
+
+/* Packing of small objects in rush mode.
+ * In rush mode, each object is normally sent on its own unidirectional stream. For
+ * tracks made of many small objects, such as audio, the cost of opening a stream
+ * and sending the stream headers for each object can exceed the size of the payload.
+ * 
+ * The function "quicrq_set_rush_packing" lets the sender append consecutive objects
+ * to the same stream, provided that:
+ * - each object is at most "object_max" bytes long,
+ * - the stream carries at most "stream_max" bytes of object data,
+ * - the stream was opened less than "delay_max" microseconds ago.
+ * Objects are never delayed by packing: the stream is kept open after the last
+ * object is sent, and closed when the next object does not qualify.
+ * 
+ * Packing is disabled if object_max is set to 0 (this is the default.)
+ */
+void quicrq_set_rush_packing(quicrq_ctx_t* qr, size_t object_max, size_t stream_max, uint64_t delay_max);
+
+/* Bundling of datagrams.
+ * In datagram mode, each fragment is normally sent in its own QUIC datagram. When a
+ * connection carries many low rate tracks, such as telemetry or chat, the fragments
+ * are small and the cost of a QUIC packet per fragment can exceed the size of the payload.
+ * 
+ * The function "quicrq_set_datagram_bundling" lets the sender bundle fragments of
+ * different media in the same QUIC datagram. Each fragment is tagged with the media ID
+ * of its track, and is acknowledged or repeated independently of the other fragments
+ * in the bundle. Fragments are never delayed by bundling: a bundle only collects the
+ * fragments that are ready when the datagram is prepared.
+ * 
+ * Only the datagram flow is bundled. Bundling does not reduce the connection state
+ * at all: each track keeps its own control stream, stream context and records of
+ * datagrams pending acknowledgement, and control messages such as start points and
+ * fin are still sent on each control stream.
+ * 
+ * Bundling is disabled by default. Receivers always accept bundles.
+ */
+void quicrq_set_datagram_bundling(quicrq_ctx_t* qr, int is_enabled);
+
+/* Latest first scheduling in warp mode.
+ * In warp mode, each group is sent on its own unidirectional stream. A subscriber
+ * recovering from an outage may have many groups in progress, and by default the
+ * sender spends the available bandwidth on the oldest groups before reaching the
+ * live edge.
+ *
+ * The function "quicrq_set_warp_latest_first" changes that policy. When the oldest
+ * group in progress is at least "lag_groups" behind the latest group, the stream of
+ * the latest group gets strict precedence, and the older groups are sent in order with
+ * the leftover capacity. Groups that fall more than "horizon_groups" behind the latest
+ * group are abandoned: their streams are reset, and the sender notifies a new start
+ * point so the receiver skips them.
+ *
+ * The policy only applies to real time media. It does not apply to subscriptions
+ * that start in the past, with the start_point or start_time intents, since the
+ * subscriber explicitly asked for the older groups.
+ *
+ * The policy is disabled if lag_groups is 0 (this is the default.) Abandon is disabled
+ * if horizon_groups is 0.
+ */
+void quicrq_set_warp_latest_first(quicrq_ctx_t* qr, uint64_t lag_groups, uint64_t horizon_groups);
+
 #ifdef __cplusplus
 }
 #endif
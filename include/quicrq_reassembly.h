@@ -38,6 +38,7 @@ typedef int (*quicrq_reassembly_object_ready_fn)(
     uint64_t group_id,
     uint64_t object_id,
     uint8_t flags,
+    uint64_t origin_timestamp,
     const uint8_t* data,
     size_t data_length,
     quicrq_reassembly_object_mode_enum object_mode);
@@ -56,6 +57,7 @@ int quicrq_reassembly_input(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length,
     quicrq_reassembly_object_ready_fn ready_fn,
     void * app_media_ctx);
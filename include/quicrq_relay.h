@@ -18,6 +18,11 @@ extern "C" {
     /* Disable the relay */
     void quicrq_disable_relay(quicrq_ctx_t* qr_ctx);
 
+    /* Pass through mode: for real time media read by a single client,
+     * only keep in the relay cache the data not yet sent to that client.
+     * Must be called after enabling the relay or the origin. */
+    int quicrq_set_relay_pass_through(quicrq_ctx_t* qr_ctx, int is_pass_through);
+
 #ifdef __cplusplus
 }
 #endif
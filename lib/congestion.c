@@ -42,16 +42,76 @@
 *         - if threshold larger than max flag, clear "is_congested".
 * - in any case, reset "has_backlog", "old threshold", and epoch time.
 *  
+* If congestion weights are set, the connection state is complemented by
+* a per stream state, see quicrq_congestion_evaluate_shares. The skip
+* decision then only applies to the streams that exceed their share.
 */
-int quicrq_congestion_check_per_cnx(quicrq_cnx_ctx_t* cnx_ctx, uint8_t flags, int has_backlog, uint64_t current_time)
+
+/* Congestion weight of a media stream.
+ * The weight is resolved from the URL of the media source the first time
+ * it is needed. Streams without a source or without a configured weight
+ * use the default weight 1.
+ */
+static uint64_t quicrq_congestion_stream_weight(quicrq_stream_ctx_t* stream_ctx)
+{
+    if (stream_ctx->congestion.weight == 0) {
+        if (stream_ctx->media_source != NULL) {
+            stream_ctx->congestion.weight = quicrq_get_media_congestion_weight(stream_ctx->cnx_ctx->qr_ctx,
+                stream_ctx->media_source->media_url, stream_ctx->media_source->media_url_length);
+        }
+        else {
+            stream_ctx->congestion.weight = 1;
+        }
+    }
+    return stream_ctx->congestion.weight;
+}
+
+/* Allocation of the connection capacity across media streams.
+ * The capacity is estimated as the total number of bytes sent by the media
+ * streams of the connection since the last evaluation. Each stream that sent
+ * data or reported a backlog is allocated a share of that total in proportion
+ * of its weight. A stream is "over share" if it sent at least its share; only
+ * those streams skip objects while the connection is congested. If a single
+ * stream is active, it is always over share, which is the same as the
+ * behavior without weights.
+ */
+static void quicrq_congestion_evaluate_shares(quicrq_cnx_ctx_t* cnx_ctx)
+{
+    quicrq_stream_ctx_t* stream_ctx;
+    uint64_t total_bytes = 0;
+    uint64_t total_weight = 0;
+
+    for (stream_ctx = cnx_ctx->first_stream; stream_ctx != NULL; stream_ctx = stream_ctx->next_stream) {
+        if (stream_ctx->congestion.bytes_sent > 0 || stream_ctx->congestion.has_backlog) {
+            total_bytes += stream_ctx->congestion.bytes_sent;
+            total_weight += quicrq_congestion_stream_weight(stream_ctx);
+        }
+    }
+    for (stream_ctx = cnx_ctx->first_stream; stream_ctx != NULL; stream_ctx = stream_ctx->next_stream) {
+        if (stream_ctx->congestion.bytes_sent > 0 || stream_ctx->congestion.has_backlog) {
+            uint64_t share = (total_bytes * quicrq_congestion_stream_weight(stream_ctx)) / total_weight;
+            stream_ctx->congestion.is_over_share = (stream_ctx->congestion.bytes_sent >= share);
+        }
+        else {
+            stream_ctx->congestion.is_over_share = 0;
+        }
+        stream_ctx->congestion.bytes_sent = 0;
+        stream_ctx->congestion.has_backlog = 0;
+    }
+}
+
+int quicrq_congestion_check_per_cnx(quicrq_stream_ctx_t* stream_ctx, uint8_t flags, int has_backlog, uint64_t current_time)
 {
     int should_skip = 0;
+    quicrq_cnx_ctx_t* cnx_ctx = stream_ctx->cnx_ctx;
+    int is_per_track = (cnx_ctx->qr_ctx->first_congestion_weight != NULL);
 
     /* Update the 'worst flag for the connection' */
     if (flags > cnx_ctx->congestion.max_flags && flags != 0xff) {
         cnx_ctx->congestion.max_flags = flags;
     }
     cnx_ctx->congestion.has_backlog |= has_backlog;
+    stream_ctx->congestion.has_backlog |= has_backlog;
 
     if (!cnx_ctx->congestion.is_congested) {
         if (has_backlog) {
@@ -60,6 +120,9 @@ int quicrq_congestion_check_per_cnx(quicrq_cnx_ctx_t* cnx_ctx, uint8_t flags, in
             cnx_ctx->congestion.has_backlog = 0;
             cnx_ctx->congestion.priority_threshold = cnx_ctx->congestion.max_flags;
             cnx_ctx->congestion.old_priority_threshold = 0xff;
+            if (is_per_track) {
+                quicrq_congestion_evaluate_shares(cnx_ctx);
+            }
         }
     } else if (current_time >= cnx_ctx->congestion.congestion_check_time) {
         /* Check the epoch */
@@ -86,9 +149,13 @@ int quicrq_congestion_check_per_cnx(quicrq_cnx_ctx_t* cnx_ctx, uint8_t flags, in
         cnx_ctx->congestion.old_priority_threshold = old_priority_threshold;
         cnx_ctx->congestion.has_backlog = 0;
         cnx_ctx->congestion.congestion_check_time += 50000; /* TODO: should be RTT of connection */
+        if (is_per_track) {
+            quicrq_congestion_evaluate_shares(cnx_ctx);
+        }
     }
     /* Evaluate whether this packet should be skipped */
-    if (cnx_ctx->qr_ctx->congestion_control_mode != 0 && cnx_ctx->congestion.is_congested && flags >= cnx_ctx->congestion.priority_threshold) {
+    if (cnx_ctx->qr_ctx->congestion_control_mode != 0 && cnx_ctx->congestion.is_congested && flags >= cnx_ctx->congestion.priority_threshold &&
+        (!is_per_track || stream_ctx->congestion.is_over_share)) {
         should_skip = 1;
     }
     return should_skip;
@@ -196,7 +263,7 @@ int quicrq_evaluate_stream_congestion(quicrq_fragment_publisher_context_t* media
             media_ctx->has_backlog = 0;
         }
         /* Check the cache time, compare to current time, determine congestion */
-        should_skip = quicrq_congestion_check_per_cnx(media_ctx->stream_ctx->cnx_ctx,
+        should_skip = quicrq_congestion_check_per_cnx(media_ctx->stream_ctx,
             media_ctx->current_fragment->flags, has_backlog, current_time);
         break;
     }
@@ -233,7 +300,7 @@ int quicrq_evaluate_warp_congestion(quicrq_uni_stream_ctx_t* uni_stream_ctx, qui
                 has_backlog = 1;
             } 
             if (uni_stream_ctx->current_object_id > 0 && flags != 0xff) {
-                should_skip = quicrq_congestion_check_per_cnx(uni_stream_ctx->control_stream_ctx->cnx_ctx,
+                should_skip = quicrq_congestion_check_per_cnx(uni_stream_ctx->control_stream_ctx,
                     flags, has_backlog, current_time);
             }
             break;
@@ -264,7 +331,7 @@ int quicrq_evaluate_datagram_congestion(quicrq_stream_ctx_t * stream_ctx, quicrq
         case quicrq_congestion_control_delay:
         default:
             has_backlog = (int64_t)(current_time - media_ctx->current_fragment->cache_time) > delta_t_max;
-            should_skip = quicrq_congestion_check_per_cnx(stream_ctx->cnx_ctx,
+            should_skip = quicrq_congestion_check_per_cnx(stream_ctx,
                 media_ctx->current_fragment->flags, has_backlog, current_time);
             break;
         }
@@ -272,3 +339,50 @@ int quicrq_evaluate_datagram_congestion(quicrq_stream_ctx_t * stream_ctx, quicrq
 
     return should_skip;
 }
+
+/* Dependency aware skipping.
+ * 
+ * When an object is skipped, the following objects of the same group that
+ * depend on it cannot be decoded. The publisher keeps track of whether
+ * the dependency chain of the current group is broken:
+ * - an independent object restarts the chain, which is broken if that
+ *   object is skipped.
+ * - an object that depends on the previous one is skipped if the chain
+ *   is broken, and breaks the chain if it is skipped.
+ * - a discardable leaf is skipped if the chain is broken, but skipping it
+ *   does not break the chain.
+ * - objects without dependency information do not change the chain.
+ * The chain is reset at the beginning of each group. The state of the chain
+ * is kept by the caller: per publisher if the objects are evaluated in order,
+ * per warp stream if the groups are sent in parallel.
+ */
+int quicrq_evaluate_dependency(uint64_t* dependency_group_id, int* is_dependency_broken, uint64_t group_id,
+    quicrq_object_dependency_enum dependency, int should_skip)
+{
+    if (group_id != *dependency_group_id) {
+        *dependency_group_id = group_id;
+        *is_dependency_broken = 0;
+    }
+    switch (dependency) {
+    case quicrq_object_dependency_independent:
+        *is_dependency_broken = should_skip;
+        break;
+    case quicrq_object_dependency_previous:
+        if (*is_dependency_broken) {
+            should_skip = 1;
+        }
+        else {
+            *is_dependency_broken = should_skip;
+        }
+        break;
+    case quicrq_object_dependency_leaf:
+        if (*is_dependency_broken) {
+            should_skip = 1;
+        }
+        break;
+    case quicrq_object_dependency_none:
+    default:
+        break;
+    }
+    return should_skip;
+}
@@ -46,6 +46,16 @@ static picosplay_node_t* quicrq_fragment_cache_node_create(void* v_media_object)
     return &((quicrq_cached_fragment_t*)v_media_object)->fragment_node;
 }
 
+/* Extents of streamed objects grow out of line.
+ * The data of a fragment is allocated after the fragment header, unless
+ * the extent had to grow, in which case it is allocated separately. The
+ * header does not move, so it remains linked in the cache.
+ */
+static int quicrq_fragment_has_inline_data(quicrq_cached_fragment_t* fragment)
+{
+    return fragment->data == ((uint8_t*)fragment) + sizeof(quicrq_cached_fragment_t);
+}
+
 static void quicrq_fragment_cache_node_delete(void* tree, picosplay_node_t* node)
 {
 #ifdef _WINDOWS
@@ -67,8 +77,107 @@ static void quicrq_fragment_cache_node_delete(void* tree, picosplay_node_t* node
     else {
         fragment->next_in_order->previous_in_order = fragment->previous_in_order;
     }
+    cached_media->nb_fragments_deleted++;
+
+    if (!quicrq_fragment_has_inline_data(fragment)) {
+        free(fragment->data);
+    }
+    free(fragment);
+}
 
-    free(quicrq_fragment_cache_node_value(node));
+/* Manage the splay of group start times */
+static void* quicrq_fragment_group_time_node_value(picosplay_node_t* group_time_node)
+{
+    return (group_time_node == NULL) ? NULL : (void*)((char*)group_time_node - offsetof(struct st_quicrq_group_time_t, group_time_node));
+}
+
+static int64_t quicrq_fragment_group_time_node_compare(void* l, void* r) {
+    quicrq_group_time_t* ls = (quicrq_group_time_t*)l;
+    quicrq_group_time_t* rs = (quicrq_group_time_t*)r;
+    int64_t ret = 0;
+
+    if (ls->start_time < rs->start_time) {
+        ret = -1;
+    }
+    else if (ls->start_time > rs->start_time) {
+        ret = 1;
+    }
+    else if (ls->group_id < rs->group_id) {
+        ret = -1;
+    }
+    else if (ls->group_id > rs->group_id) {
+        ret = 1;
+    }
+    return ret;
+}
+
+static picosplay_node_t* quicrq_fragment_group_time_node_create(void* v_group_time)
+{
+    return &((quicrq_group_time_t*)v_group_time)->group_time_node;
+}
+
+static void quicrq_fragment_group_time_node_delete(void* tree, picosplay_node_t* node)
+{
+    (void)tree;
+    free(quicrq_fragment_group_time_node_value(node));
+}
+
+/* Add a group to the time index, if it is the first fragment of a new group */
+static int quicrq_fragment_group_time_add(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t start_time)
+{
+    int ret = 0;
+    quicrq_group_time_t* last_group_time = (quicrq_group_time_t*)quicrq_fragment_group_time_node_value(
+        picosplay_last(&cache_ctx->group_time_tree));
+
+    if (last_group_time == NULL || (group_id > last_group_time->group_id && start_time >= last_group_time->start_time)) {
+        quicrq_group_time_t* group_time = (quicrq_group_time_t*)malloc(sizeof(quicrq_group_time_t));
+        if (group_time == NULL) {
+            ret = -1;
+        }
+        else {
+            memset(group_time, 0, sizeof(quicrq_group_time_t));
+            group_time->start_time = start_time;
+            group_time->group_id = group_id;
+            picosplay_insert(&cache_ctx->group_time_tree, group_time);
+        }
+    }
+    return ret;
+}
+
+/* Remove from the time index the groups that are not in the cache anymore */
+static void quicrq_fragment_group_time_prune(quicrq_fragment_cache_t* cache_ctx, uint64_t first_group_id)
+{
+    picosplay_node_t* group_time_node;
+
+    while ((group_time_node = picosplay_first(&cache_ctx->group_time_tree)) != NULL) {
+        quicrq_group_time_t* group_time = (quicrq_group_time_t*)quicrq_fragment_group_time_node_value(group_time_node);
+        if (group_time->group_id >= first_group_id) {
+            break;
+        }
+        picosplay_delete_hint(&cache_ctx->group_time_tree, group_time_node);
+    }
+}
+
+int quicrq_fragment_cache_seek_time(quicrq_fragment_cache_t* cache_ctx, uint64_t start_time, uint64_t* group_id)
+{
+    int ret = -1;
+    quicrq_group_time_t key = { 0 };
+    quicrq_group_time_t* group_time;
+
+    key.start_time = start_time;
+    key.group_id = UINT64_MAX;
+    group_time = (quicrq_group_time_t*)quicrq_fragment_group_time_node_value(
+        picosplay_find_previous(&cache_ctx->group_time_tree, &key));
+    if (group_time == NULL) {
+        /* The time is older than the oldest indexed group */
+        group_time = (quicrq_group_time_t*)quicrq_fragment_group_time_node_value(
+            picosplay_first(&cache_ctx->group_time_tree));
+    }
+    if (group_time != NULL) {
+        *group_id = group_time->group_id;
+        ret = 0;
+    }
+    return ret;
 }
 
 quicrq_cached_fragment_t* quicrq_fragment_cache_get_fragment(quicrq_fragment_cache_t* cache_ctx,
@@ -82,11 +191,99 @@ quicrq_cached_fragment_t* quicrq_fragment_cache_get_fragment(quicrq_fragment_cac
     return (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(fragment_node);
 }
 
+quicrq_cached_fragment_t* quicrq_fragment_cache_find_fragment_at(quicrq_fragment_cache_t* cache_ctx,
+    uint64_t group_id, uint64_t object_id, uint64_t offset)
+{
+    quicrq_cached_fragment_t key = { 0 };
+    quicrq_cached_fragment_t* fragment;
+    key.group_id = group_id;
+    key.object_id = object_id;
+    key.offset = offset;
+    fragment = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(
+        picosplay_find_previous(&cache_ctx->fragment_tree, &key));
+    if (fragment != NULL && (fragment->group_id != group_id || fragment->object_id != object_id ||
+        (fragment->offset != offset && fragment->offset + fragment->data_length <= offset))) {
+        fragment = NULL;
+    }
+    return fragment;
+}
+
+static int quicrq_fragment_is_at(quicrq_cached_fragment_t* fragment, uint64_t group_id, uint64_t object_id, uint64_t offset)
+{
+    return (fragment->group_id == group_id && fragment->object_id == object_id &&
+        (fragment->offset == offset || (fragment->offset < offset && fragment->offset + fragment->data_length > offset)));
+}
+
+quicrq_cached_fragment_t* quicrq_fragment_cursor_seek(quicrq_fragment_cache_t* cache_ctx, quicrq_fragment_cursor_t* cursor,
+    uint64_t group_id, uint64_t object_id, uint64_t offset)
+{
+    quicrq_cached_fragment_t* fragment = NULL;
+
+    /* The cursor fragment is still in the cache if nothing was deleted since it was set */
+    if (cursor->fragment != NULL && cursor->nb_fragments_deleted == cache_ctx->nb_fragments_deleted) {
+        if (quicrq_fragment_is_at(cursor->fragment, group_id, object_id, offset)) {
+            fragment = cursor->fragment;
+        }
+        else {
+            quicrq_cached_fragment_t* next_fragment = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(
+                picosplay_next(&cursor->fragment->fragment_node));
+            if (next_fragment != NULL && quicrq_fragment_is_at(next_fragment, group_id, object_id, offset)) {
+                fragment = next_fragment;
+            }
+        }
+    }
+    if (fragment == NULL) {
+        cache_ctx->nb_cursor_lookups++;
+        fragment = quicrq_fragment_cache_find_fragment_at(cache_ctx, group_id, object_id, offset);
+    }
+    if (fragment != NULL) {
+        cursor->fragment = fragment;
+        cursor->nb_fragments_deleted = cache_ctx->nb_fragments_deleted;
+    }
+    return fragment;
+}
+
+/* Copy a range of object data from the cache, e.g., to repeat a datagram.
+ * Returns 0 if the whole range was found, -1 if some of it was not received
+ * or was already purged.
+ */
+int quicrq_fragment_cache_copy_range(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id,
+    uint64_t offset, uint8_t* data, size_t length)
+{
+    int ret = 0;
+
+    while (ret == 0 && length > 0) {
+        quicrq_cached_fragment_t* fragment = quicrq_fragment_cache_find_fragment_at(cache_ctx, group_id, object_id, offset);
+        if (fragment == NULL || fragment->offset + fragment->data_length <= offset) {
+            ret = -1;
+        }
+        else {
+            size_t start = (size_t)(offset - fragment->offset);
+            size_t copied = fragment->data_length - start;
+            if (copied > length) {
+                copied = length;
+            }
+            memcpy(data, fragment->data + start, copied);
+            data += copied;
+            offset += copied;
+            length -= copied;
+        }
+    }
+    return ret;
+}
+
 void quicrq_fragment_cache_media_clear(quicrq_fragment_cache_t* cached_media)
 {
     cached_media->first_fragment = NULL;
     cached_media->last_fragment = NULL;
+    while (cached_media->first_repair_skip != NULL) {
+        quicrq_repair_skip_t* skip = cached_media->first_repair_skip;
+        cached_media->first_repair_skip = skip->next_skip;
+        free(skip);
+    }
+    cached_media->last_repair_skip = NULL;
     picosplay_empty_tree(&cached_media->fragment_tree);
+    picosplay_empty_tree(&cached_media->group_time_tree);
 }
 
 void quicrq_fragment_cache_media_init(quicrq_fragment_cache_t* cached_media)
@@ -94,6 +291,9 @@ void quicrq_fragment_cache_media_init(quicrq_fragment_cache_t* cached_media)
     picosplay_init_tree(&cached_media->fragment_tree, quicrq_fragment_cache_node_compare,
         quicrq_fragment_cache_node_create, quicrq_fragment_cache_node_delete,
         quicrq_fragment_cache_node_value);
+    picosplay_init_tree(&cached_media->group_time_tree, quicrq_fragment_group_time_node_compare,
+        quicrq_fragment_group_time_node_create, quicrq_fragment_group_time_node_delete,
+        quicrq_fragment_group_time_node_value);
 }
 
 
@@ -126,7 +326,10 @@ void quicrq_fragment_cache_progress(quicrq_fragment_cache_t* cache_ctx,
         }
         if (fragment->group_id == cache_ctx->next_group_id &&
             fragment->object_id == cache_ctx->next_object_id &&
-            fragment->offset == cache_ctx->next_offset) {
+            (fragment->offset == cache_ctx->next_offset ||
+                (fragment->offset < cache_ctx->next_offset &&
+                    fragment->offset + fragment->data_length > cache_ctx->next_offset))) {
+            /* Expected fragment, or extent that was extended past the expected offset */
             is_expected = 1;
         }
         else if (fragment->group_id == (cache_ctx->next_group_id + 1) &&
@@ -141,7 +344,7 @@ void quicrq_fragment_cache_progress(quicrq_fragment_cache_t* cache_ctx,
             is_expected = 1;
         }
         if (is_expected) {
-            uint64_t next_offset = cache_ctx->next_offset + fragment->data_length;
+            uint64_t next_offset = fragment->offset + fragment->data_length;
             if (next_offset >= fragment->object_length) {
                 cache_ctx->next_object_id += 1;
                 cache_ctx->next_offset = 0;
@@ -156,7 +359,44 @@ void quicrq_fragment_cache_progress(quicrq_fragment_cache_t* cache_ctx,
     } while ((next_fragment_node = picosplay_next(next_fragment_node)) != NULL);
 }
 
-int quicrq_fragment_add_to_cache(quicrq_fragment_cache_t* cache_ctx,
+static int quicrq_fragment_extent_grow(quicrq_cached_fragment_t* fragment, size_t data_needed)
+{
+    int ret = 0;
+    size_t data_alloc = 2 * fragment->data_alloc;
+
+    if (data_alloc < data_needed) {
+        data_alloc = data_needed;
+    }
+    if (data_alloc > QUICRQ_FRAGMENT_EXTENT_MAX) {
+        data_alloc = QUICRQ_FRAGMENT_EXTENT_MAX;
+    }
+    if (data_alloc < data_needed) {
+        /* Do not grow beyond the maximum extent, start a new fragment instead */
+        ret = -1;
+    }
+    else {
+        uint8_t* data;
+        if (quicrq_fragment_has_inline_data(fragment)) {
+            data = (uint8_t*)malloc(data_alloc);
+            if (data != NULL) {
+                memcpy(data, fragment->data, fragment->data_length);
+            }
+        }
+        else {
+            data = (uint8_t*)realloc(fragment->data, data_alloc);
+        }
+        if (data == NULL) {
+            ret = -1;
+        }
+        else {
+            fragment->data = data;
+            fragment->data_alloc = data_alloc;
+        }
+    }
+    return ret;
+}
+
+static int quicrq_fragment_add_to_cache_ex(quicrq_fragment_cache_t* cache_ctx,
     const uint8_t* data,
     uint64_t group_id,
     uint64_t object_id,
@@ -165,12 +405,39 @@ int quicrq_fragment_add_to_cache(quicrq_fragment_cache_t* cache_ctx,
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length,
+    size_t data_alloc,
     uint64_t current_time)
 {
     int ret = 0;
-    quicrq_cached_fragment_t* fragment = (quicrq_cached_fragment_t*)malloc(
-        sizeof(quicrq_cached_fragment_t) + data_length);
+    quicrq_cached_fragment_t* fragment = cache_ctx->last_fragment;
+
+    if (fragment != NULL && fragment->group_id == group_id && fragment->object_id == object_id &&
+        fragment->offset + fragment->data_length == offset) {
+        if (fragment->data_length + data_length > fragment->data_alloc &&
+            fragment->object_length == QUICRQ_OBJECT_LENGTH_UNKNOWN) {
+            /* The length of streamed objects is not known in advance, grow the extent geometrically.
+             * If it cannot grow, the data is cached in a new fragment. */
+            (void)quicrq_fragment_extent_grow(fragment, fragment->data_length + data_length);
+        }
+        if (fragment->data_length + data_length <= fragment->data_alloc) {
+            /* Append to the extent of the last received fragment */
+            memcpy(fragment->data + fragment->data_length, data, data_length);
+            fragment->data_length += data_length;
+            if (object_length != QUICRQ_OBJECT_LENGTH_UNKNOWN) {
+                /* The final fragment of a streamed object carries the actual length */
+                fragment->object_length = object_length;
+            }
+            quicrq_fragment_cache_progress(cache_ctx, fragment);
+            return 0;
+        }
+    }
+
+    if (data_alloc < data_length) {
+        data_alloc = data_length;
+    }
+    fragment = (quicrq_cached_fragment_t*)malloc(sizeof(quicrq_cached_fragment_t) + data_alloc);
 
     if (fragment == NULL) {
         ret = -1;
@@ -193,16 +460,40 @@ int quicrq_fragment_add_to_cache(quicrq_fragment_cache_t* cache_ctx,
         fragment->flags = flags;
         fragment->nb_objects_previous_group = nb_objects_previous_group;
         fragment->object_length = object_length;
+        fragment->origin_timestamp = origin_timestamp;
         fragment->data = ((uint8_t*)fragment) + sizeof(quicrq_cached_fragment_t);
         fragment->data_length = data_length;
+        fragment->data_alloc = data_alloc;
         memcpy(fragment->data, data, data_length);
         picosplay_insert(&cache_ctx->fragment_tree, fragment);
         quicrq_fragment_cache_progress(cache_ctx, fragment);
+        if (object_id == 0 && offset == 0) {
+            /* Index on the origin clock, so start times mean the same thing at every relay */
+            ret = quicrq_fragment_group_time_add(cache_ctx, group_id,
+                (origin_timestamp != 0) ? origin_timestamp : current_time);
+        }
     }
 
     return ret;
 }
 
+int quicrq_fragment_add_to_cache(quicrq_fragment_cache_t* cache_ctx,
+    const uint8_t* data,
+    uint64_t group_id,
+    uint64_t object_id,
+    uint64_t offset,
+    uint64_t queue_delay,
+    uint8_t flags,
+    uint64_t nb_objects_previous_group,
+    uint64_t object_length,
+    uint64_t origin_timestamp,
+    size_t data_length,
+    uint64_t current_time)
+{
+    return quicrq_fragment_add_to_cache_ex(cache_ctx, data, group_id, object_id, offset, queue_delay, flags,
+        nb_objects_previous_group, object_length, origin_timestamp, data_length, data_length, current_time);
+}
+
 int quicrq_fragment_propose_to_cache(quicrq_fragment_cache_t* cache_ctx,
     const uint8_t* data,
     uint64_t group_id,
@@ -212,11 +503,13 @@ int quicrq_fragment_propose_to_cache(quicrq_fragment_cache_t* cache_ctx,
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length,
     uint64_t current_time)
 {
     int ret = 0;
     int data_was_added = 0;
+    int is_first_of_object;
     /* First check whether the object is in the cache. */
     /* If the object is in the cache, check whether this fragment is already received */
     quicrq_cached_fragment_t * first_fragment_state = NULL;
@@ -228,19 +521,43 @@ int quicrq_fragment_propose_to_cache(quicrq_fragment_cache_t* cache_ctx,
         /* This fragment is too old to be considered. */
         return 0;
     }
+    if ((group_id < cache_ctx->next_group_id ||
+        (group_id == cache_ctx->next_group_id && (object_id < cache_ctx->next_object_id ||
+            (object_id == cache_ctx->next_object_id && cache_ctx->next_offset > 0 &&
+                offset + data_length <= cache_ctx->next_offset)))) &&
+        (cache_ctx->first_repair_skip == NULL ||
+            (quicrq_fragment_cache_get_repair_skip(cache_ctx, group_id, object_id) == NULL &&
+                quicrq_fragment_cache_get_repair_skip(cache_ctx, group_id + 1, 0) == NULL))) {
+        /* Everything before the in sequence point is already received. This is a
+         * duplicate, e.g., a repeat or a copy from a redundant ingest. Only repairs
+         * of objects skipped after the repair deadline are still considered. */
+        cache_ctx->nb_duplicate_fragments++;
+        return 0;
+    }
     key.group_id = group_id;
     key.object_id = object_id;
     key.offset = UINT64_MAX;
     picosplay_node_t* last_fragment_node = picosplay_find_previous(&cache_ctx->fragment_tree, &key);
+    first_fragment_state = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(last_fragment_node);
+    is_first_of_object = (first_fragment_state == NULL ||
+        first_fragment_state->group_id != group_id ||
+        first_fragment_state->object_id != object_id);
     do {
         first_fragment_state = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(last_fragment_node);
         if (first_fragment_state == NULL || 
             first_fragment_state->group_id != group_id ||
             first_fragment_state->object_id != object_id ||
             first_fragment_state->offset + first_fragment_state->data_length < offset) {          
-            /* Insert the whole fragment */
-            ret = quicrq_fragment_add_to_cache(cache_ctx, data, 
-                group_id, object_id, offset, queue_delay, flags, nb_objects_previous_group, object_length, data_length, current_time);
+            /* Insert the whole fragment. If this is the first fragment received for the object,
+             * reserve space for the rest of the object, so next fragments can be appended. */
+            size_t data_alloc = data_length;
+            if (is_first_of_object &&
+                object_length > offset + data_length && object_length - offset <= QUICRQ_FRAGMENT_EXTENT_MAX) {
+                data_alloc = (size_t)(object_length - offset);
+            }
+            ret = quicrq_fragment_add_to_cache_ex(cache_ctx, data, 
+                group_id, object_id, offset, queue_delay, flags, nb_objects_previous_group, object_length, origin_timestamp,
+                data_length, data_alloc, current_time);
             data_was_added = 1;
             /* Mark done */
             data_length = 0;
@@ -251,12 +568,15 @@ int quicrq_fragment_propose_to_cache(quicrq_fragment_cache_t* cache_ctx,
             if (offset + data_length > previous_last_byte) {
                 /* Some of the fragment data comes after this one. Submit */
                 size_t added_length = offset + data_length - previous_last_byte;
-                ret = quicrq_fragment_add_to_cache(cache_ctx, data, 
-                    group_id, object_id, offset, queue_delay, flags, nb_objects_previous_group, object_length, added_length, current_time);
+                ret = quicrq_fragment_add_to_cache(cache_ctx, data + (previous_last_byte - offset),
+                    group_id, object_id, previous_last_byte, queue_delay, flags,
+                    (previous_last_byte == 0) ? nb_objects_previous_group : 0, object_length,
+                    (previous_last_byte == 0) ? origin_timestamp : 0, added_length, current_time);
                 data_was_added = 1;
                 data_length -= added_length;
-                /* Previous group count is only used on first fragment */
+                /* Previous group count and origin timestamp are only used on first fragment */
                 nb_objects_previous_group = 0;
+                origin_timestamp = 0;
             }
             if (offset >= first_fragment_state->offset) {
                 /* What remained of the fragment overlaps with existing data */
@@ -311,13 +631,40 @@ int quicrq_fragment_propose_to_cache(quicrq_fragment_cache_t* cache_ctx,
     return ret;
 }
 
+static void* quicrq_fragment_publisher_object_node_value(picosplay_node_t* publisher_object_node);
+static void quicrq_fragment_publisher_release_point(quicrq_stream_ctx_t* stream_ctx, uint64_t* group_id, uint64_t* object_id);
+
+/* Delete all the fragments of objects before (group_id, object_id) from the cache.
+ */
+static void quicrq_fragment_cache_delete_before(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id)
+{
+    picosplay_node_t* fragment_node;
+
+    while ((fragment_node = picosplay_first(&cache_ctx->fragment_tree)) != NULL) {
+        quicrq_cached_fragment_t* fragment =
+            (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(fragment_node);
+        if (fragment->group_id > group_id ||
+            (fragment->group_id == group_id && fragment->object_id >= object_id)) {
+            break;
+        }
+        picosplay_delete_hint(&cache_ctx->fragment_tree, fragment_node);
+    }
+}
+
+/* Learn the start point of the media. This happens once at the beginning, but
+ * the start point may also move forward in the middle of the media, e.g., if the
+ * upstream sender abandoned groups. In that case, the publishers may still be
+ * reading fragments before the start point: these fragments are only deleted once
+ * no publisher needs them, i.e., below the lowest release point of the readers.
+ */
 int quicrq_fragment_cache_learn_start_point(quicrq_fragment_cache_t* cache_ctx,
     uint64_t start_group_id, uint64_t start_object_id)
 {
     int ret = 0;
-    /* Find all cache fragments that might be before the start point,
-    * and delete them */
-    picosplay_node_t* first_fragment_node = NULL;
+    uint64_t kept_group_id = start_group_id;
+    uint64_t kept_object_id = start_object_id;
+    quicrq_stream_ctx_t* reader_ctx = cache_ctx->srce_ctx->first_stream;
+
     cache_ctx->first_group_id = start_group_id;
     cache_ctx->first_object_id = start_object_id;
     if (cache_ctx->next_group_id < start_group_id ||
@@ -325,20 +672,25 @@ int quicrq_fragment_cache_learn_start_point(quicrq_fragment_cache_t* cache_ctx,
             cache_ctx->next_object_id < start_object_id)) {
         cache_ctx->next_group_id = start_group_id;
         cache_ctx->next_object_id = start_object_id;
+        cache_ctx->next_offset = 0;
     }
-    while ((first_fragment_node = picosplay_first(&cache_ctx->fragment_tree)) != NULL) {
-        quicrq_cached_fragment_t* first_fragment_state = 
-            (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(first_fragment_node);
-        if (first_fragment_state == NULL || 
-            first_fragment_state->group_id > start_group_id ||
-            (first_fragment_state->group_id == start_group_id &&
-                first_fragment_state->object_id >= start_object_id)) {
-            break;
-        }
-        else {
-            picosplay_delete_hint(&cache_ctx->fragment_tree, first_fragment_node);
+    /* Find the lowest point still needed by the active publishers */
+    while (reader_ctx != NULL) {
+        if (reader_ctx->is_sender && reader_ctx->media_ctx != NULL) {
+            uint64_t group_id;
+            uint64_t object_id;
+
+            quicrq_fragment_publisher_release_point(reader_ctx, &group_id, &object_id);
+            if (group_id < kept_group_id || (group_id == kept_group_id && object_id < kept_object_id)) {
+                kept_group_id = group_id;
+                kept_object_id = object_id;
+            }
         }
+        reader_ctx = reader_ctx->next_stream_for_source;
     }
+    /* Delete the cache fragments that are before the start point and not needed anymore */
+    quicrq_fragment_cache_delete_before(cache_ctx, kept_group_id, kept_object_id);
+    quicrq_fragment_group_time_prune(cache_ctx, kept_group_id);
 
     if (ret == 0) {
         /* Set the start point for the dependent streams. */
@@ -346,9 +698,19 @@ int quicrq_fragment_cache_learn_start_point(quicrq_fragment_cache_t* cache_ctx,
         while (stream_ctx != NULL) {
             /* for each client waiting for data on this media,
             * update the start point and then wakeup the stream 
-            * so the start point can be releayed. */
+            * so the start point can be releayed. If the start point moves
+            * forward, e.g., because the upstream sender abandoned groups, it
+            * is relayed again, and the warp streams skip the missing groups. */
+            if (stream_ctx->is_start_object_id_sent &&
+                (start_group_id > stream_ctx->start_group_id ||
+                (start_group_id == stream_ctx->start_group_id && start_object_id > stream_ctx->start_object_id))) {
+                stream_ctx->is_start_object_id_sent = 0;
+            }
             stream_ctx->start_group_id = start_group_id;
             stream_ctx->start_object_id = start_object_id;
+            if (stream_ctx->is_sender && stream_ctx->transport_mode == quicrq_transport_mode_warp) {
+                quicrq_warp_abandon_groups(stream_ctx, start_group_id);
+            }
             if (stream_ctx->cnx_ctx->cnx != NULL) {
                 picoquic_mark_active_stream(stream_ctx->cnx_ctx->cnx, stream_ctx->stream_id, 1, stream_ctx);
             }
@@ -393,6 +755,142 @@ int quicrq_fragment_cache_set_real_time_cache(quicrq_fragment_cache_t* cache_ctx
     return ret;
 }
 
+/* Repair deadline.
+ * The missing object is found from the first fragment after the in sequence point.
+ * If the missing object is partially received, or if the next fragment belongs to the
+ * same group, or is the first fragment of the next group with a larger object count,
+ * the missing object is in the current group.
+ * Otherwise, the current group is assumed complete, and the missing object is the
+ * first object of the next group.
+ */
+static void quicrq_fragment_cache_repair_skip_prune(quicrq_fragment_cache_t* cache_ctx)
+{
+    while (cache_ctx->first_repair_skip != NULL &&
+        (cache_ctx->first_repair_skip->group_id < cache_ctx->first_group_id ||
+            (cache_ctx->first_repair_skip->group_id == cache_ctx->first_group_id &&
+                cache_ctx->first_repair_skip->object_id < cache_ctx->first_object_id))) {
+        quicrq_repair_skip_t* skip = cache_ctx->first_repair_skip;
+        cache_ctx->first_repair_skip = skip->next_skip;
+        free(skip);
+    }
+    if (cache_ctx->first_repair_skip == NULL) {
+        cache_ctx->last_repair_skip = NULL;
+    }
+}
+
+uint64_t quicrq_fragment_cache_check_repair_deadline(quicrq_fragment_cache_t* cache_ctx, uint64_t deadline, uint64_t current_time)
+{
+    uint64_t next_time = UINT64_MAX;
+
+    quicrq_fragment_cache_repair_skip_prune(cache_ctx);
+
+    while (1) {
+        quicrq_cached_fragment_t key = { 0 };
+        quicrq_cached_fragment_t* next_fragment;
+        picosplay_node_t* fragment_node;
+        quicrq_repair_skip_t* skip;
+
+        /* Find the first fragment after the in sequence point */
+        key.group_id = cache_ctx->next_group_id;
+        key.object_id = cache_ctx->next_object_id;
+        key.offset = cache_ctx->next_offset;
+        fragment_node = picosplay_find_previous(&cache_ctx->fragment_tree, &key);
+        fragment_node = (fragment_node == NULL) ? picosplay_first(&cache_ctx->fragment_tree) : picosplay_next(fragment_node);
+        next_fragment = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(fragment_node);
+        if (next_fragment == NULL) {
+            /* Nothing is missing */
+            break;
+        }
+        if (current_time < next_fragment->cache_time + deadline) {
+            next_time = next_fragment->cache_time + deadline;
+            break;
+        }
+        skip = (quicrq_repair_skip_t*)malloc(sizeof(quicrq_repair_skip_t));
+        if (skip == NULL) {
+            break;
+        }
+        memset(skip, 0, sizeof(quicrq_repair_skip_t));
+        if (cache_ctx->next_offset > 0 || cache_ctx->next_object_id == 0 ||
+            next_fragment->group_id == cache_ctx->next_group_id ||
+            (next_fragment->group_id == cache_ctx->next_group_id + 1 && next_fragment->object_id == 0 &&
+                next_fragment->offset == 0 && next_fragment->nb_objects_previous_group > cache_ctx->next_object_id)) {
+            skip->group_id = cache_ctx->next_group_id;
+            skip->object_id = cache_ctx->next_object_id;
+        }
+        else {
+            skip->group_id = cache_ctx->next_group_id + 1;
+            skip->object_id = 0;
+            skip->nb_objects_previous_group = cache_ctx->next_object_id;
+        }
+        DBG_PRINTF("Repair deadline, skip object %" PRIu64 "/%" PRIu64 ", time= %" PRIu64,
+            skip->group_id, skip->object_id, current_time);
+        if (cache_ctx->last_repair_skip == NULL) {
+            cache_ctx->first_repair_skip = skip;
+        }
+        else {
+            cache_ctx->last_repair_skip->next_skip = skip;
+        }
+        cache_ctx->last_repair_skip = skip;
+        cache_ctx->nb_repair_skipped++;
+        /* Move the in sequence point past the skipped object, and check the fragments after it. */
+        cache_ctx->next_group_id = skip->group_id;
+        cache_ctx->next_object_id = skip->object_id + 1;
+        cache_ctx->next_offset = 0;
+        key.group_id = cache_ctx->next_group_id;
+        key.object_id = cache_ctx->next_object_id;
+        key.offset = 0;
+        next_fragment = quicrq_fragment_cache_get_fragment(cache_ctx, key.group_id, key.object_id, 0);
+        if (next_fragment == NULL) {
+            next_fragment = quicrq_fragment_cache_get_fragment(cache_ctx, key.group_id + 1, 0, 0);
+        }
+        if (next_fragment != NULL) {
+            quicrq_fragment_cache_progress(cache_ctx, next_fragment);
+        }
+    }
+
+    return next_time;
+}
+
+uint64_t quicrq_fragment_check_repair_deadlines(quicrq_ctx_t* qr_ctx, uint64_t current_time)
+{
+    uint64_t next_time = UINT64_MAX;
+    quicrq_media_source_ctx_t* srce_ctx = qr_ctx->first_source;
+
+    while (srce_ctx != NULL) {
+        quicrq_fragment_cache_t* cache_ctx = srce_ctx->cache_ctx;
+        /* Only the context that owns the cache fills it */
+        if (cache_ctx != NULL && cache_ctx->srce_ctx == srce_ctx && !cache_ctx->is_feed_closed) {
+            uint64_t deadline = quicrq_get_media_repair_deadline(qr_ctx, srce_ctx->media_url, srce_ctx->media_url_length);
+            if (deadline > 0) {
+                uint64_t nb_skipped = cache_ctx->nb_repair_skipped;
+                uint64_t cache_time = quicrq_fragment_cache_check_repair_deadline(cache_ctx, deadline, current_time);
+                if (cache_time < next_time) {
+                    next_time = cache_time;
+                }
+                if (cache_ctx->nb_repair_skipped > nb_skipped) {
+                    /* Wake up the streams waiting for the skipped objects */
+                    quicrq_source_wakeup(srce_ctx);
+                }
+            }
+        }
+        srce_ctx = srce_ctx->next_source;
+    }
+    return next_time;
+}
+
+quicrq_repair_skip_t* quicrq_fragment_cache_get_repair_skip(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id)
+{
+    quicrq_repair_skip_t* skip = cache_ctx->first_repair_skip;
+
+    while (skip != NULL && (skip->group_id < group_id || (skip->group_id == group_id && skip->object_id < object_id))) {
+        skip = skip->next_skip;
+    }
+    if (skip != NULL && (skip->group_id != group_id || skip->object_id != object_id)) {
+        skip = NULL;
+    }
+    return skip;
+}
+
 /* Purging old fragments from the cache. 
  * This should only be done for caches of type "real time".
  * - Compute the latest GOB.
@@ -434,7 +932,132 @@ void quicrq_fragment_cache_media_purge_to_gob(
                 picosplay_delete_hint(&cache_ctx->fragment_tree, fragment_node);
             }
         }
+        quicrq_fragment_group_time_prune(cache_ctx, kept_group_id);
+    }
+}
+
+/* Compute the point below which a publisher does not need the cache anymore,
+ * i.e., all objects before (group_id, object_id) have been sent, and in
+ * datagram mode acknowledged.
+ */
+static void quicrq_fragment_publisher_release_point(quicrq_stream_ctx_t* stream_ctx, uint64_t* group_id, uint64_t* object_id)
+{
+    quicrq_fragment_publisher_context_t* media_ctx = (quicrq_fragment_publisher_context_t*)stream_ctx->media_ctx;
+
+    switch (stream_ctx->transport_mode) {
+    case quicrq_transport_mode_datagram: {
+        quicrq_fragment_publisher_object_state_t* first_object = (quicrq_fragment_publisher_object_state_t*)
+            quicrq_fragment_publisher_object_node_value(picosplay_first(&media_ctx->publisher_object_tree));
+        quicrq_datagram_ack_state_t* first_ack = quicrq_datagram_ack_first(stream_ctx);
+
+        /* Objects are only forgotten by the publisher once sent in sequence */
+        if (first_object != NULL) {
+            *group_id = first_object->group_id;
+            *object_id = first_object->object_id;
+        }
+        else {
+            *group_id = stream_ctx->start_group_id;
+            *object_id = stream_ctx->start_object_id;
+        }
+        /* The current fragment is used to find the next one in arrival order */
+        if (media_ctx->current_fragment != NULL &&
+            (media_ctx->current_fragment->group_id < *group_id ||
+            (media_ctx->current_fragment->group_id == *group_id && media_ctx->current_fragment->object_id < *object_id))) {
+            *group_id = media_ctx->current_fragment->group_id;
+            *object_id = media_ctx->current_fragment->object_id;
+        }
+        /* Ack records are only removed once acknowledged below the horizon */
+        if (first_ack != NULL &&
+            (first_ack->group_id < *group_id || (first_ack->group_id == *group_id && first_ack->object_id < *object_id))) {
+            *group_id = first_ack->group_id;
+            *object_id = first_ack->object_id;
+        }
+        break;
+    }
+    case quicrq_transport_mode_warp:
+    case quicrq_transport_mode_rush: {
+        quicrq_uni_stream_ctx_t* uni_stream_ctx = stream_ctx->first_uni_stream;
+
+        *group_id = stream_ctx->next_warp_group_id;
+        *object_id = (stream_ctx->transport_mode == quicrq_transport_mode_rush) ? stream_ctx->next_rush_object_id : 0;
+        while (uni_stream_ctx != NULL) {
+            if (uni_stream_ctx->current_group_id < *group_id ||
+                (uni_stream_ctx->current_group_id == *group_id && uni_stream_ctx->current_object_id < *object_id)) {
+                *group_id = uni_stream_ctx->current_group_id;
+                *object_id = uni_stream_ctx->current_object_id;
+            }
+            uni_stream_ctx = uni_stream_ctx->next_uni_stream_for_control_stream;
+        }
+        break;
+    }
+    default:
+        *group_id = media_ctx->current_group_id;
+        *object_id = media_ctx->current_object_id;
+        break;
+    }
+}
+
+int quicrq_fragment_cache_media_purge_pass_through(
+    quicrq_media_source_ctx_t* srce_ctx)
+{
+    int is_pass_through = 0;
+    quicrq_fragment_cache_t* cache_ctx = srce_ctx->cache_ctx;
+    quicrq_stream_ctx_t* stream_ctx = srce_ctx->first_stream;
+
+    if (cache_ctx != NULL && srce_ctx->is_cache_real_time &&
+        stream_ctx != NULL && stream_ctx->next_stream_for_source == NULL &&
+        stream_ctx->is_sender && stream_ctx->media_ctx != NULL) {
+        uint64_t kept_group_id;
+        uint64_t kept_object_id;
+
+        is_pass_through = 1;
+        quicrq_fragment_publisher_release_point(stream_ctx, &kept_group_id, &kept_object_id);
+
+        /* Purge all objects that the single reader does not need anymore. */
+        quicrq_fragment_cache_delete_before(cache_ctx, kept_group_id, kept_object_id);
+        if (kept_group_id > cache_ctx->first_group_id ||
+            (kept_group_id == cache_ctx->first_group_id && kept_object_id > cache_ctx->first_object_id)) {
+            /* Fragments arriving late for the released objects will not be cached again */
+            cache_ctx->first_group_id = kept_group_id;
+            cache_ctx->first_object_id = kept_object_id;
+            quicrq_fragment_group_time_prune(cache_ctx, kept_group_id);
+        }
+    }
+    return is_pass_through;
+}
+
+int quicrq_fragment_publisher_is_stalled(quicrq_stream_ctx_t* stream_ctx, uint64_t current_time,
+    uint64_t stall_time_max, uint64_t lag_groups_max)
+{
+    int is_stalled = 0;
+    quicrq_fragment_publisher_context_t* media_ctx = (quicrq_fragment_publisher_context_t*)stream_ctx->media_ctx;
+    quicrq_fragment_cache_t* cache_ctx = media_ctx->cache_ctx;
+    uint64_t group_id;
+    uint64_t object_id;
+
+    quicrq_fragment_publisher_release_point(stream_ctx, &group_id, &object_id);
+
+    if (stream_ctx->watchdog_progress_time == 0 ||
+        group_id != stream_ctx->watchdog_group_id || object_id != stream_ctx->watchdog_object_id ||
+        group_id > cache_ctx->next_group_id ||
+        (group_id == cache_ctx->next_group_id && object_id >= cache_ctx->next_object_id)) {
+        /* The publisher progressed, or has nothing left to send: not stalled */
+        stream_ctx->watchdog_group_id = group_id;
+        stream_ctx->watchdog_object_id = object_id;
+        stream_ctx->watchdog_progress_time = current_time;
+    }
+    else if (stall_time_max > 0 && current_time > stream_ctx->watchdog_progress_time + stall_time_max) {
+        is_stalled = 1;
     }
+
+    /* Fetches and subscriptions that start in the past are expected to lag behind */
+    if (lag_groups_max > 0 && stream_ctx->is_cache_real_time &&
+        !media_ctx->is_fetch && !stream_ctx->is_start_in_past &&
+        cache_ctx->highest_group_id > group_id + lag_groups_max) {
+        is_stalled = 1;
+    }
+
+    return is_stalled;
 }
 
 void quicrq_fragment_cache_delete_ctx(quicrq_fragment_cache_t* cache_ctx)
@@ -538,15 +1161,104 @@ quicrq_fragment_publisher_object_state_t* quicrq_fragment_publisher_object_get(q
 void quicrq_fragment_publisher_close(quicrq_fragment_publisher_context_t* media_ctx)
 {
     quicrq_fragment_cache_t * cache_ctx = media_ctx->cache_ctx;
-
-    picosplay_empty_tree(&media_ctx->publisher_object_tree);
+    quicrq_ctx_t* qr_ctx = (media_ctx->stream_ctx == NULL) ? NULL : media_ctx->stream_ctx->cnx_ctx->qr_ctx;
 
     if (cache_ctx->is_feed_closed && cache_ctx->qr_ctx != NULL) {
         /* This may be the last connection served from this cache */
         cache_ctx->qr_ctx->is_cache_closing_needed = 1;
     }
 
-    free(media_ctx);
+    if (qr_ctx == NULL) {
+        picosplay_empty_tree(&media_ctx->publisher_object_tree);
+        free(media_ctx);
+    }
+    else {
+        /* Defer the release of the object tree to the next time check, so
+         * unsubscribe storms do not add work to the sending code. */
+        media_ctx->stream_ctx = NULL;
+        media_ctx->cache_ctx = NULL;
+        media_ctx->next_in_pool = qr_ctx->first_retired_publisher;
+        qr_ctx->first_retired_publisher = media_ctx;
+    }
+}
+
+/* Batch teardown of the retired publisher contexts. The emptied contexts are kept
+ * in the free pool, up to qr_ctx->context_pool_max, and reused by the next subscriptions.
+ */
+void quicrq_fragment_publisher_reap(quicrq_ctx_t* qr_ctx)
+{
+    while (qr_ctx->first_retired_publisher != NULL) {
+        quicrq_fragment_publisher_context_t* media_ctx = qr_ctx->first_retired_publisher;
+        qr_ctx->first_retired_publisher = media_ctx->next_in_pool;
+        picosplay_empty_tree(&media_ctx->publisher_object_tree);
+        if (qr_ctx->nb_free_publishers < qr_ctx->context_pool_max) {
+            media_ctx->next_in_pool = qr_ctx->first_free_publisher;
+            qr_ctx->first_free_publisher = media_ctx;
+            qr_ctx->nb_free_publishers++;
+        }
+        else {
+            free(media_ctx);
+        }
+    }
+}
+
+void quicrq_fragment_publisher_pool_release(quicrq_ctx_t* qr_ctx)
+{
+    quicrq_fragment_publisher_reap(qr_ctx);
+    while (qr_ctx->first_free_publisher != NULL) {
+        quicrq_fragment_publisher_context_t* media_ctx = qr_ctx->first_free_publisher;
+        qr_ctx->first_free_publisher = media_ctx->next_in_pool;
+        free(media_ctx);
+    }
+    qr_ctx->nb_free_publishers = 0;
+}
+
+/* Check whether the object at the specified position in the current group of the publisher,
+ * or the first object of the next group, was skipped after its repair deadline.
+ */
+static quicrq_repair_skip_t* quicrq_fragment_publisher_get_repair_skip(quicrq_fragment_publisher_context_t* media_ctx,
+    uint64_t object_id, int* is_next_group)
+{
+    quicrq_repair_skip_t* skip = NULL;
+
+    *is_next_group = 0;
+    if (media_ctx->cache_ctx->first_repair_skip != NULL && !media_ctx->is_fetch) {
+        skip = quicrq_fragment_cache_get_repair_skip(media_ctx->cache_ctx, media_ctx->current_group_id, object_id);
+        if (skip == NULL) {
+            skip = quicrq_fragment_cache_get_repair_skip(media_ctx->cache_ctx, media_ctx->current_group_id + 1, 0);
+            if (skip != NULL && object_id >= skip->nb_objects_previous_group) {
+                *is_next_group = 1;
+            }
+            else {
+                skip = NULL;
+            }
+        }
+    }
+    return skip;
+}
+
+/* Move a single stream publisher forward to the start point of the stream, if it is
+ * still positioned before it. This happens when the start point moves in the middle
+ * of the media, e.g., because the upstream sender abandoned groups: the objects before
+ * the start point will never be complete. Only called between objects.
+ */
+void quicrq_fragment_publisher_skip_to_start_point(quicrq_stream_ctx_t* stream_ctx)
+{
+    quicrq_fragment_publisher_context_t* media_ctx = (quicrq_fragment_publisher_context_t*)stream_ctx->media_ctx;
+
+    if (media_ctx != NULL && !media_ctx->is_fetch &&
+        (media_ctx->current_group_id < stream_ctx->start_group_id ||
+        (media_ctx->current_group_id == stream_ctx->start_group_id && media_ctx->current_object_id < stream_ctx->start_object_id))) {
+        media_ctx->current_group_id = stream_ctx->start_group_id;
+        media_ctx->current_object_id = stream_ctx->start_object_id;
+        media_ctx->current_offset = 0;
+        media_ctx->length_sent = 0;
+        media_ctx->current_fragment = NULL;
+        media_ctx->is_current_object_skipped = 0;
+        stream_ctx->next_group_id = stream_ctx->start_group_id;
+        stream_ctx->next_object_id = stream_ctx->start_object_id;
+        stream_ctx->next_object_offset = 0;
+    }
 }
 
 int quicrq_fragment_is_ready_to_send(void* v_media_ctx, size_t data_max_size, uint64_t current_time)
@@ -562,13 +1274,23 @@ int quicrq_fragment_is_ready_to_send(void* v_media_ctx, size_t data_max_size, ui
 
     if (0 == quicrq_fragment_publisher_fn(quicrq_media_source_get_data, v_media_ctx, NULL, data_max_size,
         &data_length, &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &should_skip, current_time)) {
-        if (data_length > 0) {
+        if (data_length > 0 || should_skip) {
             is_ready = 1; 
         }
     }
     return is_ready;
 }
 
+/* Check whether a fetch publisher reached the end of the fetched range.
+ */
+static int quicrq_fragment_publisher_is_fetch_end(quicrq_fragment_publisher_context_t* media_ctx)
+{
+    return media_ctx->is_fetch &&
+        (media_ctx->current_group_id > media_ctx->fetch_end_group_id ||
+            (media_ctx->current_group_id == media_ctx->fetch_end_group_id &&
+                media_ctx->current_object_id >= media_ctx->fetch_end_object_id));
+}
+
 int quicrq_fragment_publisher_fn(
     quicrq_media_source_action_enum action,
     void* v_media_ctx,
@@ -586,6 +1308,8 @@ int quicrq_fragment_publisher_fn(
     int ret = 0;
 
     quicrq_fragment_publisher_context_t* media_ctx = (quicrq_fragment_publisher_context_t*)v_media_ctx;
+    int is_next_group = 0;
+
     if (action == quicrq_media_source_get_data) {
         *is_new_group = 0;
         *is_media_finished = 0;
@@ -604,6 +1328,10 @@ int quicrq_fragment_publisher_fn(
                     media_ctx->current_object_id >= media_ctx->cache_ctx->final_object_id))) {
             *is_media_finished = 1;
         }
+        else if (media_ctx->current_offset == 0 && quicrq_fragment_publisher_is_fetch_end(media_ctx)) {
+            /* End of the fetched range */
+            *is_media_finished = 1;
+        }
         else {
             /* If skipping the current objet, check that the next object is available */
             if (media_ctx->is_current_object_skipped) {
@@ -628,8 +1356,21 @@ int quicrq_fragment_publisher_fn(
                         media_ctx->current_object_id = 0;
                         media_ctx->current_offset = 0;
                         media_ctx->is_current_object_skipped = 0;
-                        media_ctx->current_fragment = next_group_fragment;
                         *is_new_group = 1;
+                        if (quicrq_fragment_publisher_is_fetch_end(media_ctx)) {
+                            /* The fetched range ends before the new group */
+                            media_ctx->current_fragment = NULL;
+                            *is_media_finished = 1;
+                        }
+                        else {
+                            media_ctx->current_fragment = next_group_fragment;
+                        }
+                    }
+                    else if (quicrq_fragment_publisher_get_repair_skip(media_ctx, media_ctx->current_object_id + 1, &is_next_group) != NULL) {
+                        /* The next object was skipped after its repair deadline. It is processed below. */
+                        media_ctx->current_object_id += 1;
+                        media_ctx->current_offset = 0;
+                        media_ctx->is_current_object_skipped = 0;
                     }
                     else {
                         if ((media_ctx->cache_ctx->final_group_id > 0 || media_ctx->cache_ctx->final_object_id > 0) &&
@@ -641,22 +1382,32 @@ int quicrq_fragment_publisher_fn(
                     }
                 }
             } else if (media_ctx->current_fragment == NULL) {
-                /* Find the fragment with the expected offset */
-                media_ctx->current_fragment = quicrq_fragment_cache_get_fragment(media_ctx->cache_ctx, 
+                /* Find the fragment with the expected offset, starting from the read cursor */
+                media_ctx->current_fragment = quicrq_fragment_cursor_seek(media_ctx->cache_ctx, &media_ctx->read_cursor,
                     media_ctx->current_group_id, media_ctx->current_object_id, media_ctx->current_offset);
+                if (media_ctx->current_fragment != NULL) {
+                    /* The expected offset may be inside an extent that grew after it was last read */
+                    media_ctx->length_sent = (size_t)(media_ctx->current_offset - media_ctx->current_fragment->offset);
+                }
                 /* if there is no such fragment and this is the beginning of a new object, try the next group */
                 if (media_ctx->current_fragment == NULL && media_ctx->current_offset == 0) {
-                    quicrq_cached_fragment_t* next_group_fragment = quicrq_fragment_cache_get_fragment(media_ctx->cache_ctx,
-                        media_ctx->current_group_id + 1, 0, 0);
+                    quicrq_cached_fragment_t* next_group_fragment = quicrq_fragment_cursor_seek(media_ctx->cache_ctx,
+                        &media_ctx->read_cursor, media_ctx->current_group_id + 1, 0, 0);
                     if (next_group_fragment != NULL) {
                         /* This is the first fragment of a new group. Check whether the objects from the
                          * previous group have been all received. */
                         if (media_ctx->current_object_id >= next_group_fragment->nb_objects_previous_group) {
-                            media_ctx->current_fragment = next_group_fragment;
                             media_ctx->current_group_id = media_ctx->current_group_id + 1;
                             media_ctx->current_object_id = 0;
                             media_ctx->current_offset = 0;
                             *is_new_group = 1;
+                            if (quicrq_fragment_publisher_is_fetch_end(media_ctx)) {
+                                /* The fetched range ends before the new group */
+                                *is_media_finished = 1;
+                            }
+                            else {
+                                media_ctx->current_fragment = next_group_fragment;
+                            }
                         }
                         else {
                             DBG_PRINTF("Group %" PRIu64 " is not complete, time= %" PRIu64, media_ctx->current_group_id, current_time);
@@ -664,6 +1415,20 @@ int quicrq_fragment_publisher_fn(
                     }
                 }
             }
+            if (!*is_media_finished && !media_ctx->is_current_object_skipped && media_ctx->current_offset == 0 && media_ctx->length_sent == 0 &&
+                quicrq_fragment_publisher_get_repair_skip(media_ctx, media_ctx->current_object_id, &is_next_group) != NULL) {
+                /* The object was skipped after its repair deadline. If it was partially received,
+                 * skip it anyway, since the missing data may never arrive. */
+                if (is_next_group) {
+                    media_ctx->current_group_id += 1;
+                    media_ctx->current_object_id = 0;
+                    *is_new_group = 1;
+                }
+                media_ctx->current_fragment = NULL;
+                *flags = 0xff;
+                *is_still_active = 1;
+                *should_skip = 1;
+            }
             if (media_ctx->current_fragment == NULL) {
                 /* Check for end of media maybe */
             }
@@ -681,10 +1446,14 @@ int quicrq_fragment_publisher_fn(
                 }
                 *data_length = copied;
                 *is_still_active = 1;
-                if (data == NULL) {
+                if (data == NULL && !media_ctx->is_fetch) {
                     if (available > 0 && media_ctx->current_fragment->object_id != 0 &&
                         media_ctx->stream_ctx->next_object_id != 0 ) {
                         *should_skip = quicrq_evaluate_stream_congestion(media_ctx, current_time);
+                        if (media_ctx->current_offset == 0 && media_ctx->length_sent == 0) {
+                            *should_skip = quicrq_evaluate_dependency(&media_ctx->dependency_group_id, &media_ctx->is_dependency_broken, media_ctx->current_fragment->group_id,
+                                media_ctx->current_fragment->dependency, *should_skip);
+                        }
                     }
                 }
 
@@ -693,7 +1462,7 @@ int quicrq_fragment_publisher_fn(
                     memcpy(data, media_ctx->current_fragment->data + media_ctx->length_sent, copied);
                     media_ctx->length_sent += copied;
                     if (end_of_fragment) {
-                        size_t next_offset = media_ctx->current_offset + media_ctx->current_fragment->data_length;
+                        size_t next_offset = media_ctx->current_fragment->offset + media_ctx->current_fragment->data_length;
                         if (next_offset >= media_ctx->current_fragment->object_length) {
                             media_ctx->current_object_id++;
                             media_ctx->current_offset = 0;
@@ -751,6 +1520,14 @@ int quicrq_fragment_datagram_publisher_check_fragment(
     if (media_ctx->current_fragment == NULL) {
         /* Nothing to send yet */
     }
+    else if (media_ctx->is_current_fragment_sent &&
+        media_ctx->length_sent < media_ctx->current_fragment->data_length &&
+        (publisher_object = quicrq_fragment_publisher_object_get(media_ctx,
+            media_ctx->current_fragment->group_id, media_ctx->current_fragment->object_id)) != NULL &&
+        !publisher_object->is_dropped && !publisher_object->is_sent) {
+        /* The fragment was extended with new data after it was sent. Send the new data. */
+        media_ctx->is_current_fragment_sent = 0;
+    }
     else if (media_ctx->is_current_fragment_sent) {
         /* Find the next fragment in order, but skip if already skipped. */
         while (media_ctx->current_fragment->next_in_order != NULL) {
@@ -773,6 +1550,8 @@ int quicrq_fragment_datagram_publisher_check_fragment(
                 else {
                     /* this is a new object. The fragment should be processed. */
                     *should_skip = quicrq_evaluate_datagram_congestion(stream_ctx, media_ctx, current_time);
+                    *should_skip = quicrq_evaluate_dependency(&media_ctx->dependency_group_id, &media_ctx->is_dependency_broken, media_ctx->current_fragment->group_id,
+                        media_ctx->current_fragment->dependency, *should_skip);
                     break;
                 }
             }
@@ -853,7 +1632,12 @@ int quicrq_fragment_datagram_publisher_object_update(
     }
     else {
         /* Document object properties */
-        int is_last_fragment = (next_offset >= publisher_object->object_length);
+        int is_last_fragment;
+        if (publisher_object->object_length == QUICRQ_OBJECT_LENGTH_UNKNOWN) {
+            /* Streamed object, the actual length comes with the final fragment */
+            publisher_object->object_length = media_ctx->current_fragment->object_length;
+        }
+        is_last_fragment = (next_offset >= publisher_object->object_length);
         publisher_object->bytes_sent += copied;
         publisher_object->is_dropped = should_skip;
         if (media_ctx->current_fragment->nb_objects_previous_group > 0) {
@@ -872,6 +1656,53 @@ int quicrq_fragment_datagram_publisher_object_update(
     return ret;
 }
 
+/* Compute how many bytes of the current fragment should be sent in the available space.
+ * Splitting at the available space often produces a full datagram followed by a tiny
+ * tail, which costs a header, an ack record and a loss opportunity. Instead:
+ * - the data is split in evenly sized pieces, based on the largest datagram space
+ *   seen so far, minus a margin for the growth of the offset encoding,
+ * - if starting the split in a space smaller than that would require an extra
+ *   datagram, the split is deferred once, waiting for a larger space.
+ * Returns 0 if the split is deferred.
+ */
+#define QUICRQ_DATAGRAM_SPLIT_MARGIN 4
+
+static size_t quicrq_fragment_datagram_split_length(quicrq_fragment_publisher_context_t* media_ctx,
+    size_t available, size_t space, size_t h_size)
+{
+    size_t copied = space - h_size;
+
+    if (copied >= available) {
+        copied = available;
+    }
+    else if (copied > 0) {
+        size_t full_length = copied;
+        size_t nb_pieces_min;
+        size_t nb_pieces_now;
+
+        if (media_ctx->datagram_space_max > h_size + QUICRQ_DATAGRAM_SPLIT_MARGIN + copied) {
+            full_length = media_ctx->datagram_space_max - h_size - QUICRQ_DATAGRAM_SPLIT_MARGIN;
+        }
+        else if (copied > 2 * QUICRQ_DATAGRAM_SPLIT_MARGIN) {
+            full_length = copied - QUICRQ_DATAGRAM_SPLIT_MARGIN;
+        }
+        nb_pieces_min = (available + full_length - 1) / full_length;
+        nb_pieces_now = 1 + (available - copied + full_length - 1) / full_length;
+
+        if (nb_pieces_now > nb_pieces_min && !media_ctx->is_split_deferred) {
+            media_ctx->is_split_deferred = 1;
+            copied = 0;
+        }
+        else {
+            size_t even_length = (available + nb_pieces_min - 1) / nb_pieces_min;
+            if (even_length < copied) {
+                copied = even_length;
+            }
+        }
+    }
+    return copied;
+}
+
 /* Send the next fragment, or a placeholder if the object shall be skipped. 
  */
 int quicrq_fragment_datagram_publisher_send_fragment(
@@ -893,7 +1724,7 @@ int quicrq_fragment_datagram_publisher_send_fragment(
     uint8_t* h_byte = quicrq_datagram_header_encode(datagram_header, datagram_header + QUICRQ_DATAGRAM_HEADER_MAX,
         media_id, media_ctx->current_fragment->group_id, media_ctx->current_fragment->object_id, offset,
         media_ctx->current_fragment->queue_delay, flags, media_ctx->current_fragment->nb_objects_previous_group,
-        object_length);
+        object_length, (should_skip) ? 0 : media_ctx->current_fragment->origin_timestamp);
     if (h_byte == NULL) {
         /* Should never happen. */
         ret = -1;
@@ -914,14 +1745,26 @@ int quicrq_fragment_datagram_publisher_send_fragment(
                  * Encode the header again if something changed, e.g., last fragment bit. 
                  */
                 available = media_ctx->current_fragment->data_length - media_ctx->length_sent;
-                copied = space - h_size;
-                if (copied >= available) {
-                    copied = available;
+                if (space > media_ctx->datagram_space_max) {
+                    media_ctx->datagram_space_max = space;
+                }
+                if (stream_ctx != NULL && stream_ctx->cnx_ctx->qr_ctx->is_datagram_split_policy_disabled) {
+                    copied = space - h_size;
+                    if (copied >= available) {
+                        copied = available;
+                    }
+                }
+                else {
+                    copied = quicrq_fragment_datagram_split_length(media_ctx, available, space, h_size);
+                    if (copied == 0) {
+                        /* Wait for a larger datagram */
+                        *at_least_one_active = 1;
+                    }
                 }
             }
             if (copied > 0 || should_skip || media_ctx->current_fragment->data_length == 0){
                 /* Get a buffer inside the datagram packet */
-                void* buffer = picoquic_provide_datagram_buffer(context, copied + h_size);
+                void* buffer = quicrq_provide_datagram_buffer(stream_ctx, context, copied + h_size);
                 if (buffer == NULL) {
                     ret = -1;
                 }
@@ -935,6 +1778,7 @@ int quicrq_fragment_datagram_publisher_send_fragment(
                             media_ctx->length_sent += copied;
                         }
                         media_ctx->is_current_fragment_sent |= (should_skip || media_ctx->length_sent >= media_ctx->current_fragment->data_length);
+                        media_ctx->is_split_deferred = 0;
                         *media_was_sent = 1;
                         *at_least_one_active = 1;
                         if (stream_ctx != NULL) {
@@ -945,11 +1789,27 @@ int quicrq_fragment_datagram_publisher_send_fragment(
                                 media_ctx->current_fragment->nb_objects_previous_group,
                                 ((uint8_t*)buffer) + h_size, copied,
                                 media_ctx->current_fragment->queue_delay, 
-                                media_ctx->current_fragment->object_length, NULL,
+                                media_ctx->current_fragment->object_length,
+                                (should_skip) ? 0 : media_ctx->current_fragment->origin_timestamp, NULL,
                                 picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic));
                             if (ret != 0) {
                                 DBG_PRINTF("Datagram ack init returns %d", ret);
                             }
+                            else {
+                                quicrq_extra_repeat_credit(stream_ctx->cnx_ctx, copied + h_size);
+                                if (offset == 0 && !should_skip) {
+                                    quicrq_stream_first_byte_sent(stream_ctx, media_ctx->current_fragment->cache_time,
+                                        picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic));
+                                }
+                                stream_ctx->congestion.bytes_sent += copied;
+                                stream_ctx->nb_bytes_sent += copied;
+                                stream_ctx->nb_datagrams_sent++;
+                                stream_ctx->datagram_header_bytes += h_size;
+                                if (should_skip && offset == 0) {
+                                    /* Count the object once, not once per skipped fragment */
+                                    stream_ctx->nb_objects_skipped++;
+                                }
+                            }
                         }
                         if (ret == 0) {
                             ret = quicrq_fragment_datagram_publisher_object_update(media_ctx,
@@ -1069,6 +1929,13 @@ uint64_t quicrq_fragment_get_object_count(quicrq_fragment_cache_t* cache_ctx, ui
             (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(fragment_node);
         nb_objects = fragment_state->nb_objects_previous_group;
     }
+    else if (cache_ctx->first_repair_skip != NULL) {
+        /* The first object of the next group may have been skipped after its repair deadline */
+        quicrq_repair_skip_t* skip = quicrq_fragment_cache_get_repair_skip(cache_ctx, group_id + 1, 0);
+        if (skip != NULL) {
+            nb_objects = skip->nb_objects_previous_group;
+        }
+    }
     return nb_objects;
 }
 
@@ -1090,6 +1957,36 @@ uint8_t quicrq_fragment_get_flags(quicrq_fragment_cache_t* cache_ctx, uint64_t g
     return flags;
 }
 
+uint64_t quicrq_fragment_get_origin_timestamp(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id)
+{
+    uint64_t origin_timestamp = 0;
+    quicrq_cached_fragment_t* fragment_state = quicrq_fragment_cache_get_fragment(cache_ctx, group_id, object_id, 0);
+    if (fragment_state != NULL) {
+        origin_timestamp = fragment_state->origin_timestamp;
+    }
+    return origin_timestamp;
+}
+
+uint64_t quicrq_fragment_get_cache_time(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id)
+{
+    uint64_t cache_time = 0;
+    quicrq_cached_fragment_t* fragment_state = quicrq_fragment_cache_get_fragment(cache_ctx, group_id, object_id, 0);
+    if (fragment_state != NULL) {
+        cache_time = fragment_state->cache_time;
+    }
+    return cache_time;
+}
+
+quicrq_object_dependency_enum quicrq_fragment_get_dependency(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id)
+{
+    quicrq_object_dependency_enum dependency = quicrq_object_dependency_none;
+    quicrq_cached_fragment_t* fragment_state = quicrq_fragment_cache_get_fragment(cache_ctx, group_id, object_id, 0);
+    if (fragment_state != NULL) {
+        dependency = fragment_state->dependency;
+    }
+    return dependency;
+}
+
 /* Get the length and flags of an object, i.e., the information required to
  * format the object header.
  */
@@ -1106,51 +2003,63 @@ int quicrq_fragment_get_object_properties(quicrq_fragment_cache_t* cache_ctx, ui
     if (fragment_node != NULL) {
         quicrq_cached_fragment_t* fragment_state =
             (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(fragment_node);
-        ret = 0;
-        *object_length = fragment_state->object_length;
-        *nb_objects_previous_group = fragment_state->nb_objects_previous_group;
-        *flags = fragment_state->flags;
+        uint64_t length = fragment_state->object_length;
+        if (length == QUICRQ_OBJECT_LENGTH_UNKNOWN) {
+            /* The object is streamed. The length is only known once the final fragment is received */
+            quicrq_cached_fragment_t* last_fragment;
+            key.offset = UINT64_MAX;
+            last_fragment = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(
+                picosplay_find_previous(&cache_ctx->fragment_tree, &key));
+            if (last_fragment != NULL) {
+                length = last_fragment->object_length;
+            }
+        }
+        if (length != QUICRQ_OBJECT_LENGTH_UNKNOWN) {
+            ret = 0;
+            *object_length = (size_t)length;
+            *nb_objects_previous_group = fragment_state->nb_objects_previous_group;
+            *flags = fragment_state->flags;
+        }
     }
     return ret;
 }
 
-size_t quicrq_fragment_object_copy_available_data(quicrq_fragment_cache_t* cache_ctx, 
+size_t quicrq_fragment_object_copy_available_data(quicrq_fragment_cache_t* cache_ctx, quicrq_fragment_cursor_t* cursor,
     uint64_t group_id, uint64_t object_id, size_t offset, size_t available, uint8_t* buffer)
 {
     size_t fragment_size = 0;
-    uint64_t current_offset = 0;
-    picosplay_node_t* fragment_node = NULL;
-    /* find the fragment tree for the group/object */
-    /* TODO: should start the lookup at the current offset. */
-    quicrq_cached_fragment_t key = { 0 };
-    key.group_id = group_id;
-    key.object_id = object_id;
-    key.offset = 0;
-    fragment_node = picosplay_find(&cache_ctx->fragment_tree, &key);
+    quicrq_fragment_cursor_t local_cursor = { 0 };
+    quicrq_cached_fragment_t* fragment_state;
 
-    while (fragment_node != NULL && fragment_size < available) {
-        quicrq_cached_fragment_t* fragment_state =
-            (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(fragment_node);
-        if (fragment_state->group_id != group_id || 
-            fragment_state->object_id != object_id ||
-            fragment_state->offset != current_offset) {
-            /* Next fragment in order is not what we expect, so stop there */
-            break;
-        }
+    if (cursor == NULL) {
+        cursor = &local_cursor;
+    }
+    /* find the fragment that contains the offset */
+    fragment_state = quicrq_fragment_cursor_seek(cache_ctx, cursor, group_id, object_id, offset);
+
+    while (fragment_state != NULL && fragment_size < available) {
         /* compute the object size and fill the passed in buffer, if non-null */
-        if (current_offset + fragment_state->data_length > offset) {
-            size_t offset_offset = (current_offset < offset) ? offset - current_offset : 0;
-            size_t copied = fragment_state->data_length - offset_offset;
-            if (fragment_size + copied > available) {
-                copied = available - fragment_size;
-            }
-            if (buffer != NULL) {
-                memcpy(buffer + fragment_size, fragment_state->data + offset_offset, copied);
+        size_t offset_offset = (size_t)(offset + fragment_size - fragment_state->offset);
+        size_t copied = fragment_state->data_length - offset_offset;
+        uint64_t next_offset = fragment_state->offset + fragment_state->data_length;
+        if (fragment_size + copied > available) {
+            copied = available - fragment_size;
+        }
+        if (buffer != NULL) {
+            memcpy(buffer + fragment_size, fragment_state->data + offset_offset, copied);
+            /* The data is consumed, move the cursor */
+            cursor->fragment = fragment_state;
+        }
+        fragment_size += copied;
+        if (fragment_size < available) {
+            fragment_state = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(
+                picosplay_next(&fragment_state->fragment_node));
+            if (fragment_state != NULL && (fragment_state->group_id != group_id ||
+                fragment_state->object_id != object_id || fragment_state->offset != next_offset)) {
+                /* Next fragment in order is not what we expect, so stop there */
+                fragment_state = NULL;
             }
-            fragment_size += copied;
         }
-        current_offset += fragment_state->data_length;
-        fragment_node = picosplay_next(fragment_node);
     }
 
     return fragment_size;
@@ -1193,7 +2102,7 @@ size_t quicrq_fragment_object_copy(quicrq_fragment_cache_t* cache_ctx, uint64_t
         /* compute the object size and fill the passed in buffer, if non-null*/
         object_size += fragment_state->data_length;
         if (buffer != NULL) {
-            memcpy(buffer, fragment_state->data + current_offset, fragment_state->data_length);
+            memcpy(buffer + current_offset, fragment_state->data, fragment_state->data_length);
         }
         current_offset += fragment_state->data_length;
 
@@ -1210,8 +2119,17 @@ size_t quicrq_fragment_object_copy(quicrq_fragment_cache_t* cache_ctx, uint64_t
 
 void* quicrq_fragment_publisher_subscribe(quicrq_fragment_cache_t* cache_ctx, quicrq_stream_ctx_t * stream_ctx)
 {
-    quicrq_fragment_publisher_context_t* media_ctx = (quicrq_fragment_publisher_context_t*)
-        malloc(sizeof(quicrq_fragment_publisher_context_t));
+    quicrq_ctx_t* qr_ctx = stream_ctx->cnx_ctx->qr_ctx;
+    quicrq_fragment_publisher_context_t* media_ctx = qr_ctx->first_free_publisher;
+
+    if (media_ctx != NULL) {
+        /* Reuse a context from the pool */
+        qr_ctx->first_free_publisher = media_ctx->next_in_pool;
+        qr_ctx->nb_free_publishers--;
+    }
+    else {
+        media_ctx = (quicrq_fragment_publisher_context_t*)malloc(sizeof(quicrq_fragment_publisher_context_t));
+    }
     if (media_ctx != NULL) {
         memset(media_ctx, 0, sizeof(quicrq_fragment_publisher_context_t));
         media_ctx->stream_ctx = stream_ctx;
@@ -24,8 +24,23 @@ typedef struct st_quicrq_object_stream_consumer_ctx {
     quicrq_subscribe_order_enum order_required;
     uint64_t next_group_id;
     uint64_t next_object_id;
+    /* Parameters kept for resuming the subscription on a new connection */
+    uint8_t* url;
+    size_t url_length;
+    quicrq_transport_mode_enum transport_mode;
+    int is_resumable;
 } quicrq_object_stream_consumer_ctx;
 
+/* Release the bridge context */
+static void quicrq_media_object_bridge_release(quicrq_object_stream_consumer_ctx* bridge_ctx)
+{
+    quicrq_reassembly_release(&bridge_ctx->reassembly_ctx);
+    if (bridge_ctx->url != NULL) {
+        free(bridge_ctx->url);
+    }
+    free(bridge_ctx);
+}
+
 
 /* Process fragments arriving to the bridge */
 int quicrq_media_object_bridge_ready(
@@ -34,6 +49,7 @@ int quicrq_media_object_bridge_ready(
     uint64_t group_id,
     uint64_t object_id,
     uint8_t flags,
+    uint64_t origin_timestamp,
     const uint8_t* data,
     size_t data_length,
     quicrq_reassembly_object_mode_enum object_mode)
@@ -121,6 +137,7 @@ int quicrq_media_object_bridge_ready(
         /* Deliver to the application, update the counters */
         quicrq_object_stream_consumer_properties_t properties = { 0 };
         properties.flags = flags;
+        properties.origin_timestamp = origin_timestamp;
         bridge_ctx->next_group_id = group_id;
         bridge_ctx->next_object_id = object_id + 1;
         ret = bridge_ctx->object_stream_consumer_fn(
@@ -145,6 +162,7 @@ int quicrq_media_object_bridge_fn(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length)
 {
     int ret = 0;
@@ -154,7 +172,7 @@ int quicrq_media_object_bridge_fn(
     case quicrq_media_datagram_ready:
         ret = quicrq_reassembly_input(&bridge_ctx->reassembly_ctx, current_time, data, group_id, object_id, offset, 
             queue_delay, flags,
-            nb_objects_previous_group, object_length, data_length,
+            nb_objects_previous_group, object_length, origin_timestamp, data_length,
             quicrq_media_object_bridge_ready, bridge_ctx);
         if (ret == 0 && bridge_ctx->reassembly_ctx.is_finished) {
             ret = quicrq_consumer_finished;
@@ -177,13 +195,20 @@ int quicrq_media_object_bridge_fn(
         }
         break;
     case quicrq_media_close:
-        ret = bridge_ctx->object_stream_consumer_fn(
-            quicrq_media_close,
-            bridge_ctx->object_stream_consumer_ctx,
-            current_time, group_id, object_id,
-            NULL, 0, NULL, 0, 0);
-        quicrq_reassembly_release(&bridge_ctx->reassembly_ctx);
-        free(media_ctx);
+        /* The close reason and error code are passed in the object length and data length arguments */
+        if (bridge_ctx->is_resumable && !bridge_ctx->reassembly_ctx.is_finished &&
+            object_length == quicrq_media_close_quic_connection) {
+            /* The connection was lost. Keep the context, so the subscription can be resumed. */
+            bridge_ctx->stream_ctx = NULL;
+        }
+        else {
+            ret = bridge_ctx->object_stream_consumer_fn(
+                quicrq_media_close,
+                bridge_ctx->object_stream_consumer_ctx,
+                current_time, group_id, object_id,
+                NULL, 0, NULL, (quicrq_media_close_reason_enum)object_length, data_length);
+            quicrq_media_object_bridge_release(bridge_ctx);
+        }
         break;
     default:
         ret = -1;
@@ -207,12 +232,20 @@ quicrq_object_stream_consumer_ctx* quicrq_subscribe_object_stream(quicrq_cnx_ctx
         bridge_ctx->object_stream_consumer_fn = object_stream_consumer_fn;
         bridge_ctx->object_stream_consumer_ctx = object_stream_consumer_ctx;
         bridge_ctx->order_required = order_required;
+        bridge_ctx->transport_mode = transport_mode;
         quicrq_reassembly_init(&bridge_ctx->reassembly_ctx);
-        /* Create a media context for the stream */
-        ret = quicrq_cnx_subscribe_media_ex(cnx_ctx, url, url_length, transport_mode, intent,
-            quicrq_media_object_bridge_fn, bridge_ctx, &bridge_ctx->stream_ctx);
+        if ((bridge_ctx->url = (uint8_t*)malloc(url_length)) == NULL) {
+            ret = -1;
+        }
+        else {
+            memcpy(bridge_ctx->url, url, url_length);
+            bridge_ctx->url_length = url_length;
+            /* Create a media context for the stream */
+            ret = quicrq_cnx_subscribe_media_ex(cnx_ctx, url, url_length, transport_mode, intent,
+                quicrq_media_object_bridge_fn, bridge_ctx, &bridge_ctx->stream_ctx);
+        }
         if (ret != 0) {
-            free(bridge_ctx);
+            quicrq_media_object_bridge_release(bridge_ctx);
             bridge_ctx = NULL;
         }
     }
@@ -222,11 +255,61 @@ quicrq_object_stream_consumer_ctx* quicrq_subscribe_object_stream(quicrq_cnx_ctx
 
 void quicrq_unsubscribe_object_stream(quicrq_object_stream_consumer_ctx* bridge_ctx)
 {
+    if (bridge_ctx->stream_ctx == NULL) {
+        /* Suspended subscription. There is no stream to close, just close the bridge. */
+        (void)quicrq_media_object_bridge_fn(quicrq_media_close, bridge_ctx, picoquic_get_quic_time(bridge_ctx->qr_ctx->quic),
+            NULL, 0, 0, 0, 0, 0, 0, quicrq_media_close_local_application, 0, 0);
+    }
+    else {
+        if (bridge_ctx->stream_ctx->close_reason == quicrq_media_close_reason_unknown) {
+            bridge_ctx->stream_ctx->close_reason = quicrq_media_close_local_application;
+        }
+        /* Deleting the stream closes the bridge, which releases the bridge context */
+        quicrq_delete_stream_ctx(bridge_ctx->stream_ctx->cnx_ctx, bridge_ctx->stream_ctx);
+    }
+}
+
+void quicrq_object_stream_set_resumable(quicrq_object_stream_consumer_ctx* bridge_ctx, int is_resumable)
+{
+    bridge_ctx->is_resumable = is_resumable;
+}
 
-    if (bridge_ctx->stream_ctx->close_reason == quicrq_media_close_reason_unknown) {
-        bridge_ctx->stream_ctx->close_reason = quicrq_media_close_local_application;
+int quicrq_object_stream_is_suspended(quicrq_object_stream_consumer_ctx* bridge_ctx)
+{
+    return (bridge_ctx->stream_ctx == NULL);
+}
+
+/* Resume a suspended subscription on a new connection.
+ * The subscription restarts at the first object not yet received in sequence.
+ * Objects received out of order before the connection was lost are still held in the
+ * reassembly context, which will discard the duplicates. When skipping to the group
+ * ahead, the objects before the last delivered one are not wanted anymore.
+ */
+int quicrq_resume_object_stream(quicrq_object_stream_consumer_ctx* bridge_ctx, quicrq_cnx_ctx_t* cnx_ctx)
+{
+    int ret = 0;
+
+    if (bridge_ctx->stream_ctx != NULL) {
+        /* Subscription is still active */
+        ret = -1;
+    }
+    else {
+        quicrq_subscribe_intent_t intent = { 0 };
+        intent.intent_mode = quicrq_subscribe_intent_start_point;
+        intent.start_group_id = bridge_ctx->reassembly_ctx.next_group_id;
+        intent.start_object_id = bridge_ctx->reassembly_ctx.next_object_id;
+        if (bridge_ctx->order_required == quicrq_subscribe_in_order_skip_to_group_ahead &&
+            (bridge_ctx->next_group_id > intent.start_group_id ||
+                (bridge_ctx->next_group_id == intent.start_group_id && bridge_ctx->next_object_id > intent.start_object_id))) {
+            intent.start_group_id = bridge_ctx->next_group_id;
+            intent.start_object_id = bridge_ctx->next_object_id;
+        }
+        ret = quicrq_cnx_subscribe_media_ex(cnx_ctx, bridge_ctx->url, bridge_ctx->url_length, bridge_ctx->transport_mode, &intent,
+            quicrq_media_object_bridge_fn, bridge_ctx, &bridge_ctx->stream_ctx);
+        if (ret == 0) {
+            quicrq_log_message(cnx_ctx, "Resuming subscription on stream %" PRIu64 " at %" PRIu64 ",%" PRIu64,
+                bridge_ctx->stream_ctx->stream_id, intent.start_group_id, intent.start_object_id);
+        }
     }
-    quicrq_delete_stream_ctx(bridge_ctx->stream_ctx->cnx_ctx, bridge_ctx->stream_ctx);
-    bridge_ctx->object_stream_consumer_fn = NULL;
-    bridge_ctx->object_stream_consumer_ctx = NULL;
+    return ret;
 }
@@ -71,26 +71,25 @@ quicrq_media_object_source_ctx_t* quicrq_publish_object_source(quicrq_ctx_t* qr_
     return(object_source_ctx);
 }
 
-int quicrq_publish_object(
-    quicrq_media_object_source_ctx_t* object_source_ctx,
-    uint8_t* object_data,
-    size_t object_length,
-    quicrq_media_object_properties_t* properties,
-    uint64_t group_id,
-    uint64_t object_id)
+/* Verify that the progression of numbers by the application matches the rules,
+ * and if it does, move to the next group if needed.
+ */
+static int quicrq_object_source_check_next(quicrq_media_object_source_ctx_t* object_source_ctx,
+    uint64_t group_id, uint64_t object_id, uint64_t* nb_objects_previous_group)
 {
     int ret = 0;
-    uint64_t current_time = picoquic_get_quic_time(object_source_ctx->qr_ctx->quic);
-    uint64_t nb_objects_previous_group = 0;
 
-    /* Verify that the progression of numbers by the application matches the rules */
-    if (group_id != object_source_ctx->next_group_id) {
+    *nb_objects_previous_group = 0;
+    if (object_source_ctx->is_object_open) {
+        ret = -1;
+    }
+    else if (group_id != object_source_ctx->next_group_id) {
         if (group_id != object_source_ctx->next_group_id + 1 ||
             object_id != 0 || object_source_ctx->next_object_id == 0) {
             ret = -1;
         }
         else {
-            nb_objects_previous_group = object_source_ctx->next_object_id;
+            *nb_objects_previous_group = object_source_ctx->next_object_id;
             object_source_ctx->next_group_id++;
             object_source_ctx->next_object_id = 0;
         }
@@ -98,13 +97,124 @@ int quicrq_publish_object(
     else if (object_id !=  object_source_ctx->next_object_id){
         ret = -1;
     }
+    return ret;
+}
+
+/* Document the dependency class of an object, which is held by its first fragment */
+static void quicrq_object_source_set_dependency(quicrq_media_object_source_ctx_t* object_source_ctx,
+    quicrq_object_dependency_enum dependency)
+{
+    if (dependency != quicrq_object_dependency_none) {
+        quicrq_cached_fragment_t* fragment = quicrq_fragment_cache_get_fragment(object_source_ctx->cache_ctx,
+            object_source_ctx->next_group_id, object_source_ctx->next_object_id, 0);
+        if (fragment != NULL) {
+            fragment->dependency = dependency;
+        }
+    }
+}
+
+int quicrq_publish_object(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    uint8_t* object_data,
+    size_t object_length,
+    quicrq_media_object_properties_t* properties,
+    uint64_t group_id,
+    uint64_t object_id)
+{
+    uint64_t current_time = picoquic_get_quic_time(object_source_ctx->qr_ctx->quic);
+    uint64_t nb_objects_previous_group = 0;
+    int ret = quicrq_object_source_check_next(object_source_ctx, group_id, object_id, &nb_objects_previous_group);
 
     if (ret == 0) {
         ret = quicrq_fragment_propose_to_cache(object_source_ctx->cache_ctx,
             object_data, object_source_ctx->next_group_id, object_source_ctx->next_object_id,
             /* offset */ 0, /* queue delay */ 0, properties->flags, nb_objects_previous_group,
-            object_length, object_length, current_time);
+            object_length, properties->origin_timestamp, object_length, current_time);
+        if (ret == 0) {
+            quicrq_object_source_set_dependency(object_source_ctx, properties->dependency);
+            object_source_ctx->next_object_id++;
+        }
+    }
+    return ret;
+}
+
+/* Streaming publication of objects.
+ * Chunks are proposed to the cache as they are appended, with the provisional
+ * length QUICRQ_OBJECT_LENGTH_UNKNOWN. The final chunk carries the actual length.
+ */
+int quicrq_publish_object_open(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    quicrq_media_object_properties_t* properties,
+    uint64_t group_id,
+    uint64_t object_id)
+{
+    int ret = quicrq_object_source_check_next(object_source_ctx, group_id, object_id,
+        &object_source_ctx->open_nb_objects_previous_group);
+
+    if (ret == 0) {
+        object_source_ctx->is_object_open = 1;
+        object_source_ctx->open_offset = 0;
+        object_source_ctx->open_properties = *properties;
+    }
+    return ret;
+}
+
+static int quicrq_publish_object_chunk(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    const uint8_t* data,
+    size_t data_length,
+    uint64_t object_length)
+{
+    uint64_t current_time = picoquic_get_quic_time(object_source_ctx->qr_ctx->quic);
+    int ret = quicrq_fragment_propose_to_cache(object_source_ctx->cache_ctx,
+        data, object_source_ctx->next_group_id, object_source_ctx->next_object_id,
+        object_source_ctx->open_offset, /* queue delay */ 0, object_source_ctx->open_properties.flags,
+        (object_source_ctx->open_offset == 0) ? object_source_ctx->open_nb_objects_previous_group : 0,
+        object_length, (object_source_ctx->open_offset == 0) ? object_source_ctx->open_properties.origin_timestamp : 0,
+        data_length, current_time);
+
+    if (ret == 0) {
+        if (object_source_ctx->open_offset == 0) {
+            quicrq_object_source_set_dependency(object_source_ctx, object_source_ctx->open_properties.dependency);
+        }
+        object_source_ctx->open_offset += data_length;
+    }
+    return ret;
+}
+
+int quicrq_publish_object_append(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    const uint8_t* data,
+    size_t data_length)
+{
+    int ret = 0;
+
+    if (!object_source_ctx->is_object_open) {
+        ret = -1;
+    }
+    else if (data_length > 0) {
+        ret = quicrq_publish_object_chunk(object_source_ctx, data, data_length, QUICRQ_OBJECT_LENGTH_UNKNOWN);
+    }
+    return ret;
+}
+
+int quicrq_publish_object_close(
+    quicrq_media_object_source_ctx_t* object_source_ctx,
+    const uint8_t* data,
+    size_t data_length)
+{
+    int ret = 0;
+
+    if (!object_source_ctx->is_object_open ||
+        (data_length == 0 && object_source_ctx->open_offset > 0)) {
+        /* The final length must be carried by a non empty fragment */
+        ret = -1;
+    }
+    else {
+        ret = quicrq_publish_object_chunk(object_source_ctx, data, data_length,
+            object_source_ctx->open_offset + data_length);
         if (ret == 0) {
+            object_source_ctx->is_object_open = 0;
             object_source_ctx->next_object_id++;
         }
     }
@@ -107,6 +107,11 @@ const uint8_t* quicrq_notify_msg_decode(const uint8_t* bytes, const uint8_t* byt
  *     intent_mode(i),
  *     [ start_group_id(i),
  *       start_object_id(i),]
+ *     [ start_time(i) ]
+ *     [ start_group_id(i),
+ *       start_object_id(i),
+ *       end_group_id(i),
+ *       end_object_id(i)]
  * 
  * 
  * Same encoding and decoding code is used for both.
@@ -114,13 +119,15 @@ const uint8_t* quicrq_notify_msg_decode(const uint8_t* bytes, const uint8_t* byt
  */
 size_t quicrq_rq_msg_reserve(size_t url_length, quicrq_subscribe_intent_enum intent_mode)
 {
-    size_t intent_length = (intent_mode == quicrq_subscribe_intent_start_point) ? 17:1;
+    size_t intent_length = (intent_mode == quicrq_subscribe_intent_start_point) ? 17 :
+        ((intent_mode == quicrq_subscribe_intent_start_time) ? 9 :
+        ((intent_mode == quicrq_subscribe_intent_fetch_range) ? 33 : 1));
     return 8 + 2 + url_length + 8 + 1 + intent_length;
 }
 
 uint8_t* quicrq_rq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, size_t url_length, const uint8_t* url,
     uint64_t media_id, quicrq_transport_mode_enum transport_mode, quicrq_subscribe_intent_enum intent_mode,
-    uint64_t start_group_id,  uint64_t start_object_id)
+    uint64_t start_group_id,  uint64_t start_object_id, uint64_t start_time, uint64_t end_group_id, uint64_t end_object_id)
 {
     if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, message_type)) != NULL &&
         (bytes = picoquic_frames_length_data_encode(bytes, bytes_max, url_length, url)) != NULL &&
@@ -132,13 +139,23 @@ uint8_t* quicrq_rq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t messa
                 bytes = picoquic_frames_varint_encode(bytes, bytes_max, (uint64_t)start_object_id);
             }
         }
+        else if (intent_mode == quicrq_subscribe_intent_start_time) {
+            bytes = picoquic_frames_varint_encode(bytes, bytes_max, start_time);
+        }
+        else if (intent_mode == quicrq_subscribe_intent_fetch_range) {
+            if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, (uint64_t)start_group_id)) != NULL &&
+                (bytes = picoquic_frames_varint_encode(bytes, bytes_max, (uint64_t)start_object_id)) != NULL &&
+                (bytes = picoquic_frames_varint_encode(bytes, bytes_max, (uint64_t)end_group_id)) != NULL) {
+                bytes = picoquic_frames_varint_encode(bytes, bytes_max, (uint64_t)end_object_id);
+            }
+        }
     }
     return bytes;
 }
 
 const uint8_t* quicrq_rq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t * message_type, size_t * url_length, const uint8_t** url,
     uint64_t *media_id, quicrq_transport_mode_enum* transport_mode, quicrq_subscribe_intent_enum* intent_mode,
-    uint64_t *start_group_id, uint64_t *start_object_id)
+    uint64_t *start_group_id, uint64_t *start_object_id, uint64_t* start_time, uint64_t* end_group_id, uint64_t* end_object_id)
 {
     uint64_t intent_64 = 0;
     uint64_t t_mode_64 = 0;
@@ -149,6 +166,9 @@ const uint8_t* quicrq_rq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_m
     *intent_mode = 0;
     *start_group_id = 0;
     *start_object_id = 0;
+    *start_time = 0;
+    *end_group_id = 0;
+    *end_object_id = 0;
 
     if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, message_type)) != NULL &&
         (bytes = picoquic_frames_varlen_decode(bytes, bytes_max, url_length)) != NULL){
@@ -157,7 +177,7 @@ const uint8_t* quicrq_rq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_m
             (bytes = picoquic_frames_varint_decode(bytes, bytes_max, media_id)) != NULL &&
             (bytes = picoquic_frames_varint_decode(bytes, bytes_max, &t_mode_64)) != NULL &&
             (bytes = picoquic_frames_varint_decode(bytes, bytes_max, &intent_64)) != NULL) {
-            if (intent_64 > quicrq_subscribe_intent_start_point ||
+            if (intent_64 > quicrq_subscribe_intent_fetch_range ||
                 t_mode_64 >= quicrq_transport_mode_max) {
                 bytes = NULL;
             }
@@ -170,6 +190,16 @@ const uint8_t* quicrq_rq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_m
                         bytes = picoquic_frames_varint_decode(bytes, bytes_max, start_object_id);
                     }
                 }
+                else if (*intent_mode == quicrq_subscribe_intent_start_time) {
+                    bytes = picoquic_frames_varint_decode(bytes, bytes_max, start_time);
+                }
+                else if (*intent_mode == quicrq_subscribe_intent_fetch_range) {
+                    if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, start_group_id)) != NULL &&
+                        (bytes = picoquic_frames_varint_decode(bytes, bytes_max, start_object_id)) != NULL &&
+                        (bytes = picoquic_frames_varint_decode(bytes, bytes_max, end_group_id)) != NULL) {
+                        bytes = picoquic_frames_varint_decode(bytes, bytes_max, end_object_id);
+                    }
+                }
             }
         }
     }
@@ -224,15 +254,21 @@ const uint8_t* quicrq_fin_msg_decode(const uint8_t* bytes, const uint8_t* bytes_
  *     object_length(i),
  *     flags (8),
  *     [nb_objects_previous_group(i)],
+ *     [origin_timestamp(i)],
  *     fragment_length(i),
  *     data(...)
  * }
  * 
+ * The origin timestamp is only present in the first fragment of an object, i.e., if
+ * the fragment offset is zero. It is set to zero if the origin did not provide a
+ * capture time for the object.
+ * 
  * Calling the encoding function with the "data" parameter set to NULL results in the encoding
  * of the fragment message header, minus the data.
  */
 
-size_t quicrq_fragment_msg_reserve(uint64_t group_id, uint64_t object_id, uint64_t nb_objects_previous_group, uint64_t offset, uint64_t object_length, size_t data_length)
+size_t quicrq_fragment_msg_reserve(uint64_t group_id, uint64_t object_id, uint64_t nb_objects_previous_group,
+    uint64_t offset, uint64_t object_length, uint64_t origin_timestamp, size_t data_length)
 {
     size_t len = 1 +
         picoquic_frames_varint_encode_length(group_id) +
@@ -243,6 +279,9 @@ size_t quicrq_fragment_msg_reserve(uint64_t group_id, uint64_t object_id, uint64
     if (object_id == 0 && offset == 0) {
         len += picoquic_frames_varint_encode_length(nb_objects_previous_group);
     }
+    if (offset == 0) {
+        len += picoquic_frames_varint_encode_length(origin_timestamp);
+    }
     len += picoquic_frames_varint_encode_length(data_length);
 
     return len;
@@ -250,7 +289,7 @@ size_t quicrq_fragment_msg_reserve(uint64_t group_id, uint64_t object_id, uint64
 
 uint8_t* quicrq_fragment_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type,
     uint64_t group_id, uint64_t object_id, uint64_t nb_objects_previous_group,
-    uint64_t offset, uint64_t object_length, uint8_t flags, size_t length, const uint8_t * data)
+    uint64_t offset, uint64_t object_length, uint64_t origin_timestamp, uint8_t flags, size_t length, const uint8_t * data)
 {
     if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, message_type)) != NULL &&
         (bytes = picoquic_frames_varint_encode(bytes, bytes_max, group_id)) != NULL &&
@@ -261,6 +300,9 @@ uint8_t* quicrq_fragment_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t
         if (object_id == 0 && offset == 0) {
             bytes = picoquic_frames_varint_encode(bytes, bytes_max, nb_objects_previous_group);
         }
+        if (bytes != NULL && offset == 0) {
+            bytes = picoquic_frames_varint_encode(bytes, bytes_max, origin_timestamp);
+        }
         if (bytes != NULL) {
             if (data != NULL) {
                 bytes = picoquic_frames_length_data_encode(bytes, bytes_max, length, data);
@@ -275,13 +317,14 @@ uint8_t* quicrq_fragment_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t
 
 const uint8_t* quicrq_fragment_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type,
     uint64_t * group_id, uint64_t * object_id, uint64_t* nb_objects_previous_group,
-    uint64_t* offset, uint64_t* object_length, uint8_t * flags, size_t * length, const uint8_t ** data)
+    uint64_t* offset, uint64_t* object_length, uint64_t* origin_timestamp, uint8_t * flags, size_t * length, const uint8_t ** data)
 {
     *group_id = 0;
     *object_id = 0;
     *nb_objects_previous_group = 0;
     *offset = 0;
     *object_length = 0;
+    *origin_timestamp = 0;
     *length = 0;
     *data = NULL;
     if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, message_type)) != NULL &&
@@ -293,6 +336,9 @@ const uint8_t* quicrq_fragment_msg_decode(const uint8_t* bytes, const uint8_t* b
         if (*object_id == 0 && *offset == 0) {
             bytes = picoquic_frames_varint_decode(bytes, bytes_max, nb_objects_previous_group);
         }
+        if (bytes != NULL && *offset == 0) {
+            bytes = picoquic_frames_varint_decode(bytes, bytes_max, origin_timestamp);
+        }
         if (bytes != NULL &&
             (bytes = picoquic_frames_varlen_decode(bytes, bytes_max, length)) != NULL) {
             *data = bytes;
@@ -521,22 +567,25 @@ const uint8_t* quicrq_warp_header_msg_decode(const uint8_t* bytes, const uint8_t
  *     object_id(i),
  *     [nb_objects_previous_group(i),]
  *     flags[8],
- *     object_length(i)
+ *     object_length(i),
+ *     origin_timestamp(i)
  * }
  * 
  * The nb_objects_previous_group is only set if the object_id is zero.
+ * The origin_timestamp is zero if the origin did not provide a capture time.
  */
 
-size_t quicrq_object_header_msg_reserve(uint64_t object_id, uint64_t nb_objects_previous_group, size_t object_length)
+size_t quicrq_object_header_msg_reserve(uint64_t object_id, uint64_t nb_objects_previous_group, size_t object_length, uint64_t origin_timestamp)
 {
     size_t len = 1 + picoquic_frames_varint_encode_length(object_id) +
         ((object_id == 0) ? picoquic_frames_varint_encode_length(nb_objects_previous_group) : 0)
-        + 1 + picoquic_frames_varint_encode_length(object_length);
+        + 1 + picoquic_frames_varint_encode_length(object_length)
+        + picoquic_frames_varint_encode_length(origin_timestamp);
     return len;
 }
 
 uint8_t* quicrq_object_header_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, uint64_t object_id,
-    uint64_t nb_objects_previous_group, uint8_t flags, size_t object_length)
+    uint64_t nb_objects_previous_group, uint8_t flags, size_t object_length, uint64_t origin_timestamp)
 {
     if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, message_type)) != NULL &&
         (bytes = picoquic_frames_varint_encode(bytes, bytes_max, object_id)) != NULL) {
@@ -546,7 +595,9 @@ uint8_t* quicrq_object_header_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uin
         if (bytes != NULL) {
             if (bytes < bytes_max) {
                 *bytes++ = flags;
-                bytes = picoquic_frames_varint_encode(bytes, bytes_max, object_length);
+                if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, object_length)) != NULL) {
+                    bytes = picoquic_frames_varint_encode(bytes, bytes_max, origin_timestamp);
+                }
             }
             else {
                 bytes = NULL;
@@ -557,12 +608,13 @@ uint8_t* quicrq_object_header_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uin
 }
 
 const uint8_t* quicrq_object_header_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type,
-    uint64_t *object_id, uint64_t *nb_objects_previous_group, uint8_t* flags, size_t *object_length)
+    uint64_t *object_id, uint64_t *nb_objects_previous_group, uint8_t* flags, size_t *object_length, uint64_t* origin_timestamp)
 {
     *object_id = 0;
     *nb_objects_previous_group = 0;
     *flags = 0;
     *object_length = 0;
+    *origin_timestamp = 0;
     if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, message_type)) != NULL &&
         (bytes = picoquic_frames_varint_decode(bytes, bytes_max, object_id)) != NULL){
         if (*object_id == 0) {
@@ -571,7 +623,9 @@ const uint8_t* quicrq_object_header_msg_decode(const uint8_t* bytes, const uint8
         if (bytes != NULL) {
             if (bytes < bytes_max) {
                 *flags = *bytes++;
-                bytes = picoquic_frames_varlen_decode(bytes, bytes_max, object_length);
+                if ((bytes = picoquic_frames_varlen_decode(bytes, bytes_max, object_length)) != NULL) {
+                    bytes = picoquic_frames_varint_decode(bytes, bytes_max, origin_timestamp);
+                }
             }
             else {
                 bytes = NULL;
@@ -593,7 +647,8 @@ const uint8_t* quicrq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max,
         switch (msg->message_type) {
         case QUICRQ_ACTION_REQUEST:
             bytes = quicrq_rq_msg_decode(bytes, bytes_max, &msg->message_type, &msg->url_length, &msg->url,
-                &msg->media_id, &msg->transport_mode, &msg->subscribe_intent, &msg->group_id, &msg->object_id);
+                &msg->media_id, &msg->transport_mode, &msg->subscribe_intent, &msg->group_id, &msg->object_id, &msg->start_time,
+                &msg->end_group_id, &msg->end_object_id);
             break;
         case QUICRQ_ACTION_FIN_DATAGRAM:
             bytes = quicrq_fin_msg_decode(bytes, bytes_max, &msg->message_type, &msg->group_id, &msg->object_id);
@@ -601,7 +656,7 @@ const uint8_t* quicrq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max,
         case QUICRQ_ACTION_FRAGMENT:
             bytes = quicrq_fragment_msg_decode(bytes, bytes_max, &msg->message_type,
                 &msg->group_id, &msg->object_id, &msg->nb_objects_previous_group,
-                &msg->fragment_offset, &msg->object_length, &msg->flags, &msg->fragment_length, &msg->data);
+                &msg->fragment_offset, &msg->object_length, &msg->origin_timestamp, &msg->flags, &msg->fragment_length, &msg->data);
             break;
         case QUICRQ_ACTION_POST:
             bytes = quicrq_post_msg_decode(bytes, bytes_max, &msg->message_type, &msg->url_length, &msg->url,
@@ -627,7 +682,7 @@ const uint8_t* quicrq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max,
             break;
         case QUICRQ_ACTION_OBJECT_HEADER:
             bytes = quicrq_object_header_msg_decode(bytes, bytes_max, &msg->message_type, &msg->object_id,
-                &msg->nb_objects_previous_group, &msg->flags, &msg->object_length);
+                &msg->nb_objects_previous_group, &msg->flags, &msg->object_length, &msg->origin_timestamp);
             break;
         default:
             /* Unexpected message type */
@@ -644,7 +699,8 @@ uint8_t* quicrq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, quicrq_message_t*
     switch (msg->message_type) {
     case QUICRQ_ACTION_REQUEST:
         bytes = quicrq_rq_msg_encode(bytes, bytes_max, msg->message_type, msg->url_length, msg->url,
-            msg->media_id, msg->transport_mode, msg->subscribe_intent, msg->group_id, msg->object_id);
+            msg->media_id, msg->transport_mode, msg->subscribe_intent, msg->group_id, msg->object_id, msg->start_time,
+            msg->end_group_id, msg->end_object_id);
         break;
     case QUICRQ_ACTION_FIN_DATAGRAM:
         bytes = quicrq_fin_msg_encode(bytes, bytes_max, msg->message_type, msg->group_id, msg->object_id);
@@ -652,7 +708,7 @@ uint8_t* quicrq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, quicrq_message_t*
     case QUICRQ_ACTION_FRAGMENT:
         bytes = quicrq_fragment_msg_encode(bytes, bytes_max,
             msg->message_type, msg->group_id, msg->object_id, msg->nb_objects_previous_group,
-            msg->fragment_offset, msg->object_length, msg->flags, msg->fragment_length, msg->data);
+            msg->fragment_offset, msg->object_length, msg->origin_timestamp, msg->flags, msg->fragment_length, msg->data);
         break;
     case QUICRQ_ACTION_POST:
         bytes = quicrq_post_msg_encode(bytes, bytes_max, msg->message_type, msg->url_length, msg->url,
@@ -678,7 +734,7 @@ uint8_t* quicrq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, quicrq_message_t*
         break;
     case QUICRQ_ACTION_OBJECT_HEADER:
         bytes = quicrq_object_header_msg_encode(bytes, bytes_max, msg->message_type, msg->object_id,
-            msg->nb_objects_previous_group, msg->flags, msg->object_length);
+            msg->nb_objects_previous_group, msg->flags, msg->object_length, msg->origin_timestamp);
         break;
     default:
         /* Unexpected message type */
@@ -699,13 +755,27 @@ uint8_t* quicrq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, quicrq_message_t*
  *     queue_delay (i)
  *     flags (8)
  *     [nb_objects_previous_group (i)]
+ *     [origin_timestamp (i)]
+ * }
+ * 
+ * As in the fragment message, the origin timestamp is only present if the offset is zero.
+ * The media ID is encoded as an even number, because the odd value 1 marks a bundle.
+ * A bundle carries several fragments, possibly of different media, in one datagram:
+ * 
+ * quicrq_datagram_bundle {
+ *     bundle_marker (i) = 1
+ *     1* {
+ *         segment_length (i)
+ *         datagram header
+ *         data
+ *     }
  * }
  */
 uint8_t* quicrq_datagram_header_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t media_id, uint64_t group_id,
     uint64_t object_id, uint64_t object_offset, uint64_t queue_delay, uint8_t flags,
-    uint64_t nb_objects_previous_group, uint64_t object_length)
+    uint64_t nb_objects_previous_group, uint64_t object_length, uint64_t origin_timestamp)
 {
-    if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, media_id)) != NULL &&
+    if ((bytes = picoquic_frames_varint_encode(bytes, bytes_max, media_id << 1)) != NULL &&
         (bytes = picoquic_frames_varint_encode(bytes, bytes_max, group_id)) != NULL &&
         (bytes = picoquic_frames_varint_encode(bytes, bytes_max, object_id)) != NULL &&
         (bytes = picoquic_frames_varint_encode(bytes, bytes_max, object_offset)) != NULL &&
@@ -716,6 +786,9 @@ uint8_t* quicrq_datagram_header_encode(uint8_t* bytes, uint8_t* bytes_max, uint6
             if (object_id == 0 && object_offset == 0) {
                 bytes = picoquic_frames_varint_encode(bytes, bytes_max, nb_objects_previous_group);
             }
+            if (bytes != NULL && object_offset == 0) {
+                bytes = picoquic_frames_varint_encode(bytes, bytes_max, origin_timestamp);
+            }
         }
         else {
             bytes = NULL;
@@ -725,9 +798,17 @@ uint8_t* quicrq_datagram_header_encode(uint8_t* bytes, uint8_t* bytes_max, uint6
 }
 
 const uint8_t* quicrq_datagram_header_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* media_id, uint64_t* group_id,
-    uint64_t* object_id, uint64_t* object_offset, uint64_t* queue_delay, uint8_t* flags, uint64_t* nb_objects_previous_group, uint64_t* object_length)
+    uint64_t* object_id, uint64_t* object_offset, uint64_t* queue_delay, uint8_t* flags, uint64_t* nb_objects_previous_group,
+    uint64_t* object_length, uint64_t* origin_timestamp)
 {
-    if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, media_id)) != NULL &&
+    if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, media_id)) != NULL) {
+        if ((*media_id & 1) != 0) {
+            /* Bundle marker, or not a valid media ID */
+            bytes = NULL;
+        }
+        *media_id >>= 1;
+    }
+    if (bytes != NULL &&
         (bytes = picoquic_frames_varint_decode(bytes, bytes_max, group_id)) != NULL &&
         (bytes = picoquic_frames_varint_decode(bytes, bytes_max, object_id)) != NULL &&
         (bytes = picoquic_frames_varint_decode(bytes, bytes_max, object_offset)) != NULL &&
@@ -740,6 +821,32 @@ const uint8_t* quicrq_datagram_header_decode(const uint8_t* bytes, const uint8_t
         else {
             *nb_objects_previous_group = 0;
         }
+        if (bytes != NULL && *object_offset == 0) {
+            bytes = picoquic_frames_varint_decode(bytes, bytes_max, origin_timestamp);
+        }
+        else {
+            *origin_timestamp = 0;
+        }
+    }
+    return bytes;
+}
+
+int quicrq_datagram_is_bundle(const uint8_t* bytes, size_t length)
+{
+    return (length > 0 && bytes[0] == QUICRQ_DATAGRAM_BUNDLE_MARKER);
+}
+
+const uint8_t* quicrq_datagram_bundle_segment_decode(const uint8_t* bytes, const uint8_t* bytes_max, size_t* segment_length)
+{
+    uint64_t length = 0;
+
+    if ((bytes = picoquic_frames_varint_decode(bytes, bytes_max, &length)) != NULL) {
+        if (length == 0 || length > (uint64_t)(bytes_max - bytes)) {
+            bytes = NULL;
+        }
+        else {
+            *segment_length = (size_t)length;
+        }
     }
     return bytes;
 }
@@ -978,21 +1085,100 @@ static void quicrq_set_rush_stream_priority(quicrq_uni_stream_ctx_t* uni_stream_
     }
 }
 
+/* Rush packing.
+ * If packing is enabled, consecutive small objects are appended to the same uni stream,
+ * instead of opening one stream per object. The next object of the same group is added
+ * by incrementing the "last object" of the stream. The first object of the next group
+ * can also be added if the stream has finished sending the previous objects: the stream
+ * state is reset to "open", so a new warp header is sent before the object header.
+ */
+static int quicrq_rush_pack_object_is_small(quicrq_stream_ctx_t* stream_ctx, uint64_t group_id, uint64_t object_id, size_t * object_length)
+{
+    uint64_t nb_objects_previous_group = 0;
+    uint8_t flags = 0;
+
+    return (quicrq_fragment_get_object_properties(stream_ctx->media_ctx->cache_ctx, group_id, object_id,
+        object_length, &nb_objects_previous_group, &flags) == 0 &&
+        *object_length <= stream_ctx->cnx_ctx->qr_ctx->rush_pack_object_max);
+}
+
+static void quicrq_rush_pack_close(quicrq_stream_ctx_t* stream_ctx)
+{
+    quicrq_uni_stream_ctx_t* uni_stream_ctx = stream_ctx->rush_pack_uni_stream;
+
+    if (uni_stream_ctx != NULL) {
+        uni_stream_ctx->is_rush_pack_open = 0;
+        uni_stream_ctx->is_waiting_for_data = 0;
+        stream_ctx->rush_pack_uni_stream = NULL;
+        /* Wake up the stream so the FIN can be sent */
+        picoquic_mark_active_stream(stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, 1, uni_stream_ctx);
+    }
+}
+
+static void quicrq_rush_pack_open(quicrq_stream_ctx_t* stream_ctx, quicrq_uni_stream_ctx_t* uni_stream_ctx, uint64_t current_time)
+{
+    size_t object_length = 0;
+
+    if (stream_ctx->cnx_ctx->qr_ctx->rush_pack_object_max > 0 &&
+        quicrq_rush_pack_object_is_small(stream_ctx, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id, &object_length)) {
+        uni_stream_ctx->is_rush_pack_open = 1;
+        uni_stream_ctx->rush_pack_start_time = current_time;
+        uni_stream_ctx->rush_pack_bytes = object_length;
+        stream_ctx->rush_pack_uni_stream = uni_stream_ctx;
+    }
+}
+
+static int quicrq_rush_pack_append(quicrq_stream_ctx_t* stream_ctx, uint64_t group_id, uint64_t object_id, uint64_t current_time)
+{
+    int is_appended = 0;
+    quicrq_ctx_t* qr_ctx = stream_ctx->cnx_ctx->qr_ctx;
+    quicrq_uni_stream_ctx_t* uni_stream_ctx = stream_ctx->rush_pack_uni_stream;
+    size_t object_length = 0;
+
+    if (current_time < uni_stream_ctx->rush_pack_start_time + qr_ctx->rush_pack_delay &&
+        quicrq_rush_pack_object_is_small(stream_ctx, group_id, object_id, &object_length) &&
+        uni_stream_ctx->rush_pack_bytes + object_length <= qr_ctx->rush_pack_stream_max) {
+        if (group_id == uni_stream_ctx->current_group_id && object_id == uni_stream_ctx->last_object_id) {
+            uni_stream_ctx->last_object_id++;
+            is_appended = 1;
+        }
+        else if (group_id == uni_stream_ctx->current_group_id + 1 && object_id == 0 &&
+            uni_stream_ctx->send_state == quicrq_sending_warp_header_sent &&
+            uni_stream_ctx->current_object_id >= uni_stream_ctx->last_object_id &&
+            uni_stream_ctx->message_buffer.message_size == 0) {
+            uni_stream_ctx->current_group_id = group_id;
+            uni_stream_ctx->current_object_id = 0;
+            uni_stream_ctx->last_object_id = 1;
+            uni_stream_ctx->send_state = quicrq_sending_open;
+            is_appended = 1;
+        }
+        if (is_appended) {
+            uni_stream_ctx->rush_pack_bytes += object_length;
+            uni_stream_ctx->is_waiting_for_data = 0;
+            picoquic_mark_active_stream(stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, 1, uni_stream_ctx);
+        }
+    }
+    return is_appended;
+}
+
 void quicrq_wakeup_media_rush_stream(quicrq_stream_ctx_t* stream_ctx)
 {
     uint64_t highest_group_id = stream_ctx->media_ctx->cache_ctx->highest_group_id;
     uint64_t highest_object_id = stream_ctx->media_ctx->cache_ctx->highest_object_id;
     uint64_t old_highest_group_id = stream_ctx->next_warp_group_id;
+    uint64_t current_time = picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic);
     int stop_creating = 0;
 
-    /* loop through all the unistreams, since more than one can be active */
+    /* loop through all the unistreams, since more than one can be active.
+     * The contexts of finished streams are deleted, so the list only contains streams in progress.
+     * Streams that are still active do not need a wake up, only those that were waiting for data. */
     quicrq_uni_stream_ctx_t* uni_stream_ctx = stream_ctx->first_uni_stream;
     while (uni_stream_ctx != NULL) {
-        if (uni_stream_ctx->send_state != quicrq_sending_warp_should_close) {
-            /* TODO: the used contexts should be removed, so the test above will not be needed. */
-            /* TODO: maybe document object properties */
-            /* TODO: if object unknown, priorities should be set when it becomes known. */
-            quicrq_set_rush_stream_priority(uni_stream_ctx);
+        /* TODO: maybe document object properties */
+        /* TODO: if object unknown, priorities should be set when it becomes known. */
+        quicrq_set_rush_stream_priority(uni_stream_ctx);
+        if (uni_stream_ctx->is_waiting_for_data) {
+            uni_stream_ctx->is_waiting_for_data = 0;
             picoquic_mark_active_stream(uni_stream_ctx->control_stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, 1, uni_stream_ctx);
         }
         /* todo, for rush: if header sent, only wake up if object is fully received. */
@@ -1024,8 +1210,16 @@ void quicrq_wakeup_media_rush_stream(quicrq_stream_ctx_t* stream_ctx)
             }
         }
         for (uint64_t j = next_object_in_group; j < last_object_in_group; j++) {
-            uint64_t uni_stream_id = picoquic_get_next_local_stream_id(stream_ctx->cnx_ctx->cnx, 1);
-            quicrq_uni_stream_ctx_t* uni_stream_ctx = quicrq_find_or_create_uni_stream(
+            uint64_t uni_stream_id;
+            if (stream_ctx->rush_pack_uni_stream != NULL) {
+                if (quicrq_rush_pack_append(stream_ctx, i, j, current_time)) {
+                    stream_ctx->next_rush_object_id = j + 1;
+                    continue;
+                }
+                quicrq_rush_pack_close(stream_ctx);
+            }
+            uni_stream_id = picoquic_get_next_local_stream_id(stream_ctx->cnx_ctx->cnx, 1);
+            uni_stream_ctx = quicrq_find_or_create_uni_stream(
                 uni_stream_id, stream_ctx->cnx_ctx, stream_ctx, 1);
             if (uni_stream_ctx != NULL) {
                 uni_stream_ctx->current_group_id = i;
@@ -1039,6 +1233,7 @@ void quicrq_wakeup_media_rush_stream(quicrq_stream_ctx_t* stream_ctx)
                 if (stream_ctx->lowest_flags != 0) {
                     quicrq_set_rush_stream_priority(uni_stream_ctx);
                 }
+                quicrq_rush_pack_open(stream_ctx, uni_stream_ctx, current_time);
                 picoquic_mark_active_stream(uni_stream_ctx->control_stream_ctx->cnx_ctx->cnx,
                     uni_stream_ctx->stream_id, 1, uni_stream_ctx);
             }
@@ -1048,20 +1243,97 @@ void quicrq_wakeup_media_rush_stream(quicrq_stream_ctx_t* stream_ctx)
             }
         }
     }
+    /* No more objects will be appended after the final object: close the pack. */
+    if (stream_ctx->rush_pack_uni_stream != NULL &&
+        (stream_ctx->media_ctx->cache_ctx->final_group_id != 0 ||
+            stream_ctx->media_ctx->cache_ctx->final_object_id != 0)) {
+        quicrq_rush_pack_close(stream_ctx);
+    }
+}
+
+/* Flags assumed for the priority of warp streams if the latest first policy is
+ * enabled but the flags of the media are not known */
+#define QUICRQ_WARP_LATEST_FIRST_DEFAULT_FLAGS 4
+
+/* Abandon the warp groups before the specified start group. The streams of the
+ * abandoned groups are reset, the groups not yet opened are skipped, and the start
+ * point is updated so the receiver does not wait for the missing objects.
+ */
+void quicrq_warp_abandon_groups(quicrq_stream_ctx_t* stream_ctx, uint64_t start_group_id)
+{
+    int is_abandoned = 0;
+    quicrq_uni_stream_ctx_t* uni_stream_ctx = stream_ctx->first_uni_stream;
+
+    while (uni_stream_ctx != NULL) {
+        quicrq_uni_stream_ctx_t* next_uni_stream_ctx = uni_stream_ctx->next_uni_stream_for_control_stream;
+        if (uni_stream_ctx->current_group_id < start_group_id) {
+            quicrq_log_message(stream_ctx->cnx_ctx, "Stream %" PRIu64 ", abandon group %" PRIu64 " on uni stream %" PRIu64,
+                stream_ctx->stream_id, uni_stream_ctx->current_group_id, uni_stream_ctx->stream_id);
+            /* Deleting the context resets the stream if the group is not fully sent */
+            quicrq_delete_uni_stream_ctx(stream_ctx->cnx_ctx, uni_stream_ctx);
+            stream_ctx->nb_groups_abandoned++;
+            is_abandoned = 1;
+        }
+        uni_stream_ctx = next_uni_stream_ctx;
+    }
+    if (stream_ctx->next_warp_group_id < start_group_id) {
+        /* Only count the groups after the previous start point, that the receiver was waiting for */
+        uint64_t first_skipped = (stream_ctx->next_warp_group_id > stream_ctx->start_group_id) ?
+            stream_ctx->next_warp_group_id : stream_ctx->start_group_id;
+        if (start_group_id > first_skipped) {
+            stream_ctx->nb_groups_abandoned += start_group_id - first_skipped;
+        }
+        stream_ctx->next_warp_group_id = start_group_id;
+        is_abandoned = 1;
+    }
+    if (is_abandoned && (start_group_id > stream_ctx->start_group_id ||
+        (start_group_id == stream_ctx->start_group_id && stream_ctx->start_object_id > 0))) {
+        stream_ctx->start_group_id = start_group_id;
+        stream_ctx->start_object_id = 0;
+        stream_ctx->is_start_object_id_sent = 0;
+        if (stream_ctx->cnx_ctx->cnx != NULL) {
+            picoquic_mark_active_stream(stream_ctx->cnx_ctx->cnx, stream_ctx->stream_id, 1, stream_ctx);
+        }
+    }
 }
 
+/* Waking up warp streams.
+ * One uni stream is created per group, for all the groups from next_warp_group_id
+ * to the highest group in the cache.
+ * If the latest first policy is enabled and the sender lags behind, the latest
+ * group gets strict precedence over the older ones, and the groups older than the
+ * horizon are abandoned. The policy only applies to real time media, and not to
+ * subscribers that asked to start in the past: these groups were explicitly requested.
+ */
 void quicrq_wakeup_media_uni_stream(quicrq_stream_ctx_t* stream_ctx)
 {
+    quicrq_ctx_t* qr_ctx = stream_ctx->cnx_ctx->qr_ctx;
     uint64_t highest_group_id = stream_ctx->media_ctx->cache_ctx->highest_group_id;
     int uni_created = 0;
+    int is_latest_first = 0;
+    quicrq_uni_stream_ctx_t* uni_stream_ctx = NULL;
 
-    /* loop through all the unistreams, since more than one can be active */
-    quicrq_uni_stream_ctx_t* uni_stream_ctx = stream_ctx->first_uni_stream;
-    while (uni_stream_ctx != NULL) {
-        if (uni_stream_ctx->send_state != quicrq_sending_warp_should_close) {
-            /* TODO: the used contexts should be removed, so the test above will not be needed. */
-            picoquic_mark_active_stream(uni_stream_ctx->control_stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, 1, uni_stream_ctx);
+    if (qr_ctx->warp_latest_first_lag > 0 && stream_ctx->is_cache_real_time && !stream_ctx->is_start_in_past) {
+        uint64_t oldest_group_id = stream_ctx->next_warp_group_id;
+
+        if (qr_ctx->warp_abandon_horizon > 0 && highest_group_id > qr_ctx->warp_abandon_horizon) {
+            quicrq_warp_abandon_groups(stream_ctx, highest_group_id - qr_ctx->warp_abandon_horizon);
         }
+        uni_stream_ctx = stream_ctx->first_uni_stream;
+        while (uni_stream_ctx != NULL) {
+            if (uni_stream_ctx->current_group_id < oldest_group_id) {
+                oldest_group_id = uni_stream_ctx->current_group_id;
+            }
+            uni_stream_ctx = uni_stream_ctx->next_uni_stream_for_control_stream;
+        }
+        is_latest_first = (highest_group_id >= oldest_group_id + qr_ctx->warp_latest_first_lag);
+    }
+
+    /* loop through all the unistreams, since more than one can be active.
+     * The contexts of finished streams are deleted, so the list only contains streams in progress. */
+    uni_stream_ctx = stream_ctx->first_uni_stream;
+    while (uni_stream_ctx != NULL) {
+        picoquic_mark_active_stream(uni_stream_ctx->control_stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, 1, uni_stream_ctx);
         uni_stream_ctx = uni_stream_ctx->next_uni_stream_for_control_stream;
     }
 
@@ -1087,31 +1359,37 @@ void quicrq_wakeup_media_uni_stream(quicrq_stream_ctx_t* stream_ctx)
      * Exception:
      * - if the congestion control is not set to "group", don't reset previous streams.
      * - if the stream priority is set to 0x80 (e.g., audio), don't reset the previous streams.
+     * If the latest first policy is enabled, the priorities are managed even if the flags
+     * are not known yet, using default flags. If the policy applies, the previous streams
+     * are always set 3 down, i.e., in a lower priority class served in FIFO order, so the
+     * oldest group completes first.
      */
     if (uni_created && stream_ctx->lowest_flags == 0) {
         quicrq_set_control_stream_priority(stream_ctx);
     }
-    if (uni_created && stream_ctx->lowest_flags != 0) {
-        uint8_t uni_stream_priority = quicrq_flags_to_picoquic_stream_priority(stream_ctx->lowest_flags, 0);
+    if (uni_created && (stream_ctx->lowest_flags != 0 || qr_ctx->warp_latest_first_lag > 0)) {
+        uint8_t uni_stream_priority = quicrq_flags_to_picoquic_stream_priority(
+            (stream_ctx->lowest_flags != 0) ? stream_ctx->lowest_flags : QUICRQ_WARP_LATEST_FIRST_DEFAULT_FLAGS, 0);
         uni_stream_ctx = stream_ctx->first_uni_stream;
 
         while (uni_stream_ctx != NULL) {
-            if (uni_stream_ctx->send_state != quicrq_sending_warp_should_close) {
-                if (uni_stream_ctx->current_group_id == highest_group_id) {
-                    (void)picoquic_set_stream_priority(stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, uni_stream_priority);
-                    uni_stream_ctx->stream_priority = uni_stream_priority;
+            if (uni_stream_ctx->current_group_id == highest_group_id) {
+                (void)picoquic_set_stream_priority(stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, uni_stream_priority);
+                uni_stream_ctx->stream_priority = uni_stream_priority;
+            }
+            else
+            {
+                uint8_t lower_uni_stream_priority = uni_stream_priority;
+                if (is_latest_first) {
+                    lower_uni_stream_priority = (uni_stream_priority < 0xfd) ? uni_stream_priority + 3 : 0xff;
                 }
-                else
-                {
-                    uint8_t lower_uni_stream_priority = uni_stream_priority;
-                    if (stream_ctx->media_ctx != NULL && stream_ctx->media_ctx->congestion_control_mode == quicrq_congestion_control_group_p &&
-                        stream_ctx->lowest_flags != 0x80 && lower_uni_stream_priority < 0xfe) {
-                        lower_uni_stream_priority += 2;
-                    }
-                    if (uni_stream_ctx->stream_priority != lower_uni_stream_priority) {
-                        (void)picoquic_set_stream_priority(stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, lower_uni_stream_priority);
-                        uni_stream_ctx->stream_priority = lower_uni_stream_priority;
-                    }
+                else if (stream_ctx->media_ctx != NULL && stream_ctx->media_ctx->congestion_control_mode == quicrq_congestion_control_group_p &&
+                    stream_ctx->lowest_flags != 0x80 && lower_uni_stream_priority < 0xfe) {
+                    lower_uni_stream_priority += 2;
+                }
+                if (uni_stream_ctx->stream_priority != lower_uni_stream_priority) {
+                    (void)picoquic_set_stream_priority(stream_ctx->cnx_ctx->cnx, uni_stream_ctx->stream_id, lower_uni_stream_priority);
+                    uni_stream_ctx->stream_priority = lower_uni_stream_priority;
                 }
             }
             uni_stream_ctx = uni_stream_ctx->next_uni_stream_for_control_stream;
@@ -1183,15 +1461,48 @@ void quicrq_wakeup_media_stream(quicrq_stream_ctx_t* stream_ctx)
 
 /* When data is available for a source, wake up the corresponding connection 
  * and possibly stream.
+ * The connections are served in the order in which they are woken up. If the
+ * list of streams was always walked from the start, the first subscribers would
+ * consistently get each object first, and the last ones consistently last. To
+ * spread the latency evenly, the first stream woken up rotates each time a new
+ * object is added to the cache.
  * TODO: for datagram, we may want to manage a queue of media for which data is ready.
  */
 void quicrq_source_wakeup(quicrq_media_source_ctx_t* srce_ctx)
 {
     quicrq_stream_ctx_t* stream_ctx = srce_ctx->first_stream;
+    quicrq_stream_ctx_t* first_woken = stream_ctx;
+    quicrq_fragment_cache_t* cache_ctx = srce_ctx->cache_ctx;
+
+    if (cache_ctx != NULL && stream_ctx != NULL && stream_ctx->next_stream_for_source != NULL &&
+        !cache_ctx->qr_ctx->is_wakeup_rotation_disabled) {
+        uint64_t nb_streams = 0;
+
+        if (cache_ctx->highest_group_id != srce_ctx->wakeup_group_id ||
+            cache_ctx->highest_object_id != srce_ctx->wakeup_object_id) {
+            srce_ctx->wakeup_group_id = cache_ctx->highest_group_id;
+            srce_ctx->wakeup_object_id = cache_ctx->highest_object_id;
+            srce_ctx->wakeup_rotation++;
+        }
+        while (stream_ctx != NULL) {
+            nb_streams++;
+            stream_ctx = stream_ctx->next_stream_for_source;
+        }
+        for (uint64_t i = 0; i < srce_ctx->wakeup_rotation % nb_streams; i++) {
+            first_woken = first_woken->next_stream_for_source;
+        }
+    }
+    /* Wake up from the first stream in rotation to the end of the list, then from the start of the list */
+    stream_ctx = first_woken;
     while (stream_ctx != NULL) {
         quicrq_wakeup_media_stream(stream_ctx);
         stream_ctx = stream_ctx->next_stream_for_source;
     }
+    stream_ctx = srce_ctx->first_stream;
+    while (stream_ctx != first_woken) {
+        quicrq_wakeup_media_stream(stream_ctx);
+        stream_ctx = stream_ctx->next_stream_for_source;
+    }
 }
 
 /* Request media in connection.
@@ -1206,7 +1517,7 @@ int quicrq_cnx_subscribe_media_ex(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* url,
     uint64_t stream_id = picoquic_get_next_local_stream_id(cnx_ctx->cnx, 0);
     quicrq_stream_ctx_t* stream_ctx = quicrq_create_stream_context(cnx_ctx, stream_id);
     quicrq_message_buffer_t* message = &stream_ctx->message_sent;
-    static const quicrq_subscribe_intent_t default_intent = { quicrq_subscribe_intent_start_point, 0, 0 };
+    static const quicrq_subscribe_intent_t default_intent = { quicrq_subscribe_intent_start_point, 0, 0, 0, 0, 0 };
 
     if (intent == NULL) {
         intent = &default_intent;
@@ -1224,7 +1535,8 @@ int quicrq_cnx_subscribe_media_ex(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* url,
             uint64_t media_id = stream_ctx->cnx_ctx->next_media_id;
             uint8_t* message_next = quicrq_rq_msg_encode(message->buffer, message->buffer + message->buffer_alloc,
                 QUICRQ_ACTION_REQUEST, url_length, url, media_id, transport_mode,
-                intent->intent_mode, intent->start_group_id, intent->start_object_id);
+                intent->intent_mode, intent->start_group_id, intent->start_object_id, intent->start_time,
+                intent->end_group_id, intent->end_object_id);
             if (message_next == NULL) {
                 ret = -1;
             } else {
@@ -1389,7 +1701,7 @@ int quicrq_cnx_accept_media(quicrq_stream_ctx_t * stream_ctx, const uint8_t* url
             /* Set the cache policy for the local media */
             if (ret == 0 && cache_policy != 0) {
                 ret = stream_ctx->consumer_fn(quicrq_media_real_time_cache, stream_ctx->media_ctx, picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic),
-                    NULL, 0, 0, 0, 0, 0, 0, 0, 0);
+                    NULL, 0, 0, 0, 0, 0, 0, 0, 0, 0);
             }
             /* Set the initial group and object id for the local media */
             if (start_group_id != 0 || start_object_id != 0) {
@@ -1399,7 +1711,7 @@ int quicrq_cnx_accept_media(quicrq_stream_ctx_t * stream_ctx, const uint8_t* url
                 stream_ctx->start_group_id = start_group_id;
                 stream_ctx->start_object_id = start_object_id;
                 ret = stream_ctx->consumer_fn(quicrq_media_start_point, stream_ctx->media_ctx, picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic),
-                    NULL, start_group_id, start_object_id, 0, 0, 0, 0, 0, 0);
+                    NULL, start_group_id, start_object_id, 0, 0, 0, 0, 0, 0, 0);
             }
         }
     }
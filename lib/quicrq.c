@@ -201,6 +201,8 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
     uint8_t flags = 0;
     size_t h_size;
     uint64_t nb_objects_previous_group = 0;
+    uint64_t origin_timestamp = 0;
+    uint64_t cache_time = 0;
     int ret = 0;
 
     /* TODO: maintain a priority threshold per connection. If a stream is congested,
@@ -209,10 +211,18 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
      */
 
     /* First, create a "mock" buffer based on the available space instead of the actual number of bytes.
-     * By design, we are encoding the fragment with the "data" parameter set to NULL. */
+     * By design, we are encoding the fragment with the "data" parameter set to NULL. The object
+     * length and origin timestamp are those of the current fragment if it is known. Otherwise,
+     * the prediction assumes the worst case, i.e., a new group, an unknown object length and a
+     * full size timestamp, so the actual header cannot be larger than predicted. */
+    quicrq_cached_fragment_t* current_fragment = stream_ctx->media_ctx->current_fragment;
+    int is_new_object = (stream_ctx->next_object_offset == 0);
+    int is_space_too_small = 0;
     uint8_t* h_byte = quicrq_fragment_msg_encode(stream_header + 2, stream_header + QUICRQ_STREAM_HEADER_MAX, QUICRQ_ACTION_FRAGMENT,
-        stream_ctx->next_group_id, stream_ctx->next_object_id, 0, stream_ctx->next_object_offset,
-        stream_ctx->next_object_offset + available, flags, space, NULL);
+        (is_new_object) ? stream_ctx->next_group_id + 1 : stream_ctx->next_group_id,
+        (is_new_object) ? 0 : stream_ctx->next_object_id, stream_ctx->next_object_id, stream_ctx->next_object_offset,
+        (current_fragment == NULL) ? QUICRQ_OBJECT_LENGTH_UNKNOWN : current_fragment->object_length,
+        (current_fragment == NULL) ? (UINT64_MAX >> 2) : current_fragment->origin_timestamp, flags, space, NULL);
 
     if (h_byte == NULL) {
         /* That should not happen, unless the stream_header size is way too small */
@@ -220,9 +230,9 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
     }
     else {
         h_size = h_byte - stream_header;
-        if (h_size > space) {
-            /* That should not happen either, picoquic should never provide less than 17 bytes. */
-            ret = -1;
+        if (h_size >= space) {
+            /* Not enough space for the header and some data, wait for the next packet. */
+            is_space_too_small = 1;
         }
         else {
             /* Find how much data is actually available */
@@ -234,18 +244,29 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
                 stream_ctx->next_object_id = 0;
                 stream_ctx->next_object_offset = 0;
             }
+            if (stream_ctx->next_object_offset == 0 && stream_ctx->media_ctx->current_fragment != NULL) {
+                origin_timestamp = stream_ctx->media_ctx->current_fragment->origin_timestamp;
+                cache_time = stream_ctx->media_ctx->current_fragment->cache_time;
+            }
         }
     }
 
-    if (ret == 0) {
+    if (ret == 0 && !is_space_too_small) {
         if (should_skip) {
             /* Prepare and a place holder for the object, pretending 0 length, setting the flags to 0xFF
              * Call the publisher APi to signal that the object should be skipped. 
              */
             h_byte = quicrq_fragment_msg_encode(stream_header + 2, stream_header + QUICRQ_STREAM_HEADER_MAX, QUICRQ_ACTION_FRAGMENT,
-                stream_ctx->next_group_id, stream_ctx->next_object_id, nb_objects_previous_group, 0, 0, 0xFF, 0, NULL);
-            ret = quicrq_fragment_publisher_fn(quicrq_media_source_skip_object, stream_ctx->media_ctx, NULL, 0, &data_length,
-                &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &has_backlog, current_time);
+                stream_ctx->next_group_id, stream_ctx->next_object_id, nb_objects_previous_group, 0, 0, 0, 0xFF, 0, NULL);
+            if (h_byte == NULL) {
+                ret = -1;
+            }
+            else {
+                /* The place holder is shorter than the predicted header */
+                h_size = h_byte - stream_header;
+                ret = quicrq_fragment_publisher_fn(quicrq_media_source_skip_object, stream_ctx->media_ctx, NULL, 0, &data_length,
+                    &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &has_backlog, current_time);
+            }
             if (ret == 0) {
                 uint8_t* buffer = (uint8_t*)picoquic_provide_stream_data_buffer(context, h_size, 0, 1);
                 if (buffer == NULL) {
@@ -261,6 +282,7 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
 
                     stream_ctx->next_object_id++;
                     stream_ctx->next_object_offset = 0;
+                    stream_ctx->nb_objects_skipped++;
 
                     if (is_media_finished) {
                         stream_ctx->final_group_id = stream_ctx->next_group_id;
@@ -315,7 +337,7 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
             /* Encode the actual header, instead of a prediction */
             h_byte = quicrq_fragment_msg_encode(stream_header + 2, stream_header + QUICRQ_STREAM_HEADER_MAX, QUICRQ_ACTION_FRAGMENT,
                 stream_ctx->next_group_id, stream_ctx->next_object_id, nb_objects_previous_group, stream_ctx->next_object_offset,
-                object_length, flags, available, NULL);
+                object_length, origin_timestamp, flags, available, NULL);
 
             if (h_byte == NULL) {
                 /* That should not happen, unless the stream_header size was way too small */
@@ -323,12 +345,16 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
             } else if ((size_t)(h_byte - stream_header) != h_size) {
                 /* Encoding has changed. May need to change the length, and if that recompute the header */
                 h_size = h_byte - stream_header;
-                if (h_size + available > space) {
+                if (h_size >= space) {
+                    /* The prediction was wrong and there is no space left for data. That should not happen. */
+                    ret = -1;
+                }
+                else if (h_size + available > space) {
                     /* The encoding changed, the computation of available space was wrong. */
                     available = space - h_size;
                     h_byte = quicrq_fragment_msg_encode(stream_header + 2, stream_header + QUICRQ_STREAM_HEADER_MAX, QUICRQ_ACTION_FRAGMENT,
                         stream_ctx->next_group_id, stream_ctx->next_object_id, nb_objects_previous_group, stream_ctx->next_object_offset, 
-                        object_length, flags, available, NULL);
+                        object_length, origin_timestamp, flags, available, NULL);
                     /* The header size may have changed again, if the smaller "available" value is coded on fewer bytes. But it can only be decreased. */
                     h_size = h_byte - stream_header;
                 }
@@ -359,7 +385,12 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
                         buffer[0] = (uint8_t)(message_length >> 8);
                         buffer[1] = (uint8_t)(message_length & 0xff);
 
+                        if (stream_ctx->next_object_offset == 0 && available > 0) {
+                            quicrq_stream_first_byte_sent(stream_ctx, cache_time, current_time);
+                        }
                         stream_ctx->next_object_offset += available;
+                        stream_ctx->congestion.bytes_sent += available;
+                        stream_ctx->nb_bytes_sent += available;
                         if (stream_ctx->next_object_offset >= object_length) {
                             stream_ctx->next_object_id++;
                             stream_ctx->next_object_offset = 0;
@@ -379,6 +410,139 @@ int quicrq_prepare_to_send_media_to_stream(quicrq_stream_ctx_t* stream_ctx, void
     return ret;
 }
 
+/* Send a fetched range on a stream.
+ * The fetch is served without congestion based skipping. Instead of sending one
+ * fragment per call, as many fragments as fit are packed in the space provided by
+ * the transport, followed by the fin message once the end of the range is reached.
+ * The messages are assembled in a local buffer, because the size of the data
+ * buffer must be known before requesting it from the transport.
+ */
+int quicrq_prepare_to_send_fetch_to_stream(quicrq_stream_ctx_t* stream_ctx, void* context, size_t space, uint64_t current_time)
+{
+    uint8_t fetch_buffer[PICOQUIC_MAX_PACKET_SIZE];
+    size_t fetch_max = (space < sizeof(fetch_buffer)) ? space : sizeof(fetch_buffer);
+    size_t fetch_length = 0;
+    int is_fin = 0;
+    int ret = 0;
+
+    while (ret == 0 && !is_fin && fetch_length + 2 < fetch_max) {
+        uint8_t* message_start = fetch_buffer + fetch_length;
+        uint8_t* message_max = fetch_buffer + fetch_max;
+        uint8_t* h_byte = NULL;
+        int is_media_finished = 0;
+        int is_new_group = 0;
+        int is_still_active = 0;
+        int should_skip = 0;
+        size_t available = 0;
+        size_t data_length = 0;
+        size_t h_size = 0;
+        uint64_t object_length = 0;
+        uint64_t nb_objects_previous_group = 0;
+        uint64_t origin_timestamp = 0;
+        uint8_t flags = 0;
+
+        ret = quicrq_fragment_publisher_fn(quicrq_media_source_get_data, stream_ctx->media_ctx, NULL, message_max - message_start - 2,
+            &available, &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &should_skip, current_time);
+        if (ret != 0) {
+            break;
+        }
+        if (is_new_group) {
+            stream_ctx->next_group_id += 1;
+            stream_ctx->next_object_id = 0;
+            stream_ctx->next_object_offset = 0;
+        }
+        if (available == 0 && flags != 0xff) {
+            if (is_media_finished) {
+                /* End of the range, or end of the media, whichever comes first. */
+                h_byte = quicrq_fin_msg_encode(message_start + 2, message_max, QUICRQ_ACTION_FIN_DATAGRAM,
+                    stream_ctx->next_group_id, stream_ctx->next_object_id);
+                if (h_byte != NULL) {
+                    stream_ctx->final_group_id = stream_ctx->next_group_id;
+                    stream_ctx->final_object_id = stream_ctx->next_object_id;
+                    is_fin = 1;
+                }
+            }
+            /* Otherwise, wait until more data is available, or until there is space in the next packet */
+        }
+        else {
+            if (stream_ctx->next_object_id == 0 && stream_ctx->next_object_offset == 0 && stream_ctx->media_ctx->current_fragment != NULL) {
+                nb_objects_previous_group = stream_ctx->media_ctx->current_fragment->nb_objects_previous_group;
+            }
+            if (stream_ctx->next_object_offset == 0 && stream_ctx->media_ctx->current_fragment != NULL) {
+                origin_timestamp = stream_ctx->media_ctx->current_fragment->origin_timestamp;
+            }
+            h_size = 2 + quicrq_fragment_msg_reserve(stream_ctx->next_group_id, stream_ctx->next_object_id, nb_objects_previous_group,
+                stream_ctx->next_object_offset, object_length, origin_timestamp, available);
+            if (h_size + available > (size_t)(message_max - message_start)) {
+                if (h_size >= (size_t)(message_max - message_start)) {
+                    /* Not enough space left for this fragment, wait for the next packet */
+                    break;
+                }
+                /* The header can only become shorter if less data is sent */
+                available = (message_max - message_start) - h_size;
+            }
+            h_byte = quicrq_fragment_msg_encode(message_start + 2, message_max, QUICRQ_ACTION_FRAGMENT,
+                stream_ctx->next_group_id, stream_ctx->next_object_id, nb_objects_previous_group, stream_ctx->next_object_offset,
+                object_length, origin_timestamp, flags, available, NULL);
+            if (h_byte == NULL || h_byte + available > message_max) {
+                ret = -1;
+            }
+            else {
+                ret = quicrq_fragment_publisher_fn(quicrq_media_source_get_data, stream_ctx->media_ctx, h_byte, available, &data_length,
+                    &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &should_skip, current_time);
+                if (ret == 0 && available != data_length) {
+                    ret = -1;
+                }
+                else {
+                    h_byte += available;
+                    stream_ctx->next_object_offset += available;
+                    if (stream_ctx->next_object_offset >= object_length) {
+                        stream_ctx->next_object_id++;
+                        stream_ctx->next_object_offset = 0;
+                    }
+                }
+            }
+        }
+        if (h_byte == NULL) {
+            break;
+        }
+        else if (ret == 0) {
+            /* Set the message length */
+            size_t message_length = h_byte - message_start - 2;
+            message_start[0] = (uint8_t)(message_length >> 8);
+            message_start[1] = (uint8_t)(message_length & 0xff);
+            fetch_length += message_length + 2;
+        }
+    }
+    if (ret == 0) {
+        if (fetch_length == 0) {
+            /* Mark stream as not ready. It will be awakened when data becomes available */
+            picoquic_mark_active_stream(stream_ctx->cnx_ctx->cnx, stream_ctx->stream_id, 0, stream_ctx);
+        }
+        else {
+            uint8_t* buffer = (uint8_t*)picoquic_provide_stream_data_buffer(context, fetch_length, is_fin, !is_fin);
+            if (buffer == NULL) {
+                ret = -1;
+            }
+            else {
+                memcpy(buffer, fetch_buffer, fetch_length);
+                if (is_fin) {
+                    picoquic_log_app_message(stream_ctx->cnx_ctx->cnx,
+                        "Fetch complete on stream %" PRIu64 " : %" PRIu64 ", %" PRIu64,
+                        stream_ctx->stream_id, stream_ctx->final_group_id, stream_ctx->final_object_id);
+                    stream_ctx->is_local_finished = 1;
+                    stream_ctx->is_final_object_id_sent = 1;
+                    if (stream_ctx->close_reason == quicrq_media_close_reason_unknown) {
+                        stream_ctx->close_reason = quicrq_media_close_finished;
+                    }
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
 /* Find the stream context associated with a datagram */
 quicrq_stream_ctx_t* quicrq_find_stream_ctx_for_datagram(quicrq_cnx_ctx_t* cnx_ctx, uint64_t media_id, int is_sender)
 {
@@ -395,8 +559,8 @@ quicrq_stream_ctx_t* quicrq_find_stream_ctx_for_datagram(quicrq_cnx_ctx_t* cnx_c
     return stream_ctx;
 }
 
-/* Receive data in a datagram */
-int quicrq_receive_datagram(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* bytes, size_t length, uint64_t current_time)
+/* Receive data in a datagram fragment */
+static int quicrq_receive_datagram_fragment(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* bytes, size_t length, uint64_t current_time)
 {
     int ret = 0;
     quicrq_stream_ctx_t* stream_ctx = NULL;
@@ -410,10 +574,12 @@ int quicrq_receive_datagram(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* bytes, siz
     uint64_t queue_delay;
     uint64_t nb_objects_previous_group;
     uint64_t object_length;
+    uint64_t origin_timestamp;
     uint8_t flags;
     const uint8_t* next_bytes;
 
-    next_bytes = quicrq_datagram_header_decode(bytes, bytes_max, &media_id, &group_id, &object_id, &object_offset, &queue_delay, &flags, &nb_objects_previous_group, &object_length);
+    next_bytes = quicrq_datagram_header_decode(bytes, bytes_max, &media_id, &group_id, &object_id, &object_offset, &queue_delay, &flags,
+        &nb_objects_previous_group, &object_length, &origin_timestamp);
 
     if (next_bytes == NULL) {
         DBG_PRINTF("%s", "Error decoding datagram header");
@@ -447,7 +613,7 @@ int quicrq_receive_datagram(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* bytes, siz
                     group_id, object_id, media_id, stream_ctx->stream_id);
             }
             ret = stream_ctx->consumer_fn(quicrq_media_datagram_ready, stream_ctx->media_ctx, current_time, next_bytes, group_id, object_id, object_offset, 
-                queue_delay, flags, nb_objects_previous_group, object_length, bytes_max - next_bytes);
+                queue_delay, flags, nb_objects_previous_group, object_length, origin_timestamp, bytes_max - next_bytes);
             if (ret == quicrq_consumer_finished) {
                 ret = quicrq_cnx_handle_consumer_finished(stream_ctx, 0, 1, ret);
             }
@@ -460,6 +626,34 @@ int quicrq_receive_datagram(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* bytes, siz
     return ret;
 }
 
+/* Receive data in a datagram, which may be a bundle of several fragments */
+int quicrq_receive_datagram(quicrq_cnx_ctx_t* cnx_ctx, const uint8_t* bytes, size_t length, uint64_t current_time)
+{
+    int ret = 0;
+
+    if (quicrq_datagram_is_bundle(bytes, length)) {
+        const uint8_t* bytes_max = bytes + length;
+        const uint8_t* next_bytes = bytes + 1;
+
+        while (ret == 0 && next_bytes < bytes_max) {
+            size_t segment_length = 0;
+            if ((next_bytes = quicrq_datagram_bundle_segment_decode(next_bytes, bytes_max, &segment_length)) == NULL) {
+                DBG_PRINTF("%s", "Error decoding datagram bundle");
+                ret = -1;
+            }
+            else {
+                ret = quicrq_receive_datagram_fragment(cnx_ctx, next_bytes, segment_length, current_time);
+                next_bytes += segment_length;
+            }
+        }
+    }
+    else {
+        ret = quicrq_receive_datagram_fragment(cnx_ctx, bytes, length, current_time);
+    }
+
+    return ret;
+}
+
 /* Handle the list of datagrams pending acknowledgement or retransmission.
  * The code maintains an acknowledgement tree of the fragments that were sent.
  * TODO: handle whether we can have overlapping fragments. We will assume that
@@ -499,7 +693,7 @@ static picosplay_node_t* quicrq_datagram_ack_node_create(void* v_datagram_ack_st
 
 static void quicrq_datagram_ack_extra_dequeue(quicrq_stream_ctx_t* stream_ctx, quicrq_datagram_ack_state_t* das)
 {
-    if (das->extra_data == NULL) {
+    if (!das->is_extra_scheduled) {
         return;
     }
     if (das->extra_previous == NULL) {
@@ -515,13 +709,31 @@ static void quicrq_datagram_ack_extra_dequeue(quicrq_stream_ctx_t* stream_ctx, q
         das->extra_next->extra_previous = das->extra_previous;
     }
 
-    free(das->extra_data);
-    das->extra_data = NULL;
+    if (das->extra_data != NULL) {
+        free(das->extra_data);
+        das->extra_data = NULL;
+        stream_ctx->cnx_ctx->qr_ctx->extra_repeat_copy_bytes -= das->length;
+    }
+    das->is_extra_scheduled = 0;
     das->extra_next = NULL;
     das->extra_previous = NULL;
     das->extra_repeat_time = 0;
 }
 
+/* Check whether the payload of a fragment can be read from the cache of the stream */
+static int quicrq_datagram_ack_extra_copy_needed(quicrq_stream_ctx_t* stream_ctx, quicrq_datagram_ack_state_t* das)
+{
+    int is_needed = 1;
+
+    if (!stream_ctx->cnx_ctx->qr_ctx->is_extra_repeat_copy_forced &&
+        stream_ctx->media_ctx != NULL && stream_ctx->media_ctx->cache_ctx != NULL) {
+        quicrq_cached_fragment_t* fragment = quicrq_fragment_cache_find_fragment_at(stream_ctx->media_ctx->cache_ctx,
+            das->group_id, das->object_id, das->object_offset);
+        is_needed = (fragment == NULL || fragment->offset + fragment->data_length < das->object_offset + das->length);
+    }
+    return is_needed;
+}
+
 static void quicrq_datagram_ack_extra_queue(quicrq_stream_ctx_t* stream_ctx, quicrq_datagram_ack_state_t* das, const uint8_t * data, uint64_t repeat_time)
 {
     if (das->is_extra_queued) {
@@ -529,13 +741,27 @@ static void quicrq_datagram_ack_extra_queue(quicrq_stream_ctx_t* stream_ctx, qui
     }
     das->is_extra_queued = 1;
 
-    if (das->extra_data != NULL) {
+    if (das->is_extra_scheduled) {
         /* new repeat request replaces the previous one */
         quicrq_datagram_ack_extra_dequeue(stream_ctx, das);
     }
-    das->extra_data = (uint8_t *)malloc(das->length);
-    if (das->extra_data != NULL) {
-        memcpy(das->extra_data, data, das->length);
+    if (quicrq_datagram_ack_extra_copy_needed(stream_ctx, das)) {
+        /* Keep a copy of the payload, if it cannot be read from the cache at repeat time */
+        das->extra_data = (uint8_t*)malloc(das->length);
+        if (das->extra_data != NULL) {
+            quicrq_ctx_t* qr_ctx = stream_ctx->cnx_ctx->qr_ctx;
+            memcpy(das->extra_data, data, das->length);
+            qr_ctx->extra_repeat_copy_bytes += das->length;
+            if (qr_ctx->extra_repeat_copy_bytes > qr_ctx->extra_repeat_copy_bytes_peak) {
+                qr_ctx->extra_repeat_copy_bytes_peak = qr_ctx->extra_repeat_copy_bytes;
+            }
+            das->is_extra_scheduled = 1;
+        }
+    }
+    else {
+        das->is_extra_scheduled = 1;
+    }
+    if (das->is_extra_scheduled) {
         if (stream_ctx->extra_last == NULL) {
             stream_ctx->extra_first = das;
             stream_ctx->extra_last = das;
@@ -556,7 +782,7 @@ static void quicrq_datagram_ack_node_delete(void* tree, picosplay_node_t* node)
         ((char*)tree - offsetof(struct st_quicrq_stream_ctx_t, datagram_ack_tree));
     quicrq_datagram_ack_state_t* das = (quicrq_datagram_ack_state_t*)
         quicrq_datagram_ack_node_value(node);
-    if (das->extra_data != NULL) {
+    if (das->is_extra_scheduled) {
         /* dequeue from extra repeat list */
         quicrq_datagram_ack_extra_dequeue(stream_ctx, das);
     }
@@ -623,6 +849,25 @@ quicrq_datagram_ack_state_t* quicrq_datagram_ack_find(quicrq_stream_ctx_t* strea
     return found;
 }
 
+/* Document the delay between the arrival of an object in the cache and
+ * the sending of its first byte on the stream.
+ */
+void quicrq_stream_first_byte_sent(quicrq_stream_ctx_t* stream_ctx, uint64_t cache_time, uint64_t current_time)
+{
+    uint64_t latency = (current_time > cache_time) ? current_time - cache_time : 0;
+
+    stream_ctx->nb_first_byte_samples++;
+    stream_ctx->first_byte_latency_sum += latency;
+    if (latency > stream_ctx->first_byte_latency_max) {
+        stream_ctx->first_byte_latency_max = latency;
+    }
+}
+
+quicrq_datagram_ack_state_t* quicrq_datagram_ack_first(quicrq_stream_ctx_t* stream_ctx)
+{
+    return (quicrq_datagram_ack_state_t*)quicrq_datagram_ack_node_value(picosplay_first(&stream_ctx->datagram_ack_tree));
+}
+
 int64_t quicrq_datagram_check_horizon(quicrq_stream_ctx_t* stream_ctx, uint64_t group_id, uint64_t object_id, uint64_t object_offset)
 {
     int64_t ret = group_id - stream_ctx->horizon_group_id;
@@ -638,7 +883,7 @@ int64_t quicrq_datagram_check_horizon(quicrq_stream_ctx_t* stream_ctx, uint64_t
 
 int quicrq_datagram_ack_init(quicrq_stream_ctx_t* stream_ctx, uint64_t group_id, uint64_t object_id, 
     uint64_t object_offset, uint8_t flags, uint64_t nb_objects_previous_group, const uint8_t * data, size_t length,
-    uint64_t queue_delay, uint64_t object_length, void** p_created_state, uint64_t current_time)
+    uint64_t queue_delay, uint64_t object_length, uint64_t origin_timestamp, void** p_created_state, uint64_t current_time)
 {
     int ret = 0;
 
@@ -672,6 +917,7 @@ int quicrq_datagram_ack_init(quicrq_stream_ctx_t* stream_ctx, uint64_t group_id,
                 da_new->nb_objects_previous_group = nb_objects_previous_group;
                 da_new->length = length;
                 da_new->object_length = object_length;
+                da_new->origin_timestamp = origin_timestamp;
                 da_new->queue_delay = queue_delay;
                 da_new->start_time = current_time;
                 picosplay_insert(&stream_ctx->datagram_ack_tree, da_new);
@@ -781,7 +1027,12 @@ int quicrq_datagram_handle_ack(quicrq_stream_ctx_t* stream_ctx, uint64_t group_i
             if (!das->is_acked) {
                 break;
             }
-            if (das->group_id == stream_ctx->horizon_group_id) {
+            if (stream_ctx->horizon_group_id == UINT64_MAX) {
+                /* Nothing acked yet, the horizon starts at the start point of the stream */
+                just_after = (das->group_id == stream_ctx->start_group_id &&
+                    das->object_id == stream_ctx->start_object_id && das->object_offset == 0);
+            }
+            else if (das->group_id == stream_ctx->horizon_group_id) {
                 if (das->object_id == stream_ctx->horizon_object_id) {
                     just_after = (das->object_offset == stream_ctx->horizon_offset);
                 }
@@ -847,7 +1098,7 @@ int quicrq_datagram_handle_repeat(quicrq_stream_ctx_t* stream_ctx,
             found->last_sent_time = current_time;
             bytes = quicrq_datagram_header_encode(bytes, bytes_max, stream_ctx->media_id,
                 found->group_id, found->object_id, found->object_offset, found->queue_delay + queue_delay_delta, found->flags,
-                found->nb_objects_previous_group, found->object_length);
+                found->nb_objects_previous_group, found->object_length, found->origin_timestamp);
             /* Check how much data should be send in this fragment */
             header_length = bytes - datagram;
             datagram_length = header_length + data_length;
@@ -877,7 +1128,7 @@ int quicrq_datagram_handle_repeat(quicrq_stream_ctx_t* stream_ctx,
                         /* split the fragment, get a new one, update old record, point found to new record. */
                         ret = quicrq_datagram_ack_init(stream_ctx, found->group_id, found->object_id, next_offset,
                             found->flags, found->nb_objects_previous_group, data, data_length,
-                            found->queue_delay, found->object_length, &p_next_record, found->start_time);
+                            found->queue_delay, found->object_length, 0, &p_next_record, found->start_time);
                         if (ret == 0) {
                             quicrq_datagram_ack_state_t* next_record = (quicrq_datagram_ack_state_t*)p_next_record;
                             next_record->object_length = found->object_length;
@@ -926,8 +1177,8 @@ int quicrq_datagram_handle_lost(quicrq_stream_ctx_t* stream_ctx, uint64_t group_
     return ret;
 }
 
-/* Handle the acknowledgements of datagrams */
-int quicrq_handle_datagram_ack_nack(quicrq_cnx_ctx_t* cnx_ctx, picoquic_call_back_event_t picoquic_event, 
+/* Handle the acknowledgements of datagram fragments */
+static int quicrq_handle_datagram_fragment_ack_nack(quicrq_cnx_ctx_t* cnx_ctx, picoquic_call_back_event_t picoquic_event, 
     uint64_t send_time, const uint8_t* bytes, size_t length, uint64_t current_time)
 {
     int ret = 0;
@@ -941,13 +1192,15 @@ int quicrq_handle_datagram_ack_nack(quicrq_cnx_ctx_t* cnx_ctx, picoquic_call_bac
     uint8_t flags;
     uint64_t nb_objects_previous_group;
     uint64_t object_length;
+    uint64_t origin_timestamp;
     const uint8_t* next_bytes;
 
     if (bytes == NULL) {
         ret = -1;
     }
     else {
-        next_bytes = quicrq_datagram_header_decode(bytes, bytes_max, &media_id, &group_id, &object_id, &object_offset, &queue_delay, &flags, &nb_objects_previous_group, &object_length);
+        next_bytes = quicrq_datagram_header_decode(bytes, bytes_max, &media_id, &group_id, &object_id, &object_offset, &queue_delay, &flags,
+            &nb_objects_previous_group, &object_length, &origin_timestamp);
         
         /* Retrieve the stream context for the datagram */
         if (next_bytes == NULL) {
@@ -981,6 +1234,35 @@ int quicrq_handle_datagram_ack_nack(quicrq_cnx_ctx_t* cnx_ctx, picoquic_call_bac
     return ret;
 }
 
+/* Handle the acknowledgements of datagrams.
+ * Each fragment in a bundle is acknowledged or repeated separately. */
+int quicrq_handle_datagram_ack_nack(quicrq_cnx_ctx_t* cnx_ctx, picoquic_call_back_event_t picoquic_event, 
+    uint64_t send_time, const uint8_t* bytes, size_t length, uint64_t current_time)
+{
+    int ret = 0;
+
+    if (bytes != NULL && quicrq_datagram_is_bundle(bytes, length)) {
+        const uint8_t* bytes_max = bytes + length;
+        const uint8_t* next_bytes = bytes + 1;
+
+        while (ret == 0 && next_bytes < bytes_max) {
+            size_t segment_length = 0;
+            if ((next_bytes = quicrq_datagram_bundle_segment_decode(next_bytes, bytes_max, &segment_length)) == NULL) {
+                ret = -1;
+            }
+            else {
+                ret = quicrq_handle_datagram_fragment_ack_nack(cnx_ctx, picoquic_event, send_time, next_bytes, segment_length, current_time);
+                next_bytes += segment_length;
+            }
+        }
+    }
+    else {
+        ret = quicrq_handle_datagram_fragment_ack_nack(cnx_ctx, picoquic_event, send_time, bytes, length, current_time);
+    }
+
+    return ret;
+}
+
 /* control whether an extra copy of the packet can be sent:
 * - after the packet is repeated (on nack)
 * - if a packet was delayed at a previous hop (after-delayed)
@@ -1000,6 +1282,70 @@ void quicrq_set_extra_repeat_delay(quicrq_ctx_t* qr, uint64_t delay_in_microseco
     qr->extra_repeat_delay = delay_in_microseconds;
 }
 
+/* Control the extra repeat policy. If congestion aware, extra copies
+ * are dropped when the connection is congested or the group was skipped.
+ * If budget_percent is not zero, extra copies are limited to that
+ * fraction of the datagram bytes sent.
+ */
+void quicrq_set_extra_repeat_policy(quicrq_ctx_t* qr, int is_congestion_aware, uint64_t budget_percent)
+{
+    qr->extra_repeat_congestion_aware = (is_congestion_aware != 0);
+    qr->extra_repeat_budget_percent = budget_percent;
+}
+
+void quicrq_get_extra_repeat_statistics(quicrq_ctx_t* qr, uint64_t* nb_sent, uint64_t* nb_dropped, uint64_t* bytes_sent)
+{
+    *nb_sent = qr->nb_extra_repeat_sent;
+    *nb_dropped = qr->nb_extra_repeat_dropped;
+    *bytes_sent = qr->extra_repeat_bytes_sent;
+}
+
+void quicrq_extra_repeat_credit(quicrq_cnx_ctx_t* cnx_ctx, size_t length)
+{
+    if (cnx_ctx->qr_ctx->extra_repeat_budget_percent > 0) {
+        cnx_ctx->extra_repeat_credit += (length * cnx_ctx->qr_ctx->extra_repeat_budget_percent) / 100;
+        if (cnx_ctx->extra_repeat_credit > QUICRQ_EXTRA_REPEAT_CREDIT_MAX) {
+            cnx_ctx->extra_repeat_credit = QUICRQ_EXTRA_REPEAT_CREDIT_MAX;
+        }
+    }
+}
+
+/* Check whether a scheduled extra copy is still worth sending:
+ * - not if the fragment was acked since it was scheduled,
+ * - not if the connection is congested and the fragment would be dropped,
+ * - not if the publisher already skipped the group because of congestion,
+ * - not if the extra repeat budget is exhausted.
+ */
+static int quicrq_extra_repeat_is_useful(quicrq_stream_ctx_t* stream_ctx, quicrq_datagram_ack_state_t* das)
+{
+    int is_useful = 1;
+    quicrq_cnx_ctx_t* cnx_ctx = stream_ctx->cnx_ctx;
+    quicrq_ctx_t* qr = cnx_ctx->qr_ctx;
+
+    if (qr->extra_repeat_congestion_aware) {
+        if (das->is_acked) {
+            is_useful = 0;
+        }
+        else if (qr->congestion_control_mode != quicrq_congestion_control_none &&
+            cnx_ctx->congestion.is_congested && das->flags >= cnx_ctx->congestion.priority_threshold) {
+            is_useful = 0;
+        }
+        else if (stream_ctx->media_ctx != NULL &&
+            das->group_id < stream_ctx->media_ctx->end_of_congestion_group_id) {
+            is_useful = 0;
+        }
+    }
+    if (is_useful && qr->extra_repeat_budget_percent > 0) {
+        if (cnx_ctx->extra_repeat_credit < das->length) {
+            is_useful = 0;
+        }
+        else {
+            cnx_ctx->extra_repeat_credit -= das->length;
+        }
+    }
+    return is_useful;
+}
+
 /* Handling of extra repeats in a quicrq_context.
  * Check all the queues and return the next wakeup time, wich will be "now"
  * if there are queued datagrams, or the time at which the next datagram will be
@@ -1017,9 +1363,31 @@ uint64_t quicrq_handle_extra_repeat(quicrq_ctx_t* qr, uint64_t current_time)
             while (das != NULL) {
                 if (das->extra_repeat_time <= current_time) {
                     next_time = current_time;
-                    int ret = quicrq_datagram_handle_repeat(stream_ctx, das, das->extra_data, das->length, 0, current_time);
-                    if (ret != 0) {
-                        DBG_PRINTF("Handle repeat error, ret = %d", ret);
+                    uint8_t payload[PICOQUIC_MAX_PACKET_SIZE];
+                    const uint8_t* data = das->extra_data;
+
+                    if (data == NULL && das->length <= sizeof(payload) && stream_ctx->media_ctx != NULL &&
+                        quicrq_fragment_cache_copy_range(stream_ctx->media_ctx->cache_ctx, das->group_id, das->object_id,
+                            das->object_offset, payload, das->length) == 0) {
+                        /* Read the payload from the cache */
+                        data = payload;
+                    }
+                    if (data == NULL) {
+                        /* The fragment was purged from the cache */
+                        qr->nb_extra_repeat_dropped++;
+                    }
+                    else if (quicrq_extra_repeat_is_useful(stream_ctx, das)) {
+                        int ret = quicrq_datagram_handle_repeat(stream_ctx, das, data, das->length, 0, current_time);
+                        if (ret != 0) {
+                            DBG_PRINTF("Handle repeat error, ret = %d", ret);
+                        }
+                        else {
+                            qr->nb_extra_repeat_sent++;
+                            qr->extra_repeat_bytes_sent += das->length;
+                        }
+                    }
+                    else {
+                        qr->nb_extra_repeat_dropped++;
                     }
                     quicrq_datagram_ack_extra_dequeue(stream_ctx, das);
                     das = stream_ctx->extra_first;
@@ -1050,6 +1418,223 @@ void quicrq_enable_congestion_control(quicrq_ctx_t* qr, quicrq_congestion_contro
     }
 }
 
+int quicrq_set_media_congestion_weight(quicrq_ctx_t* qr, const uint8_t* url, size_t url_length, uint64_t weight)
+{
+    int ret = 0;
+    quicrq_congestion_weight_t** p_next = &qr->first_congestion_weight;
+
+    while (*p_next != NULL) {
+        if ((*p_next)->url_length == url_length && memcmp((*p_next)->url, url, url_length) == 0) {
+            break;
+        }
+        p_next = &(*p_next)->next_weight;
+    }
+
+    if (weight == 0) {
+        if (*p_next != NULL) {
+            quicrq_congestion_weight_t* removed = *p_next;
+            *p_next = removed->next_weight;
+            free(removed);
+        }
+    }
+    else if (*p_next != NULL) {
+        (*p_next)->weight = weight;
+    }
+    else {
+        quicrq_congestion_weight_t* added = (quicrq_congestion_weight_t*)
+            malloc(sizeof(quicrq_congestion_weight_t) + url_length);
+        if (added == NULL) {
+            ret = -1;
+        }
+        else {
+            memset(added, 0, sizeof(quicrq_congestion_weight_t));
+            added->weight = weight;
+            added->url_length = url_length;
+            added->url = ((uint8_t*)added) + sizeof(quicrq_congestion_weight_t);
+            memcpy(added->url, url, url_length);
+            *p_next = added;
+        }
+    }
+    return ret;
+}
+
+uint64_t quicrq_get_media_congestion_weight(quicrq_ctx_t* qr_ctx, const uint8_t* url, size_t url_length)
+{
+    uint64_t weight = 1;
+    quicrq_congestion_weight_t* next = qr_ctx->first_congestion_weight;
+
+    while (next != NULL) {
+        if (next->url_length == url_length && memcmp(next->url, url, url_length) == 0) {
+            weight = next->weight;
+            break;
+        }
+        next = next->next_weight;
+    }
+    return weight;
+}
+
+int quicrq_set_media_repair_deadline(quicrq_ctx_t* qr, const uint8_t* url, size_t url_length, uint64_t deadline)
+{
+    int ret = 0;
+    quicrq_repair_deadline_t** p_next = &qr->first_repair_deadline;
+
+    while (*p_next != NULL) {
+        if ((*p_next)->url_length == url_length && memcmp((*p_next)->url, url, url_length) == 0) {
+            break;
+        }
+        p_next = &(*p_next)->next_deadline;
+    }
+
+    if (deadline == 0) {
+        if (*p_next != NULL) {
+            quicrq_repair_deadline_t* removed = *p_next;
+            *p_next = removed->next_deadline;
+            free(removed);
+        }
+    }
+    else if (*p_next != NULL) {
+        (*p_next)->deadline = deadline;
+    }
+    else {
+        quicrq_repair_deadline_t* added = (quicrq_repair_deadline_t*)
+            malloc(sizeof(quicrq_repair_deadline_t) + url_length);
+        if (added == NULL) {
+            ret = -1;
+        }
+        else {
+            memset(added, 0, sizeof(quicrq_repair_deadline_t));
+            added->deadline = deadline;
+            added->url_length = url_length;
+            added->url = ((uint8_t*)added) + sizeof(quicrq_repair_deadline_t);
+            memcpy(added->url, url, url_length);
+            *p_next = added;
+        }
+    }
+    return ret;
+}
+
+uint64_t quicrq_get_media_repair_deadline(quicrq_ctx_t* qr_ctx, const uint8_t* url, size_t url_length)
+{
+    uint64_t deadline = 0;
+    quicrq_repair_deadline_t* next = qr_ctx->first_repair_deadline;
+
+    while (next != NULL) {
+        if (next->url_length == url_length && memcmp(next->url, url, url_length) == 0) {
+            deadline = next->deadline;
+            break;
+        }
+        next = next->next_deadline;
+    }
+    return deadline;
+}
+
+void quicrq_set_rush_packing(quicrq_ctx_t* qr, size_t object_max, size_t stream_max, uint64_t delay_max)
+{
+    qr->rush_pack_object_max = object_max;
+    qr->rush_pack_stream_max = stream_max;
+    qr->rush_pack_delay = delay_max;
+}
+
+void quicrq_set_datagram_bundling(quicrq_ctx_t* qr, int is_enabled)
+{
+    qr->is_datagram_bundling_enabled = (is_enabled != 0);
+}
+
+void quicrq_set_warp_latest_first(quicrq_ctx_t* qr, uint64_t lag_groups, uint64_t horizon_groups)
+{
+    qr->warp_latest_first_lag = lag_groups;
+    qr->warp_abandon_horizon = horizon_groups;
+}
+
+/* Provide a buffer for the next datagram fragment. If a bundle is being
+ * prepared, the fragment is added as a new segment of the bundle.
+ * Otherwise, the buffer is directly provided by picoquic. */
+void* quicrq_provide_datagram_buffer(quicrq_stream_ctx_t* stream_ctx, void* context, size_t length)
+{
+    void* buffer = NULL;
+    quicrq_datagram_bundle_t* bundle = (stream_ctx == NULL || stream_ctx->cnx_ctx == NULL) ? NULL :
+        stream_ctx->cnx_ctx->datagram_bundle;
+
+    if (bundle == NULL) {
+        buffer = picoquic_provide_datagram_buffer(context, length);
+    }
+    else {
+        uint8_t* bytes = picoquic_frames_varint_encode(bundle->bytes + bundle->length, bundle->bytes + bundle->space, length);
+        if (bytes != NULL && bytes + length <= bundle->bytes + bundle->space) {
+            buffer = bytes;
+            if (bundle->nb_segments == 0) {
+                bundle->first_segment_length = length;
+            }
+            bundle->nb_segments++;
+            bundle->length = (bytes + length) - bundle->bytes;
+        }
+    }
+    return buffer;
+}
+
+/* Prepare a bundle of datagram fragments.
+ * The streams are polled in order, one fragment at a time, until no stream
+ * has anything to send or the bundle is full. If only one fragment was
+ * collected, it is sent as a plain datagram.
+ */
+static int quicrq_prepare_to_send_datagram_bundle(quicrq_cnx_ctx_t* cnx_ctx, void* context, size_t space,
+    int* at_least_one_active, uint64_t current_time)
+{
+    int ret = 0;
+    int is_progressing = 1;
+    quicrq_datagram_bundle_t bundle;
+
+    memset(&bundle, 0, sizeof(bundle));
+    bundle.space = (space < sizeof(bundle.bytes)) ? space : sizeof(bundle.bytes);
+    bundle.bytes[0] = QUICRQ_DATAGRAM_BUNDLE_MARKER;
+    bundle.length = 1;
+    cnx_ctx->datagram_bundle = &bundle;
+    cnx_ctx->datagram_bundle_seq++;
+
+    while (ret == 0 && is_progressing) {
+        quicrq_stream_ctx_t* stream_ctx = cnx_ctx->first_stream;
+        is_progressing = 0;
+
+        while (ret == 0 && stream_ctx != NULL && bundle.length + 2 + QUICRQ_DATAGRAM_BUNDLE_SEGMENT_MIN <= bundle.space) {
+            /* Streams that did not send in a pass will not do better with less space. */
+            if (stream_ctx->transport_mode == quicrq_transport_mode_datagram && stream_ctx->is_sender && stream_ctx->is_active_datagram && stream_ctx->media_id < UINT64_MAX &&
+                stream_ctx->datagram_bundle_idle_seq != cnx_ctx->datagram_bundle_seq) {
+                int media_was_sent = 0;
+                int is_stream_active = 0;
+                ret = quicrq_fragment_datagram_publisher_fn(stream_ctx, context, bundle.space - bundle.length - 2,
+                    &media_was_sent, &is_stream_active, current_time);
+                *at_least_one_active |= is_stream_active;
+                if (media_was_sent) {
+                    is_progressing = 1;
+                }
+                else {
+                    stream_ctx->datagram_bundle_idle_seq = cnx_ctx->datagram_bundle_seq;
+                    if (!is_stream_active) {
+                        stream_ctx->is_active_datagram = 0;
+                    }
+                }
+            }
+            stream_ctx = stream_ctx->next_stream;
+        }
+    }
+    cnx_ctx->datagram_bundle = NULL;
+
+    if (ret == 0 && bundle.nb_segments > 0) {
+        /* Skip the marker and the segment length if there is just one fragment */
+        size_t offset = (bundle.nb_segments == 1) ? bundle.length - bundle.first_segment_length : 0;
+        void* buffer = picoquic_provide_datagram_buffer(context, bundle.length - offset);
+
+        if (buffer == NULL) {
+            ret = -1;
+        }
+        else {
+            memcpy(buffer, bundle.bytes + offset, bundle.length - offset);
+        }
+    }
+
+    return ret;
+}
+
 /* Prepare to send a datagram */
 
 int quicrq_prepare_to_send_datagram(quicrq_cnx_ctx_t* cnx_ctx, void* context, size_t space, uint64_t current_time)
@@ -1057,20 +1642,27 @@ int quicrq_prepare_to_send_datagram(quicrq_cnx_ctx_t* cnx_ctx, void* context, si
     /* Find a stream on which datagrams are available */
     int ret = 0;
     int at_least_one_active = 0;
-    quicrq_stream_ctx_t* stream_ctx = cnx_ctx->first_stream;
+    quicrq_stream_ctx_t* stream_ctx = (cnx_ctx->qr_ctx->is_datagram_bundling_enabled) ? NULL : cnx_ctx->first_stream;
 
     /* TODO: handle congestion. Check whether one stream is congested. 
      * look at priority levels, etc.
      */
 
+    if (cnx_ctx->qr_ctx->is_datagram_bundling_enabled) {
+        ret = quicrq_prepare_to_send_datagram_bundle(cnx_ctx, context, space, &at_least_one_active, current_time);
+    }
+
     while (stream_ctx != NULL) {
         if (stream_ctx->transport_mode == quicrq_transport_mode_datagram && stream_ctx->is_sender && stream_ctx->is_active_datagram && stream_ctx->media_id < UINT64_MAX) {
             int media_was_sent = 0;
-            ret = quicrq_fragment_datagram_publisher_fn(stream_ctx, context, space, &media_was_sent, &at_least_one_active, current_time);
+            int is_stream_active = 0;
+            ret = quicrq_fragment_datagram_publisher_fn(stream_ctx, context, space, &media_was_sent, &is_stream_active, current_time);
+            at_least_one_active |= is_stream_active;
             if (media_was_sent || ret != 0) {
                 break;
             }
-            else {
+            else if (!is_stream_active) {
+                /* Keep the streams waiting for a larger datagram active */
                 stream_ctx->is_active_datagram = 0;
             }
         }
@@ -1151,6 +1743,9 @@ int quicrq_prepare_to_send_on_stream(quicrq_stream_ctx_t* stream_ctx, void* cont
         /* Ready to send next message */
         if (stream_ctx->is_sender) {
             if ((stream_ctx->start_group_id > 0 || stream_ctx->start_object_id > 0) && !stream_ctx->is_start_object_id_sent) {
+                if (stream_ctx->transport_mode == quicrq_transport_mode_single_stream && stream_ctx->next_object_offset == 0) {
+                    quicrq_fragment_publisher_skip_to_start_point(stream_ctx);
+                }
                 ret = quicrq_prepare_start_point(stream_ctx);
             }
             else if ((stream_ctx->final_group_id > 0 || stream_ctx->final_object_id > 0) &&
@@ -1194,7 +1789,8 @@ int quicrq_prepare_to_send_on_stream(quicrq_stream_ctx_t* stream_ctx, void* cont
                     }
                 }
             }
-            else if (stream_ctx->transport_mode == quicrq_transport_mode_single_stream && quicrq_fragment_is_ready_to_send(stream_ctx->media_ctx, space, current_time)) {
+            else if (stream_ctx->transport_mode == quicrq_transport_mode_single_stream &&
+                (stream_ctx->media_ctx->is_fetch || quicrq_fragment_is_ready_to_send(stream_ctx->media_ctx, space, current_time))) {
                 stream_ctx->send_state = quicrq_sending_single_stream;
             }
             else {
@@ -1217,6 +1813,14 @@ int quicrq_prepare_to_send_on_stream(quicrq_stream_ctx_t* stream_ctx, void* cont
                 stream_ctx->stream_id, stream_ctx->final_group_id, stream_ctx->final_object_id);
         }
     }
+    else if (stream_ctx->send_state == quicrq_sending_single_stream && !stream_ctx->media_ctx->is_fetch &&
+        (stream_ctx->start_group_id > 0 || stream_ctx->start_object_id > 0) && !stream_ctx->is_start_object_id_sent &&
+        stream_ctx->next_object_offset == 0) {
+        /* The start point moved forward while sending the media, e.g., because the upstream
+         * sender abandoned groups. Skip to it, and send it before the next object. */
+        quicrq_fragment_publisher_skip_to_start_point(stream_ctx);
+        ret = quicrq_prepare_start_point(stream_ctx);
+    }
     else if (stream_ctx->send_state == quicrq_notify_ready) {
         if (stream_ctx->first_notify_url != NULL) {
             quicrq_notify_url_t* notified = stream_ctx->first_notify_url;
@@ -1257,7 +1861,12 @@ int quicrq_prepare_to_send_on_stream(quicrq_stream_ctx_t* stream_ctx, void* cont
             break;
         case quicrq_sending_single_stream:
             /* Send available stream data. Check whether the FIN is reached. */
-            ret = quicrq_prepare_to_send_media_to_stream(stream_ctx, context, space, current_time);
+            if (stream_ctx->media_ctx->is_fetch) {
+                ret = quicrq_prepare_to_send_fetch_to_stream(stream_ctx, context, space, current_time);
+            }
+            else {
+                ret = quicrq_prepare_to_send_media_to_stream(stream_ctx, context, space, current_time);
+            }
             break;
         case quicrq_sending_initial:
             /* Send available buffer data. Mark state ready after sent. */
@@ -1366,7 +1975,9 @@ int quicrq_prepare_warp_object_header(quicrq_uni_stream_ctx_t* uni_stream_ctx, u
     /* This handles both RUSH mode and WARP mode. RUSH sends only one object per uni stream,
     * as specified in the uni-stream context. This means there is no need to check "last object
     * id" -- it is alsways, "the specified object plus 1." We rely on the uni stream creation
-    * setting the last object ID to zero for WARP, and to "object+1" for RUSH.
+    * setting the last object ID to zero for WARP, and to "object+1" for RUSH. If rush packing
+    * is enabled, the wakeup code increments the last object ID when small objects are appended
+    * to the stream, and the stream stays open until the pack is closed.
     */
     quicrq_fragment_publisher_context_t* media_ctx = uni_stream_ctx->control_stream_ctx->media_ctx;
     quicrq_fragment_cache_t* cache_ctx = media_ctx->cache_ctx;
@@ -1387,30 +1998,66 @@ int quicrq_prepare_warp_object_header(quicrq_uni_stream_ctx_t* uni_stream_ctx, u
     }
 
     if (uni_stream_ctx->last_object_id > 0 && uni_stream_ctx->current_object_id >= uni_stream_ctx->last_object_id) {
-        /* we have sent all the objects from the current group */
-        uni_stream_ctx->send_state = quicrq_sending_warp_all_sent;
+        if (!uni_stream_ctx->is_rush_pack_open) {
+            /* we have sent all the objects from the current group */
+            uni_stream_ctx->send_state = quicrq_sending_warp_all_sent;
+        }
+        /* else, more small objects may be packed on this rush stream. Wait. */
     }
     else {
         /* Check whether the next fragment is available */
         uint8_t flags = 0;
         uint64_t nb_objects_previous_group = 0;
+        /* Objects skipped after their repair deadline are skipped, even if partially received */
+        quicrq_repair_skip_t* repair_skip = (cache_ctx->first_repair_skip == NULL) ? NULL :
+            quicrq_fragment_cache_get_repair_skip(cache_ctx, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id);
         /* Todo: we may send this immediately, as soon as the object length is known. */
-        if (quicrq_fragment_get_object_properties(cache_ctx, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id,
+        if (repair_skip != NULL ||
+            quicrq_fragment_get_object_properties(cache_ctx, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id,
             &uni_stream_ctx->current_object_length, &uni_stream_ctx->nb_objects_previous_group, 
             &uni_stream_ctx->current_object_flags) == 0){
             int should_skip = 0;
             quicrq_message_buffer_t* message = &uni_stream_ctx->message_buffer;
             uint8_t* message_next = NULL;
 
-            should_skip = quicrq_evaluate_warp_congestion(uni_stream_ctx, media_ctx, uni_stream_ctx->current_object_length, flags, current_time);
+            if (repair_skip != NULL) {
+                uni_stream_ctx->nb_objects_previous_group = repair_skip->nb_objects_previous_group;
+                should_skip = 1;
+            }
+            else {
+                should_skip = quicrq_evaluate_warp_congestion(uni_stream_ctx, media_ctx, uni_stream_ctx->current_object_length, flags, current_time);
+                if (uni_stream_ctx->control_stream_ctx->transport_mode == quicrq_transport_mode_warp) {
+                    /* Groups are sent in parallel on warp streams, each stream follows the chain of its group */
+                    should_skip = quicrq_evaluate_dependency(&uni_stream_ctx->dependency_group_id, &uni_stream_ctx->is_dependency_broken,
+                        uni_stream_ctx->current_group_id,
+                        quicrq_fragment_get_dependency(cache_ctx, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id),
+                        should_skip);
+                }
+                else {
+                    /* Rush streams carry single objects, opened in order: the chain is kept by the publisher */
+                    should_skip = quicrq_evaluate_dependency(&media_ctx->dependency_group_id, &media_ctx->is_dependency_broken,
+                        uni_stream_ctx->current_group_id,
+                        quicrq_fragment_get_dependency(cache_ctx, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id),
+                        should_skip);
+                }
+            }
 
             if (should_skip) {
                 uni_stream_ctx->current_object_length = 0;
                 uni_stream_ctx->current_object_flags = 0xff;
+                uni_stream_ctx->current_object_origin_timestamp = 0;
+                uni_stream_ctx->control_stream_ctx->nb_objects_skipped++;
+            }
+            else {
+                uni_stream_ctx->current_object_origin_timestamp = quicrq_fragment_get_origin_timestamp(cache_ctx,
+                    uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id);
+                quicrq_stream_first_byte_sent(uni_stream_ctx->control_stream_ctx, quicrq_fragment_get_cache_time(cache_ctx,
+                    uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id), current_time);
             }
             /* Encode object header */
             if (quicrq_msg_buffer_alloc(message, quicrq_object_header_msg_reserve(uni_stream_ctx->current_object_id, 
-                nb_objects_previous_group, uni_stream_ctx->current_object_length), 0) != 0) {
+                nb_objects_previous_group, uni_stream_ctx->current_object_length,
+                uni_stream_ctx->current_object_origin_timestamp), 0) != 0) {
                 ret = -1;
             }
             else {
@@ -1418,7 +2065,8 @@ int quicrq_prepare_warp_object_header(quicrq_uni_stream_ctx_t* uni_stream_ctx, u
                     message->buffer + message->buffer_alloc,
                     QUICRQ_ACTION_OBJECT_HEADER, uni_stream_ctx->current_object_id,
                     uni_stream_ctx->nb_objects_previous_group,
-                    uni_stream_ctx->current_object_flags, uni_stream_ctx->current_object_length);
+                    uni_stream_ctx->current_object_flags, uni_stream_ctx->current_object_length,
+                    uni_stream_ctx->current_object_origin_timestamp);
 
                 if (message_next == NULL) {
                     ret = -1;
@@ -1453,7 +2101,7 @@ int quicrq_prepare_to_send_on_unistream(quicrq_cnx_ctx_t * cnx_ctx, quicrq_uni_s
         /* When done: back to quicrq_sending_warp_header_sent */
         quicrq_fragment_publisher_context_t* media_ctx = uni_stream_ctx->control_stream_ctx->media_ctx;
         quicrq_fragment_cache_t* cache_ctx = media_ctx->cache_ctx;
-        size_t fragment_length = quicrq_fragment_object_copy_available_data(cache_ctx,
+        size_t fragment_length = quicrq_fragment_object_copy_available_data(cache_ctx, &uni_stream_ctx->read_cursor,
             uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id,
             uni_stream_ctx->current_object_offset, space, NULL);
 
@@ -1463,7 +2111,7 @@ int quicrq_prepare_to_send_on_unistream(quicrq_cnx_ctx_t * cnx_ctx, quicrq_uni_s
                 ret = -1;
             }
             else {
-                size_t copied_length = quicrq_fragment_object_copy_available_data(cache_ctx,
+                size_t copied_length = quicrq_fragment_object_copy_available_data(cache_ctx, &uni_stream_ctx->read_cursor,
                     uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id,
                     uni_stream_ctx->current_object_offset, fragment_length, buffer);
                 if (copied_length != fragment_length) {
@@ -1471,6 +2119,8 @@ int quicrq_prepare_to_send_on_unistream(quicrq_cnx_ctx_t * cnx_ctx, quicrq_uni_s
                 }
                 else {
                     uni_stream_ctx->current_object_offset += copied_length;
+                    uni_stream_ctx->control_stream_ctx->congestion.bytes_sent += copied_length;
+                    uni_stream_ctx->control_stream_ctx->nb_bytes_sent += copied_length;
                     if (uni_stream_ctx->current_object_offset == uni_stream_ctx->current_object_length) {
                         /* this object is sent, back to state quicrq_sending_warp_header_sent */
                         uni_stream_ctx->current_object_id++;
@@ -1484,6 +2134,7 @@ int quicrq_prepare_to_send_on_unistream(quicrq_cnx_ctx_t * cnx_ctx, quicrq_uni_s
         }
         else {
             /* Nothing to send yet. */
+            uni_stream_ctx->is_waiting_for_data = 1;
             ret = picoquic_mark_active_stream(cnx_ctx->cnx, uni_stream_ctx->stream_id, 0, uni_stream_ctx);
         }
     }
@@ -1515,6 +2166,7 @@ int quicrq_prepare_to_send_on_unistream(quicrq_cnx_ctx_t * cnx_ctx, quicrq_uni_s
             }
             else {
                 /* Nothing to send */
+                uni_stream_ctx->is_waiting_for_data = 1;
                 ret = picoquic_mark_active_stream(cnx_ctx->cnx, uni_stream_ctx->stream_id, 0, uni_stream_ctx);
             }
         }
@@ -1684,6 +2336,12 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                                 case quicrq_subscribe_intent_current_group:
                                     intent_group = stream_ctx->media_ctx->cache_ctx->next_group_id;
                                     intent_object = 0;
+                                    if (intent_group == stream_ctx->media_ctx->cache_ctx->first_group_id &&
+                                        stream_ctx->media_ctx->cache_ctx->first_object_id > 0) {
+                                        /* The start of the current group is not in the cache anymore,
+                                         * e.g., released by a pass through relay. Wait for the next group. */
+                                        intent_group++;
+                                    }
                                     break;
                                 case quicrq_subscribe_intent_next_group:
                                     intent_group = stream_ctx->media_ctx->cache_ctx->next_group_id + 1;
@@ -1692,6 +2350,32 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                                 case quicrq_subscribe_intent_start_point:
                                     intent_group = incoming.group_id;
                                     intent_object = incoming.object_id;
+                                    stream_ctx->is_start_in_past = 1;
+                                    break;
+                                case quicrq_subscribe_intent_start_time:
+                                    if (quicrq_fragment_cache_seek_time(stream_ctx->media_ctx->cache_ctx, incoming.start_time, &intent_group) != 0) {
+                                        /* Nothing cached yet, start with the current group */
+                                        intent_group = stream_ctx->media_ctx->cache_ctx->next_group_id;
+                                    }
+                                    intent_object = 0;
+                                    if (intent_group == stream_ctx->media_ctx->cache_ctx->first_group_id) {
+                                        intent_object = stream_ctx->media_ctx->cache_ctx->first_object_id;
+                                    }
+                                    stream_ctx->is_start_in_past = 1;
+                                    break;
+                                case quicrq_subscribe_intent_fetch_range:
+                                    if (incoming.transport_mode != quicrq_transport_mode_single_stream) {
+                                        quicrq_log_message(stream_ctx->cnx_ctx, "Stream %" PRIu64 ", fetch not supported in mode %s",
+                                            stream_ctx->stream_id, quicrq_transport_mode_to_string(stream_ctx->transport_mode));
+                                        ret = -1;
+                                    }
+                                    else {
+                                        intent_group = incoming.group_id;
+                                        intent_object = incoming.object_id;
+                                        stream_ctx->media_ctx->is_fetch = 1;
+                                        stream_ctx->media_ctx->fetch_end_group_id = incoming.end_group_id;
+                                        stream_ctx->media_ctx->fetch_end_object_id = incoming.end_object_id;
+                                    }
                                     break;
                                 default:
                                     break;
@@ -1767,7 +2451,10 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                         ret = quicrq_cnx_post_accepted(stream_ctx, incoming.transport_mode, incoming.media_id);
                         break;
                     case QUICRQ_ACTION_START_POINT:
-                        if (stream_ctx->receive_state != quicrq_receive_fragment || stream_ctx->start_group_id != 0 || stream_ctx->start_object_id != 0) {
+                        /* The start point may be repeated if the sender abandons groups, but shall not move backward */
+                        if (stream_ctx->receive_state != quicrq_receive_fragment ||
+                            incoming.group_id < stream_ctx->start_group_id ||
+                            (incoming.group_id == stream_ctx->start_group_id && incoming.object_id < stream_ctx->start_object_id)) {
                             /* Protocol error */
                             ret = -1;
                         }
@@ -1779,7 +2466,7 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                             stream_ctx->start_group_id = incoming.group_id;
                             stream_ctx->start_object_id = incoming.object_id;
                             ret = stream_ctx->consumer_fn(quicrq_media_start_point, stream_ctx->media_ctx, picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic),
-                                NULL, incoming.group_id, incoming.object_id, 0, 0, incoming.flags, 0, 0, 0);
+                                NULL, incoming.group_id, incoming.object_id, 0, 0, incoming.flags, 0, 0, 0, 0);
 
                             ret = quicrq_cnx_handle_consumer_finished(stream_ctx, 0, 0, ret);
                         }
@@ -1796,7 +2483,7 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                                 stream_ctx->stream_id, incoming.group_id, incoming.object_id);
                             /* Pass the final offset to the media consumer. */
                             ret = stream_ctx->consumer_fn(quicrq_media_final_object_id, stream_ctx->media_ctx, picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic), NULL,
-                                incoming.group_id, incoming.object_id, 0, 0, 0, 0, 0, 0);
+                                incoming.group_id, incoming.object_id, 0, 0, 0, 0, 0, 0, 0);
                             ret = quicrq_cnx_handle_consumer_finished(stream_ctx, 1, 0, ret);
                         }
                         break;
@@ -1816,7 +2503,7 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                             ret = stream_ctx->consumer_fn(quicrq_media_datagram_ready, stream_ctx->media_ctx, picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic),
                                 incoming.data, incoming.group_id, incoming.object_id,
                                 incoming.fragment_offset, 0, incoming.flags, incoming.nb_objects_previous_group,
-                                incoming.object_length, incoming.fragment_length);
+                                incoming.object_length, incoming.origin_timestamp, incoming.fragment_length);
                             ret = quicrq_cnx_handle_consumer_finished(stream_ctx, 0, 0, ret);
                         }
                         break;
@@ -1862,7 +2549,7 @@ int quicrq_receive_stream_data(quicrq_stream_ctx_t* stream_ctx, uint8_t* bytes,
                                 stream_ctx->stream_id, incoming.cache_policy);
                             stream_ctx->is_cache_real_time = (incoming.cache_policy == 0) ? 0 : 1;
                             ret = stream_ctx->consumer_fn(quicrq_media_real_time_cache, stream_ctx->media_ctx, picoquic_get_quic_time(stream_ctx->cnx_ctx->qr_ctx->quic),
-                                NULL, 0, 0, 0, 0, 0, 0, 0, 0);
+                                NULL, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 
                             ret = quicrq_cnx_handle_consumer_finished(stream_ctx, 0, 0, ret);
                         }
@@ -1934,7 +2621,8 @@ int quicrq_receive_warp_or_rush_stream_data(quicrq_cnx_ctx_t* cnx_ctx, quicrq_un
             ret = ctrl_stream_ctx->consumer_fn(quicrq_media_datagram_ready, ctrl_stream_ctx->media_ctx, picoquic_get_quic_time(ctrl_stream_ctx->cnx_ctx->qr_ctx->quic),
                 bytes, uni_stream_ctx->current_group_id, uni_stream_ctx->current_object_id,
                 uni_stream_ctx->current_object_offset, 0, uni_stream_ctx->current_object_flags,
-                uni_stream_ctx->nb_objects_previous_group,  uni_stream_ctx->current_object_length, copied);
+                uni_stream_ctx->nb_objects_previous_group,  uni_stream_ctx->current_object_length,
+                uni_stream_ctx->current_object_origin_timestamp, copied);
             uni_stream_ctx->current_object_offset += copied;
             length -= copied;
             if (uni_stream_ctx->current_object_offset >= uni_stream_ctx->current_object_length) {
@@ -1975,7 +2663,23 @@ int quicrq_receive_warp_or_rush_stream_data(quicrq_cnx_ctx_t* cnx_ctx, quicrq_un
 
                         switch (incoming.message_type) {
                         case QUICRQ_ACTION_WARP_HEADER:
-                            if (uni_stream_ctx->receive_state != quicrq_receive_open) {
+                            if (uni_stream_ctx->receive_state == quicrq_receive_object_header &&
+                                uni_stream_ctx->control_stream_ctx != NULL &&
+                                uni_stream_ctx->control_stream_ctx->transport_mode == quicrq_transport_mode_rush) {
+                                /* Packed rush stream, continuing with the first object of the next group */
+                                if (incoming.media_id != uni_stream_ctx->control_stream_ctx->media_id ||
+                                    incoming.group_id <= uni_stream_ctx->current_group_id) {
+                                    /* The peer is misbehaving */
+                                    DBG_PRINTF("Unexpected group in rush stream: %" PRIu64, incoming.group_id);
+                                    ret = -1;
+                                }
+                                else {
+                                    uni_stream_ctx->current_group_id = incoming.group_id;
+                                    uni_stream_ctx->current_object_id = 0;
+                                    uni_stream_ctx->receive_state = quicrq_receive_warp_header;
+                                }
+                            }
+                            else if (uni_stream_ctx->receive_state != quicrq_receive_open) {
                                 /* Protocol error */
                                 ret = -1;
                             }
@@ -2012,7 +2716,8 @@ int quicrq_receive_warp_or_rush_stream_data(quicrq_cnx_ctx_t* cnx_ctx, quicrq_un
                             }
                             else if (
                                 (uni_stream_ctx->control_stream_ctx->transport_mode == quicrq_transport_mode_rush &&
-                                    uni_stream_ctx->current_object_id != 0) ||
+                                    uni_stream_ctx->current_object_id != 0 &&
+                                    uni_stream_ctx->current_object_id != incoming.object_id) ||
                                 (uni_stream_ctx->control_stream_ctx->transport_mode == quicrq_transport_mode_warp &&
                                 uni_stream_ctx->current_object_id != incoming.object_id )) {
                                 /* The peer is misbehaving */
@@ -2024,6 +2729,7 @@ int quicrq_receive_warp_or_rush_stream_data(quicrq_cnx_ctx_t* cnx_ctx, quicrq_un
                                 uni_stream_ctx->current_object_id = incoming.object_id;
                                 uni_stream_ctx->current_object_length = incoming.object_length;
                                 uni_stream_ctx->current_object_flags = incoming.flags;
+                                uni_stream_ctx->current_object_origin_timestamp = incoming.origin_timestamp;
                                 uni_stream_ctx->nb_objects_previous_group = incoming.nb_objects_previous_group;
                                 uni_stream_ctx->current_object_offset = 0;
                             }
@@ -2035,9 +2741,9 @@ int quicrq_receive_warp_or_rush_stream_data(quicrq_cnx_ctx_t* cnx_ctx, quicrq_un
                                 /* Pass the empty data to the media consumer. */
                                 ret = ctrl_stream_ctx->consumer_fn(quicrq_media_datagram_ready, ctrl_stream_ctx->media_ctx, picoquic_get_quic_time(ctrl_stream_ctx->cnx_ctx->qr_ctx->quic),
                                     incoming.data, uni_stream_ctx->current_group_id, incoming.object_id,
-                                    0, 0, incoming.flags, incoming.nb_objects_previous_group, 0, 0);
+                                    0, 0, incoming.flags, incoming.nb_objects_previous_group, 0, incoming.origin_timestamp, 0);
                                 /* Increment predicted object ID to enable checks */
-                                uni_stream_ctx->current_object_id += 1;
+                                uni_stream_ctx->current_object_id = incoming.object_id + 1;
                                 if (ret == quicrq_consumer_finished) {
                                     ret = quicrq_cnx_handle_consumer_finished(ctrl_stream_ctx, 0, 1, ret);
                                 }
@@ -2184,7 +2890,14 @@ int quicrq_callback(picoquic_cnx_t* cnx,
         }
         case picoquic_callback_stream_reset: /* Client reset stream #x */
         case picoquic_callback_stop_sending: /* Client asks server to reset stream #x */
-            /* TODO: react to abandon stream, etc. */
+            if (uni_stream_ctx != NULL) {
+                /* The uni stream is abandoned. Release its context now, so the lists
+                 * of uni streams only contain the streams in progress. If this node is the sender,
+                 * the deletion also resets the stream. */
+                quicrq_log_message(cnx_ctx, "UniStream %" PRIu64 ", abandoned, event %d", stream_id, fin_or_event);
+                quicrq_delete_uni_stream_ctx(cnx_ctx, uni_stream_ctx);
+            }
+            /* TODO: react to abandon of control stream, etc. */
             break;
         case picoquic_callback_stateless_reset: /* Received an error message */
         case picoquic_callback_close: /* Received connection close */
@@ -2328,6 +3041,53 @@ void quicrq_set_cache_duration(quicrq_ctx_t* qr_ctx, uint64_t cache_duration_max
     qr_ctx->cache_duration_max = cache_duration_max;
 }
 
+void quicrq_set_subscription_watchdog(quicrq_ctx_t* qr_ctx, uint64_t stall_time_max, uint64_t lag_groups_max)
+{
+    qr_ctx->watchdog_stall_time_max = stall_time_max;
+    qr_ctx->watchdog_lag_groups_max = lag_groups_max;
+    qr_ctx->watchdog_next_time = 0;
+}
+
+uint64_t quicrq_get_nb_stalled_subscriptions(quicrq_ctx_t* qr_ctx)
+{
+    return qr_ctx->nb_stalled_subscriptions;
+}
+
+/* Check the progress of all the media streams sent from this context,
+ * and abort the subscriptions that are stalled. Aborting resets the
+ * control stream and deletes the stream context, which releases the
+ * publisher context, the datagram acknowledgement state and the uni streams,
+ * and lets the cache purge the data that the stream was pinning.
+ */
+static void quicrq_check_subscription_watchdog(quicrq_ctx_t* qr_ctx, uint64_t current_time)
+{
+    quicrq_cnx_ctx_t* cnx_ctx = qr_ctx->first_cnx;
+
+    while (cnx_ctx != NULL) {
+        quicrq_stream_ctx_t* stream_ctx = cnx_ctx->first_stream;
+
+        while (stream_ctx != NULL) {
+            quicrq_stream_ctx_t* next_stream_ctx = stream_ctx->next_stream;
+
+            if (stream_ctx->is_sender && stream_ctx->media_ctx != NULL &&
+                quicrq_fragment_publisher_is_stalled(stream_ctx, current_time,
+                    qr_ctx->watchdog_stall_time_max, qr_ctx->watchdog_lag_groups_max)) {
+                quicrq_log_message(cnx_ctx, "Stream %" PRIu64 " stalled at %" PRIu64 "/%" PRIu64 ", aborting subscription",
+                    stream_ctx->stream_id, stream_ctx->watchdog_group_id, stream_ctx->watchdog_object_id);
+                qr_ctx->nb_stalled_subscriptions++;
+                stream_ctx->close_reason = quicrq_media_close_local_application;
+                stream_ctx->close_error_code = QUICRQ_ERROR_STALLED;
+                if (cnx_ctx->cnx != NULL) {
+                    (void)picoquic_reset_stream(cnx_ctx->cnx, stream_ctx->stream_id, QUICRQ_ERROR_STALLED);
+                }
+                quicrq_delete_stream_ctx(cnx_ctx, stream_ctx);
+            }
+            stream_ctx = next_stream_ctx;
+        }
+        cnx_ctx = cnx_ctx->next_cnx;
+    }
+}
+
 uint64_t quicrq_time_check(quicrq_ctx_t* qr_ctx, uint64_t current_time)
 {
     uint64_t next_time = UINT64_MAX;
@@ -2341,6 +3101,29 @@ uint64_t quicrq_time_check(quicrq_ctx_t* qr_ctx, uint64_t current_time)
         next_time = quic_time;
     }
 
+    if (qr_ctx->watchdog_stall_time_max > 0 || qr_ctx->watchdog_lag_groups_max > 0) {
+        if (current_time >= qr_ctx->watchdog_next_time) {
+            quicrq_check_subscription_watchdog(qr_ctx, current_time);
+            qr_ctx->watchdog_next_time = current_time + ((qr_ctx->watchdog_stall_time_max > 0) ?
+                qr_ctx->watchdog_stall_time_max / 4 : QUICRQ_WATCHDOG_CHECK_INTERVAL);
+        }
+        if (qr_ctx->watchdog_next_time < next_time) {
+            next_time = qr_ctx->watchdog_next_time;
+        }
+    }
+
+    if (qr_ctx->first_repair_deadline != NULL) {
+        uint64_t repair_time = quicrq_fragment_check_repair_deadlines(qr_ctx, current_time);
+        if (repair_time < next_time) {
+            next_time = repair_time;
+        }
+    }
+
+    if (qr_ctx->first_retired_publisher != NULL) {
+        /* Batch teardown of the publishers closed since the last check */
+        quicrq_fragment_publisher_reap(qr_ctx);
+    }
+
     if (qr_ctx->manage_relay_cache_fn != NULL) {
         int should_manage = qr_ctx->is_cache_closing_needed;
         if (qr_ctx->cache_duration_max > 0) {
@@ -2407,6 +3190,26 @@ void quicrq_delete(quicrq_ctx_t* qr_ctx)
 
     quicrq_disable_relay(qr_ctx);
 
+    while (qr_ctx->first_congestion_weight != NULL) {
+        quicrq_congestion_weight_t* weight_next = qr_ctx->first_congestion_weight->next_weight;
+        free(qr_ctx->first_congestion_weight);
+        qr_ctx->first_congestion_weight = weight_next;
+    }
+
+    while (qr_ctx->first_repair_deadline != NULL) {
+        quicrq_repair_deadline_t* deadline_next = qr_ctx->first_repair_deadline->next_deadline;
+        free(qr_ctx->first_repair_deadline);
+        qr_ctx->first_repair_deadline = deadline_next;
+    }
+
+    /* Release the pooled contexts */
+    quicrq_fragment_publisher_pool_release(qr_ctx);
+    while (qr_ctx->first_free_stream != NULL) {
+        quicrq_stream_ctx_t* stream_next = qr_ctx->first_free_stream->next_stream;
+        free(qr_ctx->first_free_stream);
+        qr_ctx->first_free_stream = stream_next;
+    }
+
     free(qr_ctx);
 }
 
@@ -2419,6 +3222,7 @@ quicrq_ctx_t* quicrq_create_empty()
 
     if (qr_ctx != NULL) {
         memset(qr_ctx, 0, sizeof(quicrq_ctx_t));
+        qr_ctx->context_pool_max = QUICRQ_CONTEXT_POOL_MAX;
     }
     return qr_ctx;
 }
@@ -2570,6 +3374,11 @@ quicrq_cnx_ctx_t* quicrq_first_connection(quicrq_ctx_t* qr_ctx)
     return qr_ctx->first_cnx;
 }
 
+quicrq_cnx_ctx_t* quicrq_next_connection(quicrq_cnx_ctx_t* cnx_ctx)
+{
+    return cnx_ctx->next_cnx;
+}
+
 void quicrq_delete_uni_stream_ctx(quicrq_cnx_ctx_t* cnx_ctx, quicrq_uni_stream_ctx_t* uni_stream_ctx)
 {
     quicrq_stream_ctx_t* ctrl_stream = uni_stream_ctx->control_stream_ctx;
@@ -2603,6 +3412,9 @@ void quicrq_delete_uni_stream_ctx(quicrq_cnx_ctx_t* cnx_ctx, quicrq_uni_stream_c
             uni_stream_ctx->previous_uni_stream_for_control_stream->next_uni_stream_for_control_stream = 
                 uni_stream_ctx->next_uni_stream_for_control_stream;
         }
+        if (ctrl_stream->rush_pack_uni_stream == uni_stream_ctx) {
+            ctrl_stream->rush_pack_uni_stream = NULL;
+        }
         uni_stream_ctx->control_stream_ctx = NULL;
     }
     /* Unlink the unistream context from the picoquic stream context */
@@ -2669,7 +3481,7 @@ void quicrq_delete_stream_ctx(quicrq_cnx_ctx_t* cnx_ctx, quicrq_stream_ctx_t* st
         }
         else {
             if (stream_ctx->consumer_fn != NULL) {
-                stream_ctx->consumer_fn(quicrq_media_close, stream_ctx->media_ctx, current_time, NULL, 0, 0, 0, 0, 0, 0, stream_ctx->close_reason, stream_ctx->close_error_code);
+                stream_ctx->consumer_fn(quicrq_media_close, stream_ctx->media_ctx, current_time, NULL, 0, 0, 0, 0, 0, 0, stream_ctx->close_reason, 0, stream_ctx->close_error_code);
             }
         }
     }
@@ -2677,12 +3489,28 @@ void quicrq_delete_stream_ctx(quicrq_cnx_ctx_t* cnx_ctx, quicrq_stream_ctx_t* st
     quicrq_msg_buffer_release(&stream_ctx->message_receive);
     quicrq_msg_buffer_release(&stream_ctx->message_sent);
 
-    free(stream_ctx);
+    /* Keep the context in the pool of the quicrq context, for reuse by the next subscription */
+    if (cnx_ctx->qr_ctx->nb_free_streams < cnx_ctx->qr_ctx->context_pool_max) {
+        stream_ctx->next_stream = cnx_ctx->qr_ctx->first_free_stream;
+        cnx_ctx->qr_ctx->first_free_stream = stream_ctx;
+        cnx_ctx->qr_ctx->nb_free_streams++;
+    }
+    else {
+        free(stream_ctx);
+    }
 }
 
 quicrq_stream_ctx_t* quicrq_create_stream_context(quicrq_cnx_ctx_t* cnx_ctx, uint64_t stream_id)
 {
-    quicrq_stream_ctx_t* stream_ctx = (quicrq_stream_ctx_t*)malloc(sizeof(quicrq_stream_ctx_t));
+    quicrq_stream_ctx_t* stream_ctx = cnx_ctx->qr_ctx->first_free_stream;
+
+    if (stream_ctx != NULL) {
+        cnx_ctx->qr_ctx->first_free_stream = stream_ctx->next_stream;
+        cnx_ctx->qr_ctx->nb_free_streams--;
+    }
+    else {
+        stream_ctx = (quicrq_stream_ctx_t*)malloc(sizeof(quicrq_stream_ctx_t));
+    }
     if (stream_ctx != NULL) {
         memset(stream_ctx, 0, sizeof(quicrq_stream_ctx_t));
         stream_ctx->cnx_ctx = cnx_ctx;
@@ -2785,6 +3613,126 @@ int quicrq_cnx_has_stream(quicrq_cnx_ctx_t* cnx_ctx)
     return (cnx_ctx->first_stream != NULL);
 }
 
+/* Statistics of media streams.
+ * The position of a sending stream depends on the transport mode: the
+ * current object of the publisher in stream mode, the current fragment
+ * in datagram mode, and the oldest open unidirectional stream in warp
+ * or rush mode.
+ */
+static void quicrq_stream_get_send_position(quicrq_stream_ctx_t* stream_ctx, uint64_t* group_id, uint64_t* object_id)
+{
+    quicrq_fragment_publisher_context_t* media_ctx = stream_ctx->media_ctx;
+
+    switch (stream_ctx->transport_mode) {
+    case quicrq_transport_mode_datagram:
+        if (media_ctx->current_fragment != NULL) {
+            *group_id = media_ctx->current_fragment->group_id;
+            *object_id = media_ctx->current_fragment->object_id;
+        }
+        else {
+            *group_id = media_ctx->cache_ctx->first_group_id;
+            *object_id = media_ctx->cache_ctx->first_object_id;
+        }
+        break;
+    case quicrq_transport_mode_warp:
+    case quicrq_transport_mode_rush:
+        if (stream_ctx->first_uni_stream != NULL) {
+            *group_id = stream_ctx->first_uni_stream->current_group_id;
+            *object_id = stream_ctx->first_uni_stream->current_object_id;
+        }
+        else {
+            *group_id = stream_ctx->next_warp_group_id;
+            *object_id = 0;
+        }
+        break;
+    default:
+        *group_id = media_ctx->current_group_id;
+        *object_id = media_ctx->current_object_id;
+        break;
+    }
+}
+
+static uint64_t quicrq_stream_get_lag_objects(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id)
+{
+    const uint64_t nb_groups_max = 16;
+    uint64_t lag = 0;
+
+    if (group_id == cache_ctx->next_group_id) {
+        if (object_id < cache_ctx->next_object_id) {
+            lag = cache_ctx->next_object_id - object_id;
+        }
+    }
+    else if (group_id < cache_ctx->next_group_id) {
+        uint64_t nb_objects = quicrq_fragment_get_object_count(cache_ctx, group_id);
+
+        if (nb_objects > object_id) {
+            lag = nb_objects - object_id;
+        }
+        for (uint64_t i = 1; i < nb_groups_max && group_id + i < cache_ctx->next_group_id; i++) {
+            lag += quicrq_fragment_get_object_count(cache_ctx, group_id + i);
+        }
+        if (group_id + nb_groups_max >= cache_ctx->next_group_id) {
+            lag += cache_ctx->next_object_id;
+        }
+    }
+    return lag;
+}
+
+int quicrq_cnx_get_stream_statistics(quicrq_cnx_ctx_t* cnx_ctx, quicrq_stream_statistics_t* stats, size_t stats_max,
+    size_t* nb_stats, uint64_t current_time)
+{
+    quicrq_stream_ctx_t* stream_ctx = cnx_ctx->first_stream;
+    size_t nb = 0;
+
+    while (stream_ctx != NULL) {
+        if (stream_ctx->subscribe_prefix == NULL) {
+            if (nb < stats_max) {
+                quicrq_stream_statistics_t* s = &stats[nb];
+                memset(s, 0, sizeof(quicrq_stream_statistics_t));
+                s->stream_id = stream_ctx->stream_id;
+                s->transport_mode = stream_ctx->transport_mode;
+                s->is_sender = stream_ctx->is_sender;
+                if (stream_ctx->media_source != NULL) {
+                    s->url = stream_ctx->media_source->media_url;
+                    s->url_length = stream_ctx->media_source->media_url_length;
+                }
+                s->nb_objects_skipped = stream_ctx->nb_objects_skipped;
+                s->nb_extra_sent = (uint64_t)stream_ctx->nb_extra_sent;
+                s->nb_fragment_lost = (uint64_t)stream_ctx->nb_fragment_lost;
+                s->nb_datagram_ack_pending = (uint64_t)stream_ctx->datagram_ack_tree.size;
+                s->bytes_sent = stream_ctx->nb_bytes_sent;
+                s->nb_datagrams_sent = stream_ctx->nb_datagrams_sent;
+                s->datagram_header_bytes = stream_ctx->datagram_header_bytes;
+                s->nb_groups_abandoned = stream_ctx->nb_groups_abandoned;
+                if (stream_ctx->nb_first_byte_samples > 0) {
+                    s->first_byte_latency_average = stream_ctx->first_byte_latency_sum / stream_ctx->nb_first_byte_samples;
+                    s->first_byte_latency_max = stream_ctx->first_byte_latency_max;
+                }
+                if (stream_ctx->is_sender && stream_ctx->media_ctx != NULL) {
+                    quicrq_fragment_cache_t* cache_ctx = stream_ctx->media_ctx->cache_ctx;
+                    quicrq_cached_fragment_t* fragment;
+
+                    quicrq_stream_get_send_position(stream_ctx, &s->current_group_id, &s->current_object_id);
+                    s->cache_next_group_id = cache_ctx->next_group_id;
+                    s->cache_next_object_id = cache_ctx->next_object_id;
+                    s->lag_objects = quicrq_stream_get_lag_objects(cache_ctx, s->current_group_id, s->current_object_id);
+                    if (s->lag_objects > 0) {
+                        fragment = quicrq_fragment_cache_get_fragment(cache_ctx, s->current_group_id, s->current_object_id, 0);
+                        if (fragment != NULL && current_time > fragment->cache_time) {
+                            s->lag_time = current_time - fragment->cache_time;
+                        }
+                    }
+                }
+            }
+            nb++;
+        }
+        stream_ctx = stream_ctx->next_stream;
+    }
+    *nb_stats = nb;
+
+    return 0;
+}
+
 int quicrq_close_cnx(quicrq_cnx_ctx_t* cnx_ctx)
 {
     int ret = 0;
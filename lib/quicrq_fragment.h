@@ -15,6 +15,19 @@
 extern "C" {
 #endif
 
+/* Cached fragments.
+ * Contiguous fragments of the same object that arrive in order are coalesced
+ * in a single extent: the space for the rest of the object is reserved when
+ * the first fragment of the object is cached, and the next fragments are
+ * appended to the extent as long as it is the last fragment received.
+ * For streamed objects, whose length is only known when the final fragment
+ * arrives, the extent is grown geometrically up to QUICRQ_FRAGMENT_EXTENT_MAX.
+ * The fragment header does not move, so pointers to it remain valid, but the
+ * data may be reallocated. Readers must always use the current values of
+ * data and data_length. Fragments received out of order are cached separately.
+ */
+#define QUICRQ_FRAGMENT_EXTENT_MAX 0x100000
+
 typedef struct st_quicrq_cached_fragment_t {
     picosplay_node_t fragment_node;
     uint64_t group_id;
@@ -24,13 +37,40 @@ typedef struct st_quicrq_cached_fragment_t {
     uint64_t queue_delay;
     uint64_t nb_objects_previous_group;
     uint8_t flags;
+    quicrq_object_dependency_enum dependency; /* Only known at the publishing node */
     uint64_t object_length;
+    uint64_t origin_timestamp; /* Capture time set by the origin, only present in first fragment, 0 if unknown */
     struct st_quicrq_cached_fragment_t* previous_in_order;
     struct st_quicrq_cached_fragment_t* next_in_order;
     size_t data_length;
+    size_t data_alloc; /* space allocated for data, data_length <= data_alloc */
     uint8_t* data;
 } quicrq_cached_fragment_t;
 
+/* Group start time index.
+ * An entry is added each time the first fragment of a new group is added to the cache,
+ * documenting the start time of that group: the origin timestamp of its first object
+ * if the origin set one, or the cache time otherwise. Since groups are only indexed
+ * in increasing order of both group and time, the index can be used to find
+ * the group that was current at a given time.
+ */
+typedef struct st_quicrq_group_time_t {
+    picosplay_node_t group_time_node;
+    uint64_t start_time;
+    uint64_t group_id;
+} quicrq_group_time_t;
+
+/* Objects skipped after their repair deadline.
+ * Objects are skipped in order at the in sequence point of the cache, so
+ * the list is ordered by group_id/object_id.
+ */
+typedef struct st_quicrq_repair_skip_t {
+    struct st_quicrq_repair_skip_t* next_skip;
+    uint64_t group_id;
+    uint64_t object_id;
+    uint64_t nb_objects_previous_group; /* Only set if object_id is 0 */
+} quicrq_repair_skip_t;
+
 typedef struct st_quicrq_fragment_cache_t {
     quicrq_media_source_ctx_t* srce_ctx; /* Back pointer to source context */
     quicrq_ctx_t* qr_ctx; /* back pointer to quicrq context */
@@ -48,9 +88,17 @@ typedef struct st_quicrq_fragment_cache_t {
     quicrq_cached_fragment_t* first_fragment; /* Fragments in order of arrival */
     quicrq_cached_fragment_t* last_fragment;
     picosplay_tree_t fragment_tree; /* Splay ordered by group_id/object_id/offset */
+    picosplay_tree_t group_time_tree; /* Splay ordered by group start time, see quicrq_group_time_t */
     uint8_t lowest_flags;
     int is_feed_closed; /* Whether the data providing connection is closed. */
+    int nb_feeds; /* Number of streams providing data, more than one if redundant ingests */
+    uint64_t nb_duplicate_fragments; /* For statistics only */
+    uint64_t nb_fragments_deleted; /* Invalidates the read cursors, see quicrq_fragment_cursor_seek */
+    uint64_t nb_cursor_lookups; /* For statistics only */
     uint64_t cache_delete_time;
+    quicrq_repair_skip_t* first_repair_skip; /* Objects skipped after the repair deadline */
+    quicrq_repair_skip_t* last_repair_skip;
+    uint64_t nb_repair_skipped; /* For statistics only */
 } quicrq_fragment_cache_t;
 
 typedef struct st_quicrq_fragment_publisher_object_state_t {
@@ -72,6 +120,9 @@ typedef struct st_quicrq_fragment_publisher_context_t {
     size_t current_offset;
     quicrq_congestion_control_enum congestion_control_mode;
     uint64_t end_of_congestion_group_id;
+    /* Dependency chain: set if a non leaf object of dependency_group_id was skipped */
+    uint64_t dependency_group_id;
+    int is_dependency_broken;
     int is_object_complete;
     int is_media_complete;
     int is_sending_object;
@@ -82,13 +133,39 @@ typedef struct st_quicrq_fragment_publisher_context_t {
     uint64_t length_sent;
     int is_current_fragment_sent;
     picosplay_tree_t publisher_object_tree;
+    /* Bulk fetch of a range: no congestion skipping, end at fetch_end_group_id/fetch_end_object_id. */
+    int is_fetch;
+    uint64_t fetch_end_group_id;
+    uint64_t fetch_end_object_id;
+    /* Position of the in order reads in the cache, for stream publishers */
+    quicrq_fragment_cursor_t read_cursor;
+    /* Datagram split policy: largest datagram space seen so far, and whether
+     * the split of the current fragment was already deferred once. */
+    size_t datagram_space_max;
+    int is_split_deferred;
+    /* Link in the retired or free lists of the quicrq context, once closed */
+    struct st_quicrq_fragment_publisher_context_t* next_in_pool;
 } quicrq_fragment_publisher_context_t;
 
 void* quicrq_fragment_cache_node_value(picosplay_node_t* fragment_node);
 
+int quicrq_fragment_cache_copy_range(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id,
+    uint64_t offset, uint8_t* data, size_t length);
 quicrq_cached_fragment_t* quicrq_fragment_cache_get_fragment(quicrq_fragment_cache_t* cached_ctx,
     uint64_t group_id, uint64_t object_id, uint64_t offset);
 
+/* Find the fragment that contains the specified offset, which may be
+ * in the middle of a coalesced extent. */
+quicrq_cached_fragment_t* quicrq_fragment_cache_find_fragment_at(quicrq_fragment_cache_t* cached_ctx,
+    uint64_t group_id, uint64_t object_id, uint64_t offset);
+
+/* Same as quicrq_fragment_cache_find_fragment_at, but for readers that progress in order.
+ * The fragment under the cursor or the next one in the cache is tried first, and the
+ * cache is only searched if neither matches or if fragments were deleted since the
+ * cursor was set. The cursor is set to the fragment found. */
+quicrq_cached_fragment_t* quicrq_fragment_cursor_seek(quicrq_fragment_cache_t* cache_ctx, quicrq_fragment_cursor_t* cursor,
+    uint64_t group_id, uint64_t object_id, uint64_t offset);
+
 void quicrq_fragment_cache_media_clear(quicrq_fragment_cache_t* cached_media);
 
 void quicrq_fragment_cache_media_init(quicrq_fragment_cache_t* cached_media);
@@ -108,6 +185,7 @@ int quicrq_fragment_add_to_cache(quicrq_fragment_cache_t* cached_ctx,
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length,
     uint64_t current_time);
 
@@ -120,6 +198,7 @@ int quicrq_fragment_propose_to_cache(quicrq_fragment_cache_t* cached_ctx,
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length,
     uint64_t current_time);
 
@@ -130,6 +209,27 @@ int quicrq_fragment_cache_learn_end_point(quicrq_fragment_cache_t* cached_ctx, u
 
 int quicrq_fragment_cache_set_real_time_cache(quicrq_fragment_cache_t* cached_ctx);
 
+/* Repair deadline.
+ * If the object at the in sequence point of the cache is missing while a later fragment
+ * was received more than "deadline" ago, the object is added to the list of repair skips,
+ * and the in sequence point moves past it. The in order publishers skip these objects.
+ * Fragments of the object that arrive later are still added to the cache.
+ * Returns the next time at which a deadline may expire, or UINT64_MAX.
+ */
+uint64_t quicrq_fragment_cache_check_repair_deadline(quicrq_fragment_cache_t* cache_ctx, uint64_t deadline, uint64_t current_time);
+
+/* Check the repair deadlines of all the media sources with a configured deadline */
+uint64_t quicrq_fragment_check_repair_deadlines(quicrq_ctx_t* qr_ctx, uint64_t current_time);
+
+/* Find whether an object was skipped after its repair deadline */
+quicrq_repair_skip_t* quicrq_fragment_cache_get_repair_skip(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id);
+
+/* Find the group that was current at the specified time, i.e., the last group
+ * that started at or before that time, or the first group in the cache if
+ * the time is older than that. Returns -1 if no group is indexed yet.
+ */
+int quicrq_fragment_cache_seek_time(quicrq_fragment_cache_t* cached_ctx, uint64_t start_time, uint64_t* group_id);
+
 /* Purging old fragments from the cache. 
  * This should only be done for caches of type "real time".
  * - Compute the first kept GOB.
@@ -139,6 +239,16 @@ int quicrq_fragment_cache_set_real_time_cache(quicrq_fragment_cache_t* cached_ct
 void quicrq_fragment_cache_media_purge_to_gob(
     quicrq_media_source_ctx_t* srce_ctx);
 
+/* Pass through purge, for real time sources read by a single publisher.
+ * - Compute the release point of that publisher: objects already sent and,
+ *   in datagram mode, acknowledged.
+ * - Delete all objects before the release point.
+ * Returns 0 without purging if the source is not real time, or if it
+ * has zero or several readers. The caller then falls back to the GOB purge.
+ */
+int quicrq_fragment_cache_media_purge_pass_through(
+    quicrq_media_source_ctx_t* srce_ctx);
+
 /* Purging the old fragments from the cache.
  * There are two modes of operation.
  * In the general case, we want to make sure that all data has a chance of being
@@ -205,6 +315,8 @@ int quicrq_fragment_publisher_fn(
 
 int quicrq_fragment_is_ready_to_send(void* v_media_ctx, size_t data_max_size, uint64_t current_time);
 
+void quicrq_fragment_publisher_skip_to_start_point(quicrq_stream_ctx_t* stream_ctx);
+
 /* datagram_publisher_check_object:
  * evaluate and if necessary progress the "current fragment" pointer.
  * After this evaluation, expect the following results:
@@ -276,10 +388,28 @@ uint64_t quicrq_fragment_get_object_count(quicrq_fragment_cache_t* cache_ctx, ui
 
 uint8_t quicrq_fragment_get_flags(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id);
 
+uint64_t quicrq_fragment_get_origin_timestamp(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id);
+
+uint64_t quicrq_fragment_get_cache_time(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id);
+
+/* Check whether the publisher of a stream is stalled, i.e., has not moved its
+ * release point for more than stall_time_max while data was waiting in the cache,
+ * or lags more than lag_groups_max groups behind the latest group of a real time cache.
+ * A zero threshold disables the corresponding test.
+ */
+int quicrq_fragment_publisher_is_stalled(quicrq_stream_ctx_t* stream_ctx, uint64_t current_time,
+    uint64_t stall_time_max, uint64_t lag_groups_max);
+
+quicrq_object_dependency_enum quicrq_fragment_get_dependency(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id);
+
 int quicrq_fragment_get_object_properties(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id,
     size_t* object_length, uint64_t* nb_objects_previous_group, uint8_t* flags);
 
-size_t quicrq_fragment_object_copy_available_data(quicrq_fragment_cache_t* cache_ctx,
+/* Copy the data of an object available in sequence from the offset, up to "available" bytes.
+ * If "buffer" is NULL, only return the size. If a cursor is provided, the lookup starts
+ * from it, and the cursor is advanced when the data is copied.
+ */
+size_t quicrq_fragment_object_copy_available_data(quicrq_fragment_cache_t* cache_ctx, quicrq_fragment_cursor_t* cursor,
     uint64_t group_id, uint64_t object_id, size_t offset, size_t available, uint8_t* buffer);
 
 size_t quicrq_fragment_object_copy(quicrq_fragment_cache_t* cache_ctx, uint64_t group_id, uint64_t object_id, uint64_t* nb_objects_previous_group, uint8_t* flags, uint8_t* buffer);
@@ -288,6 +418,10 @@ void* quicrq_fragment_publisher_subscribe(quicrq_fragment_cache_t* cache_ctx, qu
 
 void quicrq_fragment_publisher_delete(void* v_pub_ctx);
 
+void quicrq_fragment_publisher_reap(quicrq_ctx_t* qr_ctx);
+
+void quicrq_fragment_publisher_pool_release(quicrq_ctx_t* qr_ctx);
+
 /* Fragment cache media publish */
 int quicrq_publish_fragment_cached_media(quicrq_ctx_t* qr_ctx,
     quicrq_fragment_cache_t* cache_ctx, const uint8_t* url, const size_t url_length,
@@ -303,6 +437,10 @@ int quicrq_evaluate_warp_congestion(quicrq_uni_stream_ctx_t* uni_stream_ctx, qui
 /* Evaluation of congestion in datagram mode */
 int quicrq_evaluate_datagram_congestion(quicrq_stream_ctx_t* stream_ctx, quicrq_fragment_publisher_context_t* media_ctx, uint64_t current_time);
 
+/* Skip objects that depend on a skipped object */
+int quicrq_evaluate_dependency(uint64_t* dependency_group_id, int* is_dependency_broken, uint64_t group_id,
+    quicrq_object_dependency_enum dependency, int should_skip);
+
 #ifdef __cplusplus
 }
 #endif
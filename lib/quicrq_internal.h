@@ -31,6 +31,8 @@ extern "C" {
 #endif
 
 #define QUICRQ_MAX_CONNECTIONS 256
+#define QUICRQ_WATCHDOG_CHECK_INTERVAL 100000
+#define QUICRQ_CONTEXT_POOL_MAX 64
 
 /* Implementation of the quicrq application on top of picoquic. 
  * 
@@ -93,6 +95,10 @@ typedef struct st_quicrq_message_t {
     quicrq_transport_mode_enum transport_mode;
     uint8_t cache_policy;
     quicrq_subscribe_intent_enum subscribe_intent;
+    uint64_t start_time;
+    uint64_t end_group_id;
+    uint64_t end_object_id;
+    uint64_t origin_timestamp;
 } quicrq_message_t;
 
 /* Encode and decode protocol messages
@@ -122,10 +128,10 @@ const uint8_t* quicrq_notify_msg_decode(const uint8_t* bytes, const uint8_t* byt
 size_t quicrq_rq_msg_reserve(size_t url_length, quicrq_subscribe_intent_enum intent_mode);
 uint8_t* quicrq_rq_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, size_t url_length, const uint8_t* url,
     uint64_t media_id, quicrq_transport_mode_enum transport_mode, quicrq_subscribe_intent_enum intent_mode,
-    uint64_t start_group_id, uint64_t start_object_id);
+    uint64_t start_group_id, uint64_t start_object_id, uint64_t start_time, uint64_t end_group_id, uint64_t end_object_id);
 const uint8_t* quicrq_rq_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type, size_t* url_length, const uint8_t** url,
     uint64_t* media_id, quicrq_transport_mode_enum* transport_mode, quicrq_subscribe_intent_enum* intent_mode,
-    uint64_t* start_group_id, uint64_t* start_object_id);
+    uint64_t* start_group_id, uint64_t* start_object_id, uint64_t* start_time, uint64_t* end_group_id, uint64_t* end_object_id);
 size_t quicrq_post_msg_reserve(size_t url_length);
 uint8_t* quicrq_post_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, size_t url_length, 
     const uint8_t* url, quicrq_transport_mode_enum transport_mode, uint8_t cache_policy,
@@ -140,13 +146,13 @@ const uint8_t* quicrq_fin_msg_decode(const uint8_t* bytes, const uint8_t* bytes_
     uint64_t* message_type, uint64_t* final_group_id, uint64_t* final_object_id);
 size_t quicrq_fragment_msg_reserve(uint64_t group_id, uint64_t object_id, 
     uint64_t nb_objects_previous_group,
-    uint64_t offset, uint64_t object_length, size_t data_length);
+    uint64_t offset, uint64_t object_length, uint64_t origin_timestamp, size_t data_length);
 uint8_t* quicrq_fragment_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type,
     uint64_t group_id, uint64_t object_id, uint64_t nb_objects_previous_group,
-    uint64_t offset, uint64_t object_length, uint8_t flags, size_t length, const uint8_t* data);
+    uint64_t offset, uint64_t object_length, uint64_t origin_timestamp, uint8_t flags, size_t length, const uint8_t* data);
 const uint8_t* quicrq_fragment_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type,
     uint64_t* group_id, uint64_t* object_id, uint64_t* nb_objects_previous_group,
-    uint64_t* offset, uint64_t* object_length, uint8_t* flags, size_t* length, const uint8_t** data);
+    uint64_t* offset, uint64_t* object_length, uint64_t* origin_timestamp, uint8_t* flags, size_t* length, const uint8_t** data);
 size_t quicrq_start_point_msg_reserve(uint64_t start_group, uint64_t start_object);
 uint8_t* quicrq_start_point_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, uint64_t start_group, uint64_t start_object);
 const uint8_t* quicrq_start_point_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type, uint64_t* start_group, uint64_t* start_object);
@@ -158,25 +164,43 @@ const uint8_t* quicrq_cache_policy_msg_decode(const uint8_t* bytes, const uint8_
 size_t quicrq_warp_header_msg_reserve(uint64_t media_id, uint64_t group_id);
 uint8_t* quicrq_warp_header_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, uint64_t media_id, uint64_t group_id);
 const uint8_t* quicrq_warp_header_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type, uint64_t* media_id, uint64_t* group_id);
-size_t quicrq_object_header_msg_reserve(uint64_t object_id, uint64_t nb_objects_previous_group, size_t data_length);
+size_t quicrq_object_header_msg_reserve(uint64_t object_id, uint64_t nb_objects_previous_group, size_t data_length, uint64_t origin_timestamp);
 uint8_t* quicrq_object_header_msg_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t message_type, uint64_t object_id,
-    uint64_t nb_objects_previous_group, uint8_t flags, size_t length);
+    uint64_t nb_objects_previous_group, uint8_t flags, size_t length, uint64_t origin_timestamp);
 const uint8_t* quicrq_object_header_msg_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* message_type,
-    uint64_t* object_id, uint64_t* nb_objects_previous_group, uint8_t* flags, size_t* length);
+    uint64_t* object_id, uint64_t* nb_objects_previous_group, uint8_t* flags, size_t* length, uint64_t* origin_timestamp);
 
 /* Encode and decode the header of datagram packets. */
-#define QUICRQ_DATAGRAM_HEADER_MAX 16
+#define QUICRQ_DATAGRAM_HEADER_MAX 32
 uint8_t* quicrq_datagram_header_encode(uint8_t* bytes, uint8_t* bytes_max, uint64_t media_id, uint64_t group_id, 
-    uint64_t object_id, uint64_t object_offset, uint64_t queue_delay, uint8_t flags, uint64_t nb_objects_previous_group, uint64_t object_length);
+    uint64_t object_id, uint64_t object_offset, uint64_t queue_delay, uint8_t flags, uint64_t nb_objects_previous_group, uint64_t object_length,
+    uint64_t origin_timestamp);
 const uint8_t* quicrq_datagram_header_decode(const uint8_t* bytes, const uint8_t* bytes_max, uint64_t* media_id, uint64_t* group_id,
-    uint64_t* object_id, uint64_t* object_offset, uint64_t *queue_delay, uint8_t * flags, uint64_t *nb_objects_previous_group, uint64_t* object_length);
-/* Stream header is indentical to repair message */
-#define QUICRQ_STREAM_HEADER_MAX 2+1+8+4+2
+    uint64_t* object_id, uint64_t* object_offset, uint64_t *queue_delay, uint8_t * flags, uint64_t *nb_objects_previous_group, uint64_t* object_length,
+    uint64_t* origin_timestamp);
+/* Datagrams carrying several fragments start with the bundle marker, an odd value
+ * that cannot be mistaken for the encoding of a media ID, followed by segments. */
+#define QUICRQ_DATAGRAM_BUNDLE_MARKER 1
+#define QUICRQ_DATAGRAM_BUNDLE_SEGMENT_MIN 32
+int quicrq_datagram_is_bundle(const uint8_t* bytes, size_t length);
+const uint8_t* quicrq_datagram_bundle_segment_decode(const uint8_t* bytes, const uint8_t* bytes_max, size_t* segment_length);
+/* Stream header is indentical to repair message. The buffer is sized for the worst case
+ * encoding: 2 bytes message length, then the message type, and the group id, object id,
+ * offset, object length (8 bytes if QUICRQ_OBJECT_LENGTH_UNKNOWN), flags, number of objects
+ * in the previous group, origin timestamp and data length. */
+#define QUICRQ_STREAM_HEADER_MAX (2 + 1 + 8 + 8 + 8 + 8 + 1 + 8 + 8 + 8)
 
 /* Initialize the tracking of a datagram after sending it in a stream context */
 int quicrq_datagram_ack_init(quicrq_stream_ctx_t* stream_ctx, uint64_t group_id, uint64_t object_id,
     uint64_t object_offset, uint8_t flags, uint64_t nb_objects_previous_group, const uint8_t* data, size_t length,
-    uint64_t queue_delay, uint64_t object_length, void** p_created_state, uint64_t current_time);
+    uint64_t queue_delay, uint64_t object_length, uint64_t origin_timestamp, void** p_created_state, uint64_t current_time);
+/* Obtain a buffer for sending a datagram, inside the current bundle if there is one */
+void* quicrq_provide_datagram_buffer(quicrq_stream_ctx_t* stream_ctx, void* context, size_t length);
+/* Document the delay between arrival in cache and sending of the first byte of an object */
+void quicrq_stream_first_byte_sent(quicrq_stream_ctx_t* stream_ctx, uint64_t cache_time, uint64_t current_time);
+/* Credit the extra repeat budget of a connection after sending a datagram */
+#define QUICRQ_EXTRA_REPEAT_CREDIT_MAX (16*PICOQUIC_MAX_PACKET_SIZE)
+void quicrq_extra_repeat_credit(quicrq_cnx_ctx_t* cnx_ctx, size_t length);
 
 /* Media publisher API.
  * This now only an internal API. 
@@ -252,6 +276,11 @@ struct st_quicrq_media_object_source_ctx_t {
     uint64_t next_group_id;
     uint64_t next_object_id;
     quicrq_media_object_source_properties_t properties;
+    /* Object being published in chunks, if any */
+    int is_object_open;
+    uint64_t open_offset;
+    uint64_t open_nb_objects_previous_group;
+    quicrq_media_object_properties_t open_properties;
 };
 
 
@@ -268,6 +297,10 @@ struct st_quicrq_media_source_ctx_t {
     struct st_quicrq_fragment_cache_t* cache_ctx;
     int is_local_object_source;
     int is_cache_real_time;
+    /* Rotation of the wake up order of the streams, advanced for each new object */
+    uint64_t wakeup_rotation;
+    uint64_t wakeup_group_id;
+    uint64_t wakeup_object_id;
 };
 
 quicrq_media_source_ctx_t* quicrq_find_local_media_source(quicrq_ctx_t* qr_ctx, const uint8_t* url, const size_t url_length);
@@ -275,6 +308,7 @@ int quicrq_subscribe_local_media(quicrq_stream_ctx_t* stream_ctx, const uint8_t*
 void quicrq_unsubscribe_local_media(quicrq_stream_ctx_t* stream_ctx);
 void quicrq_wakeup_media_stream(quicrq_stream_ctx_t* stream_ctx);
 void quicrq_wakeup_media_uni_stream(quicrq_stream_ctx_t* stream_ctx);
+void quicrq_warp_abandon_groups(quicrq_stream_ctx_t* stream_ctx, uint64_t start_group_id);
 
 /* Quic media consumer. Old definition, moved to internal only.
  * 
@@ -299,6 +333,7 @@ typedef int (*quicrq_media_consumer_fn)(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length);
 
 int quicrq_cnx_subscribe_media(quicrq_cnx_ctx_t* cnx_ctx,
@@ -375,17 +410,21 @@ typedef struct st_quicrq_datagram_ack_state_t {
     uint64_t queue_delay;
     uint8_t flags;
     uint64_t object_length;
+    uint64_t origin_timestamp;
     size_t length;
     int is_acked;
     int nack_received;
     /* Handling of extra repeat, i.e., poor man's FEC.
-     * Presence of extra data indicates an extra repeat is scheduled. 
+     * The payload of the repeat is read from the fragment cache when the
+     * repeat is sent. A copy is only kept in extra_data if the fragment
+     * was not found in the cache when the repeat was scheduled.
      * Length of extra_data is always equal to length of fragment.
      */
     struct st_quicrq_datagram_ack_state_t* extra_previous;
     struct st_quicrq_datagram_ack_state_t* extra_next;
     uint64_t extra_repeat_time;
     uint8_t* extra_data;
+    int is_extra_scheduled;
     int is_extra_queued;
     /* Start time is the time of the first transmission at this node */
     uint64_t start_time;
@@ -393,12 +432,50 @@ typedef struct st_quicrq_datagram_ack_state_t {
     uint64_t last_sent_time;
 } quicrq_datagram_ack_state_t;
 
+/* Oldest datagram fragment not yet acknowledged below the horizon, or NULL */
+quicrq_datagram_ack_state_t* quicrq_datagram_ack_first(quicrq_stream_ctx_t* stream_ctx);
+
 typedef struct st_quicrq_notify_url_t {
     struct st_quicrq_notify_url_t* next_notify_url;
     size_t url_len;
     uint8_t* url;
 } quicrq_notify_url_t;
 
+/* Per stream congestion state, used when congestion weights are set.
+ * The weight is resolved from the media URL the first time the stream
+ * is evaluated, and bytes_sent is reset at each share evaluation. */
+typedef struct st_quicrq_stream_congestion_state_t {
+    uint64_t weight;
+    uint64_t bytes_sent;
+    int has_backlog;
+    int is_over_share;
+} quicrq_stream_congestion_state_t;
+
+/* Congestion weights configured per media URL */
+typedef struct st_quicrq_congestion_weight_t {
+    struct st_quicrq_congestion_weight_t* next_weight;
+    uint64_t weight;
+    size_t url_length;
+    uint8_t* url;
+} quicrq_congestion_weight_t;
+
+/* Repair deadlines configured per media URL */
+typedef struct st_quicrq_repair_deadline_t {
+    struct st_quicrq_repair_deadline_t* next_deadline;
+    uint64_t deadline;
+    size_t url_length;
+    uint8_t* url;
+} quicrq_repair_deadline_t;
+
+/* Read cursor of an in order reader of a fragment cache: the last fragment read,
+ * and the number of fragments deleted from the cache when it was set. The cursor
+ * is only used if no fragment was deleted since, see quicrq_fragment_cursor_seek.
+ */
+typedef struct st_quicrq_fragment_cursor_t {
+    struct st_quicrq_cached_fragment_t* fragment;
+    uint64_t nb_fragments_deleted;
+} quicrq_fragment_cursor_t;
+
 /* Context representing unidirectional streams*/
 struct st_quicrq_uni_stream_ctx_t {
     struct st_quicrq_uni_stream_ctx_t* next_uni_stream_for_cnx;
@@ -414,12 +491,25 @@ struct st_quicrq_uni_stream_ctx_t {
     uint64_t current_object_length;
     size_t current_object_offset;
     uint8_t current_object_flags;
+    uint64_t current_object_origin_timestamp;
     uint64_t last_object_id; 
     uint64_t nb_objects_previous_group;
     uint8_t stream_priority;
+    quicrq_fragment_cursor_t read_cursor;
+    /* Dependency chain of the group sent on a warp stream, see quicrq_evaluate_dependency */
+    uint64_t dependency_group_id;
+    int is_dependency_broken;
+    /* Rush packing: time at which the packed stream was opened, bytes packed so far */
+    uint64_t rush_pack_start_time;
+    uint64_t rush_pack_bytes;
     /* UniStream state */
     quicrq_uni_stream_sending_state_enum send_state;
     quicrq_uni_stream_receive_state_enum receive_state;
+    /* is_waiting_for_data: the stream was marked inactive, and needs a wakeup when data arrives.
+     * is_rush_pack_open: more small objects may be appended to this rush stream, hold the FIN.
+     */
+    unsigned int is_waiting_for_data : 1;
+    unsigned int is_rush_pack_open : 1;
 
     quicrq_message_buffer_t message_buffer;
     /* TODO: Add priority */
@@ -463,7 +553,27 @@ struct st_quicrq_stream_ctx_t {
     int nb_horizon_acks;
     int nb_extra_sent;
     int nb_fragment_lost;
+    uint64_t nb_objects_skipped;
+    uint64_t nb_bytes_sent;
+    uint64_t nb_datagrams_sent;
+    uint64_t datagram_header_bytes;
+    /* Groups abandoned by the latest first warp policy */
+    uint64_t nb_groups_abandoned;
+    /* Sequence number of the last datagram bundle in which the stream had nothing to send */
+    uint64_t datagram_bundle_idle_seq;
+    /* Delay between arrival of an object in the cache and sending of its first byte */
+    uint64_t nb_first_byte_samples;
+    uint64_t first_byte_latency_sum;
+    uint64_t first_byte_latency_max;
+    /* Progress watchdog: release point of the publisher when last checked, and time of last progress */
+    uint64_t watchdog_group_id;
+    uint64_t watchdog_object_id;
+    uint64_t watchdog_progress_time;
+    /* Set if the subscriber asked to start at a point in the past, exempt from the lag test */
+    int is_start_in_past;
     picosplay_tree_t datagram_ack_tree;
+    /* Share of the connection congestion state */
+    quicrq_stream_congestion_state_t congestion;
     /* For notification streams, URL and notification queue */
     uint8_t* subscribe_prefix;
     size_t subscribe_prefix_length;
@@ -511,6 +621,8 @@ struct st_quicrq_stream_ctx_t {
     /* set of uni_streams for a given media_id - is there a better way handle the individual stream - priorities, reset.. */
     struct st_quicrq_uni_stream_ctx_t* first_uni_stream;
     struct st_quicrq_uni_stream_ctx_t* last_uni_stream;
+    /* In rush mode, uni stream on which small objects are being packed, if any */
+    struct st_quicrq_uni_stream_ctx_t* rush_pack_uni_stream;
 };
 
 
@@ -526,6 +638,16 @@ typedef struct st_quicrq_cnx_congestion_state_t {
 } quicrq_cnx_congestion_state_t;
 
 /* Quicrq per connection context */
+/* Datagram bundle, collecting the fragments of several media before
+ * they are copied in a single QUIC datagram */
+typedef struct st_quicrq_datagram_bundle_t {
+    uint8_t bytes[PICOQUIC_MAX_PACKET_SIZE];
+    size_t space;
+    size_t length;
+    size_t first_segment_length;
+    int nb_segments;
+} quicrq_datagram_bundle_t;
+
 struct st_quicrq_cnx_ctx_t {
     struct st_quicrq_cnx_ctx_t* next_cnx;
     struct st_quicrq_cnx_ctx_t* previous_cnx;
@@ -537,6 +659,7 @@ struct st_quicrq_cnx_ctx_t {
     int is_server;
     int is_client;
     quicrq_cnx_congestion_state_t congestion;
+    uint64_t extra_repeat_credit; /* bytes available for extra repeats, if budget is set */
 
     uint64_t next_media_id; /* only used for receiving */
     uint64_t next_abandon_datagram_id; /* used to test whether unexpected datagrams are OK */
@@ -545,6 +668,9 @@ struct st_quicrq_cnx_ctx_t {
     /* reference to the unidirectional streams */
     struct st_quicrq_uni_stream_ctx_t* first_uni_stream;
     struct st_quicrq_uni_stream_ctx_t* last_uni_stream;
+    /* Bundle being prepared, only set while preparing a datagram, and sequence number of that bundle */
+    struct st_quicrq_datagram_bundle_t* datagram_bundle;
+    uint64_t datagram_bundle_seq;
 };
 
 /* Prototype function for managing the cache of relays.
@@ -603,10 +729,56 @@ struct st_quicrq_ctx_t {
     int extra_repeat_on_nack : 1;
     int extra_repeat_after_received_delayed : 1;
     uint64_t extra_repeat_delay;
+    /* Extra repeat policy: suppress repeats that would compete with congestion
+     * control or superseded groups, and cap repeats to a fraction of the
+     * datagram bytes sent on the connection. Counters kept for statistics. */
+    int extra_repeat_congestion_aware;
+    uint64_t extra_repeat_budget_percent;
+    uint64_t nb_extra_repeat_sent;
+    uint64_t nb_extra_repeat_dropped;
+    uint64_t extra_repeat_bytes_sent;
+    /* Payload copies held for extra repeats, current and peak value. Copying is
+     * forced instead of reading from the cache if set -- mostly for testability */
+    uint64_t extra_repeat_copy_bytes;
+    uint64_t extra_repeat_copy_bytes_peak;
+    int is_extra_repeat_copy_forced;
     /* Count of media fragments received with numbers < start point */
     uint64_t useless_fragments;
+    /* Subscription watchdog, disabled if both thresholds are zero.
+     * Checked every quarter of the stall time, or every QUICRQ_WATCHDOG_CHECK_INTERVAL */
+    uint64_t watchdog_stall_time_max;
+    uint64_t watchdog_lag_groups_max;
+    uint64_t watchdog_next_time;
+    uint64_t nb_stalled_subscriptions;
     /* Control how enable congestion control -- mostly for testability */
     quicrq_congestion_control_enum congestion_control_mode;
+    /* Disable the rotation of the wake up order of subscribers -- mostly for testability */
+    int is_wakeup_rotation_disabled;
+    /* Disable the datagram split policy, split at the available space -- mostly for testability */
+    int is_datagram_split_policy_disabled;
+    /* Per track congestion weights, if any */
+    quicrq_congestion_weight_t* first_congestion_weight;
+    /* Per track repair deadlines, if any */
+    quicrq_repair_deadline_t* first_repair_deadline;
+    /* Rush packing option, disabled if rush_pack_object_max is zero */
+    size_t rush_pack_object_max;
+    size_t rush_pack_stream_max;
+    uint64_t rush_pack_delay;
+    /* Bundling of datagram fragments of several media */
+    int is_datagram_bundling_enabled;
+    /* Latest first warp policy, disabled if warp_latest_first_lag is zero */
+    uint64_t warp_latest_first_lag;
+    uint64_t warp_abandon_horizon;
+    /* Pools of released stream and publisher contexts, reused by new subscriptions.
+     * Closed publisher contexts are first retired, and their object trees are
+     * emptied in batch by quicrq_time_check, outside of the sending code.
+     * Each pool keeps at most context_pool_max contexts, 0 disables pooling. */
+    size_t context_pool_max;
+    struct st_quicrq_stream_ctx_t* first_free_stream;
+    size_t nb_free_streams;
+    struct st_quicrq_fragment_publisher_context_t* first_free_publisher;
+    size_t nb_free_publishers;
+    struct st_quicrq_fragment_publisher_context_t* first_retired_publisher;
 };
 
 quicrq_stream_ctx_t* quicrq_find_or_create_stream(
@@ -657,6 +829,7 @@ int quicrq_media_object_bridge_fn(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length);
 /* For logging.. */
 const char* quicrq_uint8_t_to_text(const uint8_t* u, size_t length, char* buffer, size_t buffer_length);
@@ -665,7 +838,11 @@ char quicrq_transport_mode_to_letter(quicrq_transport_mode_enum transport_mode);
 const char* quicrq_transport_mode_to_string(quicrq_transport_mode_enum transport_mode);
 
 /* Evaluation of congestion state */
-int quicrq_congestion_check_per_cnx(quicrq_cnx_ctx_t* cnx_ctx, uint8_t flags, int has_backlog, uint64_t current_time);
+int quicrq_congestion_check_per_cnx(quicrq_stream_ctx_t* stream_ctx, uint8_t flags, int has_backlog, uint64_t current_time);
+uint64_t quicrq_get_media_congestion_weight(quicrq_ctx_t* qr_ctx, const uint8_t* url, size_t url_length);
+
+/* Repair deadline of a media, 0 if none */
+uint64_t quicrq_get_media_repair_deadline(quicrq_ctx_t* qr_ctx, const uint8_t* url, size_t url_length);
 
 #ifdef __cplusplus
 }
@@ -60,6 +60,7 @@ typedef struct st_quicrq_relay_context_t {
     quicrq_cnx_ctx_t* cnx_ctx;
     quicrq_transport_mode_enum transport_mode;
     unsigned int is_origin_only : 1;
+    unsigned int is_pass_through : 1;
 } quicrq_relay_context_t;
 
 /* Management of the relay cache
@@ -37,6 +37,7 @@ typedef struct st_quicrq_reassembly_object_t {
     uint64_t nb_objects_previous_group;
     uint64_t object_length;
     uint64_t queue_delay;
+    uint64_t origin_timestamp;
     uint8_t flags;
     int is_last_received;
     uint64_t data_received;
@@ -382,8 +383,8 @@ int quicrq_reassembly_update_start_point(quicrq_reassembly_context_t* reassembly
             break;
         } 
         /* Submit the object in order */
-        ret = ready_fn(app_media_ctx, current_time, object->group_id, object->object_id, object->flags, object->reassembled,
-            (size_t)object->object_length, quicrq_reassembly_object_repair);
+        ret = ready_fn(app_media_ctx, current_time, object->group_id, object->object_id, object->flags, object->origin_timestamp,
+            object->reassembled, (size_t)object->object_length, quicrq_reassembly_object_repair);
         /* delete the object that was just repaired. */
         quicrq_reassembly_object_delete(reassembly_ctx, object);
         /* update the next_object id */
@@ -409,6 +410,7 @@ int quicrq_reassembly_input(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length,
     quicrq_reassembly_object_ready_fn ready_fn,
     void* app_media_ctx)
@@ -444,6 +446,14 @@ int quicrq_reassembly_input(
             if (object_id == 0 && offset == 0) {
                 object->nb_objects_previous_group = nb_objects_previous_group;
             }
+            /* The origin timestamp is carried in the first fragment of the object */
+            if (offset == 0) {
+                object->origin_timestamp = origin_timestamp;
+            }
+            /* If the object is streamed, learn the length from the final fragment */
+            if (object->object_length == QUICRQ_OBJECT_LENGTH_UNKNOWN) {
+                object->object_length = object_length;
+            }
             /* If this is the last fragment, update the object length */
             if (offset + data_length >= object->object_length) {
                 object->is_last_received = 1;
@@ -451,7 +461,7 @@ int quicrq_reassembly_input(
                     ret = -1;
                 }
             }
-            else if (object->object_length != object_length) {
+            else if (object->object_length != object_length && object_length != QUICRQ_OBJECT_LENGTH_UNKNOWN) {
                 ret = -1;
             }
             if (ret == 0) {
@@ -482,7 +492,8 @@ int quicrq_reassembly_input(
                         ret = quicrq_reassembly_object_reassemble(object);
                         if (ret == 0) {
                             /* If the object is fully received, pass it to the application, indicating sequence or not. */
-                            ret = ready_fn(app_media_ctx, current_time, group_id, object_id, flags, object->reassembled, (size_t)object->object_length, object_mode);
+                            ret = ready_fn(app_media_ctx, current_time, group_id, object_id, flags, object->origin_timestamp,
+                                object->reassembled, (size_t)object->object_length, object_mode);
                         }
                         if (ret == 0 && object_mode == quicrq_reassembly_object_in_sequence) {
                             /* delete the object that was just reassembled. */
@@ -45,6 +45,7 @@ int quicrq_relay_consumer_cb(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length)
 {
     int ret = 0;
@@ -56,7 +57,12 @@ int quicrq_relay_consumer_cb(
          * This requires accessing the cache by object_id, offset and length. */
          /* Add fragment (or fragments) to cache */
         ret = quicrq_fragment_propose_to_cache(cons_ctx->cache_ctx, data, 
-            group_id, object_id, offset, queue_delay, flags, nb_objects_previous_group, object_length, data_length, current_time);
+            group_id, object_id, offset, queue_delay, flags, nb_objects_previous_group, object_length, origin_timestamp,
+            data_length, current_time);
+        /* In pass through mode, release what the single reader already sent */
+        if (ret == 0 && cons_ctx->qr_ctx->relay_ctx != NULL && cons_ctx->qr_ctx->relay_ctx->is_pass_through) {
+            (void)quicrq_fragment_cache_media_purge_pass_through(cons_ctx->cache_ctx->srce_ctx);
+        }
         /* Manage fin of transmission */
         if (ret == 0) {
             /* If the final group id and object id are known, and the next expected
@@ -84,10 +90,26 @@ int quicrq_relay_consumer_cb(
         ret = quicrq_fragment_cache_set_real_time_cache(cons_ctx->cache_ctx);
         break;
     case quicrq_media_start_point:
-        /* Document the start point, and clean the cache of data before that point */
-        ret = quicrq_fragment_cache_learn_start_point(cons_ctx->cache_ctx, group_id, object_id);
+        /* Document the start point, and clean the cache of data before that point.
+         * If there are redundant ingests, a late ingest may start after data that the
+         * other ingests already delivered, possibly out of order beyond a hole. That data
+         * is kept: the start point is only applied if it is past all the data received.
+         * In any case, the fragments that publishers are still reading are not deleted. */
+        if (cons_ctx->cache_ctx->nb_feeds <= 1 ||
+            group_id > cons_ctx->cache_ctx->highest_group_id ||
+            (group_id == cons_ctx->cache_ctx->highest_group_id && object_id > cons_ctx->cache_ctx->highest_object_id)) {
+            ret = quicrq_fragment_cache_learn_start_point(cons_ctx->cache_ctx, group_id, object_id);
+        }
         break;
     case quicrq_media_close:
+        if (cons_ctx->cache_ctx->nb_feeds > 0) {
+            cons_ctx->cache_ctx->nb_feeds--;
+        }
+        if (cons_ctx->cache_ctx->nb_feeds > 0) {
+            /* Another ingest still feeds the cache, the media continues. */
+            free(media_ctx);
+            break;
+        }
         /* Document the final object */
         if (cons_ctx->cache_ctx->final_group_id == 0 && cons_ctx->cache_ctx->final_object_id == 0) {
             /* cache delete time set in the future to allow for reconnection. */
@@ -230,6 +252,7 @@ int quicrq_relay_default_source_fn(void* default_source_ctx, quicrq_ctx_t* qr_ct
                     if (ret == 0){
                         /* Document the stream ID for that cache */
                         char buffer[256];
+                        cache_ctx->nb_feeds++;
                         cache_ctx->subscribe_stream_id = relay_ctx->cnx_ctx->last_stream->stream_id; 
                         picoquic_log_app_message(relay_ctx->cnx_ctx->cnx, "Asking server for URL: %s on stream %" PRIu64,
                             quicrq_uint8_t_to_text(url, url_length, buffer, 256), cache_ctx->subscribe_stream_id);
@@ -325,6 +348,7 @@ int quicrq_relay_consumer_init_callback(quicrq_stream_ctx_t* stream_ctx, const u
                     char buffer[256];
 
                     cons_ctx->cache_ctx = cache_ctx;
+                    cache_ctx->nb_feeds++;
                     ret = quicrq_set_media_stream_ctx(stream_ctx, quicrq_relay_consumer_cb, cons_ctx);
                     picoquic_log_app_message(stream_ctx->cnx_ctx->cnx, "Posting URL: %s to server on stream %" PRIu64,
                         quicrq_uint8_t_to_text(url, url_length, buffer, 256), stream_ctx->stream_id);
@@ -495,6 +519,25 @@ void quicrq_disable_relay(quicrq_ctx_t* qr_ctx)
     }
 }
 
+/* Pass through mode.
+ * When a real time source has a single reader, the relay only keeps the fragments
+ * that this reader has not yet sent, or in datagram mode not yet seen acknowledged.
+ * The purge runs each time a fragment is added to the cache. As soon as a
+ * second reader subscribes, the relay reverts to the GOB based purge.
+ */
+int quicrq_set_relay_pass_through(quicrq_ctx_t* qr_ctx, int is_pass_through)
+{
+    int ret = 0;
+
+    if (qr_ctx->relay_ctx == NULL) {
+        ret = -1;
+    }
+    else {
+        qr_ctx->relay_ctx->is_pass_through = (is_pass_through) ? 1 : 0;
+    }
+    return ret;
+}
+
 /* Management of the relay cache.
  * Ensure that old segments are removed.
  */
@@ -514,8 +557,13 @@ uint64_t quicrq_manage_relay_cache(quicrq_ctx_t* qr_ctx, uint64_t current_time)
                 quicrq_fragment_cache_t* cache_ctx = srce_ctx->cache_ctx;
 
                 if (srce_ctx->is_cache_real_time) {
-                    /* Ask the cache management to purge up to the last useful GOB */
-                    quicrq_fragment_cache_media_purge_to_gob(srce_ctx);
+                    /* If there is a single reader and pass through is enabled, only keep what
+                     * that reader still needs. Otherwise, ask the cache management to purge
+                     * up to the last useful GOB */
+                    if (!qr_ctx->relay_ctx->is_pass_through ||
+                        !quicrq_fragment_cache_media_purge_pass_through(srce_ctx)) {
+                        quicrq_fragment_cache_media_purge_to_gob(srce_ctx);
+                    }
                 }
 
                 if (qr_ctx->cache_duration_max > 0 && cache_ctx->is_feed_closed && srce_ctx->first_stream == NULL) {
@@ -570,6 +618,10 @@ int quicrq_origin_consumer_init_callback(quicrq_stream_ctx_t* stream_ctx, const
         quicrq_media_source_ctx_t* srce_ctx = quicrq_find_local_media_source(qr_ctx, url, url_length);
 
         if (srce_ctx != NULL) {
+            /* The media may be posted by several publishers, e.g., a main and a backup
+             * encoder. The ingests are merged in the cache, the first copy of each
+             * fragment is kept and the duplicates are ignored. This requires that the
+             * publishers agree on the group and object numbers. */
             cache_ctx = srce_ctx->cache_ctx;
             picoquic_log_app_message(stream_ctx->cnx_ctx->cnx, "Found cache context for URL: %s",
                 quicrq_uint8_t_to_text(url, url_length, buffer, 256));
@@ -597,6 +649,9 @@ int quicrq_origin_consumer_init_callback(quicrq_stream_ctx_t* stream_ctx, const
             /* set the parameter in the stream context. */
             cons_ctx->cache_ctx = cache_ctx;
             ret = quicrq_set_media_stream_ctx(stream_ctx, quicrq_relay_consumer_cb, cons_ctx);
+            if (ret == 0 && cache_ctx != NULL) {
+                cache_ctx->nb_feeds++;
+            }
         }
 
         if (ret != 0) {
@@ -35,6 +35,8 @@ static const quicrq_test_def_t test_table[] =
     { "congestion_datagram", quicrq_congestion_datagram_test },
     { "congestion_datagram_half", quicrq_congestion_datagram_half_test },
     { "congestion_datagram_loss", quicrq_congestion_datagram_loss_test },
+    { "congestion_extra_repeat", quicrq_congestion_extra_repeat_test },
+    { "congestion_dependency", quicrq_congestion_dependency_test },
     { "congestion_datagram_recv", quicrq_congestion_datagram_recv_test },
     { "congestion_datagram_rloss", quicrq_congestion_datagram_rloss_test },
     { "congestion_datagram_zero", quicrq_congestion_datagram_zero_test },
@@ -55,6 +57,7 @@ static const quicrq_test_def_t test_table[] =
     { "twomedia_client", quicrq_twomedia_client_test },
     { "twomedia_datagram_client", quicrq_twomedia_datagram_client_test },
     { "twomedia_datagram_client_loss", quicrq_twomedia_datagram_client_loss_test },
+    { "twomedia_congestion_weights", quicrq_twomedia_congestion_weights_test },
     { "media_object_no_loss", quicrq_media_object_noloss },
     { "media_object_loss", quicrq_media_object_loss },
     { "relay_basic", quicrq_relay_basic_test },
@@ -62,6 +65,14 @@ static const quicrq_test_def_t test_table[] =
     { "relay_datagram_loss", quicrq_relay_datagram_loss_test },
     { "relay_basic_client", quicrq_relay_basic_client_test },
     { "relay_datagram_client", quicrq_relay_datagram_client_test },
+    { "relay_stats", quicrq_relay_stats_test },
+    { "relay_chunks", quicrq_relay_chunks_test },
+    { "relay_chunks_datagram", quicrq_relay_chunks_datagram_test },
+    { "relay_origin_timestamp", quicrq_relay_origin_timestamp_test },
+    { "relay_pass_through", quicrq_relay_pass_through_test },
+    { "relay_pass_through_datagram", quicrq_relay_pass_through_datagram_test },
+    { "relay_pass_through_warp", quicrq_relay_pass_through_warp_test },
+    { "relay_pass_through_chain", quicrq_relay_pass_through_chain_test },
     { "subscribe_basic", quicrq_subscribe_basic_test },
     { "subscribe_client", quicrq_subscribe_client_test },
     { "subscribe_datagram", quicrq_subscribe_datagram_test },
@@ -88,6 +99,8 @@ static const quicrq_test_def_t test_table[] =
     { "triangle_intent_next_s", quicrq_triangle_intent_next_s_test },
     { "triangle_intent_that", quicrq_triangle_intent_that_test },
     { "triangle_intent_that_s", quicrq_triangle_intent_that_s_test },
+    { "triangle_intent_time", quicrq_triangle_intent_time_test },
+    { "triangle_intent_time_s", quicrq_triangle_intent_time_s_test },
     { "triangle_intent_warp", quicrq_triangle_intent_warp_test },
     { "triangle_intent_warp_nc", quicrq_triangle_intent_warp_nc_test },
     { "triangle_intent_warp_loss", quicrq_triangle_intent_warp_loss_test },
@@ -116,7 +129,28 @@ static const quicrq_test_def_t test_table[] =
     { "fourlegs_datagram", quicrq_fourlegs_datagram_test },
     { "fourlegs_datagram_last", quicrq_fourlegs_datagram_last_test },
     { "fourlegs_datagram_loss", quicrq_fourlegs_datagram_loss_test },
+    { "fanout_basic", quicrq_fanout_basic_test },
+    { "fanout_datagram", quicrq_fanout_datagram_test },
+    { "fanout_busy", quicrq_fanout_busy_test },
+    { "fanout_repeat", quicrq_fanout_repeat_test },
+    { "watchdog", quicrq_watchdog_test },
+    { "watchdog_datagram", quicrq_watchdog_datagram_test },
+    { "bundle", quicrq_bundle_test },
+    { "bundle_loss", quicrq_bundle_loss_test },
+    { "scenario", quicrq_scenario_test },
+    { "churn", quicrq_churn_test },
+    { "repair_deadline", quicrq_repair_deadline_test },
+    { "redundant_ingest", quicrq_redundant_ingest_test },
+    { "redundant_ingest_datagram", quicrq_redundant_ingest_datagram_test },
+    { "redundant_ingest_loss", quicrq_redundant_ingest_loss_test },
     { "fragment_cache_fill", quicrq_fragment_cache_fill_test },
+    { "fragment_cache_seek_time", quicrq_fragment_cache_seek_time_test },
+    { "fragment_cache_extent", quicrq_fragment_cache_extent_test },
+    { "fragment_cache_streamed", quicrq_fragment_cache_streamed_test },
+    { "fragment_cache_repair_deadline", quicrq_fragment_cache_repair_deadline_test },
+    { "fragment_publisher_lag", quicrq_fragment_publisher_lag_test },
+    { "fragment_cache_duplicate", quicrq_fragment_cache_duplicate_test },
+    { "fragment_cache_cursor", quicrq_fragment_cache_cursor_test },
     { "get_addr", quicrq_get_addr_test },
     { "warp_basic", quicrq_warp_basic_test },
     { "warp_basic_client", quicrq_warp_basic_client_test },
@@ -128,9 +162,24 @@ static const quicrq_test_def_t test_table[] =
     { "warp_relay", quicrq_warp_relay_test },
     { "warp_basic_loss", quicrq_warp_basic_loss_test },
     { "warp_relay_loss", quicrq_warp_relay_loss_test },
+    { "warp_latest_first", quicrq_latest_first_test },
+    { "warp_latest_first_relay", quicrq_latest_first_relay_test },
+    { "warp_latest_first_relay_stream", quicrq_latest_first_relay_stream_test },
+    { "warp_latest_first_relay_datagram", quicrq_latest_first_relay_datagram_test },
+    { "warp_latest_first_start_time", quicrq_latest_first_start_time_test },
     { "rush_basic", quicrq_rush_basic_test },
     { "rush_basic_client", quicrq_rush_basic_client_test },
     { "rush_basic_loss", quicrq_rush_basic_loss_test },
+    { "rush_pack", quicrq_rush_pack_test },
+    { "rush_pack_loss", quicrq_rush_pack_loss_test },
+    { "warp_uni_bound", quicrq_warp_uni_bound_test },
+    { "rush_uni_bound_loss", quicrq_rush_uni_bound_loss_test },
+    { "datagram_split", quicrq_datagram_split_test },
+    { "datagram_split_loss", quicrq_datagram_split_loss_test },
+    { "fetch", quicrq_fetch_test },
+    { "fetch_partial", quicrq_fetch_partial_test },
+    { "resume_stream", quicrq_resume_stream_test },
+    { "resume_datagram", quicrq_resume_datagram_test },
     { "rush_triangle", quicrq_triangle_rush_test },
     { "congestion_rush", quicrq_congestion_rush_test },
     { "congestion_rush_g", quicrq_congestion_rush_g_test },
@@ -140,6 +189,9 @@ static const quicrq_test_def_t test_table[] =
 
 static size_t const nb_tests = sizeof(test_table) / sizeof(quicrq_test_def_t);
 
+#define QUICRQ_SCENARIO_DEFAULT_SEEDS 32
+#define QUICRQ_SCENARIO_TOLERANCE 5
+
 static int do_one_test(size_t i, FILE* F)
 {
     int ret = 0;
@@ -188,6 +240,14 @@ int usage(char const* argv0)
     fprintf(stderr, "  -h                Print this help message\n");
     fprintf(stderr, "  -S solution_dir   Set the path to the source files to find the default files\n");
     fprintf(stderr, "  -P picoquic_dir   Obsolete, not used anymore.\n");
+    fprintf(stderr, "  -s scenario       Run the scenario over several seeds instead of the tests.\n");
+    fprintf(stderr, "                    Scenarios are basic-stream, basic-datagram, relay-stream,\n");
+    fprintf(stderr, "                    relay-warp and relay-datagram.\n");
+    fprintf(stderr, "  -N nb_seeds       Number of seeds for the scenario, default %d.\n", QUICRQ_SCENARIO_DEFAULT_SEEDS);
+    fprintf(stderr, "  -o result_file    Scenario result file, default <scenario>-scenario.csv.\n");
+    fprintf(stderr, "  -c ref_file       Compare the scenario results to those of a reference file,\n");
+    fprintf(stderr, "                    e.g., produced by another build. Fails if the skipped\n");
+    fprintf(stderr, "                    objects, bytes or latency increase by more than %d%%.\n", QUICRQ_SCENARIO_TOLERANCE);
 
     return -1;
 }
@@ -214,6 +274,11 @@ int main(int argc, char** argv)
     int opt;
     int disable_debug = 0;
     int retry_failed_test = 0;
+    char const* scenario_name = NULL;
+    char const* scenario_file = NULL;
+    char const* scenario_ref = NULL;
+    int nb_seeds = QUICRQ_SCENARIO_DEFAULT_SEEDS;
+    char scenario_default_file[256];
 
     fprintf(stdout, "Testing QUICRQ Version %s, Picoquic version %s\n", QUICRQ_VERSION, PICOQUIC_VERSION);
 
@@ -224,7 +289,7 @@ int main(int argc, char** argv)
     }
     else
     {
-        while (ret == 0 && (opt = getopt(argc, argv, "P:S:x:nrh")) != -1) {
+        while (ret == 0 && (opt = getopt(argc, argv, "P:S:x:s:N:o:c:nrh")) != -1) {
             switch (opt) {
             case 'x': {
                 int test_number = get_test_number(optarg);
@@ -243,6 +308,22 @@ int main(int argc, char** argv)
             case 'S':
                 quicrq_test_solution_dir = optarg;
                 break;
+            case 's':
+                scenario_name = optarg;
+                break;
+            case 'N':
+                nb_seeds = atoi(optarg);
+                if (nb_seeds <= 0) {
+                    fprintf(stderr, "Incorrect number of seeds: %s\n", optarg);
+                    ret = usage(argv[0]);
+                }
+                break;
+            case 'o':
+                scenario_file = optarg;
+                break;
+            case 'c':
+                scenario_ref = optarg;
+                break;
             case 'n':
                 disable_debug = 1;
                 break;
@@ -267,7 +348,27 @@ int main(int argc, char** argv)
             DBG_PRINTF("%s", "Debug print enabled");
         }
 
-        if (ret == 0)
+        if (ret == 0 && (scenario_name != NULL || scenario_ref != NULL)) {
+            /* Run a scenario and/or compare its results, instead of running the tests */
+            if (scenario_file == NULL) {
+                size_t nb_chars = 0;
+                if (scenario_name == NULL ||
+                    picoquic_sprintf(scenario_default_file, sizeof(scenario_default_file), &nb_chars, "%s-scenario.csv", scenario_name) != 0) {
+                    fprintf(stderr, "Specify the scenario result file with -o\n");
+                    ret = usage(argv[0]);
+                }
+                scenario_file = scenario_default_file;
+            }
+            if (ret == 0 && scenario_name != NULL) {
+                ret = quicrq_scenario_run(scenario_name, nb_seeds, 1, scenario_file);
+                fprintf(stdout, "Scenario %s, %d seeds, results in %s: %s\n", scenario_name, nb_seeds, scenario_file,
+                    (ret == 0) ? "done" : "fails");
+            }
+            if (ret == 0 && scenario_ref != NULL) {
+                ret = quicrq_scenario_compare(scenario_ref, scenario_file, QUICRQ_SCENARIO_TOLERANCE, stdout);
+            }
+        }
+        else if (ret == 0)
         {
             if (optind >= argc) {
                 for (size_t i = 0; i < nb_tests; i++) {
@@ -93,6 +93,34 @@ struct sockaddr* quicrq_test_find_send_addr(quicrq_test_config_t* config, int sr
     return dest_addr;
 }
 
+/* Pseudo random generator for the simulated impairments (xorshift64*).
+ * The generator is local to the test configuration, so runs with the
+ * same seed are reproducible regardless of other uses of random numbers.
+ */
+static uint64_t quicrq_test_random(quicrq_test_config_t* config)
+{
+    uint64_t x = config->random_state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    config->random_state = x;
+
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+void quicrq_test_config_set_random(quicrq_test_config_t* config, uint64_t seed, uint64_t loss_per_million, uint64_t jitter_max)
+{
+    /* The state of xorshift shall never be zero */
+    config->random_state = (seed == 0) ? 0x9E3779B97F4A7C15ull : seed;
+    config->random_loss_per_million = loss_per_million;
+    config->random_jitter_max = jitter_max;
+    /* Stir the seed, so that close seeds do not produce similar sequences */
+    for (int i = 0; i < 4; i++) {
+        (void)quicrq_test_random(config);
+    }
+}
+
 /* Packet departure from selected node */
 int quicrq_test_packet_departure(quicrq_test_config_t* config, int node_id, int* is_active)
 {
@@ -123,7 +151,19 @@ int quicrq_test_packet_departure(quicrq_test_config_t* config, int node_id, int*
 
             if (link_id >= 0) {
                 *is_active = 1;
-                picoquictest_sim_link_submit(config->links[link_id], packet, config->simulated_time);
+                if (config->busy_packet_time > 0 && node_id == config->busy_node_id) {
+                    config->busy_next_time = config->simulated_time + config->busy_packet_time;
+                }
+                if (config->random_state != 0 && config->random_jitter_max > 0) {
+                    /* Simulate jitter by adding a random delay to the link latency for this packet */
+                    uint64_t latency = config->links[link_id]->microsec_latency;
+                    config->links[link_id]->microsec_latency += quicrq_test_random(config) % (config->random_jitter_max + 1);
+                    picoquictest_sim_link_submit(config->links[link_id], packet, config->simulated_time);
+                    config->links[link_id]->microsec_latency = latency;
+                }
+                else {
+                    picoquictest_sim_link_submit(config->links[link_id], packet, config->simulated_time);
+                }
             }
             else {
                 /* packet cannot be routed. */
@@ -154,6 +194,11 @@ int quicrq_test_packet_arrival(quicrq_test_config_t* config, int link_id, int *
         config->simulate_loss >>= 1;
         config->simulate_loss |= (loss << 63);
 
+        if (config->random_state != 0 && config->random_loss_per_million > 0 &&
+            quicrq_test_random(config) % 1000000 < config->random_loss_per_million) {
+            loss = 1;
+        }
+
         if (node_id >= 0 && loss == 0) {
             *is_active = 1;
 
@@ -195,6 +240,10 @@ int quicrq_test_loop_step(quicrq_test_config_t* config, int* is_active, uint64_t
     /* Check which node has the lowest wait time */
     for (int i = 0; i < config->nb_nodes; i++) {
         uint64_t app_next_time = quicrq_time_check(config->nodes[i], config->simulated_time);
+        if (config->busy_packet_time > 0 && i == config->busy_node_id && app_next_time < config->busy_next_time) {
+            /* The node is still busy sending the previous packet */
+            app_next_time = config->busy_next_time;
+        }
         if (app_next_time < next_time) {
             next_time = app_next_time;
             next_step_type = 2;
@@ -731,6 +780,779 @@ int quicrq_rush_basic_loss_test()
     return quicrq_basic_test_one(1, quicrq_transport_mode_rush, 0x7080, 0, 0, 0, 0);
 }
 
+/* Uni stream test.
+ * Send the audio test source in warp or rush mode, with or without packing of small objects.
+ * Verify that the media is received correctly, and report the number of uni streams
+ * opened by the server, the number of bytes received by the client, and the largest
+ * number of uni stream contexts kept by either node during the transfer.
+ */
+int quicrq_uni_stream_test_one(quicrq_transport_mode_enum transport_mode, size_t object_max, uint64_t simulate_losses,
+    uint64_t * nb_uni_streams, uint64_t * data_received, int * max_uni_stream_list)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_basic_config_create(simulate_losses, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    size_t nb_log_chars = 0;
+
+    *nb_uni_streams = 0;
+    *data_received = 0;
+    *max_uni_stream_list = 0;
+
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "uni_stream_%c_%zu_%" PRIx64 "_result.bin",
+        quicrq_transport_mode_to_letter(transport_mode), object_max, simulate_losses);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "uni_stream_%c_%zu_%" PRIx64 "_log.csv",
+        quicrq_transport_mode_to_letter(transport_mode), object_max, simulate_losses);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_AUDIO_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Publish the audio source on the server, with the desired packing option */
+        quicrq_set_rush_packing(config->nodes[0], object_max, 4 * object_max, 100000);
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_AUDIO_SOURCE,
+            strlen(QUICRQ_TEST_AUDIO_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quirq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_AUDIO_SOURCE,
+            strlen(QUICRQ_TEST_AUDIO_SOURCE), transport_mode, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Only the uni streams in progress should be kept in the connection contexts */
+        for (int i = 0; i < config->nb_nodes; i++) {
+            if (config->nodes[i]->first_cnx != NULL) {
+                int nb_uni_stream_ctx = 0;
+                quicrq_uni_stream_ctx_t* uni_stream_ctx = config->nodes[i]->first_cnx->first_uni_stream;
+                while (uni_stream_ctx != NULL) {
+                    nb_uni_stream_ctx++;
+                    uni_stream_ctx = uni_stream_ctx->next_uni_stream_for_cnx;
+                }
+                if (nb_uni_stream_ctx > *max_uni_stream_list) {
+                    *max_uni_stream_list = nb_uni_stream_ctx;
+                }
+            }
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        /* if the media is received, exit the loop */
+        if (config->nodes[1]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else {
+            int client_stream_closed = config->nodes[1]->first_cnx->first_stream == NULL;
+            int server_stream_closed = config->nodes[0]->first_cnx != NULL && config->nodes[0]->first_cnx->first_stream == NULL;
+
+            if (!is_closed && client_stream_closed && server_stream_closed) {
+                /* Document the transmission costs before closing the connection */
+                *nb_uni_streams = picoquic_get_next_local_stream_id(config->nodes[0]->first_cnx->cnx, 1) / 4;
+                *data_received = picoquic_get_data_received(config->nodes[1]->first_cnx->cnx);
+                /* Client is done. Close connection without waiting for timer */
+                ret = picoquic_close(config->nodes[1]->first_cnx->cnx, 0);
+                is_closed = 1;
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received correctly */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+int quicrq_rush_pack_test_compare(uint64_t simulate_losses)
+{
+    uint64_t nb_uni_streams_plain = 0;
+    uint64_t nb_uni_streams_packed = 0;
+    uint64_t data_received_plain = 0;
+    uint64_t data_received_packed = 0;
+    int max_uni_stream_list = 0;
+    int ret = quicrq_uni_stream_test_one(quicrq_transport_mode_rush, 0, simulate_losses,
+        &nb_uni_streams_plain, &data_received_plain, &max_uni_stream_list);
+
+    if (ret == 0) {
+        ret = quicrq_uni_stream_test_one(quicrq_transport_mode_rush, 256, simulate_losses,
+            &nb_uni_streams_packed, &data_received_packed, &max_uni_stream_list);
+    }
+    if (ret == 0) {
+        DBG_PRINTF("Rush plain: %" PRIu64 " streams, %" PRIu64 " bytes; packed: %" PRIu64 " streams, %" PRIu64 " bytes",
+            nb_uni_streams_plain, data_received_plain, nb_uni_streams_packed, data_received_packed);
+        if (nb_uni_streams_packed >= nb_uni_streams_plain) {
+            DBG_PRINTF("Packing did not reduce the number of streams: %" PRIu64 " vs %" PRIu64,
+                nb_uni_streams_packed, nb_uni_streams_plain);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/* Rush packing test, audio source, compare with plain rush. */
+int quicrq_rush_pack_test()
+{
+    return quicrq_rush_pack_test_compare(0);
+}
+
+/* Rush packing test, with forced packet losses */
+int quicrq_rush_pack_loss_test()
+{
+    return quicrq_rush_pack_test_compare(0x7080);
+}
+
+/* Uni stream bound test.
+ * The uni stream contexts are released as soon as the stream is finished or reset,
+ * so the number of contexts shall remain bounded during a long transfer.
+ */
+#define QUICRQ_TEST_UNI_STREAM_BOUND 16
+
+int quicrq_uni_stream_bound_test_one(quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses)
+{
+    uint64_t nb_uni_streams = 0;
+    uint64_t data_received = 0;
+    int max_uni_stream_list = 0;
+    int ret = quicrq_uni_stream_test_one(transport_mode, 0, simulate_losses,
+        &nb_uni_streams, &data_received, &max_uni_stream_list);
+
+    if (ret == 0 && max_uni_stream_list > QUICRQ_TEST_UNI_STREAM_BOUND) {
+        DBG_PRINTF("Kept up to %d uni stream contexts, for %" PRIu64 " streams",
+            max_uni_stream_list, nb_uni_streams);
+        ret = -1;
+    }
+    return ret;
+}
+
+int quicrq_warp_uni_bound_test()
+{
+    return quicrq_uni_stream_bound_test_one(quicrq_transport_mode_warp, 0);
+}
+
+int quicrq_rush_uni_bound_loss_test()
+{
+    return quicrq_uni_stream_bound_test_one(quicrq_transport_mode_rush, 0x7080);
+}
+
+/* Datagram split test.
+ * Send the video source as datagrams, with or without the datagram split policy, and
+ * report the number of datagram fragments sent by the server and the bytes spent
+ * in their headers.
+ */
+int quicrq_datagram_split_test_one(int is_policy_disabled, uint64_t simulate_losses, uint64_t* nb_datagrams, uint64_t* header_bytes)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_basic_config_create(simulate_losses, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    size_t nb_log_chars = 0;
+
+    *nb_datagrams = 0;
+    *header_bytes = 0;
+
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "datagram_split_%d_%" PRIx64 "_result.bin",
+        is_policy_disabled, simulate_losses);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "datagram_split_%d_%" PRIx64 "_log.csv",
+        is_policy_disabled, simulate_losses);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Publish the video source on the server, with the desired split policy */
+        config->nodes[0]->is_datagram_split_policy_disabled = is_policy_disabled;
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quirq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), quicrq_transport_mode_datagram, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Poll the datagram statistics of the server while the sending stream exists */
+        if (config->nodes[0]->first_cnx != NULL) {
+            quicrq_stream_statistics_t stats[2];
+            size_t nb_stats = 0;
+
+            if (quicrq_cnx_get_stream_statistics(config->nodes[0]->first_cnx, stats, 2, &nb_stats, config->simulated_time) == 0) {
+                for (size_t i = 0; i < nb_stats && i < 2; i++) {
+                    if (stats[i].is_sender && stats[i].nb_datagrams_sent > *nb_datagrams) {
+                        *nb_datagrams = stats[i].nb_datagrams_sent;
+                        *header_bytes = stats[i].datagram_header_bytes;
+                    }
+                }
+            }
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        /* if the media is received, exit the loop */
+        if (config->nodes[1]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && config->nodes[1]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[1]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received correctly */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+int quicrq_datagram_split_test_compare(uint64_t simulate_losses)
+{
+    uint64_t nb_datagrams_plain = 0;
+    uint64_t nb_datagrams_split = 0;
+    uint64_t header_bytes_plain = 0;
+    uint64_t header_bytes_split = 0;
+    int ret = quicrq_datagram_split_test_one(1, simulate_losses, &nb_datagrams_plain, &header_bytes_plain);
+
+    if (ret == 0) {
+        ret = quicrq_datagram_split_test_one(0, simulate_losses, &nb_datagrams_split, &header_bytes_split);
+    }
+    if (ret == 0) {
+        DBG_PRINTF("Datagrams split at available space: %" PRIu64 " datagrams, %" PRIu64 " header bytes; split policy: %" PRIu64 " datagrams, %" PRIu64 " header bytes",
+            nb_datagrams_plain, header_bytes_plain, nb_datagrams_split, header_bytes_split);
+        if (nb_datagrams_split == 0 || nb_datagrams_split > nb_datagrams_plain) {
+            DBG_PRINTF("Split policy increased the number of datagrams: %" PRIu64 " vs %" PRIu64,
+                nb_datagrams_split, nb_datagrams_plain);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/* Datagram split test, video source, compare with split at available space. */
+int quicrq_datagram_split_test()
+{
+    return quicrq_datagram_split_test_compare(0);
+}
+
+/* Datagram split test, with forced packet losses */
+int quicrq_datagram_split_loss_test()
+{
+    return quicrq_datagram_split_test_compare(0x7080);
+}
+
+/* Fetch test.
+ * The source is entirely published in the cache of the server before the client connects.
+ * The client then retrieves it, either as a regular stream subscription or as a bulk fetch,
+ * optionally limited to the first group. Report the time between subscription and
+ * completion, and the number of bytes received by the client.
+ * Partial fetches end at group 1, object is_partial - 1: the last object received
+ * shall be the one just before that range end.
+ */
+int quicrq_fetch_test_one(int is_fetch, int is_partial, uint64_t* completion_time, uint64_t* data_received)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_subscribed = 0;
+    int is_closed = 0;
+    uint64_t subscribe_time = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_basic_config_create(0, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    size_t nb_log_chars = 0;
+    const uint64_t partial_end_group_id = 1;
+    const uint64_t partial_end_object_id = (is_partial > 0) ? (uint64_t)is_partial - 1 : 0;
+
+    *completion_time = 0;
+    *data_received = 0;
+
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "fetch_%d_%d_result.bin",
+        is_fetch, is_partial);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "fetch_%d_%d_log.csv",
+        is_fetch, is_partial);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Publish the source on the server, not real time, so the cache fills immediately */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 0, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        if (!is_subscribed && config->object_sources[0]->source_is_finished &&
+            config->object_sources[0]->object_is_published) {
+            /* The whole media is in the cache. Connect and subscribe. */
+            quicrq_subscribe_intent_t intent = { 0 };
+            quicrq_subscribe_intent_t* p_intent = NULL;
+
+            if (is_fetch) {
+                intent.intent_mode = quicrq_subscribe_intent_fetch_range;
+                if (is_partial) {
+                    intent.end_group_id = partial_end_group_id;
+                    intent.end_object_id = partial_end_object_id;
+                }
+                else {
+                    intent.end_group_id = config->object_sources[0]->object_source_ctx->next_group_id;
+                    intent.end_object_id = config->object_sources[0]->object_source_ctx->next_object_id;
+                }
+                p_intent = &intent;
+            }
+            cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+            if (cnx_ctx == NULL) {
+                ret = -1;
+                DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+            }
+            else if (test_object_stream_subscribe_ex(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+                strlen(QUICRQ_TEST_BASIC_SOURCE), quicrq_transport_mode_single_stream, quicrq_subscribe_in_order,
+                p_intent, result_file_name, result_log_name) == NULL) {
+                ret = -1;
+            }
+            else {
+                is_subscribed = 1;
+                subscribe_time = config->simulated_time;
+            }
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        if (!is_subscribed) {
+            continue;
+        }
+        /* if the media is received, exit the loop */
+        if (config->nodes[1]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else {
+            int client_stream_closed = config->nodes[1]->first_cnx->first_stream == NULL;
+            int server_stream_closed = config->nodes[0]->first_cnx != NULL && config->nodes[0]->first_cnx->first_stream == NULL;
+
+            if (!is_closed && client_stream_closed && server_stream_closed) {
+                /* Document the transfer before closing the connection */
+                *completion_time = config->simulated_time - subscribe_time;
+                *data_received = picoquic_get_data_received(config->nodes[1]->first_cnx->cnx);
+                /* Client is done. Close connection without waiting for timer */
+                ret = picoquic_close(config->nodes[1]->first_cnx->cnx, 0);
+                is_closed = 1;
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received correctly */
+    if (ret == 0) {
+        if (!is_partial) {
+            ret = quicrq_compare_media_file(result_file_name, media_source_path);
+        }
+        else {
+            uint64_t last_group_id = 0;
+            uint64_t last_object_id = 0;
+
+            ret = quicrq_log_file_last_object(result_log_name, &last_group_id, &last_object_id);
+            if (ret != 0) {
+                DBG_PRINTF("Cannot find the last object received in %s", result_log_name);
+            }
+            else if ((partial_end_object_id > 0) ?
+                (last_group_id != partial_end_group_id || last_object_id + 1 != partial_end_object_id) :
+                (last_group_id + 1 != partial_end_group_id)) {
+                DBG_PRINTF("Fetch up to %" PRIu64 "/%" PRIu64 ", last object received %" PRIu64 "/%" PRIu64,
+                    partial_end_group_id, partial_end_object_id, last_group_id, last_object_id);
+                ret = -1;
+            }
+        }
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+/* Fetch the whole cached media, and verify that it is not slower than a
+ * regular subscription. */
+int quicrq_fetch_test()
+{
+    uint64_t completion_time_plain = 0;
+    uint64_t completion_time_fetch = 0;
+    uint64_t data_received_plain = 0;
+    uint64_t data_received_fetch = 0;
+    int ret = quicrq_fetch_test_one(0, 0, &completion_time_plain, &data_received_plain);
+
+    if (ret == 0) {
+        ret = quicrq_fetch_test_one(1, 0, &completion_time_fetch, &data_received_fetch);
+    }
+    if (ret == 0) {
+        DBG_PRINTF("Plain: %" PRIu64 " bytes in %" PRIu64 " us, fetch: %" PRIu64 " bytes in %" PRIu64 " us, %" PRIu64 " bps",
+            data_received_plain, completion_time_plain, data_received_fetch, completion_time_fetch,
+            (completion_time_fetch > 0) ? (data_received_fetch * 8000000) / completion_time_fetch : 0);
+        if (completion_time_fetch > completion_time_plain) {
+            DBG_PRINTF("Fetch slower than subscription: %" PRIu64 " vs %" PRIu64,
+                completion_time_fetch, completion_time_plain);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/* Fetch only the first group, then the first group and the first object of the
+ * next, verify that the fetch completes at the end of the range. */
+int quicrq_fetch_partial_test()
+{
+    uint64_t completion_time_full = 0;
+    uint64_t completion_time_partial = 0;
+    uint64_t data_received_full = 0;
+    uint64_t data_received_partial = 0;
+    int ret = quicrq_fetch_test_one(1, 0, &completion_time_full, &data_received_full);
+
+    for (int is_partial = 1; ret == 0 && is_partial <= 2; is_partial++) {
+        ret = quicrq_fetch_test_one(1, is_partial, &completion_time_partial, &data_received_partial);
+        if (ret == 0 && data_received_partial >= data_received_full) {
+            DBG_PRINTF("Partial fetch received %" PRIu64 " bytes, full fetch %" PRIu64,
+                data_received_partial, data_received_full);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/* Resume test.
+ * The client subscribes to a real time source with a resumable subscription. In the middle
+ * of the transfer, all packets are lost for a while, and the client abandons the connection.
+ * When the link is restored, the client opens a new connection and resumes the subscription.
+ * The media received should match the source, without gaps or duplicates.
+ */
+int quicrq_resume_test_one(quicrq_transport_mode_enum transport_mode)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int is_resumed = 0;
+    const uint64_t outage_start = 3000000;
+    const uint64_t outage_abandon = 3500000;
+    const uint64_t outage_end = 4000000;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_basic_config_create(0, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    size_t nb_log_chars = 0;
+    test_object_stream_ctx_t* object_stream_ctx = NULL;
+
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "resume_%c_result.bin",
+        quicrq_transport_mode_to_letter(transport_mode));
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "resume_%c_log.csv",
+        quicrq_transport_mode_to_letter(transport_mode));
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quirq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if ((object_stream_ctx = test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name, result_log_name)) == NULL) {
+            ret = -1;
+        }
+        else {
+            quicrq_object_stream_set_resumable(object_stream_ctx->media_ctx, 1);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        uint64_t app_wake_time = UINT64_MAX;
+
+        if (cnx_ctx != NULL && !is_resumed && config->simulated_time >= outage_start) {
+            if (config->simulate_loss == 0) {
+                /* Start of the outage: lose all packets */
+                config->simulate_loss = UINT64_MAX;
+            }
+            else if (config->simulated_time >= outage_abandon) {
+                /* The client gives up on the connection. */
+                quicrq_delete_cnx_context(cnx_ctx, quicrq_media_close_quic_connection, 0);
+                cnx_ctx = NULL;
+                if (!quicrq_object_stream_is_suspended(object_stream_ctx->media_ctx)) {
+                    DBG_PRINTF("%s", "Subscription not suspended after connection loss");
+                    ret = -1;
+                }
+            }
+        }
+        else if (cnx_ctx == NULL && config->simulated_time >= outage_end) {
+            /* End of the outage: reconnect and resume */
+            config->simulate_loss = 0;
+            cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+            if (cnx_ctx == NULL) {
+                ret = -1;
+                DBG_PRINTF("Cannot create second client connection, ret = %d", ret);
+            }
+            else if (quicrq_resume_object_stream(object_stream_ctx->media_ctx, cnx_ctx) != 0) {
+                DBG_PRINTF("%s", "Cannot resume the subscription");
+                ret = -1;
+            }
+            else {
+                is_resumed = 1;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+        if (!is_resumed) {
+            if (cnx_ctx == NULL) {
+                app_wake_time = outage_end;
+            }
+            else {
+                app_wake_time = (config->simulate_loss == 0) ? outage_start : outage_abandon;
+            }
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, app_wake_time);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        /* if the media is received, exit the loop */
+        if (is_resumed) {
+            if (config->nodes[1]->first_cnx == NULL) {
+                DBG_PRINTF("%s", "Exit loop after client connection closed.");
+                break;
+            }
+            else if (!is_closed && config->nodes[1]->first_cnx->first_stream == NULL) {
+                /* Client is done. Close connection without waiting for timer */
+                ret = picoquic_close(config->nodes[1]->first_cnx->cnx, 0);
+                is_closed = 1;
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_resumed || !is_closed)) {
+        DBG_PRINTF("Session was not properly resumed and closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received correctly */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+int quicrq_resume_stream_test()
+{
+    return quicrq_resume_test_one(quicrq_transport_mode_single_stream);
+}
+
+int quicrq_resume_datagram_test()
+{
+    return quicrq_resume_test_one(quicrq_transport_mode_datagram);
+}
+
 
 int quicrq_get_addr_test()
 {
@@ -0,0 +1,245 @@
+#include <string.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_internal.h"
+#include "quicrq_test_internal.h"
+
+/* Bundle test:
+ * The origin publishes many tiny tracks, such as telemetry or chat, and the client
+ * subscribes to all of them in datagram mode. The configuration diagram is:
+ *
+ *             S
+ *             |
+ *             C
+ *
+ * The test is run with and without datagram bundling. It verifies that every track
+ * is received in full, and that bundling reduces the number of bytes sent by the origin.
+ * It also reports the size of the per track connection state at the origin, for
+ * reference only: bundling does not reduce that state, since each track keeps its
+ * own control stream and stream context.
+ */
+#ifdef _WINDOWS
+/* Stay below the limit of open files, two files per track */
+#define QUICRQ_BUNDLE_TEST_NB_TRACKS 200
+#else
+#define QUICRQ_BUNDLE_TEST_NB_TRACKS 500
+#endif
+
+/* Tiny objects, 10 per second during 2 seconds */
+const generation_parameters_t tiny_track = {
+    2000000, 10, 1, 1, 16, 32, 0, 0 };
+
+/* Create a test network */
+quicrq_test_config_t* quicrq_test_bundle_config_create(uint64_t simulate_loss)
+{
+    /* Create a configuration with two nodes, two links, one source per track and two attachment points.*/
+    quicrq_test_config_t* config = quicrq_test_config_create(2, 2, 2, QUICRQ_BUNDLE_TEST_NB_TRACKS);
+
+    if (config != NULL) {
+        /* Create the contexts for the origin and the client */
+        config->nodes[0] = quicrq_create(QUICRQ_ALPN,
+            config->test_server_cert_file, config->test_server_key_file, NULL, NULL, NULL,
+            config->ticket_encryption_key, sizeof(config->ticket_encryption_key),
+            &config->simulated_time);
+        config->nodes[1] = quicrq_create(QUICRQ_ALPN,
+            NULL, NULL, config->test_server_cert_store_file, NULL, NULL,
+            NULL, 0, &config->simulated_time);
+        if (config->nodes[0] == NULL || config->nodes[1] == NULL) {
+            quicrq_test_config_delete(config);
+            config = NULL;
+        }
+    }
+    if (config != NULL) {
+        /* Populate the attachments */
+        config->return_links[0] = 1;
+        config->attachments[0].link_id = 0;
+        config->attachments[0].node_id = 0;
+        config->return_links[1] = 0;
+        config->attachments[1].link_id = 1;
+        config->attachments[1].node_id = 1;
+        /* Set the desired loss pattern */
+        config->simulate_loss = simulate_loss;
+    }
+    return config;
+}
+
+/* Estimate the size of the per track state of a connection, i.e., the
+ * stream contexts and the records of datagrams pending acknowledgement.
+ */
+static size_t quicrq_bundle_test_state_size(quicrq_cnx_ctx_t* cnx_ctx)
+{
+    size_t state_size = 0;
+    quicrq_stream_ctx_t* stream_ctx = cnx_ctx->first_stream;
+
+    while (stream_ctx != NULL) {
+        state_size += sizeof(quicrq_stream_ctx_t);
+        state_size += stream_ctx->datagram_ack_tree.size * sizeof(quicrq_datagram_ack_state_t);
+        stream_ctx = stream_ctx->next_stream;
+    }
+    return state_size;
+}
+
+int quicrq_bundle_test_one(int is_bundled, uint64_t simulate_losses, uint64_t* bytes_sent, size_t* state_size_max)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_bundle_config_create(simulate_losses);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char url[64];
+    char result_file_name[256];
+    char result_log_name[256];
+    size_t nb_log_chars = 0;
+
+    *bytes_sent = 0;
+    *state_size_max = 0;
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    for (int i = 0; ret == 0 && i < QUICRQ_BUNDLE_TEST_NB_TRACKS; i++) {
+        /* Add a generated real time source per track to the origin.
+         * Stagger the start times, so objects of different tracks are not all ready at the same time. */
+        (void)picoquic_sprintf(url, sizeof(url), &nb_log_chars, "tiny-track-%d", i);
+        config->object_sources[i] = test_media_object_source_publish(config->nodes[0], (uint8_t*)url,
+            strlen(url), NULL, &tiny_track, 1, config->simulated_time + 100 * i);
+        if (config->object_sources[i] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        quicrq_set_datagram_bundling(config->nodes[0], is_bundled);
+        /* Create a quicrq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+    }
+
+    for (int i = 0; ret == 0 && i < QUICRQ_BUNDLE_TEST_NB_TRACKS; i++) {
+        /* Subscribe to each track */
+        (void)picoquic_sprintf(url, sizeof(url), &nb_log_chars, "tiny-track-%d", i);
+        (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "bundle-recv-%d-%d-%llx.bin",
+            i, is_bundled, (unsigned long long)simulate_losses);
+        (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "bundle-log-%d-%d-%llx.csv",
+            i, is_bundled, (unsigned long long)simulate_losses);
+        if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)url, strlen(url), quicrq_transport_mode_datagram,
+            result_file_name, result_log_name) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", url, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        quicrq_cnx_ctx_t* origin_cnx_ctx = config->nodes[0]->first_cnx;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Monitor the state and the bytes sent by the origin */
+        if (origin_cnx_ctx != NULL && origin_cnx_ctx->cnx != NULL) {
+            size_t state_size = quicrq_bundle_test_state_size(origin_cnx_ctx);
+            if (state_size > *state_size_max) {
+                *state_size_max = state_size;
+            }
+            *bytes_sent = picoquic_get_data_sent(origin_cnx_ctx->cnx);
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if all the tracks are received by the client, exit the loop */
+        if (config->nodes[1]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && config->nodes[1]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[1]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        DBG_PRINTF("%d tracks, bundling %s, state size %zu bytes, %" PRIu64 " bytes sent",
+            QUICRQ_BUNDLE_TEST_NB_TRACKS, (is_bundled) ? "on" : "off", *state_size_max, *bytes_sent);
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    /* Clear everything, so the result files are closed before they are read */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    /* Verify that every track was received in full */
+    for (int i = 0; ret == 0 && i < QUICRQ_BUNDLE_TEST_NB_TRACKS; i++) {
+        (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "bundle-recv-%d-%d-%llx.bin",
+            i, is_bundled, (unsigned long long)simulate_losses);
+        ret = quicrq_compare_generated_media_file(result_file_name, &tiny_track);
+        if (ret != 0) {
+            DBG_PRINTF("Track %d not received correctly in %s", i, result_file_name);
+        }
+    }
+
+    return ret;
+}
+
+/* Compare the bytes sent with and without bundling.
+ * Bundling shall reduce the number of bytes on the wire.
+ */
+int quicrq_bundle_test_compare(uint64_t simulate_losses)
+{
+    uint64_t separate_bytes = 0;
+    uint64_t bundled_bytes = 0;
+    size_t state_size = 0;
+    int ret = quicrq_bundle_test_one(0, simulate_losses, &separate_bytes, &state_size);
+
+    if (ret == 0) {
+        ret = quicrq_bundle_test_one(1, simulate_losses, &bundled_bytes, &state_size);
+    }
+    if (ret == 0 && (bundled_bytes == 0 || bundled_bytes >= separate_bytes)) {
+        DBG_PRINTF("Bytes sent with bundling %" PRIu64 ", not below bytes without %" PRIu64, bundled_bytes, separate_bytes);
+        ret = -1;
+    }
+    return ret;
+}
+
+int quicrq_bundle_test()
+{
+    return quicrq_bundle_test_compare(0);
+}
+
+int quicrq_bundle_loss_test()
+{
+    return quicrq_bundle_test_compare(0x7080);
+}
@@ -0,0 +1,268 @@
+#include <string.h>
+#include <stdlib.h>
+#include "picoquic_utils.h"
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_test_internal.h"
+
+/* Subscription churn test:
+ * The origin publishes a real time media, and a viewer subscribes to it through a relay:
+ *
+ *             S
+ *             |
+ *             R
+ *             |
+ *             C
+ *
+ * While the viewer receives the media, the client repeatedly opens and closes other
+ * subscriptions to the same media, as would happen with channel surfing or mass
+ * reconnects. The churning subscriptions start at the next group, so they add work
+ * to the relay but almost no traffic. The churn runs twice, with and without pooling
+ * of the released stream and publisher contexts. The test reports the wall clock cost
+ * per subscription in each case, i.e., the wall clock time of the churn run minus that
+ * of a run without churn, divided by the number of subscriptions. It verifies that the
+ * relay recycles the released contexts when pooling is on, and that the 99th percentile
+ * of the viewer's delivery delay is not much above the value measured without churn.
+ */
+#define QUICRQ_CHURN_TEST_SLOTS 4
+#define QUICRQ_CHURN_TEST_START 1000000
+#define QUICRQ_CHURN_TEST_END 7000000
+#define QUICRQ_CHURN_TEST_INTERVAL 50000
+#define QUICRQ_CHURN_TEST_P99_MARGIN 50000
+
+int quicrq_churn_test_one(int is_churn, int is_pooled, uint64_t* p99, uint64_t* wall_clock_duration, int* nb_subscribes)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_relay_config_create(0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    test_object_stream_ctx_t* churn_ctx[QUICRQ_CHURN_TEST_SLOTS] = { 0 };
+    uint64_t next_churn_time = (is_churn) ? QUICRQ_CHURN_TEST_START : UINT64_MAX;
+    uint64_t wall_clock_start = 0;
+    uint64_t* delays = NULL;
+    size_t nb_delays = 0;
+    size_t delays_alloc = 0;
+    int nb_losses = 0;
+    const int p99_rank = 99;
+    char media_source_path[512];
+    char result_file_name[256];
+    char result_log_name[256];
+    size_t nb_log_chars = 0;
+
+    *p99 = UINT64_MAX;
+    *wall_clock_duration = 0;
+    *nb_subscribes = 0;
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "churn-video1-recv-%d-%d.bin", is_churn, is_pooled);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "churn-video1-log-%d-%d.csv", is_churn, is_pooled);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+    else if (!is_pooled) {
+        /* Release the closed stream and publisher contexts instead of keeping them for reuse */
+        for (int i = 0; i < config->nb_nodes; i++) {
+            config->nodes[i]->context_pool_max = 0;
+        }
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Add a real time test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Configure the relay: set the server address */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, quicrq_transport_mode_single_stream);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quicrq connection context on client, and subscribe the viewer to the media */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 2, 1);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), quicrq_transport_mode_single_stream, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    wall_clock_start = picoquic_current_time();
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        if (config->simulated_time >= next_churn_time) {
+            if (config->simulated_time < QUICRQ_CHURN_TEST_END) {
+                /* Replace the oldest churning subscription by a new one */
+                int slot = *nb_subscribes % QUICRQ_CHURN_TEST_SLOTS;
+                char churn_file_name[256];
+                char churn_log_name[256];
+                quicrq_subscribe_intent_t intent = { 0 };
+
+                intent.intent_mode = quicrq_subscribe_intent_next_group;
+                (void)picoquic_sprintf(churn_file_name, sizeof(churn_file_name), &nb_log_chars, "churn-video1-recv-slot-%d.bin", slot);
+                (void)picoquic_sprintf(churn_log_name, sizeof(churn_log_name), &nb_log_chars, "churn-video1-log-slot-%d.csv", slot);
+                test_object_stream_unsubscribe(churn_ctx[slot]);
+                churn_ctx[slot] = test_object_stream_subscribe_ex(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+                    strlen(QUICRQ_TEST_BASIC_SOURCE), quicrq_transport_mode_single_stream, quicrq_subscribe_in_order, &intent,
+                    churn_file_name, churn_log_name);
+                if (churn_ctx[slot] == NULL) {
+                    ret = -1;
+                    DBG_PRINTF("Cannot renew churning subscription %d, ret = %d", *nb_subscribes, ret);
+                    break;
+                }
+                *nb_subscribes += 1;
+                next_churn_time += QUICRQ_CHURN_TEST_INTERVAL;
+            }
+            else {
+                /* End of the churn period: close the remaining churning subscriptions */
+                for (int i = 0; i < QUICRQ_CHURN_TEST_SLOTS; i++) {
+                    test_object_stream_unsubscribe(churn_ctx[i]);
+                    churn_ctx[i] = NULL;
+                }
+                next_churn_time = UINT64_MAX;
+            }
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, next_churn_time);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received, exit the loop */
+        if (config->nodes[2]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && next_churn_time == UINT64_MAX && config->nodes[2]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[2]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    *wall_clock_duration = picoquic_current_time() - wall_clock_start;
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0 && is_churn && (is_pooled != 0) != (config->nodes[1]->nb_free_streams != 0 && config->nodes[1]->nb_free_publishers != 0)) {
+        DBG_PRINTF("Pooling %s, relay kept %zu streams, %zu publishers", (is_pooled) ? "on" : "off",
+            config->nodes[1]->nb_free_streams, config->nodes[1]->nb_free_publishers);
+        ret = -1;
+    }
+
+    /* Clear everything, so the log file is closed before it is read */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    if (ret == 0) {
+        ret = quicrq_log_file_delays(result_log_name, &delays, &nb_delays, &delays_alloc, &nb_losses);
+        if (ret == 0 && nb_delays == 0) {
+            ret = -1;
+        }
+        if (ret != 0) {
+            DBG_PRINTF("Cannot read the delays in %s", result_log_name);
+        }
+        else {
+            quicrq_delay_percentiles(delays, nb_delays, &p99_rank, 1, p99);
+        }
+    }
+
+    if (delays != NULL) {
+        free(delays);
+    }
+
+    return ret;
+}
+
+/* Estimate the wall clock cost of a subscription, from the duration of a churn
+ * run and that of the run without churn.
+ */
+static uint64_t quicrq_churn_test_cost(uint64_t churn_duration, uint64_t quiet_duration, int nb_subscribes)
+{
+    uint64_t cost = 0;
+
+    if (nb_subscribes > 0 && churn_duration > quiet_duration) {
+        cost = (churn_duration - quiet_duration) / (uint64_t)nb_subscribes;
+    }
+    return cost;
+}
+
+/* Compare the wall clock cost of subscriptions with and without pooling,
+ * and the viewer's delivery delays with and without churn.
+ */
+int quicrq_churn_test()
+{
+    uint64_t quiet_p99 = 0;
+    uint64_t pooled_p99 = 0;
+    uint64_t unpooled_p99 = 0;
+    uint64_t quiet_duration = 0;
+    uint64_t pooled_duration = 0;
+    uint64_t unpooled_duration = 0;
+    int nb_quiet_subscribes = 0;
+    int nb_pooled_subscribes = 0;
+    int nb_unpooled_subscribes = 0;
+    int ret = quicrq_churn_test_one(0, 1, &quiet_p99, &quiet_duration, &nb_quiet_subscribes);
+
+    if (ret == 0) {
+        ret = quicrq_churn_test_one(1, 1, &pooled_p99, &pooled_duration, &nb_pooled_subscribes);
+    }
+    if (ret == 0) {
+        ret = quicrq_churn_test_one(1, 0, &unpooled_p99, &unpooled_duration, &nb_unpooled_subscribes);
+    }
+    if (ret == 0) {
+        DBG_PRINTF("%d subscribes, wall clock cost per subscribe %" PRIu64 " us with pooling, %" PRIu64 " us without",
+            nb_pooled_subscribes, quicrq_churn_test_cost(pooled_duration, quiet_duration, nb_pooled_subscribes),
+            quicrq_churn_test_cost(unpooled_duration, quiet_duration, nb_unpooled_subscribes));
+        if (pooled_p99 > quiet_p99 + QUICRQ_CHURN_TEST_P99_MARGIN || unpooled_p99 > quiet_p99 + QUICRQ_CHURN_TEST_P99_MARGIN) {
+            DBG_PRINTF("Viewer p99 with churn %" PRIu64 " pooled, %" PRIu64 " unpooled, versus %" PRIu64 " without",
+                pooled_p99, unpooled_p99, quiet_p99);
+            ret = -1;
+        }
+    }
+    return ret;
+}
@@ -29,6 +29,19 @@ typedef struct st_quicrq_congestion_test_t {
     uint8_t min_loss_flag;
     uint64_t average_delay_target;
     uint64_t max_delay_target;
+    uint64_t extra_repeat_delay;
+    int extra_repeat_congestion_aware;
+    uint64_t extra_repeat_budget_percent;
+    int declare_dependency;
+    /* Results, filled by the test */
+    uint64_t nb_extra_repeat_sent;
+    uint64_t nb_extra_repeat_dropped;
+    uint64_t extra_repeat_bytes_sent;
+    int nb_frames_received;
+    int nb_frames_lost;
+    uint64_t delay_average;
+    int nb_frames_decodable;
+    uint64_t undecodable_bytes;
 } quicrq_congestion_test_t;
 
 static const quicrq_congestion_test_t congestion_test_default = {
@@ -41,6 +54,18 @@ static const quicrq_congestion_test_t congestion_test_default = {
     0x82, /* Default flag */
     0, /* Average delay needs to be set per test */
     0, /* Max delay needs to be set per test */
+    0, /* No extra repeat */
+    0, /* No extra repeat policy */
+    0, /* No extra repeat budget */
+    0, /* No dependency declared */
+    0, /* Extra repeats sent, filled by the test */
+    0, /* Extra repeats dropped, filled by the test */
+    0, /* Extra repeat bytes sent, filled by the test */
+    0, /* Frames received, filled by the test */
+    0, /* Frames lost, filled by the test */
+    0, /* Average delay, filled by the test */
+    0, /* Decodable frames, filled by the test */
+    0 /* Undecodable bytes, filled by the test */
 };
 
 /* Create a test network */
@@ -75,8 +100,14 @@ quicrq_test_config_t* quicrq_test_congestion_config_create(quicrq_congestion_tes
             ret = -1;
         }
 
-        for (int i = 0; i < 3; i++) {
+        for (int i = 0; ret == 0 && i < 3; i++) {
             quicrq_enable_congestion_control(config->nodes[i], spec->congestion_control_mode);
+            if (spec->extra_repeat_delay > 0) {
+                quicrq_set_extra_repeat(config->nodes[i], 1, 1);
+                quicrq_set_extra_repeat_delay(config->nodes[i], spec->extra_repeat_delay);
+                quicrq_set_extra_repeat_policy(config->nodes[i], spec->extra_repeat_congestion_aware,
+                    spec->extra_repeat_budget_percent);
+            }
         }
     }
 
@@ -163,6 +194,15 @@ int quicrq_congestion_test_one(int is_real_time, quicrq_transport_mode_enum tran
         quicrq_transport_mode_to_letter(transport_mode), (int)spec->congestion_control_mode,
         (int) spec->subscribe_order,
         (unsigned long long)spec->simulate_losses, spec->congested_receiver, (int)spec->congestion_mode);
+    if (spec->extra_repeat_delay > 0) {
+        size_t id_length = strlen(test_id);
+        (void)picoquic_sprintf(test_id + id_length, sizeof(test_id) - id_length, NULL, "-x%d-%d",
+            spec->extra_repeat_congestion_aware, (int)spec->extra_repeat_budget_percent);
+    }
+    if (spec->declare_dependency) {
+        size_t id_length = strlen(test_id);
+        (void)picoquic_sprintf(test_id + id_length, sizeof(test_id) - id_length, NULL, "-dep");
+    }
     (void)picoquic_sprintf(text_log_name, sizeof(text_log_name), &nb_log_chars, "%s_textlog.txt", test_id);
     (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), NULL, "%s_video1.bin", test_id);
     (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), NULL, "%s_video1.csv", test_id);
@@ -198,6 +238,9 @@ int quicrq_congestion_test_one(int is_real_time, quicrq_transport_mode_enum tran
         if (config->object_sources[0] == NULL) {
             ret = -1;
         }
+        else {
+            config->object_sources[0]->declare_dependency = spec->declare_dependency;
+        }
     }
 
     if (ret == 0) {
@@ -312,6 +355,22 @@ int quicrq_congestion_test_one(int is_real_time, quicrq_transport_mode_enum tran
         ret = -1;
     }
 
+    /* Collect the extra repeat statistics. */
+    if (config != NULL) {
+        spec->nb_extra_repeat_sent = 0;
+        spec->nb_extra_repeat_dropped = 0;
+        spec->extra_repeat_bytes_sent = 0;
+        for (int i = 0; i < 3; i++) {
+            uint64_t nb_sent;
+            uint64_t nb_dropped;
+            uint64_t bytes_sent;
+            quicrq_get_extra_repeat_statistics(config->nodes[i], &nb_sent, &nb_dropped, &bytes_sent);
+            spec->nb_extra_repeat_sent += nb_sent;
+            spec->nb_extra_repeat_dropped += nb_dropped;
+            spec->extra_repeat_bytes_sent += bytes_sent;
+        }
+    }
+
     /* Clear everything. */
     if (config != NULL) {
         quicrq_test_config_delete(config);
@@ -345,6 +404,15 @@ int quicrq_congestion_test_one(int is_real_time, quicrq_transport_mode_enum tran
 
                     ret = quicrq_log_file_statistics(result_log_name, &nb_frames, &nb_losses,
                         &delay_average, &delay_min, &delay_max);
+                    spec->nb_frames_received = nb_frames;
+                    spec->nb_frames_lost = nb_losses;
+                    spec->delay_average = delay_average;
+
+                    if (ret == 0) {
+                        int nb_logged = 0;
+                        ret = quicrq_log_file_decodable(result_log_name, &nb_logged,
+                            &spec->nb_frames_decodable, &spec->undecodable_bytes);
+                    }
 
                     if (ret == 0){
                         if (nb_losses != observed_drops) {
@@ -544,6 +612,109 @@ int quicrq_congestion_datagram_loss_test()
     return ret;
 }
 
+/* Compare the extra repeat process with and without the congestion aware
+ * policy, on a congested and lossy link. The policy shall reduce the
+ * number of bytes sent in extra copies, without degrading delivery.
+ */
+int quicrq_congestion_extra_repeat_test()
+{
+    quicrq_congestion_test_t spec[2];
+    int ret = 0;
+
+    for (int i = 0; ret == 0 && i < 2; i++) {
+        spec[i] = congestion_test_default;
+        spec[i].simulate_losses = 0x7080;
+        spec[i].congested_receiver = 0;
+        spec[i].max_drops = 95;
+        spec[i].min_loss_flag = 0x82;
+        spec[i].average_delay_target = 230000;
+        spec[i].max_delay_target = 750000;
+        spec[i].congestion_control_mode = quicrq_congestion_control_delay;
+        spec[i].extra_repeat_delay = 10000;
+        spec[i].extra_repeat_congestion_aware = i;
+        spec[i].extra_repeat_budget_percent = (i == 0) ? 0 : 10;
+
+        ret = quicrq_congestion_test_one(1, quicrq_transport_mode_datagram, &spec[i]);
+        if (ret != 0) {
+            DBG_PRINTF("Extra repeat test fails, policy = %d, ret = %d", i, ret);
+        }
+        else {
+            DBG_PRINTF("Extra repeat policy %d: %" PRIu64 " copies sent (%" PRIu64 " bytes), %" PRIu64 " dropped, %d frames, %d lost, average delay %" PRIu64,
+                i, spec[i].nb_extra_repeat_sent, spec[i].extra_repeat_bytes_sent, spec[i].nb_extra_repeat_dropped,
+                spec[i].nb_frames_received, spec[i].nb_frames_lost, spec[i].delay_average);
+        }
+    }
+
+    if (ret == 0) {
+        if (spec[0].nb_extra_repeat_dropped != 0) {
+            DBG_PRINTF("%" PRIu64 " extra copies dropped without policy", spec[0].nb_extra_repeat_dropped);
+            ret = -1;
+        }
+        else if (spec[1].extra_repeat_bytes_sent > spec[0].extra_repeat_bytes_sent) {
+            DBG_PRINTF("Extra repeat bytes %" PRIu64 " with policy, %" PRIu64 " without",
+                spec[1].extra_repeat_bytes_sent, spec[0].extra_repeat_bytes_sent);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+/* Compare congestion skipping with and without dependency classes.
+ * When dependencies are declared, the objects that depend on a skipped
+ * object are also skipped, so the receiver should not get objects that
+ * it cannot decode. The number of drops increases, but the bytes spent
+ * on undecodable objects shall not.
+ */
+int quicrq_congestion_dependency_test()
+{
+    quicrq_congestion_test_t spec[2];
+    int ret = 0;
+
+    for (int i = 0; ret == 0 && i < 2; i++) {
+        spec[i] = congestion_test_default;
+        spec[i].simulate_losses = 0;
+        spec[i].congested_receiver = 0;
+        spec[i].max_drops = (i == 0) ? 74 : 400;
+        spec[i].min_loss_flag = 0x82;
+        spec[i].average_delay_target = 220000;
+        spec[i].max_delay_target = 690000;
+        spec[i].congestion_control_mode = quicrq_congestion_control_delay;
+        spec[i].declare_dependency = i;
+
+        ret = quicrq_congestion_test_one(1, quicrq_transport_mode_datagram, &spec[i]);
+        if (ret != 0) {
+            DBG_PRINTF("Dependency test fails, declared = %d, ret = %d", i, ret);
+        }
+        else {
+            DBG_PRINTF("Dependency %d: %d frames, %d lost, %d decodable, %" PRIu64 " undecodable bytes",
+                i, spec[i].nb_frames_received, spec[i].nb_frames_lost, spec[i].nb_frames_decodable,
+                spec[i].undecodable_bytes);
+        }
+    }
+
+    if (ret == 0) {
+        double decodable_ratio[2];
+
+        for (int i = 0; i < 2; i++) {
+            int nb_received = spec[i].nb_frames_received - spec[i].nb_frames_lost;
+            decodable_ratio[i] = (nb_received > 0) ? ((double)spec[i].nb_frames_decodable) / ((double)nb_received) : 0;
+        }
+        if (spec[1].undecodable_bytes > spec[0].undecodable_bytes) {
+            DBG_PRINTF("Undecodable bytes %" PRIu64 " with dependency, %" PRIu64 " without",
+                spec[1].undecodable_bytes, spec[0].undecodable_bytes);
+            ret = -1;
+        }
+        else if (decodable_ratio[1] < decodable_ratio[0]) {
+            DBG_PRINTF("Decodable ratio %f with dependency, %f without",
+                decodable_ratio[1], decodable_ratio[0]);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
 int quicrq_congestion_datagram_recv_test()
 {
     quicrq_congestion_test_t spec = congestion_test_default;
@@ -0,0 +1,347 @@
+#include <string.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_test_internal.h"
+
+/* Fan out test:
+ * The origin publishes a media, many clients subscribe to it through a relay.
+ * The configuration diagram is:
+ *
+ *             S
+ *             |
+ *             R
+ *          /  |   \
+ *        C1  C2 .. Cn
+ *
+ * The test polls the statistics of the relay, and computes the spread between
+ * the first byte latency of the best and worst served subscribers. When the relay
+ * is simulated as busy, sending one packet at a time, the subscribers woken up
+ * first are served first, and rotating the wake up order shall reduce the spread.
+ *
+ * With extra repeats enabled at the relay, the test also reports the peak
+ * memory held in copies of the repeated payloads.
+ */
+#define QUICRQ_FANOUT_NB_CLIENTS 8
+#define QUICRQ_FANOUT_BUSY_PACKET_TIME 100
+
+/* Create a test network */
+quicrq_test_config_t* quicrq_test_fanout_config_create(uint64_t simulate_loss)
+{
+    /* Create a configuration with one origin, one relay, and the clients. Two links
+     * and two attachment points per connection. */
+    int nb_nodes = 2 + QUICRQ_FANOUT_NB_CLIENTS;
+    int nb_links = 2 * (1 + QUICRQ_FANOUT_NB_CLIENTS);
+    quicrq_test_config_t* config = quicrq_test_config_create(nb_nodes, nb_links, nb_links, 1);
+    if (config != NULL) {
+        /* Create the contexts for the origin (0), relay (1) and clients (2 to n+1) */
+        for (int i = 0; i < nb_nodes; i++) {
+            if (i < 2) {
+                config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                    config->test_server_cert_file, config->test_server_key_file, NULL, NULL, NULL,
+                    config->ticket_encryption_key, sizeof(config->ticket_encryption_key),
+                    &config->simulated_time);
+            }
+            else {
+                config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                    NULL, NULL, config->test_server_cert_store_file, NULL, NULL,
+                    NULL, 0, &config->simulated_time);
+            }
+            if (config->nodes[i] == NULL) {
+                quicrq_test_config_delete(config);
+                config = NULL;
+                break;
+            }
+        }
+    }
+    if (config != NULL) {
+        /* Populate the links and attachments */
+        /* S to R: links 0 and 1, then R to Ci: links 2i and 2i+1 */
+        for (int i = 0; i <= QUICRQ_FANOUT_NB_CLIENTS; i++) {
+            int link_id = 2 * i;
+            config->return_links[link_id] = link_id + 1;
+            config->attachments[link_id].link_id = link_id;
+            config->attachments[link_id].node_id = (i == 0) ? 0 : 1;
+            config->return_links[link_id + 1] = link_id;
+            config->attachments[link_id + 1].link_id = link_id + 1;
+            config->attachments[link_id + 1].node_id = i + 1;
+        }
+        /* Set the desired loss pattern */
+        config->simulate_loss = simulate_loss;
+    }
+    return config;
+}
+
+/* Poll the first byte latency of the sending streams of the relay.
+ * Only retain the poll if all subscribers are present.
+ */
+static void quicrq_fanout_test_poll(quicrq_ctx_t* qr_ctx, uint64_t current_time, uint64_t* latency)
+{
+    uint64_t polled[QUICRQ_FANOUT_NB_CLIENTS];
+    int nb_senders = 0;
+    quicrq_cnx_ctx_t* cnx_ctx = quicrq_first_connection(qr_ctx);
+    quicrq_stream_statistics_t stats[4];
+
+    while (cnx_ctx != NULL) {
+        size_t nb_stats = 0;
+
+        if (quicrq_cnx_get_stream_statistics(cnx_ctx, stats, 4, &nb_stats, current_time) == 0) {
+            for (size_t i = 0; i < nb_stats && i < 4; i++) {
+                if (stats[i].is_sender && nb_senders < QUICRQ_FANOUT_NB_CLIENTS) {
+                    polled[nb_senders] = stats[i].first_byte_latency_average;
+                    nb_senders++;
+                }
+            }
+        }
+        cnx_ctx = quicrq_next_connection(cnx_ctx);
+    }
+    if (nb_senders == QUICRQ_FANOUT_NB_CLIENTS) {
+        memcpy(latency, polled, sizeof(polled));
+    }
+}
+
+int quicrq_fanout_test_one_ex(quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses, int is_rotation_disabled,
+    int extra_repeat_mode, uint64_t busy_packet_time, uint64_t* latency_spread, uint64_t* extra_copy_peak)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_fanout_config_create(simulate_losses);
+    char media_source_path[512];
+    char result_file_name[QUICRQ_FANOUT_NB_CLIENTS][256];
+    char result_log_name[QUICRQ_FANOUT_NB_CLIENTS][256];
+    uint64_t latency[QUICRQ_FANOUT_NB_CLIENTS] = { 0 };
+    uint64_t next_poll_time = 0;
+    size_t nb_log_chars = 0;
+
+    for (int i = 0; i < QUICRQ_FANOUT_NB_CLIENTS; i++) {
+        (void)picoquic_sprintf(result_file_name[i], sizeof(result_file_name[i]), &nb_log_chars, "fanout-video1-recv-%d-%c-%d-%d-%d-%llx.bin",
+            i + 1, quicrq_transport_mode_to_letter(transport_mode), is_rotation_disabled, extra_repeat_mode, (busy_packet_time > 0),
+            (unsigned long long)simulate_losses);
+        (void)picoquic_sprintf(result_log_name[i], sizeof(result_log_name[i]), &nb_log_chars, "fanout-video1-log-%d-%c-%d-%d-%d-%llx.csv",
+            i + 1, quicrq_transport_mode_to_letter(transport_mode), is_rotation_disabled, extra_repeat_mode, (busy_packet_time > 0),
+            (unsigned long long)simulate_losses);
+    }
+
+    if (config == NULL) {
+        ret = -1;
+    }
+    else {
+        /* Simulate a busy relay, if required */
+        config->busy_node_id = 1;
+        config->busy_packet_time = busy_packet_time;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Add a real time test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Configure the relay: set the server address */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, transport_mode);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+        config->nodes[1]->is_wakeup_rotation_disabled = is_rotation_disabled;
+        if (extra_repeat_mode != 0) {
+            /* Enable extra repeats at the relay. In mode 2, force copying the repeated payloads. */
+            quicrq_set_extra_repeat(config->nodes[1], 1, 1);
+            quicrq_set_extra_repeat_delay(config->nodes[1], 10000);
+            config->nodes[1]->is_extra_repeat_copy_forced = (extra_repeat_mode == 2);
+        }
+    }
+
+    for (int i = 0; ret == 0 && i < QUICRQ_FANOUT_NB_CLIENTS; i++) {
+        /* Create a quicrq connection context on each client, and subscribe to the media */
+        quicrq_cnx_ctx_t* cnx_ctx = quicrq_test_create_client_cnx(config, i + 2, 1);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection %d, ret = %d", i + 2, ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name[i], result_log_name[i]) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+        else if (config->simulated_time >= next_poll_time) {
+            /* Poll the relay statistics every 100 ms */
+            quicrq_fanout_test_poll(config->nodes[1], config->simulated_time, latency);
+            next_poll_time = config->simulated_time + 100000;
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received by all clients, exit the loop */
+        if (ret == 0) {
+            int all_closed = 1;
+            int all_done = 1;
+
+            for (int i = 0; i < QUICRQ_FANOUT_NB_CLIENTS; i++) {
+                quicrq_ctx_t* client_ctx = config->nodes[i + 2];
+                all_closed &= (client_ctx->first_cnx == NULL);
+                all_done &= (client_ctx->first_cnx == NULL || client_ctx->first_cnx->first_stream == NULL);
+            }
+
+            if (all_closed) {
+                DBG_PRINTF("%s", "Exit loop after all client connection closed.");
+                break;
+            }
+            else if (!is_closed && all_done) {
+                /* Clients are done. Close connections without waiting for timer -- if not closed yet */
+                is_closed = 1;
+                for (int i = 0; ret == 0 && i < QUICRQ_FANOUT_NB_CLIENTS; i++) {
+                    if (config->nodes[i + 2]->first_cnx != NULL) {
+                        ret = quicrq_close_cnx(config->nodes[i + 2]->first_cnx);
+                        if (ret != 0) {
+                            DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Compute the spread between best and worst served subscribers */
+        uint64_t latency_min = UINT64_MAX;
+        uint64_t latency_max = 0;
+
+        for (int i = 0; i < QUICRQ_FANOUT_NB_CLIENTS; i++) {
+            if (latency[i] < latency_min) {
+                latency_min = latency[i];
+            }
+            if (latency[i] > latency_max) {
+                latency_max = latency[i];
+            }
+        }
+        *latency_spread = latency_max - latency_min;
+        *extra_copy_peak = config->nodes[1]->extra_repeat_copy_bytes_peak;
+        DBG_PRINTF("Fan out %d clients, rotation %s, first byte latency from %" PRIu64 " to %" PRIu64,
+            QUICRQ_FANOUT_NB_CLIENTS, (is_rotation_disabled) ? "off" : "on", latency_min, latency_max);
+        DBG_PRINTF("Extra repeats: %" PRIu64 " sent, peak of %" PRIu64 " bytes in payload copies",
+            config->nodes[1]->nb_extra_repeat_sent, *extra_copy_peak);
+    }
+
+    /* Verify that media file was received correctly */
+    if (ret == 0) {
+        for (int i = 0; ret == 0 && i < QUICRQ_FANOUT_NB_CLIENTS; i++) {
+            ret = quicrq_compare_media_file(result_file_name[i], media_source_path);
+        }
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    return ret;
+}
+
+int quicrq_fanout_test_one(quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses, int is_rotation_disabled,
+    uint64_t busy_packet_time, uint64_t* latency_spread)
+{
+    uint64_t extra_copy_peak = 0;
+
+    return quicrq_fanout_test_one_ex(transport_mode, simulate_losses, is_rotation_disabled, 0, busy_packet_time,
+        latency_spread, &extra_copy_peak);
+}
+
+/* Compare the latency spread with and without rotating the wake up order.
+ * Rotation shall not make the spread worse. If the relay is busy, rotation
+ * shall make the spread strictly smaller.
+ */
+int quicrq_fanout_test_compare(quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses, uint64_t busy_packet_time)
+{
+    uint64_t fixed_spread = 0;
+    uint64_t rotated_spread = 0;
+    int ret = quicrq_fanout_test_one(transport_mode, simulate_losses, 1, busy_packet_time, &fixed_spread);
+
+    if (ret == 0) {
+        ret = quicrq_fanout_test_one(transport_mode, simulate_losses, 0, busy_packet_time, &rotated_spread);
+    }
+    if (ret == 0 && (rotated_spread > fixed_spread || (busy_packet_time > 0 && rotated_spread >= fixed_spread))) {
+        DBG_PRINTF("Latency spread with rotation %" PRIu64 ", not below %" PRIu64 " without", rotated_spread, fixed_spread);
+        ret = -1;
+    }
+    return ret;
+}
+
+int quicrq_fanout_basic_test()
+{
+    return quicrq_fanout_test_compare(quicrq_transport_mode_single_stream, 0, 0);
+}
+
+int quicrq_fanout_datagram_test()
+{
+    return quicrq_fanout_test_compare(quicrq_transport_mode_datagram, 0, 0);
+}
+
+int quicrq_fanout_busy_test()
+{
+    return quicrq_fanout_test_compare(quicrq_transport_mode_single_stream, 0, QUICRQ_FANOUT_BUSY_PACKET_TIME);
+}
+
+/* Compare the memory held for extra repeats at the relay, when copying the
+ * payloads and when reading them from the cache at repeat time.
+ */
+int quicrq_fanout_repeat_test()
+{
+    uint64_t latency_spread = 0;
+    uint64_t copied_peak = 0;
+    uint64_t cached_peak = 0;
+    int ret = quicrq_fanout_test_one_ex(quicrq_transport_mode_datagram, 0x7080, 0, 2, 0, &latency_spread, &copied_peak);
+
+    if (ret == 0) {
+        ret = quicrq_fanout_test_one_ex(quicrq_transport_mode_datagram, 0x7080, 0, 1, 0, &latency_spread, &cached_peak);
+    }
+    if (ret == 0 && (copied_peak == 0 || cached_peak >= copied_peak)) {
+        DBG_PRINTF("Repeat copies peak at %" PRIu64 " bytes, not below %" PRIu64 " when copying", cached_peak, copied_peak);
+        ret = -1;
+    }
+    return ret;
+}
@@ -190,7 +190,7 @@ int quicrq_fragment_cache_fill_test_one(size_t fragment_max, size_t start_object
                         ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[f_id].data + offset,
                             fragment_test_objects[f_id].group_id, fragment_test_objects[f_id].object_id,
                             offset, 0, 0, nb_objects_previous_group,
-                            fragment_test_objects[f_id].length, data_length, 0);
+                            fragment_test_objects[f_id].length, 0, data_length, 0);
                         if (ret != 0) {
                             DBG_PRINTF("Proposed segment fails, object %zu, offset %zu, pass %d, ret %d", f_id, offset, pass, ret);
                         }
@@ -300,10 +300,11 @@ int quicrq_fragment_cache_publish_simulate(quicrq_fragment_publisher_context_t*
                     uint64_t media_id;
                     uint64_t object_offset;
                     uint64_t queue_delay;
+                    uint64_t origin_timestamp;
                     const uint8_t* datagram_max = bytes + datagram_length;
 
                     bytes = quicrq_datagram_header_decode(bytes, datagram_max, &media_id,
-                        &group_id, &object_id, &object_offset, &queue_delay, &flags, &nb_objects_previous_group, &object_length);
+                        &group_id, &object_id, &object_offset, &queue_delay, &flags, &nb_objects_previous_group, &object_length, &origin_timestamp);
                     if (bytes == NULL) {
                         DBG_PRINTF("Cannot decode datagram header, length = %zu", datagram_length);
                         ret = -1;
@@ -373,7 +374,7 @@ int quicrq_fragment_cache_publish_simulate(quicrq_fragment_publisher_context_t*
         if (ret == 0 && fragment_length > 0) {
             /* submit to the media cache */
             ret = quicrq_fragment_propose_to_cache(cache_ctx_p,
-                fragment, group_id, object_id, fragment_offset, 0, flags, nb_objects_previous_group, object_length, fragment_length, 0);
+                fragment, group_id, object_id, fragment_offset, 0, flags, nb_objects_previous_group, object_length, 0, fragment_length, 0);
         }
     } while (ret == 0 && fragment_length > 0);
 
@@ -451,7 +452,7 @@ int quicrq_fragment_cache_publish_test_one(int is_datagram)
                     }
                     ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[f_id].data + offset,
                         fragment_test_objects[f_id].group_id, fragment_test_objects[f_id].object_id,
-                        offset, 0, 0, nb_objects_previous_group, fragment_test_objects[f_id].length, data_length, 0);
+                        offset, 0, 0, nb_objects_previous_group, fragment_test_objects[f_id].length, 0, data_length, 0);
                     if (ret != 0) {
                         DBG_PRINTF("Proposed segment fails, object %zu, offset %zu, pass %d, ret %d", f_id, offset, pass, ret);
                     }
@@ -561,3 +562,702 @@ int quicrq_fragment_cache_fill_test()
 
     return ret;
 }
+
+/* Time index test.
+ * Fill the cache with the test objects, each group starting one second after the
+ * previous one, then verify that seeking by time finds the expected groups, before
+ * and after the cache is pruned.
+ */
+int quicrq_fragment_cache_seek_time_test()
+{
+    int ret = 0;
+    uint64_t group_id = UINT64_MAX;
+    quicrq_media_source_ctx_t* srce_ctx = (quicrq_media_source_ctx_t*)malloc(sizeof(quicrq_media_source_ctx_t));
+    quicrq_fragment_cache_t* cache_ctx = quicrq_fragment_cache_create_ctx(NULL);
+
+    if (cache_ctx == NULL || srce_ctx == NULL) {
+        ret = -1;
+    }
+    else {
+        memset(srce_ctx, 0, sizeof(quicrq_media_source_ctx_t));
+        cache_ctx->srce_ctx = srce_ctx;
+
+        if (quicrq_fragment_cache_seek_time(cache_ctx, 0, &group_id) == 0) {
+            DBG_PRINTF("%s", "Seek time succeeds on empty cache");
+            ret = -1;
+        }
+
+        for (size_t f_id = 0; ret == 0 && f_id < nb_fragment_test_objects; f_id++) {
+            uint64_t nb_objects_previous_group = 0;
+            /* The origin clock is 7 seconds behind the cache clock, the index shall use the origin clock */
+            uint64_t origin_timestamp = 1000000 * (fragment_test_objects[f_id].group_id + 1) + 10000 * fragment_test_objects[f_id].object_id;
+            uint64_t current_time = origin_timestamp + 7000000;
+            if (fragment_test_objects[f_id].object_id == 0 && fragment_test_objects[f_id].group_id > 0) {
+                nb_objects_previous_group = nb_fragment_test_groups_objects[fragment_test_objects[f_id].group_id - 1];
+            }
+            ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[f_id].data,
+                fragment_test_objects[f_id].group_id, fragment_test_objects[f_id].object_id,
+                0, 0, 0, nb_objects_previous_group,
+                fragment_test_objects[f_id].length, origin_timestamp, fragment_test_objects[f_id].length, current_time);
+        }
+
+        if (ret == 0 && cache_ctx->group_time_tree.size != (int)nb_fragment_test_groups) {
+            DBG_PRINTF("Found %d groups in time index instead of %zu", cache_ctx->group_time_tree.size, nb_fragment_test_groups);
+            ret = -1;
+        }
+
+        if (ret == 0) {
+            const uint64_t seek_time[] = { 0, 1000000, 1500000, 2000000, 2999999, 3000000, 10000000 };
+            const uint64_t seek_group[] = { 0, 0, 0, 1, 1, 2, 2 };
+
+            for (size_t i = 0; ret == 0 && i < sizeof(seek_time) / sizeof(uint64_t); i++) {
+                if (quicrq_fragment_cache_seek_time(cache_ctx, seek_time[i], &group_id) != 0 ||
+                    group_id != seek_group[i]) {
+                    DBG_PRINTF("Seek time %" PRIu64 " returns group %" PRIu64 " instead of %" PRIu64,
+                        seek_time[i], group_id, seek_group[i]);
+                    ret = -1;
+                }
+            }
+        }
+
+        if (ret == 0) {
+            /* Remove the first group from the cache, verify that the index is pruned */
+            ret = quicrq_fragment_cache_learn_start_point(cache_ctx, 1, 0);
+            if (ret == 0 && (quicrq_fragment_cache_seek_time(cache_ctx, 1500000, &group_id) != 0 || group_id != 1)) {
+                DBG_PRINTF("Seek time after prune returns group %" PRIu64 " instead of 1", group_id);
+                ret = -1;
+            }
+        }
+    }
+
+    if (srce_ctx != NULL) {
+        free(srce_ctx);
+    }
+
+    if (cache_ctx != NULL) {
+        quicrq_fragment_cache_delete_ctx(cache_ctx);
+    }
+
+    return ret;
+}
+
+/* Repair deadline test.
+ * Fill the cache with the test objects, except object 0/1, object 1/0 at the beginning
+ * of a group, and the second half of object 1/2. Verify that the missing objects are
+ * only skipped once the deadline expires, that the in sequence point moves past them,
+ * that an in order publisher skips them, and that a late repair is still cached.
+ */
+#define FRAGMENT_REPAIR_TEST_DEADLINE 500000
+
+int quicrq_fragment_cache_repair_deadline_test()
+{
+    int ret = 0;
+    uint64_t current_time = 0;
+    uint64_t simulated_time = 0;
+    uint64_t next_time;
+    struct sockaddr_storage addr = { 0 };
+    quicrq_ctx_t* qr_ctx = quicrq_create(QUICRQ_ALPN, NULL, NULL, NULL, NULL, NULL, NULL, 0, &simulated_time);
+    quicrq_cnx_ctx_t* cnx_ctx = (qr_ctx == NULL) ? NULL : quicrq_create_client_cnx(qr_ctx, NULL, (struct sockaddr*)&addr);
+    quicrq_stream_ctx_t* stream_ctx = (cnx_ctx == NULL) ? NULL : quicrq_create_stream_context(cnx_ctx, 0);
+    quicrq_media_source_ctx_t* srce_ctx = (quicrq_media_source_ctx_t*)malloc(sizeof(quicrq_media_source_ctx_t));
+    quicrq_fragment_cache_t* cache_ctx = quicrq_fragment_cache_create_ctx(NULL);
+    quicrq_fragment_publisher_context_t* pub_ctx = (quicrq_fragment_publisher_context_t*)malloc(sizeof(quicrq_fragment_publisher_context_t));
+    const uint64_t skipped_group[3] = { 0, 1, 1 };
+    const uint64_t skipped_object[3] = { 1, 0, 2 };
+
+    if (cache_ctx == NULL || srce_ctx == NULL || pub_ctx == NULL || stream_ctx == NULL) {
+        ret = -1;
+    }
+    else {
+        memset(srce_ctx, 0, sizeof(quicrq_media_source_ctx_t));
+        cache_ctx->srce_ctx = srce_ctx;
+        memset(pub_ctx, 0, sizeof(quicrq_fragment_publisher_context_t));
+        pub_ctx->cache_ctx = cache_ctx;
+        pub_ctx->stream_ctx = stream_ctx;
+        stream_ctx->media_ctx = pub_ctx;
+
+        for (size_t f_id = 0; ret == 0 && f_id < nb_fragment_test_objects; f_id++) {
+            uint64_t nb_objects_previous_group = 0;
+            size_t length = fragment_test_objects[f_id].length;
+            current_time = 10000 * (uint64_t)f_id;
+            if ((fragment_test_objects[f_id].group_id == 0 && fragment_test_objects[f_id].object_id == 1) ||
+                (fragment_test_objects[f_id].group_id == 1 && fragment_test_objects[f_id].object_id == 0)) {
+                continue;
+            }
+            if (fragment_test_objects[f_id].group_id == 1 && fragment_test_objects[f_id].object_id == 2) {
+                length /= 2;
+            }
+            if (fragment_test_objects[f_id].object_id == 0 && fragment_test_objects[f_id].group_id > 0) {
+                nb_objects_previous_group = nb_fragment_test_groups_objects[fragment_test_objects[f_id].group_id - 1];
+            }
+            ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[f_id].data,
+                fragment_test_objects[f_id].group_id, fragment_test_objects[f_id].object_id,
+                0, 0, 0, nb_objects_previous_group,
+                fragment_test_objects[f_id].length, 0, length, current_time);
+        }
+
+        if (ret == 0) {
+            /* Object 0/2 arrived at time 20000, so the deadline for 0/1 is not expired yet */
+            next_time = quicrq_fragment_cache_check_repair_deadline(cache_ctx, FRAGMENT_REPAIR_TEST_DEADLINE, current_time);
+            if (cache_ctx->nb_repair_skipped != 0 || next_time != 20000 + FRAGMENT_REPAIR_TEST_DEADLINE) {
+                DBG_PRINTF("Skipped %" PRIu64 " objects before the deadline, next time %" PRIu64,
+                    cache_ctx->nb_repair_skipped, next_time);
+                ret = -1;
+            }
+        }
+
+        if (ret == 0) {
+            current_time += 10 * FRAGMENT_REPAIR_TEST_DEADLINE;
+            next_time = quicrq_fragment_cache_check_repair_deadline(cache_ctx, FRAGMENT_REPAIR_TEST_DEADLINE, current_time);
+            if (cache_ctx->nb_repair_skipped != 3 || next_time != UINT64_MAX ||
+                cache_ctx->next_group_id != 2 || cache_ctx->next_object_id != 1 || cache_ctx->next_offset != 0) {
+                DBG_PRINTF("Skipped %" PRIu64 " objects after the deadline, next %" PRIu64 "/%" PRIu64,
+                    cache_ctx->nb_repair_skipped, cache_ctx->next_group_id, cache_ctx->next_object_id);
+                ret = -1;
+            }
+            for (int i = 0; ret == 0 && i < 3; i++) {
+                if (quicrq_fragment_cache_get_repair_skip(cache_ctx, skipped_group[i], skipped_object[i]) == NULL) {
+                    DBG_PRINTF("Object %" PRIu64 "/%" PRIu64 " not skipped", skipped_group[i], skipped_object[i]);
+                    ret = -1;
+                }
+            }
+            if (ret == 0 && quicrq_fragment_get_object_count(cache_ctx, 0) != nb_fragment_test_groups_objects[0]) {
+                DBG_PRINTF("%s", "Object count of group 0 not known after skip of object 1/0");
+                ret = -1;
+            }
+        }
+
+        if (ret == 0) {
+            /* Read the cache in order, as a stream publisher would */
+            int nb_skipped = 0;
+            int nb_sent = 0;
+            int is_new_group = 0;
+            int is_media_finished = 0;
+            int is_still_active = 0;
+            int should_skip = 0;
+            uint8_t flags = 0;
+            uint64_t object_length = 0;
+            size_t data_length = 0;
+            uint8_t data[RELAY_TEST_OBJECT_MAX];
+
+            while (ret == 0 && (pub_ctx->current_group_id < 2 || pub_ctx->current_object_id < 1)) {
+                uint64_t group_id;
+                uint64_t object_id;
+                ret = quicrq_fragment_publisher_fn(quicrq_media_source_get_data, pub_ctx, NULL, sizeof(data),
+                    &data_length, &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &should_skip, current_time);
+                group_id = pub_ctx->current_group_id;
+                object_id = pub_ctx->current_object_id;
+                if (ret != 0) {
+                    break;
+                }
+                else if (should_skip) {
+                    if (quicrq_fragment_cache_get_repair_skip(cache_ctx, group_id, object_id) == NULL) {
+                        DBG_PRINTF("Unexpected skip of object %" PRIu64 "/%" PRIu64, group_id, object_id);
+                        ret = -1;
+                    }
+                    nb_skipped++;
+                    ret = quicrq_fragment_publisher_fn(quicrq_media_source_skip_object, pub_ctx, NULL, 0,
+                        &data_length, &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &should_skip, current_time);
+                }
+                else if (data_length > 0) {
+                    ret = quicrq_fragment_publisher_fn(quicrq_media_source_get_data, pub_ctx, data, sizeof(data),
+                        &data_length, &flags, &is_new_group, &object_length, &is_media_finished, &is_still_active, &should_skip, current_time);
+                    if (pub_ctx->current_offset == 0) {
+                        nb_sent++;
+                    }
+                }
+                else {
+                    DBG_PRINTF("Publisher blocked at %" PRIu64 "/%" PRIu64, group_id, object_id);
+                    ret = -1;
+                }
+            }
+            if (ret == 0 && (nb_skipped != 3 || nb_sent != (int)nb_fragment_test_objects - 3)) {
+                DBG_PRINTF("Publisher skipped %d objects, sent %d", nb_skipped, nb_sent);
+                ret = -1;
+            }
+        }
+
+        if (ret == 0) {
+            /* A late repair is still added to the cache */
+            ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[1].data, 0, 1, 0, 0, 0, 0,
+                fragment_test_objects[1].length, 0, fragment_test_objects[1].length, current_time);
+            if (ret == 0 && (quicrq_fragment_cache_get_fragment(cache_ctx, 0, 1, 0) == NULL ||
+                cache_ctx->next_group_id != 2 || cache_ctx->next_object_id != 1)) {
+                DBG_PRINTF("%s", "Late repair not cached, or in sequence point moved back");
+                ret = -1;
+            }
+        }
+
+        if (ret == 0) {
+            /* After the cache is pruned, the old skips are forgotten */
+            ret = quicrq_fragment_cache_learn_start_point(cache_ctx, 1, 0);
+            (void)quicrq_fragment_cache_check_repair_deadline(cache_ctx, FRAGMENT_REPAIR_TEST_DEADLINE, current_time);
+            if (ret == 0 && (quicrq_fragment_cache_get_repair_skip(cache_ctx, 0, 1) != NULL ||
+                quicrq_fragment_cache_get_repair_skip(cache_ctx, 1, 0) == NULL)) {
+                DBG_PRINTF("%s", "Repair skips not pruned with the cache");
+                ret = -1;
+            }
+        }
+    }
+
+    if (srce_ctx != NULL) {
+        free(srce_ctx);
+    }
+
+    if (cache_ctx != NULL) {
+        quicrq_fragment_cache_delete_ctx(cache_ctx);
+    }
+
+    if (pub_ctx != NULL) {
+        free(pub_ctx);
+    }
+
+    if (qr_ctx != NULL) {
+        /* This will also delete stream_ctx and cnx_ctx */
+        quicrq_delete(qr_ctx);
+    }
+
+    return ret;
+}
+
+/* Watchdog lag test.
+ * Fill a real time cache with the test objects, and position a stream publisher
+ * at the beginning of the first group, more than one group behind the latest.
+ * The publisher is stalled with a lag threshold of one group, unless it is a
+ * fetch, or a subscription that asked to start in the past.
+ */
+int quicrq_fragment_publisher_lag_test()
+{
+    int ret = 0;
+    uint64_t simulated_time = 0;
+    struct sockaddr_storage addr = { 0 };
+    quicrq_ctx_t* qr_ctx = quicrq_create(QUICRQ_ALPN, NULL, NULL, NULL, NULL, NULL, NULL, 0, &simulated_time);
+    quicrq_cnx_ctx_t* cnx_ctx = (qr_ctx == NULL) ? NULL : quicrq_create_client_cnx(qr_ctx, NULL, (struct sockaddr*)&addr);
+    quicrq_stream_ctx_t* stream_ctx = (cnx_ctx == NULL) ? NULL : quicrq_create_stream_context(cnx_ctx, 0);
+    quicrq_media_source_ctx_t* srce_ctx = (quicrq_media_source_ctx_t*)malloc(sizeof(quicrq_media_source_ctx_t));
+    quicrq_fragment_cache_t* cache_ctx = quicrq_fragment_cache_create_ctx(NULL);
+    quicrq_fragment_publisher_context_t* pub_ctx = (quicrq_fragment_publisher_context_t*)malloc(sizeof(quicrq_fragment_publisher_context_t));
+
+    if (cache_ctx == NULL || srce_ctx == NULL || pub_ctx == NULL || stream_ctx == NULL) {
+        ret = -1;
+    }
+    else {
+        memset(srce_ctx, 0, sizeof(quicrq_media_source_ctx_t));
+        cache_ctx->srce_ctx = srce_ctx;
+        memset(pub_ctx, 0, sizeof(quicrq_fragment_publisher_context_t));
+        pub_ctx->cache_ctx = cache_ctx;
+        pub_ctx->stream_ctx = stream_ctx;
+        stream_ctx->media_ctx = pub_ctx;
+        stream_ctx->is_sender = 1;
+        stream_ctx->is_cache_real_time = 1;
+        stream_ctx->transport_mode = quicrq_transport_mode_single_stream;
+
+        for (size_t f_id = 0; ret == 0 && f_id < nb_fragment_test_objects; f_id++) {
+            uint64_t nb_objects_previous_group = 0;
+            if (fragment_test_objects[f_id].object_id == 0 && fragment_test_objects[f_id].group_id > 0) {
+                nb_objects_previous_group = nb_fragment_test_groups_objects[fragment_test_objects[f_id].group_id - 1];
+            }
+            ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[f_id].data,
+                fragment_test_objects[f_id].group_id, fragment_test_objects[f_id].object_id,
+                0, 0, 0, nb_objects_previous_group, fragment_test_objects[f_id].length, 0,
+                fragment_test_objects[f_id].length, 10000 * (uint64_t)f_id);
+        }
+
+        for (int i = 0; ret == 0 && i < 3; i++) {
+            int is_stalled;
+
+            pub_ctx->is_fetch = (i == 1);
+            stream_ctx->is_start_in_past = (i == 2);
+            is_stalled = quicrq_fragment_publisher_is_stalled(stream_ctx, 1000000, 0, 1);
+            if (is_stalled != (i == 0)) {
+                DBG_PRINTF("Lag test %d, stalled: %d", i, is_stalled);
+                ret = -1;
+            }
+        }
+        /* The publisher context is freed by the test, not when the stream is deleted */
+        stream_ctx->media_ctx = NULL;
+    }
+
+    if (srce_ctx != NULL) {
+        free(srce_ctx);
+    }
+
+    if (cache_ctx != NULL) {
+        quicrq_fragment_cache_delete_ctx(cache_ctx);
+    }
+
+    if (pub_ctx != NULL) {
+        free(pub_ctx);
+    }
+
+    if (qr_ctx != NULL) {
+        /* This will also delete stream_ctx and cnx_ctx */
+        quicrq_delete(qr_ctx);
+    }
+
+    return ret;
+}
+
+/* Redundant ingest test.
+ * Propose the test objects to the cache from two ingests, which split the objects
+ * in fragments of different sizes, and deliver each fragment at different times.
+ * The cache shall contain exactly one copy of each object, with the duplicates
+ * that arrive after the in sequence point ignored.
+ */
+int quicrq_fragment_cache_duplicate_test()
+{
+    int ret = 0;
+    const size_t fragment_max[2] = { 8, 5 };
+    size_t offset[2] = { 0, 0 };
+    size_t f_id[2] = { 0, 0 };
+    quicrq_media_source_ctx_t* srce_ctx = (quicrq_media_source_ctx_t*)malloc(sizeof(quicrq_media_source_ctx_t));
+    quicrq_fragment_cache_t* cache_ctx = quicrq_fragment_cache_create_ctx(NULL);
+
+    if (cache_ctx == NULL || srce_ctx == NULL) {
+        ret = -1;
+    }
+    else {
+        memset(srce_ctx, 0, sizeof(quicrq_media_source_ctx_t));
+        cache_ctx->srce_ctx = srce_ctx;
+
+        while (ret == 0 && (f_id[0] < nb_fragment_test_objects || f_id[1] < nb_fragment_test_objects)) {
+            /* The second ingest lags the first one by a couple of fragments */
+            int ingest = (f_id[1] >= nb_fragment_test_objects ||
+                (f_id[0] < nb_fragment_test_objects && f_id[0] < f_id[1] + 2)) ? 0 : 1;
+            size_t i = f_id[ingest];
+            size_t data_length = fragment_test_objects[i].length - offset[ingest];
+            uint64_t nb_objects_previous_group = 0;
+
+            if (data_length > fragment_max[ingest]) {
+                data_length = fragment_max[ingest];
+            }
+            if (fragment_test_objects[i].object_id == 0 && offset[ingest] == 0 && fragment_test_objects[i].group_id > 0) {
+                nb_objects_previous_group = nb_fragment_test_groups_objects[fragment_test_objects[i].group_id - 1];
+            }
+            ret = quicrq_fragment_propose_to_cache(cache_ctx, fragment_test_objects[i].data + offset[ingest],
+                fragment_test_objects[i].group_id, fragment_test_objects[i].object_id,
+                offset[ingest], 0, 0, nb_objects_previous_group,
+                fragment_test_objects[i].length, 0, data_length, 0);
+            offset[ingest] += data_length;
+            if (offset[ingest] >= fragment_test_objects[i].length) {
+                offset[ingest] = 0;
+                f_id[ingest]++;
+            }
+        }
+
+        if (ret == 0) {
+            ret = quicrq_fragment_cache_verify(cache_ctx);
+        }
+        if (ret == 0 && cache_ctx->nb_duplicate_fragments == 0) {
+            DBG_PRINTF("%s", "No duplicate fragment detected");
+            ret = -1;
+        }
+    }
+
+    if (srce_ctx != NULL) {
+        free(srce_ctx);
+    }
+
+    if (cache_ctx != NULL) {
+        quicrq_fragment_cache_delete_ctx(cache_ctx);
+    }
+
+    return ret;
+}
+
+/* Read cursor test.
+ * Load a large object in the cache as many separate fragments, by proposing the odd
+ * fragments before the even ones, then read it in small chunks as a stream publisher
+ * would, with and without read cursor. With the cursor, the cache shall only be searched
+ * at the start and after the cache is purged. The test reports the time spent reading.
+ */
+#define FRAGMENT_CURSOR_TEST_LENGTH 1000000
+#define FRAGMENT_CURSOR_TEST_FRAGMENT 1000
+#define FRAGMENT_CURSOR_TEST_CHUNK 100
+
+int quicrq_fragment_cache_cursor_test_one(int use_cursor)
+{
+    int ret = 0;
+    quicrq_media_source_ctx_t* srce_ctx = (quicrq_media_source_ctx_t*)malloc(sizeof(quicrq_media_source_ctx_t));
+    quicrq_fragment_cache_t* cache_ctx = quicrq_fragment_cache_create_ctx(NULL);
+    uint8_t* object_data = (uint8_t*)malloc(FRAGMENT_CURSOR_TEST_LENGTH);
+    uint8_t* read_data = (uint8_t*)malloc(FRAGMENT_CURSOR_TEST_LENGTH);
+    quicrq_fragment_cursor_t cursor = { 0 };
+    uint64_t read_start;
+    uint64_t read_time;
+    size_t offset = 0;
+    int nb_reads = 0;
+
+    if (cache_ctx == NULL || srce_ctx == NULL || object_data == NULL || read_data == NULL) {
+        ret = -1;
+    }
+    else {
+        memset(srce_ctx, 0, sizeof(quicrq_media_source_ctx_t));
+        cache_ctx->srce_ctx = srce_ctx;
+        for (size_t i = 0; i < FRAGMENT_CURSOR_TEST_LENGTH; i++) {
+            object_data[i] = (uint8_t)(i * 7 + (i >> 8));
+        }
+        /* A small object before the large one, so the cache can be purged while reading */
+        ret = quicrq_fragment_propose_to_cache(cache_ctx, object_data, 0, 0, 0, 0, 0, 0, 16, 0, 16, 0);
+        for (int pass = 1; ret == 0 && pass >= 0; pass--) {
+            for (size_t f_offset = (size_t)pass * FRAGMENT_CURSOR_TEST_FRAGMENT; ret == 0 && f_offset < FRAGMENT_CURSOR_TEST_LENGTH;
+                f_offset += 2 * FRAGMENT_CURSOR_TEST_FRAGMENT) {
+                ret = quicrq_fragment_propose_to_cache(cache_ctx, object_data + f_offset, 0, 1, f_offset, 0, 0, 0,
+                    FRAGMENT_CURSOR_TEST_LENGTH, 0, FRAGMENT_CURSOR_TEST_FRAGMENT, 0);
+            }
+        }
+        if (ret == 0 && cache_ctx->fragment_tree.size != 1 + FRAGMENT_CURSOR_TEST_LENGTH / FRAGMENT_CURSOR_TEST_FRAGMENT) {
+            DBG_PRINTF("Expected %d cache nodes, got %d", 1 + FRAGMENT_CURSOR_TEST_LENGTH / FRAGMENT_CURSOR_TEST_FRAGMENT,
+                cache_ctx->fragment_tree.size);
+            ret = -1;
+        }
+    }
+
+    read_start = picoquic_current_time();
+    while (ret == 0 && offset < FRAGMENT_CURSOR_TEST_LENGTH) {
+        /* Query the available size, then copy, as the warp stream sender does */
+        size_t available = quicrq_fragment_object_copy_available_data(cache_ctx, (use_cursor) ? &cursor : NULL,
+            0, 1, offset, FRAGMENT_CURSOR_TEST_CHUNK, NULL);
+        size_t copied = quicrq_fragment_object_copy_available_data(cache_ctx, (use_cursor) ? &cursor : NULL,
+            0, 1, offset, available, read_data + offset);
+        if (available == 0 || copied != available) {
+            DBG_PRINTF("Read %zu bytes at offset %zu, %zu available", copied, offset, available);
+            ret = -1;
+        }
+        offset += copied;
+        nb_reads++;
+        if (ret == 0 && offset == FRAGMENT_CURSOR_TEST_LENGTH / 2) {
+            /* Purging the cache invalidates the cursor */
+            ret = quicrq_fragment_cache_learn_start_point(cache_ctx, 0, 1);
+        }
+    }
+    read_time = picoquic_current_time() - read_start;
+
+    if (ret == 0 && memcmp(read_data, object_data, FRAGMENT_CURSOR_TEST_LENGTH) != 0) {
+        DBG_PRINTF("%s", "Data read from the cache does not match");
+        ret = -1;
+    }
+    if (ret == 0) {
+        DBG_PRINTF("Cursor test, cursor: %d, %d reads, %" PRIu64 " cache lookups, %" PRIu64 " us",
+            use_cursor, nb_reads, cache_ctx->nb_cursor_lookups, read_time);
+        if (use_cursor && cache_ctx->nb_cursor_lookups != 2) {
+            DBG_PRINTF("Expected 2 cache lookups, got %" PRIu64, cache_ctx->nb_cursor_lookups);
+            ret = -1;
+        }
+    }
+
+    if (object_data != NULL) {
+        free(object_data);
+    }
+
+    if (read_data != NULL) {
+        free(read_data);
+    }
+
+    if (srce_ctx != NULL) {
+        free(srce_ctx);
+    }
+
+    if (cache_ctx != NULL) {
+        quicrq_fragment_cache_delete_ctx(cache_ctx);
+    }
+
+    return ret;
+}
+
+int quicrq_fragment_cache_cursor_test()
+{
+    int ret = quicrq_fragment_cache_cursor_test_one(0);
+
+    if (ret == 0) {
+        ret = quicrq_fragment_cache_cursor_test_one(1);
+    }
+
+    return ret;
+}
+
+/* Extent test.
+ * Load the objects of the video test media in the cache as datagram sized
+ * fragments, either in order or with the odd fragments of each object first.
+ * Verify that each object can be copied from the cache, and report the number
+ * of cache nodes and the number of nodes walked when copying the objects.
+ * When fragments arrive in order, each object shall be coalesced in a single node,
+ * whether its length is known in advance or only with the final fragment.
+ */
+#define FRAGMENT_EXTENT_TEST_LENGTH 1200
+
+int quicrq_fragment_cache_extent_test_one(int out_of_order, int is_streamed)
+{
+    int ret = 0;
+    char media_source_path[512];
+    test_media_publisher_context_t* pub_ctx = NULL;
+    quicrq_media_source_ctx_t* srce_ctx = (quicrq_media_source_ctx_t*)malloc(sizeof(quicrq_media_source_ctx_t));
+    quicrq_fragment_cache_t* cache_ctx = quicrq_fragment_cache_create_ctx(NULL);
+    uint8_t* buffer = NULL;
+    uint64_t group_id = 0;
+    uint64_t object_id = 0;
+    int nb_objects = 0;
+    int nb_fragments = 0;
+    int nb_nodes_walked = 0;
+
+    if (cache_ctx == NULL || srce_ctx == NULL) {
+        ret = -1;
+    }
+    else {
+        memset(srce_ctx, 0, sizeof(quicrq_media_source_ctx_t));
+        cache_ctx->srce_ctx = srce_ctx;
+    }
+
+    if (ret == 0 && picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        pub_ctx = (test_media_publisher_context_t*)test_media_publisher_init(media_source_path, NULL, 0, 0);
+        if (pub_ctx == NULL) {
+            ret = -1;
+        }
+    }
+
+    while (ret == 0) {
+        uint64_t nb_objects_previous_group = 0;
+        ret = test_media_read_object_from_file(pub_ctx);
+        if (ret != 0 || pub_ctx->is_finished) {
+            break;
+        }
+        if (test_media_is_new_group(pub_ctx->media_object_size) && object_id > 0) {
+            nb_objects_previous_group = object_id;
+            group_id++;
+            object_id = 0;
+        }
+        /* Propose the fragments, in one or two passes */
+        for (int pass = 0; ret == 0 && pass < 2; pass++) {
+            size_t offset = 0;
+            int fragment_rank = 0;
+            while (ret == 0 && offset < pub_ctx->media_object_size) {
+                size_t data_length = pub_ctx->media_object_size - offset;
+                if (data_length > FRAGMENT_EXTENT_TEST_LENGTH) {
+                    data_length = FRAGMENT_EXTENT_TEST_LENGTH;
+                }
+                if ((!out_of_order && pass == 0) || (out_of_order && (fragment_rank & 1) != pass)) {
+                    /* Streamed objects only carry the actual length in the final fragment */
+                    uint64_t object_length = (is_streamed && offset + data_length < pub_ctx->media_object_size) ?
+                        QUICRQ_OBJECT_LENGTH_UNKNOWN : pub_ctx->media_object_size;
+                    ret = quicrq_fragment_propose_to_cache(cache_ctx, pub_ctx->media_object + offset,
+                        group_id, object_id, offset, 0, 0, (offset == 0) ? nb_objects_previous_group : 0,
+                        object_length, 0, data_length, 0);
+                    nb_fragments++;
+                }
+                offset += data_length;
+                fragment_rank++;
+            }
+        }
+        /* The object length shall be known once all fragments are received */
+        if (ret == 0) {
+            size_t property_length = 0;
+            uint64_t property_previous_group = 0;
+            uint8_t property_flags = 0;
+            if (quicrq_fragment_get_object_properties(cache_ctx, group_id, object_id,
+                &property_length, &property_previous_group, &property_flags) != 0 ||
+                property_length != pub_ctx->media_object_size) {
+                DBG_PRINTF("Object %" PRIu64 ",%" PRIu64 " length %zu instead of %zu",
+                    group_id, object_id, property_length, pub_ctx->media_object_size);
+                ret = -1;
+            }
+        }
+        /* Copy the object from the cache, and count the nodes that have to be walked */
+        if (ret == 0) {
+            uint64_t copied_previous_group = 0;
+            uint8_t copied_flags = 0;
+            size_t copied_length;
+            quicrq_cached_fragment_t* fragment = quicrq_fragment_cache_get_fragment(cache_ctx, group_id, object_id, 0);
+
+            while (fragment != NULL && fragment->group_id == group_id && fragment->object_id == object_id) {
+                nb_nodes_walked++;
+                fragment = (quicrq_cached_fragment_t*)quicrq_fragment_cache_node_value(picosplay_next(&fragment->fragment_node));
+            }
+            buffer = (uint8_t*)malloc(pub_ctx->media_object_size);
+            if (buffer == NULL) {
+                ret = -1;
+            }
+            else {
+                copied_length = quicrq_fragment_object_copy(cache_ctx, group_id, object_id, &copied_previous_group, &copied_flags, buffer);
+                if (copied_length != pub_ctx->media_object_size ||
+                    memcmp(buffer, pub_ctx->media_object, copied_length) != 0) {
+                    DBG_PRINTF("Object %" PRIu64 ",%" PRIu64 " copied %zu bytes instead of %zu",
+                        group_id, object_id, copied_length, pub_ctx->media_object_size);
+                    ret = -1;
+                }
+                else if (copied_previous_group != ((object_id == 0) ? nb_objects_previous_group : 0)) {
+                    DBG_PRINTF("Object %" PRIu64 ",%" PRIu64 " previous group %" PRIu64 " instead of %" PRIu64,
+                        group_id, object_id, copied_previous_group, nb_objects_previous_group);
+                    ret = -1;
+                }
+                free(buffer);
+                buffer = NULL;
+            }
+        }
+        nb_objects++;
+        object_id++;
+    }
+
+    if (ret == 0) {
+        DBG_PRINTF("Extent test, out of order: %d, streamed: %d, %d objects, %d fragments, %d cache nodes, %d nodes walked",
+            out_of_order, is_streamed, nb_objects, nb_fragments, cache_ctx->fragment_tree.size, nb_nodes_walked);
+        if (cache_ctx->nb_object_received != (uint64_t)nb_objects) {
+            DBG_PRINTF("Received %" PRIu64 " objects instead of %d", cache_ctx->nb_object_received, nb_objects);
+            ret = -1;
+        }
+        else if (cache_ctx->next_group_id != group_id || cache_ctx->next_object_id != object_id) {
+            DBG_PRINTF("Cache next object %" PRIu64 ",%" PRIu64 " instead of %" PRIu64 ",%" PRIu64,
+                cache_ctx->next_group_id, cache_ctx->next_object_id, group_id, object_id);
+            ret = -1;
+        }
+        else if (!out_of_order && cache_ctx->fragment_tree.size != nb_objects) {
+            DBG_PRINTF("Expected %d cache nodes, got %d", nb_objects, cache_ctx->fragment_tree.size);
+            ret = -1;
+        }
+        else if (cache_ctx->fragment_tree.size > nb_fragments) {
+            DBG_PRINTF("Expected at most %d cache nodes, got %d", nb_fragments, cache_ctx->fragment_tree.size);
+            ret = -1;
+        }
+    }
+
+    if (pub_ctx != NULL) {
+        test_media_publisher_close(pub_ctx);
+    }
+
+    if (srce_ctx != NULL) {
+        free(srce_ctx);
+    }
+
+    if (cache_ctx != NULL) {
+        quicrq_fragment_cache_delete_ctx(cache_ctx);
+    }
+
+    return ret;
+}
+
+int quicrq_fragment_cache_extent_test()
+{
+    int ret = quicrq_fragment_cache_extent_test_one(0, 0);
+
+    if (ret == 0) {
+        ret = quicrq_fragment_cache_extent_test_one(1, 0);
+    }
+
+    return ret;
+}
+
+/* Objects published in chunks, before their length is known */
+int quicrq_fragment_cache_streamed_test()
+{
+    int ret = quicrq_fragment_cache_extent_test_one(0, 1);
+
+    if (ret == 0) {
+        ret = quicrq_fragment_cache_extent_test_one(1, 1);
+    }
+
+    return ret;
+}
@@ -0,0 +1,406 @@
+#include <string.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_test_internal.h"
+
+/* Latest first test:
+ * The origin publishes a real time media in warp mode, and a client subscribes to it,
+ * either directly or through a relay. The configuration diagrams are:
+ *
+ *             S           S
+ *             |           |
+ *             C           R
+ *                         |
+ *                         C
+ *
+ * The links are slowed down to twice the media rate. After some time, all packets are
+ * lost during an outage, so the sender falls behind by more than a group. The test
+ * measures the time needed after the outage to get back to the live edge, i.e., to
+ * receive objects with a short delay, and verifies that the latest first policy
+ * reduces that time.
+ *
+ * When the relay serves the client on a single stream or by datagrams, the groups
+ * abandoned by the origin move the start point of the relay cache in the middle of
+ * the media. The client shall still get back to the live edge after the outage.
+ */
+#define QUICRQ_LATEST_FIRST_TEST_PICOSEC_PER_BYTE 3200000
+#define QUICRQ_LATEST_FIRST_TEST_OUTAGE_START 3000000
+#define QUICRQ_LATEST_FIRST_TEST_OUTAGE_END 5000000
+#define QUICRQ_LATEST_FIRST_TEST_EDGE_DELAY 250000
+
+int quicrq_latest_first_test_one(int is_relay, int is_latest_first, quicrq_transport_mode_enum client_mode, uint64_t* time_to_edge)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int outage_state = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    int client_node = (is_relay) ? 2 : 1;
+    quicrq_test_config_t* config = (is_relay) ? quicrq_test_relay_config_create(0) : quicrq_test_basic_config_create(0, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[256];
+    char result_log_name[256];
+    uint64_t nb_groups_abandoned = 0;
+    uint64_t edge_time = 0;
+    size_t nb_log_chars = 0;
+
+    *time_to_edge = UINT64_MAX;
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "latest-first-video1-recv-%d-%d-%c.bin",
+        is_relay, is_latest_first, quicrq_transport_mode_to_letter(client_mode));
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "latest-first-video1-log-%d-%d-%c.csv",
+        is_relay, is_latest_first, quicrq_transport_mode_to_letter(client_mode));
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Slow down the links, so the backlog accumulated during the outage takes time to drain */
+        for (int i = 0; i < config->nb_links; i++) {
+            config->links[i]->picosec_per_byte = QUICRQ_LATEST_FIRST_TEST_PICOSEC_PER_BYTE;
+        }
+        /* Add a real time test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0 && is_relay) {
+        /* Configure the relay: set the server address */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, quicrq_transport_mode_warp);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0 && is_latest_first) {
+        /* Latest first as soon as one group behind, abandon the groups two behind */
+        for (int i = 0; i < client_node; i++) {
+            quicrq_set_warp_latest_first(config->nodes[i], 1, 1);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quicrq connection context on client, and subscribe to the media */
+        cnx_ctx = quicrq_test_create_client_cnx(config, client_node, client_node - 1);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), client_mode, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        uint64_t app_wake_time = UINT64_MAX;
+
+        if (outage_state == 0 && config->simulated_time >= QUICRQ_LATEST_FIRST_TEST_OUTAGE_START) {
+            /* Start of the outage: lose all packets */
+            config->simulate_loss = UINT64_MAX;
+            outage_state = 1;
+        }
+        else if (outage_state == 1 && config->simulated_time >= QUICRQ_LATEST_FIRST_TEST_OUTAGE_END) {
+            /* End of the outage */
+            config->simulate_loss = 0;
+            outage_state = 2;
+        }
+        if (outage_state < 2) {
+            app_wake_time = (outage_state == 0) ? QUICRQ_LATEST_FIRST_TEST_OUTAGE_START : QUICRQ_LATEST_FIRST_TEST_OUTAGE_END;
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, app_wake_time);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Monitor the groups abandoned by the senders */
+        for (int i = 0; i < client_node; i++) {
+            quicrq_cnx_ctx_t* sender_cnx_ctx = config->nodes[i]->first_cnx;
+            while (sender_cnx_ctx != NULL) {
+                quicrq_stream_statistics_t stats[4];
+                size_t nb_stats = 0;
+                if (quicrq_cnx_get_stream_statistics(sender_cnx_ctx, stats, 4, &nb_stats, config->simulated_time) == 0) {
+                    for (size_t j = 0; j < nb_stats && j < 4; j++) {
+                        if (stats[j].is_sender && stats[j].nb_groups_abandoned > nb_groups_abandoned) {
+                            nb_groups_abandoned = stats[j].nb_groups_abandoned;
+                        }
+                    }
+                }
+                sender_cnx_ctx = sender_cnx_ctx->next_cnx;
+            }
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received, exit the loop */
+        if (config->nodes[client_node]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && config->nodes[client_node]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[client_node]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || outage_state != 2)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0 && is_latest_first && nb_groups_abandoned == 0) {
+        DBG_PRINTF("%s", "No group abandoned with latest first");
+        ret = -1;
+    }
+
+    /* Clear everything, so the log file is closed before it is read */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    if (ret == 0) {
+        ret = quicrq_log_file_live_edge(result_log_name, QUICRQ_LATEST_FIRST_TEST_OUTAGE_END,
+            QUICRQ_LATEST_FIRST_TEST_EDGE_DELAY, &edge_time);
+        if (ret != 0) {
+            DBG_PRINTF("Live edge not reached after the outage, log %s", result_log_name);
+        }
+        else {
+            *time_to_edge = edge_time - QUICRQ_LATEST_FIRST_TEST_OUTAGE_END;
+            DBG_PRINTF("Latest first %s, relay %s, %" PRIu64 " groups abandoned, live edge after %" PRIu64 " us",
+                (is_latest_first) ? "on" : "off", (is_relay) ? "on" : "off", nb_groups_abandoned, *time_to_edge);
+        }
+    }
+
+    return ret;
+}
+
+/* Compare the time needed to get back to the live edge after the outage.
+ * The latest first policy shall reduce that time.
+ */
+int quicrq_latest_first_test_compare(int is_relay)
+{
+    uint64_t in_order_time = 0;
+    uint64_t latest_first_time = 0;
+    int ret = quicrq_latest_first_test_one(is_relay, 0, quicrq_transport_mode_warp, &in_order_time);
+
+    if (ret == 0) {
+        ret = quicrq_latest_first_test_one(is_relay, 1, quicrq_transport_mode_warp, &latest_first_time);
+    }
+    if (ret == 0 && latest_first_time >= in_order_time) {
+        DBG_PRINTF("Time to live edge with latest first %" PRIu64 ", not below time in order %" PRIu64,
+            latest_first_time, in_order_time);
+        ret = -1;
+    }
+    return ret;
+}
+
+int quicrq_latest_first_test()
+{
+    return quicrq_latest_first_test_compare(0);
+}
+
+int quicrq_latest_first_relay_test()
+{
+    return quicrq_latest_first_test_compare(1);
+}
+
+/* Groups abandoned upstream of a relay that serves the client on a single stream,
+ * or by datagrams.
+ */
+int quicrq_latest_first_relay_stream_test()
+{
+    uint64_t time_to_edge = 0;
+
+    return quicrq_latest_first_test_one(1, 1, quicrq_transport_mode_single_stream, &time_to_edge);
+}
+
+int quicrq_latest_first_relay_datagram_test()
+{
+    uint64_t time_to_edge = 0;
+
+    return quicrq_latest_first_test_one(1, 1, quicrq_transport_mode_datagram, &time_to_edge);
+}
+
+/* Subscription by start time with the latest first policy on.
+ * The client subscribes after the media started, asking for all the groups in the
+ * cache. The sender is behind the latest group from the start, but shall not apply
+ * the latest first policy to groups that were explicitly requested: no group shall be
+ * abandoned, and the client shall receive the whole media.
+ */
+#define QUICRQ_LATEST_FIRST_TEST_SUBSCRIBE_TIME 2000000
+
+int quicrq_latest_first_start_time_test()
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int is_subscribed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_basic_config_create(0, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char const* result_file_name = "latest-first-video1-recv-start-time.bin";
+    char const* result_log_name = "latest-first-video1-log-start-time.csv";
+    uint64_t nb_groups_abandoned = 0;
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Slow down the links, so the sender stays behind the latest group for a while */
+        for (int i = 0; i < config->nb_links; i++) {
+            config->links[i]->picosec_per_byte = QUICRQ_LATEST_FIRST_TEST_PICOSEC_PER_BYTE;
+        }
+        /* Add a real time test source to the origin, with the latest first policy */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+        else {
+            quicrq_set_warp_latest_first(config->nodes[0], 1, 1);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quicrq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        if (!is_subscribed && config->simulated_time >= QUICRQ_LATEST_FIRST_TEST_SUBSCRIBE_TIME) {
+            /* Subscribe from the beginning of the media */
+            quicrq_subscribe_intent_t intent = { 0 };
+
+            intent.intent_mode = quicrq_subscribe_intent_start_time;
+            intent.start_time = 0;
+            if (test_object_stream_subscribe_ex(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+                strlen(QUICRQ_TEST_BASIC_SOURCE), quicrq_transport_mode_warp, quicrq_subscribe_in_order, &intent,
+                result_file_name, result_log_name) == NULL) {
+                ret = -1;
+                DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+                break;
+            }
+            is_subscribed = 1;
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, (is_subscribed) ? UINT64_MAX : QUICRQ_LATEST_FIRST_TEST_SUBSCRIBE_TIME);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Monitor the groups abandoned by the origin */
+        if (config->nodes[0]->first_cnx != NULL) {
+            quicrq_stream_statistics_t stats[4];
+            size_t nb_stats = 0;
+            if (quicrq_cnx_get_stream_statistics(config->nodes[0]->first_cnx, stats, 4, &nb_stats, config->simulated_time) == 0) {
+                for (size_t j = 0; j < nb_stats && j < 4; j++) {
+                    if (stats[j].is_sender && stats[j].nb_groups_abandoned > nb_groups_abandoned) {
+                        nb_groups_abandoned = stats[j].nb_groups_abandoned;
+                    }
+                }
+            }
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received, exit the loop */
+        if (config->nodes[1]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && is_subscribed && config->nodes[1]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[1]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0 && nb_groups_abandoned != 0) {
+        DBG_PRINTF("%" PRIu64 " groups abandoned after subscribing by start time", nb_groups_abandoned);
+        ret = -1;
+    }
+
+    /* Clear everything, so the result file is closed before it is read */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    /* Verify that the whole media was received */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+        if (ret != 0) {
+            DBG_PRINTF("Media received in %s does not match the source", result_file_name);
+        }
+    }
+
+    return ret;
+}
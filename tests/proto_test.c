@@ -34,7 +34,11 @@ static quicrq_message_t stream_rq = {
     NULL,
     quicrq_transport_mode_single_stream,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t stream_rq_bytes[] = {
@@ -61,7 +65,11 @@ static quicrq_message_t datagram_rq = {
     NULL,
     quicrq_transport_mode_datagram,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t datagram_rq_bytes[] = {
@@ -88,7 +96,11 @@ static quicrq_message_t datagram_rq_next_group = {
     NULL,
     quicrq_transport_mode_datagram,
     0,
-    quicrq_subscribe_intent_next_group
+    quicrq_subscribe_intent_next_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t datagram_rq_next_group_bytes[] = {
@@ -115,7 +127,11 @@ static quicrq_message_t datagram_rq_start_point = {
     NULL,
     quicrq_transport_mode_datagram,
     0,
-    quicrq_subscribe_intent_start_point
+    quicrq_subscribe_intent_start_point,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t datagram_rq_start_point_bytes[] = {
@@ -129,6 +145,73 @@ static uint8_t datagram_rq_start_point_bytes[] = {
     0x09,
 };
 
+static quicrq_message_t datagram_rq_start_time = {
+    QUICRQ_ACTION_REQUEST,
+    sizeof(url1),
+    url1,
+    1234,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    NULL,
+    quicrq_transport_mode_datagram,
+    0,
+    quicrq_subscribe_intent_start_time,
+    10000000,
+    0,
+    0,
+    0
+};
+
+static uint8_t datagram_rq_start_time_bytes[] = {
+    QUICRQ_ACTION_REQUEST,
+    sizeof(url1),
+    URL1_BYTES,
+    0x44, 0xd2,
+    quicrq_transport_mode_datagram,
+    0x03,
+    0x80, 0x98, 0x96, 0x80
+};
+
+static quicrq_message_t stream_rq_fetch_range = {
+    QUICRQ_ACTION_REQUEST,
+    sizeof(url1),
+    url1,
+    1234,
+    2,
+    3,
+    0,
+    0,
+    0,
+    0,
+    0,
+    NULL,
+    quicrq_transport_mode_single_stream,
+    0,
+    quicrq_subscribe_intent_fetch_range,
+    0,
+    1000,
+    1,
+    0
+};
+
+static uint8_t stream_rq_fetch_range_bytes[] = {
+    QUICRQ_ACTION_REQUEST,
+    sizeof(url1),
+    URL1_BYTES,
+    0x44, 0xd2,
+    quicrq_transport_mode_single_stream,
+    0x04,
+    0x02,
+    0x03,
+    0x43, 0xe8,
+    0x01
+};
+
 static quicrq_message_t fin_msg = {
     QUICRQ_ACTION_FIN_DATAGRAM,
     0,
@@ -144,7 +227,11 @@ static quicrq_message_t fin_msg = {
     NULL,
     0,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t fin_msg_bytes[] = {
@@ -171,7 +258,11 @@ static quicrq_message_t fragment_msg = {
     fragment_bytes,
     0,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t fragment_msg_bytes[] = {
@@ -200,7 +291,11 @@ static quicrq_message_t fragment_msg2 = {
     fragment_bytes,
     0,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t fragment_msg2_bytes[] = {
@@ -211,6 +306,41 @@ static uint8_t fragment_msg2_bytes[] = {
     (uint8_t)sizeof(fragment_bytes),
     0x17,
     0x3c,
+    0x00,
+    (uint8_t)sizeof(fragment_bytes),
+    FRAGMENT_BYTES
+};
+
+static quicrq_message_t fragment_msg_ts = {
+    QUICRQ_ACTION_FRAGMENT,
+    0,
+    NULL,
+    0,
+    11,
+    5,
+    0,
+    0,
+    0x17,
+    sizeof(fragment_bytes),
+    sizeof(fragment_bytes),
+    fragment_bytes,
+    0,
+    0,
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    123456
+};
+
+static uint8_t fragment_msg_ts_bytes[] = {
+    QUICRQ_ACTION_FRAGMENT,
+    0x0b,
+    0x05,
+    0x00,
+    (uint8_t)sizeof(fragment_bytes),
+    0x17,
+    0x80, 0x01, 0xe2, 0x40,
     (uint8_t)sizeof(fragment_bytes),
     FRAGMENT_BYTES
 };
@@ -230,7 +360,11 @@ static quicrq_message_t post_msg = {
     NULL,
     3,
     1,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t post_msg_bytes[] = {
@@ -258,7 +392,11 @@ static quicrq_message_t accept_dg = {
     NULL,
     quicrq_transport_mode_datagram,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t accept_dg_bytes[] = {
@@ -283,7 +421,11 @@ static quicrq_message_t accept_st = {
     NULL,
     quicrq_transport_mode_single_stream,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t accept_st_bytes[] = {
@@ -306,7 +448,11 @@ static quicrq_message_t start_msg = {
     NULL,
     0,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t start_msg_bytes[] = {
@@ -330,7 +476,11 @@ static quicrq_message_t subscribe_msg = {
     NULL,
     0,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t subscribe_msg_bytes[] = {
@@ -354,7 +504,11 @@ static quicrq_message_t notify_msg = {
     NULL,
     0,
     0,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t notify_msg_bytes[] = {
@@ -379,7 +533,11 @@ static quicrq_message_t cache_policy_msg = {
     NULL,
     0,
     1,
-    quicrq_subscribe_intent_current_group
+    quicrq_subscribe_intent_current_group,
+    0,
+    0,
+    0,
+    0
 };
 
 static uint8_t cache_policy_bytes[] = {
@@ -402,6 +560,10 @@ static quicrq_message_t warp_header = {
     NULL,
     0,
     0,
+    0,
+    0,
+    0,
+    0,
     0
 };
 
@@ -426,6 +588,10 @@ static quicrq_message_t warp_object = {
     NULL,
     0,
     0,
+    0,
+    0,
+    0,
+    0,
     0
 };
 
@@ -434,7 +600,8 @@ static uint8_t warp_object_bytes[] = {
     0x40,
     0x81,
     0x83,
-    (uint8_t)sizeof(fragment_bytes)
+    (uint8_t)sizeof(fragment_bytes),
+    0x00
 };
 
 static quicrq_message_t warp_object0 = {
@@ -452,6 +619,10 @@ static quicrq_message_t warp_object0 = {
     NULL,
     0,
     0,
+    0,
+    0,
+    0,
+    0,
     0
 };
 
@@ -460,7 +631,39 @@ static uint8_t warp_object0_bytes[] = {
     0x00,
     0x3f,
     0x83,
-    (uint8_t)sizeof(fragment_bytes)
+    (uint8_t)sizeof(fragment_bytes),
+    0x00
+};
+
+static quicrq_message_t warp_object_ts = {
+    QUICRQ_ACTION_OBJECT_HEADER,
+    0,
+    NULL,
+    0,
+    0,
+    129,
+    0,
+    0,
+    0x83,
+    sizeof(fragment_bytes),
+    0,
+    NULL,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    123456
+};
+
+static uint8_t warp_object_ts_bytes[] = {
+    QUICRQ_ACTION_OBJECT_HEADER,
+    0x40,
+    0x81,
+    0x83,
+    (uint8_t)sizeof(fragment_bytes),
+    0x80, 0x01, 0xe2, 0x40
 };
 
 
@@ -476,9 +679,12 @@ static proto_test_case_t proto_cases[] = {
     PROTO_TEST_ITEM(datagram_rq, datagram_rq_bytes),
     PROTO_TEST_ITEM(datagram_rq_next_group, datagram_rq_next_group_bytes),
     PROTO_TEST_ITEM(datagram_rq_start_point, datagram_rq_start_point_bytes),
+    PROTO_TEST_ITEM(datagram_rq_start_time, datagram_rq_start_time_bytes),
+    PROTO_TEST_ITEM(stream_rq_fetch_range, stream_rq_fetch_range_bytes),
     PROTO_TEST_ITEM(fin_msg, fin_msg_bytes),
     PROTO_TEST_ITEM(fragment_msg, fragment_msg_bytes),
     PROTO_TEST_ITEM(fragment_msg2, fragment_msg2_bytes),
+    PROTO_TEST_ITEM(fragment_msg_ts, fragment_msg_ts_bytes),
     PROTO_TEST_ITEM(post_msg, post_msg_bytes),
     PROTO_TEST_ITEM(accept_dg, accept_dg_bytes),
     PROTO_TEST_ITEM(accept_st, accept_st_bytes),
@@ -488,7 +694,8 @@ static proto_test_case_t proto_cases[] = {
     PROTO_TEST_ITEM(cache_policy_msg, cache_policy_bytes),
     PROTO_TEST_ITEM(warp_header, warp_header_bytes),
     PROTO_TEST_ITEM(warp_object, warp_object_bytes),
-    PROTO_TEST_ITEM(warp_object0, warp_object0_bytes)
+    PROTO_TEST_ITEM(warp_object0, warp_object0_bytes),
+    PROTO_TEST_ITEM(warp_object_ts, warp_object_ts_bytes)
 };
 
 static uint8_t bad_bytes1[] = {
@@ -685,6 +892,37 @@ static uint8_t bad_bytes25[] = {
     (uint8_t)sizeof(fragment_bytes),
 };
 
+static uint8_t bad_bytes26[] = {
+    QUICRQ_ACTION_REQUEST,
+    sizeof(url1),
+    URL1_BYTES,
+    0x44, 0xd2,
+    quicrq_transport_mode_datagram,
+    0x05,
+    0x01
+};
+
+static uint8_t bad_bytes27[] = {
+    QUICRQ_ACTION_REQUEST,
+    sizeof(url1),
+    URL1_BYTES,
+    0x44, 0xd2,
+    quicrq_transport_mode_single_stream,
+    0x04,
+    0x02,
+    0x03,
+    0x43, 0xe8
+};
+
+static uint8_t bad_bytes28[] = {
+    QUICRQ_ACTION_OBJECT_HEADER,
+    0x40,
+    0x81,
+    0x83,
+    (uint8_t)sizeof(fragment_bytes),
+    0x80, 0x01
+};
+
 typedef struct st_proto_test_bad_case_t {
     uint8_t* const data;
     size_t data_length;
@@ -719,7 +957,10 @@ static proto_test_bad_case_t proto_bad_cases[] = {
     PROTO_TEST_BAD_ITEM(bad_bytes22),
     PROTO_TEST_BAD_ITEM(bad_bytes23),
     PROTO_TEST_BAD_ITEM(bad_bytes24),
-    PROTO_TEST_BAD_ITEM(bad_bytes25)
+    PROTO_TEST_BAD_ITEM(bad_bytes25),
+    PROTO_TEST_BAD_ITEM(bad_bytes26),
+    PROTO_TEST_BAD_ITEM(bad_bytes27),
+    PROTO_TEST_BAD_ITEM(bad_bytes28)
 };
 
 int proto_msg_test()
@@ -779,6 +1020,18 @@ int proto_msg_test()
         else if (result.subscribe_intent != proto_cases[i].result->subscribe_intent) {
             ret = -1;
         }
+        else if (result.start_time != proto_cases[i].result->start_time) {
+            ret = -1;
+        }
+        else if (result.end_group_id != proto_cases[i].result->end_group_id) {
+            ret = -1;
+        }
+        else if (result.end_object_id != proto_cases[i].result->end_object_id) {
+            ret = -1;
+        }
+        else if (result.origin_timestamp != proto_cases[i].result->origin_timestamp) {
+            ret = -1;
+        }
         else if (result.fragment_length != proto_cases[i].result->fragment_length) {
             ret = -1;
         }
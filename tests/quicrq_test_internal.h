@@ -80,6 +80,16 @@ typedef struct st_test_media_object_source_context_t {
     int object_is_published;
     int source_is_finished;
     int fin_is_published;
+    int declare_dependency;
+    /* Simulation of a live encoder producing each object in nb_chunks chunks
+     * over production_time. If nb_chunks <= 1, the object is published whole
+     * once it is produced. */
+    int nb_chunks;
+    uint64_t production_time;
+    int nb_chunks_published;
+    /* If not zero, the objects carry an origin timestamp equal to the
+     * capture time of the object plus this clock offset. */
+    uint64_t origin_clock_base;
 } test_media_object_source_context_t;
 
 typedef struct st_quicrq_test_config_t {
@@ -102,12 +112,27 @@ typedef struct st_quicrq_test_config_t {
     test_media_object_source_context_t** object_sources;
     uint64_t cnx_error_client;
     uint64_t cnx_error_server;
+    /* Seeded random impairments, used by the scenario runner. If the
+     * random state is zero, only the deterministic loss pattern applies. */
+    uint64_t random_state;
+    uint64_t random_loss_per_million;
+    uint64_t random_jitter_max;
+    /* Simulation of a node limited by its processing capacity: if busy_packet_time
+     * is not zero, the node busy_node_id waits that long after each packet it sends. */
+    int busy_node_id;
+    uint64_t busy_packet_time;
+    uint64_t busy_next_time;
 } quicrq_test_config_t;
 
 /* Create a test network configuration */
 quicrq_test_config_t* quicrq_test_config_create(int nb_nodes, int nb_links, int nb_attachments, int nb_object_sources);
 /* Delete a test network configuration */
 void quicrq_test_config_delete(quicrq_test_config_t* config);
+/* Create the two nodes and the origin, relay and client test networks */
+quicrq_test_config_t* quicrq_test_basic_config_create(uint64_t simulate_loss, uint64_t extra_delay);
+quicrq_test_config_t* quicrq_test_relay_config_create(uint64_t simulate_loss);
+/* Seed the random loss and jitter of a test network */
+void quicrq_test_config_set_random(quicrq_test_config_t* config, uint64_t seed, uint64_t loss_per_million, uint64_t jitter_max);
 /* Find the address used by a test source to reach a destination */
 struct sockaddr* quicrq_test_find_send_addr(quicrq_test_config_t* config, int srce_node_id, int dest_node_id);
 /* Create a connection between two nodes */
@@ -143,8 +168,15 @@ extern const generation_parameters_t video_1mps;
 int quicrq_compare_media_file(char const* media_result_file, char const* media_reference_file);
 int quicrq_compare_media_file_ex(char const* media_result_file, char const* media_reference_file,
     int* nb_losses, uint8_t* loss_flag, uint64_t start_group_id, uint64_t start_object_id);
+int quicrq_compare_generated_media_file(char const* media_result_file, const generation_parameters_t* generation_model);
 int quicrq_log_file_statistics(char const* media_result_log, int* nb_frames, int* nb_losses,
     uint64_t* delay_average, uint64_t* delay_min, uint64_t* delay_max);
+int quicrq_log_file_decodable(char const* media_result_log, int* nb_frames, int* nb_decodable, uint64_t* undecodable_bytes);
+int quicrq_log_file_delays(char const* media_result_log, uint64_t** delays, size_t* nb_delays, size_t* delays_alloc,
+    int* nb_losses);
+void quicrq_delay_percentiles(uint64_t* delays, size_t nb_delays, const int* ranks, size_t nb_ranks, uint64_t* percentiles);
+int quicrq_log_file_live_edge(char const* media_result_log, uint64_t start_time, uint64_t delay_max, uint64_t* edge_time);
+int quicrq_log_file_last_object(char const* media_result_log, uint64_t* group_id, uint64_t* object_id);
 int test_media_is_audio(const uint8_t* url, size_t url_length);
 
 typedef struct st_test_object_stream_ctx_t {
@@ -156,6 +188,10 @@ typedef struct st_test_object_stream_ctx_t {
     size_t target_size;
     void* media_ctx;
     int is_closed;
+    /* Verification of origin timestamps, if origin_clock_base is not zero */
+    uint64_t origin_clock_base;
+    int nb_origin_timestamps;
+    int nb_origin_timestamp_errors;
 } test_object_stream_ctx_t;
 
 int test_media_object_consumer_cb(
@@ -170,8 +206,12 @@ int test_media_object_consumer_cb(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length);
 void* test_media_publisher_init(char const* media_source_path, const generation_parameters_t* generation_model, int is_real_time, uint64_t start_time);
+void test_media_publisher_close(void* media_ctx);
+int test_media_read_object_from_file(test_media_publisher_context_t* pub_ctx);
+int test_media_is_new_group(size_t media_object_size);
 
 void* test_media_consumer_init(char const* media_result_file, char const* media_result_log);
 int test_media_consumer_init_callback(quicrq_stream_ctx_t* stream_ctx, const uint8_t* url, size_t url_length);
@@ -3,11 +3,18 @@
 #ifndef QUICRQ_TEST_H
 #define QUICRQ_TEST_H
 
+#include <stdint.h>
+#include <stdio.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
     extern char const* quicrq_test_solution_dir;
 
+    /* Seeded multi-run scenarios, and comparison of their results */
+    int quicrq_scenario_run(char const* scenario_name, int nb_seeds, uint64_t first_seed, char const* result_file);
+    int quicrq_scenario_compare(char const* ref_file, char const* result_file, int tolerance_percent, FILE* F);
+
     int quicrq_basic_test();
     int proto_msg_test();
     int quicrq_media_video1_test();
@@ -22,6 +29,8 @@ extern "C" {
     int quicrq_congestion_basic_g_test();
     int quicrq_congestion_datagram_test();
     int quicrq_congestion_datagram_loss_test();
+    int quicrq_congestion_extra_repeat_test();
+    int quicrq_congestion_dependency_test();
     int quicrq_congestion_datagram_recv_test();
     int quicrq_congestion_datagram_rloss_test();
     int quicrq_congestion_datagram_zero_test();
@@ -40,6 +49,7 @@ extern "C" {
     int quicrq_twomedia_client_test();
     int quicrq_twomedia_datagram_client_test();
     int quicrq_twomedia_datagram_client_loss_test();
+    int quicrq_twomedia_congestion_weights_test();
     int quicrq_media_object_noloss();
     int quicrq_media_object_loss();
     int quicrq_relay_basic_test();
@@ -47,6 +57,14 @@ extern "C" {
     int quicrq_relay_datagram_loss_test();
     int quicrq_relay_basic_client_test();
     int quicrq_relay_datagram_client_test();
+    int quicrq_relay_stats_test();
+    int quicrq_relay_chunks_test();
+    int quicrq_relay_chunks_datagram_test();
+    int quicrq_relay_origin_timestamp_test();
+    int quicrq_relay_pass_through_test();
+    int quicrq_relay_pass_through_datagram_test();
+    int quicrq_relay_pass_through_warp_test();
+    int quicrq_relay_pass_through_chain_test();
     int quicrq_subscribe_basic_test();
     int quicrq_subscribe_relay1_test();
     int quicrq_subscribe_relay2_test();
@@ -73,6 +91,8 @@ extern "C" {
     int quicrq_triangle_intent_next_s_test();
     int quicrq_triangle_intent_that_test();
     int quicrq_triangle_intent_that_s_test();
+    int quicrq_triangle_intent_time_test();
+    int quicrq_triangle_intent_time_s_test();
     int quicrq_triangle_intent_warp_test();
     int quicrq_triangle_intent_warp_nc_test();
     int quicrq_triangle_intent_warp_loss_test();
@@ -97,7 +117,28 @@ extern "C" {
     int quicrq_fourlegs_datagram_test();
     int quicrq_fourlegs_datagram_last_test();
     int quicrq_fourlegs_datagram_loss_test();
+    int quicrq_fanout_basic_test();
+    int quicrq_fanout_datagram_test();
+    int quicrq_fanout_busy_test();
+    int quicrq_fanout_repeat_test();
+    int quicrq_watchdog_test();
+    int quicrq_watchdog_datagram_test();
+    int quicrq_bundle_test();
+    int quicrq_bundle_loss_test();
+    int quicrq_scenario_test();
+    int quicrq_churn_test();
+    int quicrq_repair_deadline_test();
+    int quicrq_redundant_ingest_test();
+    int quicrq_redundant_ingest_datagram_test();
+    int quicrq_redundant_ingest_loss_test();
     int quicrq_fragment_cache_fill_test();
+    int quicrq_fragment_cache_seek_time_test();
+    int quicrq_fragment_cache_extent_test();
+    int quicrq_fragment_cache_streamed_test();
+    int quicrq_fragment_cache_repair_deadline_test();
+    int quicrq_fragment_publisher_lag_test();
+    int quicrq_fragment_cache_duplicate_test();
+    int quicrq_fragment_cache_cursor_test();
     int quicrq_get_addr_test();
     int quicrq_warp_basic_test();
     int quicrq_warp_basic_client_test();
@@ -113,9 +154,24 @@ extern "C" {
     int quicrq_warp_relay_test();
     int quicrq_warp_basic_loss_test();
     int quicrq_warp_relay_loss_test();
+    int quicrq_latest_first_test();
+    int quicrq_latest_first_relay_test();
+    int quicrq_latest_first_relay_stream_test();
+    int quicrq_latest_first_relay_datagram_test();
+    int quicrq_latest_first_start_time_test();
     int quicrq_rush_basic_test();
     int quicrq_rush_basic_client_test();
     int quicrq_rush_basic_loss_test();
+    int quicrq_rush_pack_test();
+    int quicrq_rush_pack_loss_test();
+    int quicrq_warp_uni_bound_test();
+    int quicrq_rush_uni_bound_loss_test();
+    int quicrq_datagram_split_test();
+    int quicrq_datagram_split_loss_test();
+    int quicrq_fetch_test();
+    int quicrq_fetch_partial_test();
+    int quicrq_resume_stream_test();
+    int quicrq_resume_datagram_test();
     int quicrq_triangle_rush_test();
     int quicrq_triangle_intent_rush_test();
     int quicrq_triangle_intent_rush_nc_test();
@@ -0,0 +1,249 @@
+#include <string.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_fragment.h"
+#include "quicrq_test_internal.h"
+
+/* Redundant ingest test:
+ * Two publishers post the same real time media to the origin, and a client
+ * subscribes to it. The configuration diagram is:
+ *
+ *         P1  P2
+ *           \ /
+ *            S
+ *            |
+ *            C
+ *
+ * Both publishers start at the same time from the same source, so they agree on
+ * the group and object numbers. The link from P2 is slower, so most fragments
+ * arrive first from P1 and the copies from P2 are ignored. In the middle of the
+ * media, the connection of P1 is closed. The client shall receive the whole media
+ * without gap, from P2.
+ */
+#define QUICRQ_REDUNDANT_INGEST_TEST_BACKUP_LATENCY 20000
+#define QUICRQ_REDUNDANT_INGEST_TEST_KILL_TIME 2500000
+
+/* Create a test network */
+quicrq_test_config_t* quicrq_test_redundant_ingest_config_create(uint64_t simulate_loss)
+{
+    /* Create a configuration with four nodes, three connections, two links and two attachments per connection. */
+    quicrq_test_config_t* config = quicrq_test_config_create(4, 6, 6, 2);
+    if (config != NULL) {
+        /* Create the contexts for the origin (0), publishers (1, 2) and client (3) */
+        for (int i = 0; i < 4; i++) {
+            if (i == 0) {
+                config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                    config->test_server_cert_file, config->test_server_key_file, NULL, NULL, NULL,
+                    config->ticket_encryption_key, sizeof(config->ticket_encryption_key),
+                    &config->simulated_time);
+            }
+            else {
+                config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                    NULL, NULL, config->test_server_cert_store_file, NULL, NULL,
+                    NULL, 0, &config->simulated_time);
+            }
+            if (config->nodes[i] == NULL) {
+                quicrq_test_config_delete(config);
+                config = NULL;
+                break;
+            }
+        }
+    }
+    if (config != NULL) {
+        /* Populate the links and attachments:
+         * S to P1: links 0 and 1, S to P2: links 2 and 3, S to C: links 4 and 5 */
+        for (int i = 0; i < 3; i++) {
+            int link_id = 2 * i;
+            config->return_links[link_id] = link_id + 1;
+            config->attachments[link_id].link_id = link_id;
+            config->attachments[link_id].node_id = 0;
+            config->return_links[link_id + 1] = link_id;
+            config->attachments[link_id + 1].link_id = link_id + 1;
+            config->attachments[link_id + 1].node_id = i + 1;
+        }
+        /* Set the desired loss pattern */
+        config->simulate_loss = simulate_loss;
+    }
+    return config;
+}
+
+int quicrq_redundant_ingest_test_one(quicrq_transport_mode_enum transport_mode, uint64_t simulate_loss)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int is_killed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_redundant_ingest_config_create(simulate_loss);
+    quicrq_cnx_ctx_t* cnx_ctx[3] = { NULL, NULL, NULL };
+    uint64_t nb_duplicate_fragments = 0;
+    char media_source_path[512];
+    char result_file_name[256];
+    char result_log_name[256];
+    size_t nb_log_chars = 0;
+
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "redundant-ingest-video1-recv-%c-%llx.bin",
+        quicrq_transport_mode_to_letter(transport_mode), (unsigned long long)simulate_loss);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "redundant-ingest-video1-log-%c-%llx.csv",
+        quicrq_transport_mode_to_letter(transport_mode), (unsigned long long)simulate_loss);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Enable origin on node 0 */
+        ret = quicrq_enable_origin(config->nodes[0], transport_mode);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable origin, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        /* Slow down the path from the backup publisher */
+        config->links[2]->microsec_latency += QUICRQ_REDUNDANT_INGEST_TEST_BACKUP_LATENCY;
+        config->links[3]->microsec_latency += QUICRQ_REDUNDANT_INGEST_TEST_BACKUP_LATENCY;
+    }
+
+    for (int i = 0; ret == 0 && i < 3; i++) {
+        if (i < 2) {
+            /* Add the same real time source to both publishers */
+            config->object_sources[i] = test_media_object_source_publish(config->nodes[i + 1], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+                strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+            if (config->object_sources[i] == NULL) {
+                ret = -1;
+                break;
+            }
+        }
+        /* Create a quicrq connection context to the origin */
+        cnx_ctx[i] = quicrq_test_create_client_cnx(config, i + 1, 0);
+        if (cnx_ctx[i] == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection #%d, ret = %d", i + 1, ret);
+        }
+        else if (i < 2) {
+            /* Start pushing from the publisher */
+            ret = quicrq_cnx_post_media(cnx_ctx[i], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE, strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode);
+            if (ret != 0) {
+                DBG_PRINTF("Cannot publish test media %s from publisher %d, ret = %d", QUICRQ_TEST_BASIC_SOURCE, i + 1, ret);
+            }
+        }
+        else if (test_object_stream_subscribe(cnx_ctx[i], (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        quicrq_media_source_ctx_t* srce_ctx;
+
+        if (!is_killed && config->simulated_time >= QUICRQ_REDUNDANT_INGEST_TEST_KILL_TIME) {
+            /* The main publisher fails in the middle of the media */
+            is_killed = 1;
+            if (config->nodes[1]->first_cnx != NULL) {
+                ret = quicrq_close_cnx(config->nodes[1]->first_cnx);
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close main publisher connection, ret = %d", ret);
+                    break;
+                }
+            }
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, (is_killed) ? UINT64_MAX : QUICRQ_REDUNDANT_INGEST_TEST_KILL_TIME);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Monitor the duplicates ignored by the origin cache */
+        srce_ctx = config->nodes[0]->first_source;
+        while (srce_ctx != NULL) {
+            if (srce_ctx->cache_ctx != NULL && srce_ctx->cache_ctx->nb_duplicate_fragments > nb_duplicate_fragments) {
+                nb_duplicate_fragments = srce_ctx->cache_ctx->nb_duplicate_fragments;
+            }
+            srce_ctx = srce_ctx->next_source;
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        if (config->nodes[3]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && is_killed && config->nodes[3]->first_cnx->first_stream == NULL &&
+            (config->nodes[2]->first_cnx == NULL || config->nodes[2]->first_cnx->first_stream == NULL)) {
+            /* Client and backup publisher are done. Close connections without waiting for timer */
+            is_closed = 1;
+            for (int c_nb = 2; ret == 0 && c_nb < 4; c_nb++) {
+                if (config->nodes[c_nb]->first_cnx != NULL) {
+                    ret = quicrq_close_cnx(config->nodes[c_nb]->first_cnx);
+                    if (ret != 0) {
+                        DBG_PRINTF("Cannot close connection, ret = %d", ret);
+                    }
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0 && nb_duplicate_fragments == 0) {
+        DBG_PRINTF("%s", "No duplicate fragment received from the redundant ingest");
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received without gap */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+        if (ret != 0) {
+            DBG_PRINTF("Media received in %s does not match the source", result_file_name);
+        }
+    }
+
+    return ret;
+}
+
+int quicrq_redundant_ingest_test()
+{
+    return quicrq_redundant_ingest_test_one(quicrq_transport_mode_single_stream, 0);
+}
+
+int quicrq_redundant_ingest_datagram_test()
+{
+    return quicrq_redundant_ingest_test_one(quicrq_transport_mode_datagram, 0);
+}
+
+int quicrq_redundant_ingest_loss_test()
+{
+    return quicrq_redundant_ingest_test_one(quicrq_transport_mode_datagram, 0x7080);
+}
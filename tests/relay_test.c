@@ -51,10 +51,83 @@ quicrq_test_config_t* quicrq_test_relay_config_create(uint64_t simulate_loss)
     return config;
 }
 
+/* Check the statistics of the media streams on the relay.
+ * Sender streams shall document the URL, the position shall not be
+ * ahead of the cache, and the lag shall be zero if caught up.
+ */
+static int quicrq_relay_test_check_stats(quicrq_ctx_t* qr_ctx, uint64_t current_time, int* nb_senders, uint64_t* bytes_sent)
+{
+    int ret = 0;
+    quicrq_cnx_ctx_t* cnx_ctx = quicrq_first_connection(qr_ctx);
+    quicrq_stream_statistics_t stats[8];
+
+    while (ret == 0 && cnx_ctx != NULL) {
+        size_t nb_stats = 0;
+
+        ret = quicrq_cnx_get_stream_statistics(cnx_ctx, stats, 8, &nb_stats, current_time);
+        for (size_t i = 0; ret == 0 && i < nb_stats && i < 8; i++) {
+            if (!stats[i].is_sender) {
+                continue;
+            }
+            *nb_senders += 1;
+            if (stats[i].bytes_sent > *bytes_sent) {
+                *bytes_sent = stats[i].bytes_sent;
+            }
+            if (stats[i].url == NULL || stats[i].url_length == 0) {
+                DBG_PRINTF("Missing URL for stream %" PRIu64, stats[i].stream_id);
+                ret = -1;
+            }
+            else if (stats[i].current_group_id > stats[i].cache_next_group_id ||
+                (stats[i].current_group_id == stats[i].cache_next_group_id &&
+                    stats[i].current_object_id > stats[i].cache_next_object_id)) {
+                DBG_PRINTF("Stream %" PRIu64 " at %" PRIu64 ",%" PRIu64 " ahead of cache %" PRIu64 ",%" PRIu64,
+                    stats[i].stream_id, stats[i].current_group_id, stats[i].current_object_id,
+                    stats[i].cache_next_group_id, stats[i].cache_next_object_id);
+                ret = -1;
+            }
+            else if (stats[i].lag_objects == 0 && stats[i].lag_time != 0) {
+                DBG_PRINTF("Stream %" PRIu64 " has no lag but lag time %" PRIu64, stats[i].stream_id, stats[i].lag_time);
+                ret = -1;
+            }
+        }
+        cnx_ctx = quicrq_next_connection(cnx_ctx);
+    }
+    return ret;
+}
+
+/* Number of fragments currently held in the relay caches.
+ * If nb_bytes is not NULL, also add the memory used by these fragments,
+ * fragment headers plus allocated data.
+ */
+static int quicrq_relay_test_cache_size(quicrq_ctx_t* qr_ctx, size_t* nb_bytes)
+{
+    int nb_fragments = 0;
+    quicrq_media_source_ctx_t* srce_ctx = qr_ctx->first_source;
+
+    while (srce_ctx != NULL) {
+        if (!srce_ctx->is_local_object_source && srce_ctx->cache_ctx != NULL) {
+            nb_fragments += srce_ctx->cache_ctx->fragment_tree.size;
+            if (nb_bytes != NULL) {
+                quicrq_cached_fragment_t* fragment = srce_ctx->cache_ctx->first_fragment;
+                while (fragment != NULL) {
+                    *nb_bytes += sizeof(quicrq_cached_fragment_t) + fragment->data_alloc;
+                    fragment = fragment->next_in_order;
+                }
+            }
+        }
+        srce_ctx = srce_ctx->next_source;
+    }
+    return nb_fragments;
+}
+
 /* Basic relay test */
-int quicrq_relay_test_one(int is_real_time, quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses, int is_from_client)
+int quicrq_relay_test_one_ex(int is_real_time, quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses, int is_from_client,
+    int check_stats, int is_pass_through, int* cache_peak)
 {
     int ret = 0;
+    int nb_stats_senders = 0;
+    uint64_t stats_bytes_sent = 0;
+    uint64_t next_stats_time = 0;
     int nb_steps = 0;
     int nb_inactive = 0;
     int is_closed = 0;
@@ -108,6 +181,9 @@ int quicrq_relay_test_one(int is_real_time, quicrq_transport_mode_enum transport
         if (ret != 0) {
             DBG_PRINTF("Cannot enable relay, ret = %d", ret);
         }
+        else if (is_pass_through) {
+            ret = quicrq_set_relay_pass_through(config->nodes[1], 1);
+        }
     }
 
     if (ret == 0) {
@@ -147,6 +223,17 @@ int quicrq_relay_test_one(int is_real_time, quicrq_transport_mode_enum transport
         if (ret != 0) {
             DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
         }
+        else if (check_stats && config->simulated_time >= next_stats_time) {
+            /* Poll the relay statistics once per second */
+            ret = quicrq_relay_test_check_stats(config->nodes[1], config->simulated_time, &nb_stats_senders, &stats_bytes_sent);
+            next_stats_time = config->simulated_time + 1000000;
+        }
+        if (ret == 0 && cache_peak != NULL) {
+            int nb_cached = quicrq_relay_test_cache_size(config->nodes[1], NULL);
+            if (nb_cached > *cache_peak) {
+                *cache_peak = nb_cached;
+            }
+        }
 
         nb_steps++;
 
@@ -185,6 +272,11 @@ int quicrq_relay_test_one(int is_real_time, quicrq_transport_mode_enum transport
         ret = -1;
     }
 
+    if (ret == 0 && check_stats && (nb_stats_senders == 0 || stats_bytes_sent == 0)) {
+        DBG_PRINTF("Relay statistics found %d senders, %" PRIu64 " bytes", nb_stats_senders, stats_bytes_sent);
+        ret = -1;
+    }
+
     /* Clear everything. */
     if (config != NULL) {
         quicrq_test_config_delete(config);
@@ -200,6 +292,11 @@ int quicrq_relay_test_one(int is_real_time, quicrq_transport_mode_enum transport
     return ret;
 }
 
+int quicrq_relay_test_one(int is_real_time, quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses, int is_from_client)
+{
+    return quicrq_relay_test_one_ex(is_real_time, transport_mode, simulate_losses, is_from_client, 0, 0, NULL);
+}
+
 int quicrq_relay_basic_test()
 {
     int ret = quicrq_relay_test_one(1, quicrq_transport_mode_single_stream, 0, 0);
@@ -249,3 +346,551 @@ int quicrq_warp_relay_loss_test()
 
     return ret;
 }
+
+/* Poll the statistics of the media streams at the relay while the relay test runs */
+int quicrq_relay_stats_test()
+{
+    int ret = quicrq_relay_test_one_ex(1, quicrq_transport_mode_datagram, 0x7080, 0, 1, 0, NULL);
+
+    return ret;
+}
+
+/* Streaming publication test.
+ * The origin publishes objects as a live encoder would, producing each object
+ * over production_time. The objects are either published whole once produced,
+ * or in chunks as they are produced. The client gets the media through the
+ * relay, and the test returns the average delay between capture and arrival.
+ * If origin_clock_base is not zero, the origin sets the origin timestamp of
+ * the objects, and the test verifies that the client receives the expected
+ * value for each object.
+ */
+int quicrq_relay_chunk_test_one_ex(quicrq_transport_mode_enum transport_mode, int nb_chunks, uint64_t production_time,
+    uint64_t origin_clock_base, uint64_t * delay_average)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_relay_config_create(0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    test_object_stream_ctx_t* object_stream_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    char text_log_name[512];
+    char test_id[256];
+    size_t nb_log_chars = 0;
+
+    *delay_average = 0;
+    (void)picoquic_sprintf(test_id, sizeof(test_id), NULL, "relay-chunks-%c-%d-%llu%s",
+        quicrq_transport_mode_to_letter(transport_mode), nb_chunks, (unsigned long long)production_time,
+        (origin_clock_base != 0) ? "-ts" : "");
+    (void)picoquic_sprintf(text_log_name, sizeof(text_log_name), &nb_log_chars, "%s_textlog.txt", test_id);
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), NULL, "%s_video1.bin", test_id);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), NULL, "%s_video1.csv", test_id);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    /* Add QUIC level log */
+    if (ret == 0) {
+        ret = picoquic_set_textlog(config->nodes[1]->quic, text_log_name);
+    }
+
+    if (ret == 0) {
+        /* Add a test source to the origin, published in chunks */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+        else {
+            config->object_sources[0]->nb_chunks = nb_chunks;
+            config->object_sources[0]->production_time = production_time;
+            config->object_sources[0]->origin_clock_base = origin_clock_base;
+        }
+    }
+
+    if (ret == 0) {
+        /* Configure the relay: set the server address */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, transport_mode);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quirq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 2, 1);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        object_stream_ctx = test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name, result_log_name);
+        if (object_stream_ctx == NULL) {
+            ret = -1;
+        }
+        else {
+            object_stream_ctx->origin_clock_base = origin_clock_base;
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        /* if the media is received, exit the loop */
+        if (config->nodes[2]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else {
+            int client_stream_closed = config->nodes[2]->first_cnx->first_stream == NULL;
+            int server_stream_closed = config->nodes[0]->first_cnx != NULL && config->nodes[0]->first_cnx->first_stream == NULL;
+
+            if (!is_closed && client_stream_closed && server_stream_closed) {
+                /* Client is done. Close connection without waiting for timer */
+                ret = picoquic_close(config->nodes[2]->first_cnx->cnx, 0);
+                is_closed = 1;
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0 && origin_clock_base != 0 &&
+        (object_stream_ctx->nb_origin_timestamps == 0 || object_stream_ctx->nb_origin_timestamp_errors != 0)) {
+        DBG_PRINTF("Origin timestamps: %d received, %d errors",
+            object_stream_ctx->nb_origin_timestamps, object_stream_ctx->nb_origin_timestamp_errors);
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received correctly, and get the delays */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+        if (ret == 0) {
+            int nb_frames;
+            int nb_losses;
+            uint64_t delay_min;
+            uint64_t delay_max;
+
+            ret = quicrq_log_file_statistics(result_log_name, &nb_frames, &nb_losses,
+                delay_average, &delay_min, &delay_max);
+        }
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+int quicrq_relay_chunk_test_one(quicrq_transport_mode_enum transport_mode, int nb_chunks, uint64_t production_time,
+    uint64_t* delay_average)
+{
+    return quicrq_relay_chunk_test_one_ex(transport_mode, nb_chunks, production_time, 0, delay_average);
+}
+
+/* Compare the delays when objects are published whole or in chunks.
+ * The last chunk is produced at the same time as the whole object, but
+ * the first chunks are already forwarded by then, so the average delay
+ * should be lower. */
+int quicrq_relay_chunk_test_compare(quicrq_transport_mode_enum transport_mode)
+{
+    const uint64_t production_time = 20000;
+    uint64_t whole_delay = 0;
+    uint64_t chunk_delay = 0;
+    int ret = quicrq_relay_chunk_test_one(transport_mode, 1, production_time, &whole_delay);
+
+    if (ret == 0) {
+        ret = quicrq_relay_chunk_test_one(transport_mode, 8, production_time, &chunk_delay);
+    }
+    if (ret == 0 && chunk_delay >= whole_delay) {
+        DBG_PRINTF("Delay in chunks %" PRIu64 " not lower than whole %" PRIu64, chunk_delay, whole_delay);
+        ret = -1;
+    }
+    return ret;
+}
+
+int quicrq_relay_chunks_test()
+{
+    return quicrq_relay_chunk_test_compare(quicrq_transport_mode_single_stream);
+}
+
+int quicrq_relay_chunks_datagram_test()
+{
+    return quicrq_relay_chunk_test_compare(quicrq_transport_mode_datagram);
+}
+
+/* Origin timestamp test.
+ * Verify that the origin timestamp set by the publisher reaches the client
+ * through the relay in all transport modes, including when the objects are
+ * published in chunks and the timestamp is only carried in the first fragment.
+ */
+int quicrq_relay_origin_timestamp_test()
+{
+    const uint64_t origin_clock_base = 1000000000;
+    quicrq_transport_mode_enum transport_modes[] = {
+        quicrq_transport_mode_single_stream,
+        quicrq_transport_mode_datagram,
+        quicrq_transport_mode_warp,
+        quicrq_transport_mode_rush };
+    int ret = 0;
+
+    for (size_t i = 0; ret == 0 && i < sizeof(transport_modes) / sizeof(quicrq_transport_mode_enum); i++) {
+        uint64_t delay_average = 0;
+        ret = quicrq_relay_chunk_test_one_ex(transport_modes[i], 4, 20000, origin_clock_base, &delay_average);
+        if (ret != 0) {
+            DBG_PRINTF("Origin timestamp test fails for mode %s", quicrq_transport_mode_to_string(transport_modes[i]));
+        }
+    }
+    return ret;
+}
+
+/* Pass through test.
+ * Run the relay test with a single client, first with the regular real time
+ * cache and then in pass through mode, and compare the peak number of fragments
+ * held in the relay cache. In stream and warp mode, pass through shall hold
+ * strictly fewer fragments than the regular cache. In datagram mode with losses,
+ * fragments wait in the cache until the holes are filled, so we only check that
+ * pass through does not hold more.
+ */
+int quicrq_relay_pass_through_test_one(quicrq_transport_mode_enum transport_mode, uint64_t simulate_losses)
+{
+    int cache_peak = 0;
+    int pass_through_peak = 0;
+    int ret = quicrq_relay_test_one_ex(1, transport_mode, simulate_losses, 0, 0, 0, &cache_peak);
+
+    if (ret == 0) {
+        ret = quicrq_relay_test_one_ex(1, transport_mode, simulate_losses, 0, 0, 1, &pass_through_peak);
+    }
+    if (ret == 0) {
+        DBG_PRINTF("Mode %s, peak relay cache %d fragments, %d in pass through",
+            quicrq_transport_mode_to_string(transport_mode), cache_peak, pass_through_peak);
+        if (pass_through_peak == 0 || pass_through_peak > cache_peak ||
+            (transport_mode != quicrq_transport_mode_datagram && pass_through_peak == cache_peak)) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int quicrq_relay_pass_through_test()
+{
+    return quicrq_relay_pass_through_test_one(quicrq_transport_mode_single_stream, 0);
+}
+
+int quicrq_relay_pass_through_datagram_test()
+{
+    return quicrq_relay_pass_through_test_one(quicrq_transport_mode_datagram, 0x7080);
+}
+
+int quicrq_relay_pass_through_warp_test()
+{
+    return quicrq_relay_pass_through_test_one(quicrq_transport_mode_warp, 0);
+}
+
+/* Create a chain of relays.
+ * Node 0 is the origin, nodes 1 to nb_relays are relays, node nb_relays+1 is
+ * the client. Links 2*i and 2*i+1 connect node i and node i+1.
+ */
+static quicrq_test_config_t* quicrq_test_relay_chain_config_create(int nb_relays, uint64_t simulate_loss)
+{
+    int nb_nodes = nb_relays + 2;
+    int nb_links = 2 * (nb_relays + 1);
+    quicrq_test_config_t* config = quicrq_test_config_create(nb_nodes, nb_links, nb_links, 1);
+    if (config != NULL) {
+        int is_ok = 1;
+        /* Create the contexts for the origin and the relays, then the client */
+        for (int i = 0; i < nb_nodes - 1; i++) {
+            config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                config->test_server_cert_file, config->test_server_key_file, NULL, NULL, NULL,
+                config->ticket_encryption_key, sizeof(config->ticket_encryption_key),
+                &config->simulated_time);
+            if (config->nodes[i] == NULL) {
+                is_ok = 0;
+            }
+        }
+        config->nodes[nb_nodes - 1] = quicrq_create(QUICRQ_ALPN,
+            NULL, NULL, config->test_server_cert_store_file, NULL, NULL,
+            NULL, 0, &config->simulated_time);
+        if (config->nodes[nb_nodes - 1] == NULL) {
+            is_ok = 0;
+        }
+        if (!is_ok) {
+            quicrq_test_config_delete(config);
+            config = NULL;
+        }
+    }
+    if (config != NULL) {
+        /* Populate the attachments */
+        for (int i = 0; i < nb_links; i += 2) {
+            config->return_links[i] = i + 1;
+            config->attachments[i].link_id = i;
+            config->attachments[i].node_id = i / 2;
+            config->return_links[i + 1] = i;
+            config->attachments[i + 1].link_id = i + 1;
+            config->attachments[i + 1].node_id = i / 2 + 1;
+        }
+        /* Set the desired loss pattern */
+        config->simulate_loss = simulate_loss;
+    }
+    return config;
+}
+
+/* Data sent by the relays to their downstream peers */
+static uint64_t quicrq_relay_chain_bytes_forwarded(quicrq_test_config_t* config, int nb_relays)
+{
+    uint64_t bytes_forwarded = 0;
+
+    for (int i = 1; i <= nb_relays; i++) {
+        quicrq_cnx_ctx_t* cnx_ctx = quicrq_first_connection(config->nodes[i]);
+        while (cnx_ctx != NULL) {
+            if (cnx_ctx->is_server) {
+                bytes_forwarded += picoquic_get_data_sent(cnx_ctx->cnx);
+            }
+            cnx_ctx = quicrq_next_connection(cnx_ctx);
+        }
+    }
+    return bytes_forwarded;
+}
+
+/* Relay chain test.
+ * Send the test media from the origin to the client through a chain of relays,
+ * and measure the peak memory held in the relay caches and the computation
+ * time of the simulation, both per byte forwarded by the relays.
+ * The computation time is the wall clock time of the whole simulation,
+ * including origin and client, so it is only an upper bound of the relay cost.
+ */
+static int quicrq_relay_chain_test_one(quicrq_transport_mode_enum transport_mode, int nb_relays, int is_pass_through,
+    int* cache_peak, size_t* cache_bytes_peak)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int client_node = nb_relays + 1;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_relay_chain_config_create(nb_relays, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    uint64_t bytes_forwarded = 0;
+    uint64_t start_wall_time = picoquic_current_time();
+    uint64_t wall_time = 0;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    size_t nb_log_chars = 0;
+
+    *cache_peak = 0;
+    *cache_bytes_peak = 0;
+
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "relay_chain-%c-%d-%d.bin",
+        quicrq_transport_mode_to_letter(transport_mode), nb_relays, is_pass_through);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "relay_chain-%c-%d-%d.csv",
+        quicrq_transport_mode_to_letter(transport_mode), nb_relays, is_pass_through);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Add a test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    /* Configure each relay to use the previous node in the chain as server */
+    for (int i = 1; ret == 0 && i <= nb_relays; i++) {
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, i, i - 1);
+        ret = quicrq_enable_relay(config->nodes[i], NULL, addr_to, transport_mode);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay %d, ret = %d", i, ret);
+        }
+        else if (is_pass_through) {
+            ret = quicrq_set_relay_pass_through(config->nodes[i], 1);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quirq connection context on client, and subscribe to the source */
+        cnx_ctx = quicrq_test_create_client_cnx(config, client_node, nb_relays);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the relay caches and the forwarded data. */
+        int is_active = 0;
+        int nb_cached = 0;
+        size_t nb_cached_bytes = 0;
+        uint64_t nb_forwarded;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+            break;
+        }
+        for (int i = 1; i <= nb_relays; i++) {
+            nb_cached += quicrq_relay_test_cache_size(config->nodes[i], &nb_cached_bytes);
+        }
+        if (nb_cached > *cache_peak) {
+            *cache_peak = nb_cached;
+        }
+        if (nb_cached_bytes > *cache_bytes_peak) {
+            *cache_bytes_peak = nb_cached_bytes;
+        }
+        nb_forwarded = quicrq_relay_chain_bytes_forwarded(config, nb_relays);
+        if (nb_forwarded > bytes_forwarded) {
+            bytes_forwarded = nb_forwarded;
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        /* if the media is received, exit the loop */
+        if (config->nodes[client_node]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else {
+            int client_stream_closed = config->nodes[client_node]->first_cnx->first_stream == NULL;
+            int server_stream_closed = config->nodes[0]->first_cnx != NULL && config->nodes[0]->first_cnx->first_stream == NULL;
+
+            if (!is_closed && client_stream_closed && server_stream_closed) {
+                /* Client is done. Close connection without waiting for timer */
+                ret = picoquic_close(config->nodes[client_node]->first_cnx->cnx, 0);
+                is_closed = 1;
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                }
+            }
+        }
+    }
+    wall_time = picoquic_current_time() - start_wall_time;
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        if (bytes_forwarded == 0) {
+            DBG_PRINTF("%s", "No data forwarded by the relays");
+            ret = -1;
+        }
+        else {
+            DBG_PRINTF("Mode %s, %d relays%s: %" PRIu64 " bytes forwarded, peak cache %d fragments, %zu bytes (%.3f per forwarded byte), %.1f ns per forwarded byte",
+                quicrq_transport_mode_to_string(transport_mode), nb_relays, (is_pass_through) ? " in pass through" : "",
+                bytes_forwarded, *cache_peak, *cache_bytes_peak, ((double)*cache_bytes_peak) / ((double)bytes_forwarded),
+                ((double)wall_time) * 1000.0 / ((double)bytes_forwarded));
+        }
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    /* Verify that media file was received correctly */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name, media_source_path);
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+/* Run the relay chain test with and without pass through, and verify that
+ * pass through reduces the peak memory held in the relay caches.
+ */
+int quicrq_relay_pass_through_chain_test()
+{
+    int ret = 0;
+    const int nb_relays = 4;
+    quicrq_transport_mode_enum transport_modes[2] = { quicrq_transport_mode_single_stream, quicrq_transport_mode_warp };
+
+    for (size_t i = 0; ret == 0 && i < sizeof(transport_modes) / sizeof(quicrq_transport_mode_enum); i++) {
+        int cache_peak = 0;
+        int pass_through_peak = 0;
+        size_t cache_bytes_peak = 0;
+        size_t pass_through_bytes_peak = 0;
+
+        ret = quicrq_relay_chain_test_one(transport_modes[i], nb_relays, 0, &cache_peak, &cache_bytes_peak);
+        if (ret == 0) {
+            ret = quicrq_relay_chain_test_one(transport_modes[i], nb_relays, 1, &pass_through_peak, &pass_through_bytes_peak);
+        }
+        if (ret == 0 && (pass_through_peak == 0 || pass_through_peak >= cache_peak ||
+            pass_through_bytes_peak >= cache_bytes_peak)) {
+            DBG_PRINTF("Mode %s, pass through peak %d fragments, %zu bytes, cache peak %d fragments, %zu bytes",
+                quicrq_transport_mode_to_string(transport_modes[i]), pass_through_peak, pass_through_bytes_peak,
+                cache_peak, cache_bytes_peak);
+            ret = -1;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,213 @@
+#include <string.h>
+#include <stdlib.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_fragment.h"
+#include "quicrq_test_internal.h"
+
+/* Repair deadline test:
+ * The origin publishes a real time media, which the relay receives by datagrams and
+ * serves to the client on a single stream:
+ *
+ *             S
+ *             | (datagrams, long delay, losses)
+ *             R
+ *             | (stream)
+ *             C
+ *
+ * Each lost datagram on the upstream link blocks the client's stream until the repair
+ * arrives, one long round trip later. When a repair deadline is set at the relay, the
+ * missing objects are skipped after the deadline instead. The test verifies that the
+ * relay did skip objects, and that the largest delivery delay measured by the client
+ * is lower than without deadline.
+ */
+#define QUICRQ_REPAIR_DEADLINE_TEST_LATENCY 100000
+#define QUICRQ_REPAIR_DEADLINE_TEST_DEADLINE 20000
+#define QUICRQ_REPAIR_DEADLINE_TEST_LOSS 0x10000001000100ull
+
+int quicrq_repair_deadline_test_one(int is_deadline, uint64_t* max_delay)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_relay_config_create(QUICRQ_REPAIR_DEADLINE_TEST_LOSS);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    uint64_t nb_repair_skipped = 0;
+    uint64_t* delays = NULL;
+    size_t nb_delays = 0;
+    size_t delays_alloc = 0;
+    int nb_losses = 0;
+    char media_source_path[512];
+    char result_file_name[256];
+    char result_log_name[256];
+    size_t nb_log_chars = 0;
+
+    *max_delay = UINT64_MAX;
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "repair-deadline-video1-recv-%d.bin", is_deadline);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "repair-deadline-video1-log-%d.csv", is_deadline);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Lengthen the links between origin and relay, so repairs take a long time */
+        config->links[0]->microsec_latency = QUICRQ_REPAIR_DEADLINE_TEST_LATENCY;
+        config->links[1]->microsec_latency = QUICRQ_REPAIR_DEADLINE_TEST_LATENCY;
+        /* Add a real time test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Configure the relay: set the server address, receive the media by datagrams */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, quicrq_transport_mode_datagram);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0 && is_deadline) {
+        ret = quicrq_set_media_repair_deadline(config->nodes[1], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), QUICRQ_REPAIR_DEADLINE_TEST_DEADLINE);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot set repair deadline, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quicrq connection context on client, and subscribe to the media on a stream */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 2, 1);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), quicrq_transport_mode_single_stream, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        quicrq_media_source_ctx_t* srce_ctx;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Monitor the objects skipped in the relay cache */
+        srce_ctx = config->nodes[1]->first_source;
+        while (srce_ctx != NULL) {
+            if (srce_ctx->cache_ctx != NULL && srce_ctx->cache_ctx->nb_repair_skipped > nb_repair_skipped) {
+                nb_repair_skipped = srce_ctx->cache_ctx->nb_repair_skipped;
+            }
+            srce_ctx = srce_ctx->next_source;
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received, exit the loop */
+        if (config->nodes[2]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && config->nodes[2]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[2]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0 && (is_deadline != 0) != (nb_repair_skipped != 0)) {
+        DBG_PRINTF("Deadline %s, relay skipped %" PRIu64 " objects", (is_deadline) ? "on" : "off", nb_repair_skipped);
+        ret = -1;
+    }
+
+    /* Clear everything, so the log file is closed before it is read */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    if (ret == 0) {
+        ret = quicrq_log_file_delays(result_log_name, &delays, &nb_delays, &delays_alloc, &nb_losses);
+        if (ret == 0 && nb_delays == 0) {
+            ret = -1;
+        }
+        if (ret != 0) {
+            DBG_PRINTF("Cannot read the delays in %s", result_log_name);
+        }
+        else {
+            *max_delay = 0;
+            for (size_t i = 0; i < nb_delays; i++) {
+                if (delays[i] > *max_delay) {
+                    *max_delay = delays[i];
+                }
+            }
+            DBG_PRINTF("Repair deadline %s, %" PRIu64 " objects skipped, %zu received, max delay %" PRIu64 " us",
+                (is_deadline) ? "on" : "off", nb_repair_skipped, nb_delays, *max_delay);
+        }
+    }
+
+    if (delays != NULL) {
+        free(delays);
+    }
+
+    return ret;
+}
+
+/* Compare the largest delivery delay with and without repair deadline.
+ */
+int quicrq_repair_deadline_test()
+{
+    uint64_t repair_delay = 0;
+    uint64_t deadline_delay = 0;
+    int ret = quicrq_repair_deadline_test_one(0, &repair_delay);
+
+    if (ret == 0) {
+        ret = quicrq_repair_deadline_test_one(1, &deadline_delay);
+    }
+    if (ret == 0 && deadline_delay >= repair_delay) {
+        DBG_PRINTF("Max delay with repair deadline %" PRIu64 ", not below %" PRIu64 " without",
+            deadline_delay, repair_delay);
+        ret = -1;
+    }
+    return ret;
+}
@@ -0,0 +1,418 @@
+#include <stdlib.h>
+#include <string.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_tests.h"
+#include "quicrq_test_internal.h"
+
+/* Scenario runner:
+ * The regular tests run a single deterministic loss pattern, and compare the
+ * results to reference logs. The scenario runner executes a named topology over
+ * many random seeds, with random losses and jitter on all links, and documents
+ * the distribution of results in a CSV file:
+ *
+ *     scenario,seed,objects,skipped,bytes,p50,p95,p99
+ *
+ * There is one line per seed, plus a summary line in which the seed is
+ * replaced by "all". In the summary, objects, skipped objects and bytes sent by
+ * the origin are summed over all seeds, and the delivery latency percentiles
+ * (in microseconds) are computed over the objects of all seeds.
+ *
+ * The comparison mode reads the summary lines of two result files, e.g.,
+ * produced by two builds, and flags the metrics that regressed by more than
+ * a tolerance.
+ */
+
+typedef struct st_quicrq_scenario_t {
+    char const* name;
+    int is_relay;
+    quicrq_transport_mode_enum transport_mode;
+    uint64_t loss_per_million;
+    uint64_t jitter_max;
+} quicrq_scenario_t;
+
+static const quicrq_scenario_t quicrq_scenario_list[] = {
+    { "basic-stream", 0, quicrq_transport_mode_single_stream, 10000, 2000 },
+    { "basic-datagram", 0, quicrq_transport_mode_datagram, 10000, 2000 },
+    { "relay-stream", 1, quicrq_transport_mode_single_stream, 10000, 2000 },
+    { "relay-warp", 1, quicrq_transport_mode_warp, 10000, 2000 },
+    { "relay-datagram", 1, quicrq_transport_mode_datagram, 10000, 2000 }
+};
+
+static const size_t nb_quicrq_scenarios = sizeof(quicrq_scenario_list) / sizeof(quicrq_scenario_t);
+
+#define QUICRQ_SCENARIO_NB_METRICS 6
+
+typedef struct st_quicrq_scenario_result_t {
+    uint64_t nb_objects;
+    uint64_t nb_skipped;
+    uint64_t bytes_sent;
+    uint64_t latency[3];
+} quicrq_scenario_result_t;
+
+static const int quicrq_scenario_ranks[3] = { 50, 95, 99 };
+
+static const quicrq_scenario_t* quicrq_scenario_find(char const* scenario_name)
+{
+    for (size_t i = 0; i < nb_quicrq_scenarios; i++) {
+        if (strcmp(scenario_name, quicrq_scenario_list[i].name) == 0) {
+            return &quicrq_scenario_list[i];
+        }
+    }
+    return NULL;
+}
+
+/* Run one seed of a scenario. The delivery delays of the objects are
+ * appended to the array "delays".
+ */
+static int quicrq_scenario_run_one(const quicrq_scenario_t* scenario, uint64_t seed,
+    uint64_t** delays, size_t* nb_delays, size_t* delays_alloc, quicrq_scenario_result_t* result)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int nb_losses = 0;
+    size_t first_delay = *nb_delays;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    int client_node = (scenario->is_relay) ? 2 : 1;
+    int server_node = (scenario->is_relay) ? 1 : 0;
+    quicrq_test_config_t* config = (scenario->is_relay) ? quicrq_test_relay_config_create(0) :
+        quicrq_test_basic_config_create(0, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    size_t nb_log_chars = 0;
+
+    memset(result, 0, sizeof(quicrq_scenario_result_t));
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), &nb_log_chars, "scenario-%s-recv-%llu.bin",
+        scenario->name, (unsigned long long)seed);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), &nb_log_chars, "scenario-%s-log-%llu.csv",
+        scenario->name, (unsigned long long)seed);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+    else {
+        quicrq_test_config_set_random(config, seed, scenario->loss_per_million, scenario->jitter_max);
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Add a real time test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0 && scenario->is_relay) {
+        /* Configure the relay: set the server address */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, scenario->transport_mode);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quicrq connection context on client, and subscribe to the media */
+        cnx_ctx = quicrq_test_create_client_cnx(config, client_node, server_node);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), scenario->transport_mode, result_file_name, result_log_name) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        quicrq_cnx_ctx_t* origin_cnx_ctx = config->nodes[0]->first_cnx;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        /* Monitor the bytes sent by the origin */
+        if (origin_cnx_ctx != NULL && origin_cnx_ctx->cnx != NULL) {
+            result->bytes_sent = picoquic_get_data_sent(origin_cnx_ctx->cnx);
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received, exit the loop */
+        if (config->nodes[client_node]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && config->nodes[client_node]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connection without waiting for timer */
+            ret = quicrq_close_cnx(config->nodes[client_node]->first_cnx);
+            is_closed = 1;
+            if (ret != 0) {
+                DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+            }
+        }
+    }
+
+    if (ret == 0 && !is_closed) {
+        DBG_PRINTF("Scenario %s, seed %llu, session was not properly closed, time = %" PRIu64,
+            scenario->name, (unsigned long long)seed, config->simulated_time);
+        ret = -1;
+    }
+
+    /* Clear everything, so the log file is closed before it is read */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    if (ret == 0) {
+        ret = quicrq_log_file_delays(result_log_name, delays, nb_delays, delays_alloc, &nb_losses);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot read the delays in %s", result_log_name);
+        }
+    }
+
+    if (ret == 0) {
+        size_t nb_received = *nb_delays - first_delay;
+        uint64_t* seed_delays = (uint64_t*)malloc(((nb_received > 0) ? nb_received : 1) * sizeof(uint64_t));
+
+        if (seed_delays == NULL) {
+            ret = -1;
+        }
+        else {
+            /* Sort a copy, so the pooled delays remain available for the summary */
+            if (nb_received > 0) {
+                memcpy(seed_delays, *delays + first_delay, nb_received * sizeof(uint64_t));
+            }
+            quicrq_delay_percentiles(seed_delays, nb_received, quicrq_scenario_ranks, 3, result->latency);
+            result->nb_objects = nb_received + nb_losses;
+            result->nb_skipped = nb_losses;
+            free(seed_delays);
+        }
+    }
+
+    return ret;
+}
+
+static void quicrq_scenario_write_line(FILE* F, char const* scenario_name, char const* seed_text, quicrq_scenario_result_t* result)
+{
+    fprintf(F, "%s,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+        scenario_name, seed_text, result->nb_objects, result->nb_skipped, result->bytes_sent,
+        result->latency[0], result->latency[1], result->latency[2]);
+}
+
+/* Run a named scenario over nb_seeds consecutive seeds, starting with first_seed,
+ * and write the results to the specified file.
+ */
+int quicrq_scenario_run(char const* scenario_name, int nb_seeds, uint64_t first_seed, char const* result_file)
+{
+    int ret = 0;
+    const quicrq_scenario_t* scenario = quicrq_scenario_find(scenario_name);
+    FILE* F = NULL;
+    uint64_t* delays = NULL;
+    size_t nb_delays = 0;
+    size_t delays_alloc = 0;
+    quicrq_scenario_result_t total;
+
+    memset(&total, 0, sizeof(quicrq_scenario_result_t));
+
+    if (scenario == NULL) {
+        DBG_PRINTF("Unknown scenario: %s", scenario_name);
+        ret = -1;
+    }
+    else if (nb_seeds <= 0) {
+        ret = -1;
+    }
+    else if ((F = picoquic_file_open(result_file, "w")) == NULL) {
+        DBG_PRINTF("Cannot open %s", result_file);
+        ret = -1;
+    }
+    else {
+        fprintf(F, "scenario,seed,objects,skipped,bytes,p50,p95,p99\n");
+    }
+
+    for (int i = 0; ret == 0 && i < nb_seeds; i++) {
+        quicrq_scenario_result_t result;
+        uint64_t seed = first_seed + i;
+        char seed_text[32];
+        size_t nb_chars = 0;
+
+        ret = quicrq_scenario_run_one(scenario, seed, &delays, &nb_delays, &delays_alloc, &result);
+        if (ret == 0) {
+            (void)picoquic_sprintf(seed_text, sizeof(seed_text), &nb_chars, "%llu", (unsigned long long)seed);
+            quicrq_scenario_write_line(F, scenario->name, seed_text, &result);
+            total.nb_objects += result.nb_objects;
+            total.nb_skipped += result.nb_skipped;
+            total.bytes_sent += result.bytes_sent;
+        }
+        else {
+            DBG_PRINTF("Scenario %s fails for seed %llu", scenario->name, (unsigned long long)seed);
+        }
+    }
+
+    if (ret == 0) {
+        quicrq_delay_percentiles(delays, nb_delays, quicrq_scenario_ranks, 3, total.latency);
+        quicrq_scenario_write_line(F, scenario->name, "all", &total);
+        DBG_PRINTF("Scenario %s, %d seeds, %" PRIu64 " objects, %" PRIu64 " skipped, p50=%" PRIu64 ", p95=%" PRIu64 ", p99=%" PRIu64,
+            scenario->name, nb_seeds, total.nb_objects, total.nb_skipped, total.latency[0], total.latency[1], total.latency[2]);
+    }
+
+    if (F != NULL) {
+        picoquic_file_close(F);
+    }
+    if (delays != NULL) {
+        free(delays);
+    }
+
+    return ret;
+}
+
+/* Read the summary line of a result file */
+static int quicrq_scenario_read_summary(char const* result_file, char* scenario_name, size_t name_max, uint64_t* metrics)
+{
+    int ret = -1;
+    int last_err = 0;
+    FILE* F = picoquic_file_open_ex(result_file, "r", &last_err);
+
+    if (F == NULL) {
+        DBG_PRINTF("Cannot open %s, error %d", result_file, last_err);
+    }
+    else {
+        char line[512];
+
+        while (ret != 0 && fgets(line, sizeof(line), F) != NULL) {
+            char* seed_field = strchr(line, ',');
+            char* s;
+            int nb_metrics = 0;
+
+            if (seed_field == NULL || strncmp(seed_field + 1, "all,", 4) != 0 ||
+                (size_t)(seed_field - line) >= name_max) {
+                continue;
+            }
+            memcpy(scenario_name, line, seed_field - line);
+            scenario_name[seed_field - line] = 0;
+            s = seed_field + 5;
+            while (nb_metrics < QUICRQ_SCENARIO_NB_METRICS && *s >= '0' && *s <= '9') {
+                metrics[nb_metrics] = 0;
+                while (*s >= '0' && *s <= '9') {
+                    metrics[nb_metrics] = 10 * metrics[nb_metrics] + (*s - '0');
+                    s++;
+                }
+                nb_metrics++;
+                if (*s == ',') {
+                    s++;
+                }
+            }
+            if (nb_metrics == QUICRQ_SCENARIO_NB_METRICS) {
+                ret = 0;
+            }
+        }
+        picoquic_file_close(F);
+        if (ret != 0) {
+            DBG_PRINTF("No summary line in %s", result_file);
+        }
+    }
+    return ret;
+}
+
+/* Compare the summary of a result file to that of a reference file, and print the
+ * differences. Returns -1 if the files cannot be compared, or if the number of skipped
+ * objects, the bytes sent or one of the latency percentiles increased by more than
+ * tolerance_percent.
+ */
+int quicrq_scenario_compare(char const* ref_file, char const* result_file, int tolerance_percent, FILE* F)
+{
+    static const char* metric_names[QUICRQ_SCENARIO_NB_METRICS] = { "objects", "skipped", "bytes", "p50", "p95", "p99" };
+    char ref_name[256];
+    char result_name[256];
+    uint64_t ref_metrics[QUICRQ_SCENARIO_NB_METRICS];
+    uint64_t result_metrics[QUICRQ_SCENARIO_NB_METRICS];
+    int ret = quicrq_scenario_read_summary(ref_file, ref_name, sizeof(ref_name), ref_metrics);
+
+    if (ret == 0) {
+        ret = quicrq_scenario_read_summary(result_file, result_name, sizeof(result_name), result_metrics);
+    }
+    if (ret == 0 && strcmp(ref_name, result_name) != 0) {
+        fprintf(F, "Cannot compare scenario %s to scenario %s\n", result_name, ref_name);
+        ret = -1;
+    }
+    if (ret == 0) {
+        fprintf(F, "Scenario %s, %s compared to %s:\n", result_name, result_file, ref_file);
+        for (int i = 0; i < QUICRQ_SCENARIO_NB_METRICS; i++) {
+            double delta = (ref_metrics[i] == 0) ? ((result_metrics[i] == 0) ? 0.0 : 100.0) :
+                100.0 * ((double)result_metrics[i] - (double)ref_metrics[i]) / (double)ref_metrics[i];
+            /* The number of objects is reported, but more objects is not a regression */
+            int is_regression = (i > 0 && 100 * result_metrics[i] > (100 + (uint64_t)tolerance_percent) * ref_metrics[i]);
+
+            fprintf(F, "    %-8s %12" PRIu64 " %12" PRIu64 " %+8.2f%%%s\n", metric_names[i], ref_metrics[i],
+                result_metrics[i], delta, (is_regression) ? " REGRESSION" : "");
+            if (is_regression) {
+                ret = -1;
+            }
+        }
+    }
+    return ret;
+}
+
+/* Scenario test: run a few seeds twice, verify that the results are
+ * reproducible and consistent.
+ */
+int quicrq_scenario_test()
+{
+    char const* result_files[2] = { "scenario-relay-datagram-1.csv", "scenario-relay-datagram-2.csv" };
+    char scenario_name[256];
+    uint64_t metrics[QUICRQ_SCENARIO_NB_METRICS];
+    int ret = 0;
+
+    for (int i = 0; ret == 0 && i < 2; i++) {
+        ret = quicrq_scenario_run("relay-datagram", 3, 1, result_files[i]);
+    }
+
+    if (ret == 0) {
+        ret = quicrq_scenario_read_summary(result_files[0], scenario_name, sizeof(scenario_name), metrics);
+    }
+
+    if (ret == 0 && (metrics[0] == 0 || metrics[3] > metrics[4] || metrics[4] > metrics[5])) {
+        DBG_PRINTF("Inconsistent summary, %" PRIu64 " objects, p50=%" PRIu64 ", p95=%" PRIu64 ", p99=%" PRIu64,
+            metrics[0], metrics[3], metrics[4], metrics[5]);
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Same seeds, same results: the comparison shall pass with zero tolerance */
+        ret = quicrq_scenario_compare(result_files[0], result_files[1], 0, stdout);
+        if (ret != 0) {
+            DBG_PRINTF("%s", "Scenario results are not reproducible");
+        }
+    }
+
+    return ret;
+}
@@ -50,8 +50,11 @@ void* test_media_publisher_init(char const* media_source_path, const generation_
         memset(media_ctx, 0, sizeof(test_media_publisher_context_t));
         media_ctx->start_time = start_time;
         media_ctx->is_real_time = (is_real_time != 0);
-        media_ctx->F = picoquic_file_open(media_source_path, "rb");
-        media_ctx->is_audio = test_media_is_audio((const uint8_t*)media_source_path, strlen(media_source_path));
+        if (media_source_path != NULL) {
+            /* If no path is specified, the media is generated */
+            media_ctx->F = picoquic_file_open(media_source_path, "rb");
+            media_ctx->is_audio = test_media_is_audio((const uint8_t*)media_source_path, strlen(media_source_path));
+        }
 
         if (media_ctx->F == NULL) {
             if (generation_model != NULL) {
@@ -460,6 +463,50 @@ int test_media_is_new_group(size_t media_object_size)
     return (media_object_size > 10000 || media_object_size < 200);
 }
 
+/* Time at which the next object, or the next chunk of the object, is produced */
+static uint64_t test_media_object_source_publish_time(test_media_object_source_context_t* object_pub_ctx)
+{
+    test_media_publisher_context_t* pub_ctx = object_pub_ctx->pub_ctx;
+    uint64_t publish_time = pub_ctx->start_time + pub_ctx->current_header.timestamp;
+
+    if (object_pub_ctx->nb_chunks > 1) {
+        publish_time += (object_pub_ctx->production_time * (object_pub_ctx->nb_chunks_published + 1)) / object_pub_ctx->nb_chunks;
+    }
+    else {
+        publish_time += object_pub_ctx->production_time;
+    }
+    return publish_time;
+}
+
+/* Publish the next chunk of the current object, opening the object on the
+ * first chunk and closing it on the last one. */
+static int test_media_object_source_publish_chunk(test_media_object_source_context_t* object_pub_ctx,
+    quicrq_media_object_properties_t* properties, uint64_t group_id, uint64_t object_id)
+{
+    int ret = 0;
+    test_media_publisher_context_t* pub_ctx = object_pub_ctx->pub_ctx;
+    size_t chunk_start = (pub_ctx->media_object_size * object_pub_ctx->nb_chunks_published) / object_pub_ctx->nb_chunks;
+    size_t chunk_end = (pub_ctx->media_object_size * (object_pub_ctx->nb_chunks_published + 1)) / object_pub_ctx->nb_chunks;
+
+    if (object_pub_ctx->nb_chunks_published == 0) {
+        ret = quicrq_publish_object_open(object_pub_ctx->object_source_ctx, properties, group_id, object_id);
+    }
+    if (ret == 0) {
+        object_pub_ctx->nb_chunks_published++;
+        if (object_pub_ctx->nb_chunks_published >= object_pub_ctx->nb_chunks) {
+            ret = quicrq_publish_object_close(object_pub_ctx->object_source_ctx, pub_ctx->media_object + chunk_start,
+                chunk_end - chunk_start);
+            object_pub_ctx->nb_chunks_published = 0;
+            object_pub_ctx->object_is_published = 1;
+        }
+        else {
+            ret = quicrq_publish_object_append(object_pub_ctx->object_source_ctx, pub_ctx->media_object + chunk_start,
+                chunk_end - chunk_start);
+        }
+    }
+    return ret;
+}
+
 int test_media_object_source_iterate(
     test_media_object_source_context_t* object_pub_ctx,
     uint64_t current_time, int * is_active)
@@ -480,8 +527,16 @@ int test_media_object_source_iterate(
                 object_pub_ctx->object_is_published = 1;
                 *is_active |= 1;
             }
+            else if (object_pub_ctx->nb_chunks_published > 0) {
+                /* The object is being published in chunks */
+                if (!pub_ctx->is_real_time ||
+                    current_time >= test_media_object_source_publish_time(object_pub_ctx)) {
+                    ret = test_media_object_source_publish_chunk(object_pub_ctx, NULL, 0, 0);
+                    *is_active |= 1;
+                }
+            }
             else if (!pub_ctx->is_real_time ||
-                current_time >= pub_ctx->start_time + pub_ctx->current_header.timestamp) {
+                current_time >= test_media_object_source_publish_time(object_pub_ctx)) {
                 /* else if the data is not published, publish it */
                 int is_new_group = test_media_is_new_group(pub_ctx->media_object_size);
                 quicrq_media_object_properties_t properties = { 0 };
@@ -490,9 +545,22 @@ int test_media_object_source_iterate(
                     published_object_id = 0;
                 }
                 properties.flags = test_media_set_flags(pub_ctx->is_real_time, pub_ctx->is_audio, pub_ctx->media_object_size);
-                ret = quicrq_publish_object(object_pub_ctx->object_source_ctx, pub_ctx->media_object, pub_ctx->media_object_size, 
-                    &properties, published_group_id, published_object_id);
-                object_pub_ctx->object_is_published = 1;
+                if (object_pub_ctx->declare_dependency) {
+                    /* First object of group is a key frame, the others are predicted from the previous one */
+                    properties.dependency = (published_object_id == 0 || pub_ctx->is_audio) ?
+                        quicrq_object_dependency_independent : quicrq_object_dependency_previous;
+                }
+                if (object_pub_ctx->origin_clock_base != 0) {
+                    properties.origin_timestamp = object_pub_ctx->origin_clock_base + pub_ctx->current_header.timestamp;
+                }
+                if (object_pub_ctx->nb_chunks > 1) {
+                    ret = test_media_object_source_publish_chunk(object_pub_ctx, &properties, published_group_id, published_object_id);
+                }
+                else {
+                    ret = quicrq_publish_object(object_pub_ctx->object_source_ctx, pub_ctx->media_object, pub_ctx->media_object_size,
+                        &properties, published_group_id, published_object_id);
+                    object_pub_ctx->object_is_published = 1;
+                }
                 *is_active |= 1;
             }
         }
@@ -518,7 +586,7 @@ uint64_t test_media_object_source_next_time(
                 next_time = current_time;
             }
             else if (pub_ctx->is_real_time) {
-                next_time = pub_ctx->start_time + pub_ctx->current_header.timestamp;
+                next_time = test_media_object_source_publish_time(object_pub_ctx);
             }
             else {
                 next_time = current_time;
@@ -652,7 +720,10 @@ typedef struct st_test_media_consumer_context_t {
     quicrq_media_object_header_t current_header;
 
     quicrq_reassembly_context_t reassembly_ctx;
-
+    /* Offset between the origin timestamps and the object timestamps, learned
+     * from the first object that carries an origin timestamp */
+    int is_origin_clock_known;
+    uint64_t origin_clock_base;
 } test_media_consumer_context_t;
 
 int test_media_derive_file_names(const uint8_t* url, size_t url_length, quicrq_transport_mode_enum transport_mode, int is_real_time, int is_post,
@@ -782,6 +853,7 @@ int test_media_consumer_object_ready(
     uint64_t group_id,
     uint64_t object_id,
     uint8_t flags,
+    uint64_t origin_timestamp,
     const uint8_t* data,
     size_t data_length,
     quicrq_reassembly_object_mode_enum object_mode)
@@ -811,6 +883,18 @@ int test_media_consumer_object_ready(
                 }
             }
         }
+        if (ret == 0 && origin_timestamp != 0) {
+            /* The origin timestamps shall follow the object timestamps, up to a constant offset */
+            if (!cons_ctx->is_origin_clock_known) {
+                cons_ctx->origin_clock_base = origin_timestamp - current_header.timestamp;
+                cons_ctx->is_origin_clock_known = 1;
+            }
+            else if (origin_timestamp != cons_ctx->origin_clock_base + current_header.timestamp) {
+                DBG_PRINTF("Object %" PRIu64 "/%" PRIu64 ", origin timestamp %" PRIu64 " does not match the object timestamp %" PRIu64,
+                    group_id, object_id, origin_timestamp, current_header.timestamp);
+                ret = -1;
+            }
+        }
         if (ret == 0) {
             /* if in sequence, write the data to the file. */
             if (object_mode != quicrq_reassembly_object_peek) {
@@ -835,6 +919,7 @@ int test_media_object_consumer_cb(
     uint8_t flags,
     uint64_t nb_objects_previous_group,
     uint64_t object_length,
+    uint64_t origin_timestamp,
     size_t data_length)
 {
     int ret = 0;
@@ -843,7 +928,7 @@ int test_media_object_consumer_cb(
     switch (action) {
     case quicrq_media_datagram_ready:
         ret = quicrq_reassembly_input(&cons_ctx->reassembly_ctx, current_time, data, group_id, object_id, offset,
-            queue_delay, flags, nb_objects_previous_group, object_length, data_length,
+            queue_delay, flags, nb_objects_previous_group, object_length, origin_timestamp, data_length,
             test_media_consumer_object_ready, cons_ctx);
         if (ret == 0 && cons_ctx->reassembly_ctx.is_finished) {
             ret = quicrq_consumer_finished;
@@ -963,6 +1048,15 @@ int test_object_stream_consumer_cb(
                     ret = -1;
                 }
             }
+            if (ret == 0 && cons_ctx->origin_clock_base != 0) {
+                /* Verify that the origin timestamp was carried end to end */
+                if (properties != NULL && properties->origin_timestamp == cons_ctx->origin_clock_base + current_header.timestamp) {
+                    cons_ctx->nb_origin_timestamps++;
+                }
+                else {
+                    cons_ctx->nb_origin_timestamp_errors++;
+                }
+            }
             if (ret == 0) {
                 /* in sequence, write the data to the file. */
                 if (fwrite(data, 1, data_length, cons_ctx->Res) != data_length) {
@@ -1165,6 +1259,67 @@ int quicrq_compare_media_file_ex(char const* media_result_file, char const* medi
     return ret;
 }
 
+/* Verify a media file received from a generated source. The content of generated objects
+ * is random, so it cannot be compared to a reference file. Instead, verify that no object
+ * is missing or truncated: the objects shall be numbered in sequence, have the timestamps
+ * and sizes set by the generation model, and be as many as the model generates.
+ */
+int quicrq_compare_generated_media_file(char const* media_result_file, const generation_parameters_t* generation_model)
+{
+    int ret = 0;
+    test_media_publisher_context_t* result_ctx = (test_media_publisher_context_t*)
+        test_media_publisher_init(media_result_file, NULL, 0, 0);
+    uint64_t nb_objects = 0;
+    uint64_t nb_objects_expected = 0;
+    size_t size_max = generation_model->target_p_max * ((generation_model->nb_p_in_i > 1) ? generation_model->nb_p_in_i : 1);
+
+    while ((nb_objects_expected * 1000000ull) / generation_model->objects_per_second < generation_model->target_duration) {
+        nb_objects_expected++;
+    }
+
+    if (result_ctx == NULL) {
+        ret = -1;
+        DBG_PRINTF("Could not open result file %s, ret=%d", media_result_file, ret);
+    }
+    else {
+        while (ret == 0) {
+            ret = test_media_read_object_from_file(result_ctx);
+            if (ret != 0) {
+                DBG_PRINTF("Could not read object from results, ret=%d", ret);
+            }
+            else if (result_ctx->is_finished) {
+                break;
+            }
+            else if (result_ctx->media_object_size == 0 || result_ctx->current_header.length == 0) {
+                ret = -1;
+                DBG_PRINTF("Object #%" PRIu64 " was lost", nb_objects);
+            }
+            else if (result_ctx->current_header.number != nb_objects ||
+                result_ctx->current_header.timestamp != (nb_objects * 1000000ull) / generation_model->objects_per_second) {
+                ret = -1;
+                DBG_PRINTF("Object #%" PRIu64 " received as number %" PRIu64 ", time %" PRIu64, nb_objects,
+                    result_ctx->current_header.number, result_ctx->current_header.timestamp);
+            }
+            else if (result_ctx->current_header.length < generation_model->target_p_min ||
+                result_ctx->current_header.length > size_max) {
+                ret = -1;
+                DBG_PRINTF("Object #%" PRIu64 " length %zu out of range", nb_objects, result_ctx->current_header.length);
+            }
+            else {
+                nb_objects++;
+            }
+        }
+        test_media_publisher_close(result_ctx);
+    }
+
+    if (ret == 0 && nb_objects != nb_objects_expected) {
+        ret = -1;
+        DBG_PRINTF("Received %" PRIu64 " objects instead of %" PRIu64, nb_objects, nb_objects_expected);
+    }
+
+    return ret;
+}
+
 int quicrq_compare_media_file(char const* media_result_file, char const* media_reference_file)
 {
     return quicrq_compare_media_file_ex(media_result_file, media_reference_file, NULL, NULL, 0, 0);
@@ -1321,6 +1476,278 @@ int quicrq_log_file_statistics(char const* media_result_log, int* nb_frames, int
     return ret;
 }
 
+/* List the delivery delays of the objects in a log file, in the order of the log.
+ * The delays are appended to the array *delays, which is allocated or extended
+ * as needed and shall be freed by the caller. Objects that were not received,
+ * e.g., skipped by a relay, are counted in nb_losses.
+ */
+int quicrq_log_file_delays(char const* media_result_log, uint64_t** delays, size_t* nb_delays, size_t* delays_alloc,
+    int* nb_losses)
+{
+    int ret = 0;
+    int last_err1 = 0;
+    FILE* F = picoquic_file_open_ex(media_result_log, "r", &last_err1);
+
+    if (F == NULL) {
+        ret = -1;
+    }
+    else {
+        char result_line[512];
+        while (ret == 0) {
+            char* result_read = fgets(result_line, sizeof(result_line), F);
+            if (result_read == NULL) {
+                break;
+            }
+            else {
+                int g_id = 0;
+                int o_id = 0;
+                int a_time = 0;
+                int o_time = 0;
+                int f_num = 0;
+                int len = 0;
+                const char* s = result_line;
+                const char* s_max = result_line + strlen(result_line);
+
+                /* Parse the log line */
+                if (NULL != (s = quicrq_get_log_number(s, s_max, &g_id)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &o_id)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &a_time)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &o_time)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &f_num))) {
+                    s = quicrq_get_log_number(s, s_max, &len);
+                }
+                if (s == NULL) {
+                    ret = -1;
+                }
+                else if (len <= 0) {
+                    *nb_losses += 1;
+                }
+                else {
+                    if (*nb_delays >= *delays_alloc) {
+                        size_t new_alloc = (*delays_alloc == 0) ? 256 : 2 * (*delays_alloc);
+                        uint64_t* new_delays = (uint64_t*)malloc(new_alloc * sizeof(uint64_t));
+                        if (new_delays == NULL) {
+                            ret = -1;
+                            break;
+                        }
+                        if (*nb_delays > 0) {
+                            memcpy(new_delays, *delays, *nb_delays * sizeof(uint64_t));
+                        }
+                        if (*delays != NULL) {
+                            free(*delays);
+                        }
+                        *delays = new_delays;
+                        *delays_alloc = new_alloc;
+                    }
+                    (*delays)[*nb_delays] = (a_time > o_time) ? a_time - o_time : 0;
+                    *nb_delays += 1;
+                }
+            }
+        }
+        picoquic_file_close(F);
+    }
+
+    return ret;
+}
+
+static int quicrq_compare_delays(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/* Compute the percentiles of a list of delays, e.g., obtained with quicrq_log_file_delays,
+ * using the nearest rank method. The delays are sorted in place. The percentiles
+ * are set to 0 if the list is empty.
+ */
+void quicrq_delay_percentiles(uint64_t* delays, size_t nb_delays, const int* ranks, size_t nb_ranks, uint64_t* percentiles)
+{
+    qsort(delays, nb_delays, sizeof(uint64_t), quicrq_compare_delays);
+
+    for (size_t i = 0; i < nb_ranks; i++) {
+        if (nb_delays == 0) {
+            percentiles[i] = 0;
+        }
+        else {
+            size_t rank = (ranks[i] * nb_delays + 99) / 100;
+            percentiles[i] = delays[(rank > 0) ? rank - 1 : 0];
+        }
+    }
+}
+
+/* Find the first object received at or after start_time with a delivery delay of at
+ * most delay_max, i.e., the time at which the receiver reached the live edge.
+ * Returns -1 if the log cannot be read, or if the live edge is never reached.
+ */
+int quicrq_log_file_live_edge(char const* media_result_log, uint64_t start_time, uint64_t delay_max, uint64_t* edge_time)
+{
+    int ret = -1;
+    int last_err1 = 0;
+    FILE* F = picoquic_file_open_ex(media_result_log, "r", &last_err1);
+
+    *edge_time = UINT64_MAX;
+
+    if (F != NULL) {
+        char result_line[512];
+        while (fgets(result_line, sizeof(result_line), F) != NULL) {
+            int g_id = 0;
+            int o_id = 0;
+            int a_time = 0;
+            int o_time = 0;
+            int f_num = 0;
+            int len = 0;
+            const char* s = result_line;
+            const char* s_max = result_line + strlen(result_line);
+
+            /* Parse the log line */
+            if (NULL != (s = quicrq_get_log_number(s, s_max, &g_id)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &o_id)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &a_time)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &o_time)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &f_num))) {
+                s = quicrq_get_log_number(s, s_max, &len);
+            }
+            if (s == NULL) {
+                break;
+            }
+            else if (len > 0 && (uint64_t)a_time >= start_time &&
+                (a_time < o_time || (uint64_t)(a_time - o_time) <= delay_max)) {
+                *edge_time = a_time;
+                ret = 0;
+                break;
+            }
+        }
+        picoquic_file_close(F);
+    }
+
+    return ret;
+}
+
+/* Find the highest group and object id of the objects received in a log file.
+ * Returns -1 if the log cannot be read, or if no object was received.
+ */
+int quicrq_log_file_last_object(char const* media_result_log, uint64_t* group_id, uint64_t* object_id)
+{
+    int ret = -1;
+    int last_err1 = 0;
+    FILE* F = picoquic_file_open_ex(media_result_log, "r", &last_err1);
+
+    *group_id = 0;
+    *object_id = 0;
+
+    if (F != NULL) {
+        char result_line[512];
+        while (fgets(result_line, sizeof(result_line), F) != NULL) {
+            int g_id = 0;
+            int o_id = 0;
+            int a_time = 0;
+            int o_time = 0;
+            int f_num = 0;
+            int len = 0;
+            const char* s = result_line;
+            const char* s_max = result_line + strlen(result_line);
+
+            /* Parse the log line */
+            if (NULL != (s = quicrq_get_log_number(s, s_max, &g_id)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &o_id)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &a_time)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &o_time)) &&
+                NULL != (s = quicrq_get_log_number(s, s_max, &f_num))) {
+                s = quicrq_get_log_number(s, s_max, &len);
+            }
+            if (s == NULL) {
+                ret = -1;
+                break;
+            }
+            else if (len > 0 && (ret != 0 || (uint64_t)g_id > *group_id ||
+                ((uint64_t)g_id == *group_id && (uint64_t)o_id > *object_id))) {
+                *group_id = g_id;
+                *object_id = o_id;
+                ret = 0;
+            }
+        }
+        picoquic_file_close(F);
+    }
+
+    return ret;
+}
+
+/* Count the objects that could be decoded, assuming that each object
+ * depends on all the previous objects in the same group, and the
+ * bytes received for objects that could not be decoded.
+ */
+int quicrq_log_file_decodable(char const* media_result_log, int* nb_frames, int* nb_decodable, uint64_t* undecodable_bytes)
+{
+    int ret = 0;
+    int last_err1 = 0;
+    *nb_frames = 0;
+    *nb_decodable = 0;
+    *undecodable_bytes = 0;
+
+    FILE* F = picoquic_file_open_ex(media_result_log, "r", &last_err1);
+
+    if (F == NULL) {
+        ret = -1;
+    }
+    else {
+        char result_line[512];
+        int current_group_id = -1;
+        int is_chain_broken = 0;
+        while (ret == 0) {
+            char* result_read = fgets(result_line, sizeof(result_line), F);
+            if (result_read == NULL) {
+                break;
+            }
+            else {
+                int g_id = 0;
+                int o_id = 0;
+                int a_time = 0;
+                int o_time = 0;
+                int f_num = 0;
+                int len = 0;
+                const char* s = result_line;
+                const char* s_max = result_line + strlen(result_line);
+
+                /* Parse the log line */
+                if (NULL != (s = quicrq_get_log_number(s, s_max, &g_id)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &o_id)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &a_time)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &o_time)) &&
+                    NULL != (s = quicrq_get_log_number(s, s_max, &f_num))) {
+                    s = quicrq_get_log_number(s, s_max, &len);
+                }
+                if (s == NULL) {
+                    ret = -1;
+                    break;
+                }
+                else {
+                    *nb_frames += 1;
+                    if (g_id != current_group_id) {
+                        current_group_id = g_id;
+                        is_chain_broken = 0;
+                    }
+                    if (len <= 0) {
+                        is_chain_broken = 1;
+                    }
+                    else if (is_chain_broken) {
+                        *undecodable_bytes += len;
+                    }
+                    else {
+                        *nb_decodable += 1;
+                    }
+                }
+            }
+        }
+    }
+    if (F != NULL) {
+        picoquic_file_close(F);
+    }
+
+    return ret;
+}
+
 /* The media test provides two results:
  * - a media result file, which shuld be identical to the media source file
  * - a media result log, which provides for each received object the receive time, compared to the media time
@@ -1396,7 +1823,7 @@ int quicrq_media_api_test_one(char const *media_source_name, char const* media_l
                 }
             }
             ret = test_media_object_consumer_cb(quicrq_media_datagram_ready, cons_ctx, current_time, media_buffer,
-                group_id, object_id, object_offset, 0, flags, nb_objects_previous_group, object_length, data_length);
+                group_id, object_id, object_offset, 0, flags, nb_objects_previous_group, object_length, 0, data_length);
             if (ret != 0) {
                 DBG_PRINTF("Consumer, ret=%d", ret);
             }
@@ -1419,7 +1846,7 @@ int quicrq_media_api_test_one(char const *media_source_name, char const* media_l
 
     if (ret == 0) {
         ret = test_media_object_consumer_cb(quicrq_media_final_object_id, cons_ctx, current_time, NULL,
-            group_id, object_id, 0, 0, 0, 0, 0, 0);
+            group_id, object_id, 0, 0, 0, 0, 0, 0, 0);
         if (ret == quicrq_consumer_finished) {
             ret = 0;
         }
@@ -1649,7 +2076,7 @@ int quicrq_media_datagram_test_one(char const* media_source_name, char const* me
             /* Simulate arrival of packet -- TODO: deal with group_id */
             uint64_t nb_objects_previous_group = 0;
             ret = test_media_object_consumer_cb(quicrq_media_datagram_ready, cons_ctx, current_time, media_buffer,
-                    group_id, object_id, object_offset, 0, flags, nb_objects_previous_group, object_length, data_length);
+                    group_id, object_id, object_offset, 0, flags, nb_objects_previous_group, object_length, 0, data_length);
             if (ret != 0) {
                 DBG_PRINTF("Media consumer callback: ret = %d", ret);
                 break;
@@ -1671,7 +2098,7 @@ int quicrq_media_datagram_test_one(char const* media_source_name, char const* me
 
     /* Indicate the final object_id, to simulate what datagrams would do */
     if (ret == 0) {
-        ret = test_media_object_consumer_cb(quicrq_media_final_object_id, cons_ctx, current_time, NULL, group_id, object_id, 0, 0, 0, 0, 0, 0);
+        ret = test_media_object_consumer_cb(quicrq_media_final_object_id, cons_ctx, current_time, NULL, group_id, object_id, 0, 0, 0, 0, 0, 0, 0);
         if (ret == quicrq_consumer_finished) {
             consumer_properly_finished = 1;
             if (nb_losses > 0) {
@@ -1698,7 +2125,7 @@ int quicrq_media_datagram_test_one(char const* media_source_name, char const* me
                 /* Simulate repair of a hole */
                 actual_dup++;
                 ret = test_media_object_consumer_cb(quicrq_media_datagram_ready, cons_ctx, current_time, loss->media_buffer,
-                    loss->group_id, loss->object_id, loss->offset, 0, 0, 0, loss->object_length, loss->length);
+                    loss->group_id, loss->object_id, loss->offset, 0, 0, 0, loss->object_length, 0, loss->length);
                 if (ret != 0) {
                     DBG_PRINTF("Media consumer callback: ret = %d", ret);
                 }
@@ -1716,7 +2143,7 @@ int quicrq_media_datagram_test_one(char const* media_source_name, char const* me
         while (loss != NULL && ret == 0) {
             /* Simulate repair of a hole */
             ret = test_media_object_consumer_cb(quicrq_media_datagram_ready, cons_ctx, current_time, loss->media_buffer,
-                loss->group_id, loss->object_id, loss->offset, 0, 0, 0, loss->object_length, loss->length);
+                loss->group_id, loss->object_id, loss->offset, 0, 0, 0, loss->object_length, 0, loss->length);
             if (ret == quicrq_consumer_finished) {
                 consumer_properly_finished = 1;
                 ret = 0;
@@ -236,6 +236,12 @@ int quicrq_triangle_test_one(quicrq_transport_mode_enum transport_mode, quicrq_t
                 start_group_intent =  intent.start_group_id;
                 start_object_intent = intent.start_object_id;
                 break;
+            case quicrq_subscribe_intent_start_time:
+                /* Group 1 started before the subscription time, group 2 did not */
+                intent.start_time = config->simulated_time;
+                start_group_intent = 1;
+                start_object_intent = 0;
+                break;
             default:
                 break;
             }
@@ -590,6 +596,26 @@ int quicrq_triangle_intent_that_s_test()
     return ret;
 }
 
+int quicrq_triangle_intent_time_test()
+{
+    quicrq_triangle_test_spec_t spec = triangle_test_default;
+    spec.test_cache_clear = 1;
+    spec.test_intent = 4;
+    int ret = quicrq_triangle_test_one(quicrq_transport_mode_datagram, &spec);
+
+    return ret;
+}
+
+int quicrq_triangle_intent_time_s_test()
+{
+    quicrq_triangle_test_spec_t spec = triangle_test_default;
+    spec.test_cache_clear = 1;
+    spec.test_intent = 4;
+    int ret = quicrq_triangle_test_one(quicrq_transport_mode_single_stream, &spec);
+
+    return ret;
+}
+
 int quicrq_triangle_intent_warp_test()
 {
     quicrq_triangle_test_spec_t spec = triangle_test_default;
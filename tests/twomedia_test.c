@@ -259,3 +259,213 @@ int quicrq_twomedia_datagram_client_loss_test()
 {
     return quicrq_twomedia_test_one(1, quicrq_transport_mode_datagram, 0xf080, 1, 0, 0);
 }
+
+/* Two medias with per track congestion weights.
+ * The server publishes the video and audio sources to the client over a
+ * congested link, with delay based congestion control. The video is bursty
+ * and exceeds its share of the link, the audio stays well below its own.
+ * With weights set, only the video should skip objects, and the audio should
+ * be received intact.
+ */
+int quicrq_twomedia_congestion_test_one(quicrq_transport_mode_enum transport_mode, uint64_t video_weight, uint64_t audio_weight)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_two_media_config_create(0, 0);
+    quicrq_cnx_ctx_t* cnx_ctx = NULL;
+    picoquictest_sim_link_t* congested_link = NULL;
+    char media_source_path[512];
+    char result_file_name[512];
+    char result_log_name[512];
+    char audio_source_path[512];
+    char audio_file_name[512];
+    char audio_log_name[512];
+    char text_log_name[512];
+    char test_id[256];
+    size_t nb_log_chars = 0;
+
+    (void)picoquic_sprintf(test_id, sizeof(test_id), NULL, "twomedia-congestion-%c-%llu-%llu",
+        quicrq_transport_mode_to_letter(transport_mode), (unsigned long long)video_weight, (unsigned long long)audio_weight);
+    (void)picoquic_sprintf(text_log_name, sizeof(text_log_name), &nb_log_chars, "%s_textlog.txt", test_id);
+    (void)picoquic_sprintf(result_file_name, sizeof(result_file_name), NULL, "%s_video1.bin", test_id);
+    (void)picoquic_sprintf(result_log_name, sizeof(result_log_name), NULL, "%s_video1.csv", test_id);
+    (void)picoquic_sprintf(audio_file_name, sizeof(audio_file_name), NULL, "%s_audio.bin", test_id);
+    (void)picoquic_sprintf(audio_log_name, sizeof(audio_log_name), NULL, "%s_audio.csv", test_id);
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+    else if (picoquic_get_input_path(audio_source_path, sizeof(audio_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_AUDIO_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Replace the link from server to client by a congested link */
+        struct sockaddr* dest_addr = quicrq_test_find_send_addr(config, 0, 1);
+        int replaced_link_id = quicrq_test_find_send_link(config, 0, dest_addr, NULL);
+
+        congested_link = picoquictest_sim_link_create(0.001, 10000, NULL, 0, config->simulated_time);
+        if (replaced_link_id < 0 || congested_link == NULL) {
+            ret = -1;
+        }
+        else {
+            picoquictest_sim_link_delete(config->links[replaced_link_id]);
+            config->links[replaced_link_id] = congested_link;
+            config->congested_link_id = replaced_link_id;
+            congested_link = NULL;
+        }
+    }
+
+    for (int i = 0; ret == 0 && i < 2; i++) {
+        quicrq_enable_congestion_control(config->nodes[i], quicrq_congestion_control_delay);
+    }
+
+    if (ret == 0 && video_weight > 0) {
+        ret = quicrq_set_media_congestion_weight(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), video_weight);
+    }
+
+    if (ret == 0 && audio_weight > 0) {
+        ret = quicrq_set_media_congestion_weight(config->nodes[0], (uint8_t*)QUICRQ_TEST_AUDIO_SOURCE,
+            strlen(QUICRQ_TEST_AUDIO_SOURCE), audio_weight);
+    }
+
+    /* Add QUIC level log */
+    if (ret == 0) {
+        ret = picoquic_set_textlog(config->nodes[1]->quic, text_log_name);
+    }
+
+    if (ret == 0) {
+        /* Add the video and audio sources to the server */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        config->object_sources[1] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_AUDIO_SOURCE,
+            strlen(QUICRQ_TEST_AUDIO_SOURCE), audio_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL || config->object_sources[1] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Create a quirq connection context on client */
+        cnx_ctx = quicrq_test_create_client_cnx(config, 1, 0);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection, ret = %d", ret);
+        }
+    }
+
+    if (ret == 0) {
+        test_object_stream_ctx_t* object_stream_ctx = NULL;
+        object_stream_ctx = test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name, result_log_name);
+        if (object_stream_ctx == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        test_object_stream_ctx_t* object_stream_ctx = NULL;
+        object_stream_ctx = test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_AUDIO_SOURCE,
+            strlen(QUICRQ_TEST_AUDIO_SOURCE), transport_mode, audio_file_name, audio_log_name);
+        if (object_stream_ctx == NULL) {
+            ret = -1;
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+
+        ret = quicrq_test_loop_step(config, &is_active, UINT64_MAX);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+        /* if the media is received, exit the loop */
+        if (config->nodes[1]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else {
+            int client_stream_closed = config->nodes[1]->first_cnx->first_stream == NULL;
+            int server_stream_closed = config->nodes[0]->first_cnx != NULL && config->nodes[0]->first_cnx->first_stream == NULL;
+
+            if (!is_closed && client_stream_closed && server_stream_closed) {
+                /* Client is done. Close connection without waiting for timer */
+                ret = picoquic_close(config->nodes[1]->first_cnx->cnx, 0);
+                is_closed = 1;
+                if (ret != 0) {
+                    DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+    if (congested_link != NULL) {
+        picoquictest_sim_link_delete(congested_link);
+    }
+
+    /* The audio shall be intact, the video may have skipped objects */
+    if (ret == 0) {
+        int observed_drops = 0;
+        uint8_t observed_min_loss = 0xff;
+
+        ret = quicrq_compare_media_file(audio_file_name, audio_source_path);
+        if (ret != 0) {
+            DBG_PRINTF("Audio was not received intact, ret = %d", ret);
+        }
+        else {
+            ret = quicrq_compare_media_file_ex(result_file_name, media_source_path, &observed_drops, &observed_min_loss, 0, 0);
+            if (ret != 0) {
+                DBG_PRINTF("Video does not match the source, ret = %d", ret);
+            }
+            else {
+                DBG_PRINTF("Video drops: %d, min loss flag 0x%x", observed_drops, observed_min_loss);
+            }
+        }
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    return ret;
+}
+
+/* Per track congestion test, datagrams, bursty video and audio sharing a
+ * congested link, with the video weighted 4 times the audio. */
+int quicrq_twomedia_congestion_weights_test()
+{
+    return quicrq_twomedia_congestion_test_one(quicrq_transport_mode_datagram, 4, 1);
+}
@@ -189,7 +189,7 @@ int quicrq_twoways_test_one(int is_real_time, quicrq_transport_mode_enum transpo
                             for (int source_id = 0; ret == 0 && source_id < 2; source_id++) {
                                 /* Create a subscription to the test source on client*/
                                 test_object_stream_ctx_t* object_stream_ctx = NULL;
-                                quicrq_subscribe_intent_t intent = { quicrq_subscribe_intent_current_group, 0, 0 };
+                                quicrq_subscribe_intent_t intent = { quicrq_subscribe_intent_current_group, 0, 0, 0, 0, 0 };
                                 object_stream_ctx = test_object_stream_subscribe_ex(cnx_ctx[i], (const uint8_t*)target[source_id]->url,
                                     target[source_id]->url_length, transport_mode, quicrq_subscribe_in_order,
                                     &intent, target[source_id]->target_bin, target[source_id]->target_csv);
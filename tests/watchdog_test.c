@@ -0,0 +1,267 @@
+#include <string.h>
+#include "picoquic_set_textlog.h"
+#include "picoquic_set_binlog.h"
+#include "quicrq.h"
+#include "quicrq_relay.h"
+#include "quicrq_internal.h"
+#include "quicrq_relay_internal.h"
+#include "quicrq_test_internal.h"
+
+/* Watchdog test:
+ * The origin publishes a real time media, two clients subscribe to it through a relay.
+ * The configuration diagram is:
+ *
+ *             S
+ *             |
+ *             R
+ *            / \
+ *          C1   C2
+ *
+ * After some time, the link from the relay to C2 stops delivering packets, so
+ * the subscription of C2 stops making progress while its connection is not yet
+ * timed out. Without the watchdog, that subscription pins the relay cache. With
+ * the watchdog, it is aborted and the relay cache remains bounded.
+ */
+#define QUICRQ_WATCHDOG_TEST_STALL_LINK 5
+#define QUICRQ_WATCHDOG_TEST_STALL_TIME 1000000
+#define QUICRQ_WATCHDOG_TEST_STALL_MAX 500000
+
+/* Create a test network */
+quicrq_test_config_t* quicrq_test_watchdog_config_create(uint64_t simulate_loss)
+{
+    /* Create a configuration with four nodes, three connections, two links and two attachments per connection. */
+    quicrq_test_config_t* config = quicrq_test_config_create(4, 6, 6, 1);
+    if (config != NULL) {
+        /* Create the contexts for the origin (0), relay (1) and clients (2, 3) */
+        for (int i = 0; i < 4; i++) {
+            if (i < 2) {
+                config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                    config->test_server_cert_file, config->test_server_key_file, NULL, NULL, NULL,
+                    config->ticket_encryption_key, sizeof(config->ticket_encryption_key),
+                    &config->simulated_time);
+            }
+            else {
+                config->nodes[i] = quicrq_create(QUICRQ_ALPN,
+                    NULL, NULL, config->test_server_cert_store_file, NULL, NULL,
+                    NULL, 0, &config->simulated_time);
+            }
+            if (config->nodes[i] == NULL) {
+                quicrq_test_config_delete(config);
+                config = NULL;
+                break;
+            }
+        }
+    }
+    if (config != NULL) {
+        /* Populate the links and attachments:
+         * S to R: links 0 and 1, R to C1: links 2 and 3, R to C2: links 4 and 5 */
+        for (int i = 0; i < 3; i++) {
+            int link_id = 2 * i;
+            config->return_links[link_id] = link_id + 1;
+            config->attachments[link_id].link_id = link_id;
+            config->attachments[link_id].node_id = (i == 0) ? 0 : 1;
+            config->return_links[link_id + 1] = link_id;
+            config->attachments[link_id + 1].link_id = link_id + 1;
+            config->attachments[link_id + 1].node_id = i + 1;
+        }
+        /* Set the desired loss pattern */
+        config->simulate_loss = simulate_loss;
+    }
+    return config;
+}
+
+static int quicrq_watchdog_test_cache_size(quicrq_ctx_t* qr_ctx)
+{
+    int nb_fragments = 0;
+    quicrq_media_source_ctx_t* srce_ctx = qr_ctx->first_source;
+
+    while (srce_ctx != NULL) {
+        if (!srce_ctx->is_local_object_source && srce_ctx->cache_ctx != NULL) {
+            nb_fragments += srce_ctx->cache_ctx->fragment_tree.size;
+        }
+        srce_ctx = srce_ctx->next_source;
+    }
+    return nb_fragments;
+}
+
+int quicrq_watchdog_test_one(quicrq_transport_mode_enum transport_mode, int is_watchdog, int* cache_peak)
+{
+    int ret = 0;
+    int nb_steps = 0;
+    int nb_inactive = 0;
+    int is_closed = 0;
+    int is_stalled = 0;
+    const uint64_t max_time = 360000000;
+    const int max_inactive = 128;
+    quicrq_test_config_t* config = quicrq_test_watchdog_config_create(0);
+    char media_source_path[512];
+    char result_file_name[2][256];
+    char result_log_name[2][256];
+    size_t nb_log_chars = 0;
+
+    *cache_peak = 0;
+    for (int i = 0; i < 2; i++) {
+        (void)picoquic_sprintf(result_file_name[i], sizeof(result_file_name[i]), &nb_log_chars, "watchdog-video1-recv-%d-%c-%d.bin",
+            i + 1, quicrq_transport_mode_to_letter(transport_mode), is_watchdog);
+        (void)picoquic_sprintf(result_log_name[i], sizeof(result_log_name[i]), &nb_log_chars, "watchdog-video1-log-%d-%c-%d.csv",
+            i + 1, quicrq_transport_mode_to_letter(transport_mode), is_watchdog);
+    }
+
+    if (config == NULL) {
+        ret = -1;
+    }
+
+    /* Locate the source and reference file */
+    if (picoquic_get_input_path(media_source_path, sizeof(media_source_path),
+        quicrq_test_solution_dir, QUICRQ_TEST_BASIC_SOURCE) != 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        /* Add a real time test source to the origin */
+        config->object_sources[0] = test_media_object_source_publish(config->nodes[0], (uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), media_source_path, NULL, 1, config->simulated_time);
+        if (config->object_sources[0] == NULL) {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        /* Configure the relay: set the server address, check the cache often enough to see the purge */
+        struct sockaddr* addr_to = quicrq_test_find_send_addr(config, 1, 0);
+        ret = quicrq_enable_relay(config->nodes[1], NULL, addr_to, transport_mode);
+        if (ret != 0) {
+            DBG_PRINTF("Cannot enable relay, ret = %d", ret);
+        }
+        quicrq_set_cache_duration(config->nodes[1], QUICRQ_WATCHDOG_TEST_STALL_MAX);
+        if (is_watchdog) {
+            quicrq_set_subscription_watchdog(config->nodes[1], QUICRQ_WATCHDOG_TEST_STALL_MAX, 0);
+        }
+    }
+
+    for (int i = 0; ret == 0 && i < 2; i++) {
+        /* Create a quicrq connection context on each client, and subscribe to the media */
+        quicrq_cnx_ctx_t* cnx_ctx = quicrq_test_create_client_cnx(config, i + 2, 1);
+        if (cnx_ctx == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot create client connection %d, ret = %d", i + 2, ret);
+        }
+        else if (test_object_stream_subscribe(cnx_ctx, (const uint8_t*)QUICRQ_TEST_BASIC_SOURCE,
+            strlen(QUICRQ_TEST_BASIC_SOURCE), transport_mode, result_file_name[i], result_log_name[i]) == NULL) {
+            ret = -1;
+            DBG_PRINTF("Cannot subscribe to test media %s, ret = %d", QUICRQ_TEST_BASIC_SOURCE, ret);
+        }
+    }
+
+    while (ret == 0 && nb_inactive < max_inactive && config->simulated_time < max_time) {
+        /* Run the simulation. Monitor the connection. Monitor the media. */
+        int is_active = 0;
+        int cache_size;
+
+        if (!is_stalled && config->simulated_time >= QUICRQ_WATCHDOG_TEST_STALL_TIME) {
+            /* Stop delivering packets from the relay to C2, as if the client stopped reading */
+            config->links[QUICRQ_WATCHDOG_TEST_STALL_LINK]->picosec_per_byte = 1000000000000ull;
+            is_stalled = 1;
+        }
+
+        ret = quicrq_test_loop_step(config, &is_active, (is_stalled) ? UINT64_MAX : QUICRQ_WATCHDOG_TEST_STALL_TIME);
+        if (ret != 0) {
+            DBG_PRINTF("Fail on loop step %d, %d, active: ret=%d", nb_steps, is_active, ret);
+        }
+
+        nb_steps++;
+
+        cache_size = quicrq_watchdog_test_cache_size(config->nodes[1]);
+        if (cache_size > *cache_peak) {
+            *cache_peak = cache_size;
+        }
+
+        if (is_active) {
+            nb_inactive = 0;
+        }
+        else {
+            nb_inactive++;
+            if (nb_inactive >= max_inactive) {
+                DBG_PRINTF("Exit loop after too many inactive: %d", nb_inactive);
+            }
+        }
+
+        /* if the media is received by C1, exit the loop. C2 cannot complete. */
+        if (config->nodes[2]->first_cnx == NULL) {
+            DBG_PRINTF("%s", "Exit loop after client connection closed.");
+            break;
+        }
+        else if (!is_closed && config->nodes[2]->first_cnx->first_stream == NULL) {
+            /* Client is done. Close connections without waiting for timer */
+            is_closed = 1;
+            for (int i = 2; ret == 0 && i < 4; i++) {
+                if (config->nodes[i]->first_cnx != NULL) {
+                    ret = quicrq_close_cnx(config->nodes[i]->first_cnx);
+                    if (ret != 0) {
+                        DBG_PRINTF("Cannot close client connection, ret = %d", ret);
+                    }
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && (!is_closed || config->simulated_time > 12000000)) {
+        DBG_PRINTF("Session was not properly closed, time = %" PRIu64, config->simulated_time);
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        uint64_t nb_stalled = quicrq_get_nb_stalled_subscriptions(config->nodes[1]);
+
+        DBG_PRINTF("Watchdog %s, %" PRIu64 " stalled subscriptions, cache peak %d fragments",
+            (is_watchdog) ? "on" : "off", nb_stalled, *cache_peak);
+        if (nb_stalled != ((is_watchdog) ? 1 : 0)) {
+            DBG_PRINTF("Expected %d stalled subscriptions, got %" PRIu64, is_watchdog, nb_stalled);
+            ret = -1;
+        }
+    }
+
+    /* Verify that media file was received correctly by the client that kept reading */
+    if (ret == 0) {
+        ret = quicrq_compare_media_file(result_file_name[0], media_source_path);
+    }
+    else {
+        DBG_PRINTF("Test failed before getting results, ret = %d", ret);
+    }
+
+    /* Clear everything. */
+    if (config != NULL) {
+        quicrq_test_config_delete(config);
+    }
+
+    return ret;
+}
+
+/* Compare the relay cache peak with and without the watchdog.
+ * The stalled subscription shall not pin the cache if the watchdog is on.
+ */
+int quicrq_watchdog_test_compare(quicrq_transport_mode_enum transport_mode)
+{
+    int pinned_peak = 0;
+    int watchdog_peak = 0;
+    int ret = quicrq_watchdog_test_one(transport_mode, 0, &pinned_peak);
+
+    if (ret == 0) {
+        ret = quicrq_watchdog_test_one(transport_mode, 1, &watchdog_peak);
+    }
+    if (ret == 0 && (watchdog_peak == 0 || watchdog_peak >= pinned_peak)) {
+        DBG_PRINTF("Cache peak with watchdog %d, not below peak without %d", watchdog_peak, pinned_peak);
+        ret = -1;
+    }
+    return ret;
+}
+
+int quicrq_watchdog_test()
+{
+    return quicrq_watchdog_test_compare(quicrq_transport_mode_single_stream);
+}
+
+int quicrq_watchdog_datagram_test()
+{
+    return quicrq_watchdog_test_compare(quicrq_transport_mode_datagram);
+}